@@ -1,124 +1,65 @@
 #include "bridge.h"
 #include "../core/neuron.h"
 #include "../core/synapse.h"
+#include "../runtime/sim_context.h"
+#include "../runtime/sim_topology.h"
+#include "../runtime/sim_build.h"
+#include "../runtime/sim_reorder.h"
 #include "../memory/mm.h"
 #include "../utils/log.h"
 #include <stdlib.h>
 #include <string.h>
 
-// Global simulation state
-static int g_initialized = 0;
-static Neuron **g_neurons = NULL;
-static int g_neuron_count = 0;
-static int g_neuron_capacity = 0;
-static Synapse **g_synapses = NULL;
-static int g_synapse_count = 0;
-static int g_synapse_capacity = 0;
-static float g_simulation_time = 0.0f;
-
 // Initialize the NeuroCore system
-JNIEXPORT jint JNICALL Java_interop_NeuroBridge_initCore(JNIEnv *env, jobject obj) {
-    if (g_initialized) {
-        log_warn("NeuroCore already initialized");
+JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_initCore(JNIEnv *env, jobject obj, jint numThreads) {
+    if (numThreads < 0) {
+        log_error("Invalid number of threads");
         return 0;
     }
     
-    // Initialize subsystems
-    log_init(NULL, LOG_DEBUG);
-    mm_init();
-    
-    // Allocate initial neuron and synapse arrays
-    g_neuron_capacity = 100;  // Initial capacity
-    g_neurons = (Neuron **)mm_alloc(g_neuron_capacity * sizeof(Neuron *));
-    if (!g_neurons) {
-        log_error("Failed to allocate neuron array");
-        return -1;
-    }
-    
-    g_synapse_capacity = 500;  // Initial capacity
-    g_synapses = (Synapse **)mm_alloc(g_synapse_capacity * sizeof(Synapse *));
-    if (!g_synapses) {
-        mm_free(g_neurons);
-        g_neurons = NULL;
-        log_error("Failed to allocate synapse array");
-        return -1;
+    // Allocate an independent simulation
+    sim_context_t *ctx = sim_context_create((uint32_t)numThreads);
+    if (!ctx) {
+        return 0;
     }
     
-    g_neuron_count = 0;
-    g_synapse_count = 0;
-    g_simulation_time = 0.0f;
-    g_initialized = 1;
-    
     log_info("NeuroCore initialized");
-    return 1;
+    return (jlong)ctx;
 }
 
 // Clean up the NeuroCore system
-JNIEXPORT void JNICALL Java_interop_NeuroBridge_cleanupCore(JNIEnv *env, jobject obj) {
-    if (!g_initialized) {
+JNIEXPORT void JNICALL Java_interop_NeuroBridge_cleanupCore(JNIEnv *env, jobject obj, jlong context) {
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
         return;
     }
     
-    // Free all neurons
-    for (int i = 0; i < g_neuron_count; i++) {
-        if (g_neurons[i]) {
-            neuron_destroy(g_neurons[i]);
-        }
-    }
-    
-    // Free all synapses
-    for (int i = 0; i < g_synapse_count; i++) {
-        if (g_synapses[i]) {
-            synapse_destroy(g_synapses[i]);
-        }
-    }
-    
-    // Free arrays
-    mm_free(g_neurons);
-    mm_free(g_synapses);
-    
-    g_neurons = NULL;
-    g_synapses = NULL;
-    g_neuron_count = 0;
-    g_synapse_count = 0;
-    
-    // Clean up subsystems
-    mm_cleanup();
-    log_cleanup();
-    
-    g_initialized = 0;
+    // Free all neurons, synapses and population state
     log_info("NeuroCore cleaned up");
+    sim_context_destroy(ctx);
 }
 
 // Create a new neuron
 JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_createNeuron(
-    JNIEnv *env, jobject obj, jint id, jint type, jint activation) {
+    JNIEnv *env, jobject obj, jlong context, jint id, jint type, jint activation) {
     
-    if (!g_initialized) {
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
         log_error("NeuroCore not initialized");
         return 0;
     }
     
-    // Check if we need to expand the neuron array
-    if (g_neuron_count >= g_neuron_capacity) {
-        int new_capacity = g_neuron_capacity * 2;
-        Neuron **new_neurons = (Neuron **)mm_realloc(g_neurons, new_capacity * sizeof(Neuron *));
-        if (!new_neurons) {
-            log_error("Failed to expand neuron array");
-            return 0;
-        }
-        g_neurons = new_neurons;
-        g_neuron_capacity = new_capacity;
-    }
-    
     // Create the neuron
     Neuron *neuron = neuron_create(id, (NeuronType)type, (ActivationFunction)activation);
     if (!neuron) {
         return 0;
     }
     
-    // Add to array
-    g_neurons[g_neuron_count++] = neuron;
+    // Add to simulation
+    if (sim_add_neuron(ctx, neuron) < 0) {
+        neuron_destroy(neuron);
+        return 0;
+    }
     
     log_debug("Created neuron with ID %d (JNI)", id);
     return (jlong)neuron;
@@ -126,36 +67,32 @@ JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_createNeuron(
 
 // Delete a neuron
 JNIEXPORT void JNICALL Java_interop_NeuroBridge_deleteNeuron(
-    JNIEnv *env, jobject obj, jlong neuronPtr) {
+    JNIEnv *env, jobject obj, jlong context, jlong neuronPtr) {
     
-    if (!g_initialized) {
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
         return;
     }
     
     Neuron *neuron = (Neuron *)neuronPtr;
     
-    // Find and remove from array
-    for (int i = 0; i < g_neuron_count; i++) {
-        if (g_neurons[i] == neuron) {
-            // Shift remaining neurons
-            for (int j = i; j < g_neuron_count - 1; j++) {
-                g_neurons[j] = g_neurons[j + 1];
-            }
-            g_neuron_count--;
-            break;
-        }
+    // Find and remove from the simulation, which destroys the neuron
+    int slot = neuron ? sim_find_neuron(ctx, neuron->id) : -1;
+    if (slot >= 0 && ctx->neurons[slot] == neuron) {
+        sim_remove_neuron(ctx, (uint32_t)slot);
+        log_debug("Deleted neuron (JNI)");
+        return;
     }
     
-    // Destroy the neuron
-    neuron_destroy(neuron);
-    log_debug("Deleted neuron (JNI)");
+    log_warn("Neuron %p not found (JNI)", (void *)neuron);
 }
 
 // Connect two neurons
 JNIEXPORT jint JNICALL Java_interop_NeuroBridge_connectNeurons(
-    JNIEnv *env, jobject obj, jlong sourcePtr, jlong targetPtr) {
+    JNIEnv *env, jobject obj, jlong context, jlong sourcePtr, jlong targetPtr) {
     
-    if (!g_initialized) {
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
         log_error("NeuroCore not initialized");
         return -1;
     }
@@ -166,45 +103,103 @@ JNIEXPORT jint JNICALL Java_interop_NeuroBridge_connectNeurons(
     return neuron_connect(source, target);
 }
 
+// Connect neurons from a list of (source, target) ID pairs
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_connectNeuronsBulk(
+    JNIEnv *env, jobject obj, jlong context, jintArray pairs) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    jsize length = pairs ? (*env)->GetArrayLength(env, pairs) : 0;
+    if (length % 2 != 0) {
+        log_error("Connections must be (source, target) pairs");
+        return -1;
+    }
+    
+    jint *data = length > 0 ? (*env)->GetIntArrayElements(env, pairs, NULL) : NULL;
+    if (length > 0 && !data) {
+        return -1;
+    }
+    
+    int added = sim_connect_neurons(ctx, (const uint32_t *)data, (uint32_t)(length / 2));
+    
+    if (data) {
+        (*env)->ReleaseIntArrayElements(env, pairs, data, JNI_ABORT);
+    }
+    return added;
+}
+
 // Create a synapse between two neurons
 JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_createSynapse(
-    JNIEnv *env, jobject obj, jint id, jint preId, jint postId, jint type) {
+    JNIEnv *env, jobject obj, jlong context, jint id, jint preId, jint postId, jint type) {
     
-    if (!g_initialized) {
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
         log_error("NeuroCore not initialized");
         return 0;
     }
     
-    // Check if we need to expand the synapse array
-    if (g_synapse_count >= g_synapse_capacity) {
-        int new_capacity = g_synapse_capacity * 2;
-        Synapse **new_synapses = (Synapse **)mm_realloc(g_synapses, new_capacity * sizeof(Synapse *));
-        if (!new_synapses) {
-            log_error("Failed to expand synapse array");
-            return 0;
-        }
-        g_synapses = new_synapses;
-        g_synapse_capacity = new_capacity;
-    }
-    
     // Create the synapse
     Synapse *synapse = synapse_create(id, preId, postId, (SynapseType)type);
     if (!synapse) {
         return 0;
     }
     
-    // Add to array
-    g_synapses[g_synapse_count++] = synapse;
+    // Add to simulation
+    if (sim_add_synapse(ctx, synapse) != 0) {
+        synapse_destroy(synapse);
+        return 0;
+    }
     
     log_debug("Created synapse with ID %d from %d to %d (JNI)", id, preId, postId);
     return (jlong)synapse;
 }
 
+// Set the plasticity rule and weight bounds of a synapse
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setSynapsePlasticity(
+    JNIEnv *env, jobject obj, jlong context, jint id, jint plasticity, jfloat minWeight, jfloat maxWeight) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    Synapse *synapse = sim_find_synapse(ctx, (uint32_t)id);
+    if (!synapse || minWeight > maxWeight) {
+        return -1;
+    }
+    
+    // Bring the record up to date with learning before editing it
+    sim_sync_synapses(ctx);
+    synapse->plasticity = (PlasticityType)plasticity;
+    synapse->min_weight = minWeight;
+    synapse->max_weight = maxWeight;
+    return 0;
+}
+
+// Get the current weight of a synapse
+JNIEXPORT jfloat JNICALL Java_interop_NeuroBridge_getSynapseWeight(
+    JNIEnv *env, jobject obj, jlong context, jint id) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        return 0.0f;
+    }
+    
+    Synapse *synapse = sim_find_synapse(ctx, (uint32_t)id);
+    return synapse ? sim_get_synapse_weight(ctx, synapse) : 0.0f;
+}
+
 // Run a simulation step
 JNIEXPORT jfloatArray JNICALL Java_interop_NeuroBridge_runSimulationStep(
-    JNIEnv *env, jobject obj, jfloatArray inputs, jfloat timeStep) {
+    JNIEnv *env, jobject obj, jlong context, jfloatArray inputs, jfloat timeStep) {
     
-    if (!g_initialized) {
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
         log_error("NeuroCore not initialized");
         return NULL;
     }
@@ -213,78 +208,39 @@ JNIEXPORT jfloatArray JNICALL Java_interop_NeuroBridge_runSimulationStep(
     jsize input_length = (*env)->GetArrayLength(env, inputs);
     jfloat *input_data = (*env)->GetFloatArrayElements(env, inputs, NULL);
     
-    if (input_length > g_neuron_count) {
-        input_length = g_neuron_count;  // Limit to available neurons
+    if (input_length > (jsize)ctx->neuron_count) {
+        input_length = ctx->neuron_count;  // Limit to available neurons
     }
     
     // Apply inputs to input neurons
     for (int i = 0; i < input_length; i++) {
-        if (g_neurons[i]) {
-            g_neurons[i]->potential += input_data[i];
-        }
+        population_add_input(&ctx->population, (uint32_t)i, input_data[i]);
     }
     
     // Release input array
     (*env)->ReleaseFloatArrayElements(env, inputs, input_data, JNI_ABORT);
     
-    // Update simulation time
-    g_simulation_time += timeStep;
-    
     // Process all neurons
-    float *outputs = (float *)mm_alloc(g_neuron_count * sizeof(float));
+    float *outputs = (float *)mm_alloc(ctx->neuron_count * sizeof(float));
     if (!outputs) {
         log_error("Failed to allocate output array");
         return NULL;
     }
     
-    for (int i = 0; i < g_neuron_count; i++) {
-        if (g_neurons[i]) {
-            // Compute neuron state
-            outputs[i] = neuron_compute(g_neurons[i], 0.0f, timeStep);
-            
-            // Check for firing
-            int fired = neuron_fire(g_neurons[i], g_simulation_time);
-            
-            // If neuron fired, propagate signal to connected neurons
-            if (fired) {
-                for (uint32_t j = 0; j < g_neurons[i]->num_connections; j++) {
-                    uint32_t target_id = g_neurons[i]->connected_neurons[j];
-                    
-                    // Find target neuron
-                    for (int k = 0; k < g_neuron_count; k++) {
-                        if (g_neurons[k] && g_neurons[k]->id == target_id) {
-                            // Find synapse between these neurons
-                            for (int s = 0; s < g_synapse_count; s++) {
-                                if (g_synapses[s] && 
-                                    g_synapses[s]->pre_neuron_id == g_neurons[i]->id &&
-                                    g_synapses[s]->post_neuron_id == target_id) {
-                                    
-                                    // Activate synapse
-                                    float signal = synapse_activate(g_synapses[s], 1.0f, g_simulation_time);
-                                    
-                                    // Apply signal to target neuron
-                                    g_neurons[k]->potential += signal;
-                                    break;
-                                }
-                            }
-                            break;
-                        }
-                    }
-                }
-            }
-        } else {
-            outputs[i] = 0.0f;
-        }
+    if (sim_step(ctx, timeStep, outputs) < 0) {
+        log_error("Simulation step failed");
+        mm_free(outputs);
+        return NULL;
     }
     
     // Create output array
-    jfloatArray result = (*env)->NewFloatArray(env, g_neuron_count);
+    jfloatArray result = (*env)->NewFloatArray(env, ctx->neuron_count);
     if (result == NULL) {
         mm_free(outputs);
         return NULL;
     }
     
-    (*env)->SetFloatArrayRegion(env, result, 0, g_neuron_count, outputs);
+    (*env)->SetFloatArrayRegion(env, result, 0, ctx->neuron_count, outputs);
     
     // Free temporary array
     mm_free(outputs);
@@ -292,11 +248,591 @@ JNIEXPORT jfloatArray JNICALL Java_interop_NeuroBridge_runSimulationStep(
     return result;
 }
 
-// Get memory usage statistics
+// Advance the simulation by several steps without copying outputs
+JNIEXPORT jfloat JNICALL Java_interop_NeuroBridge_advanceSimulation(
+    JNIEnv *env, jobject obj, jlong context, jfloat timeStep, jint numSteps) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1.0f;
+    }
+    
+    for (jint i = 0; i < numSteps; i++) {
+        if (sim_step(ctx, timeStep, NULL) < 0) {
+            return -1.0f;
+        }
+    }
+    
+    return ctx->time;
+}
+
+// Queue sparse input. The arrays are read in place inside a critical
+// section, which only copies the touched entries into the input buffer.
+static jint inject(JNIEnv *env, sim_context_t *ctx, int spikes, int channel,
+                   jintArray indices, jfloatArray currents) {
+    jsize count = indices ? (*env)->GetArrayLength(env, indices)
+                          : (currents ? (*env)->GetArrayLength(env, currents) : 0);
+    if (!spikes && (!currents || (*env)->GetArrayLength(env, currents) != count)) {
+        log_error("Input currents and indices differ in length");
+        return -1;
+    }
+    
+    jint *index_data = indices ? (*env)->GetPrimitiveArrayCritical(env, indices, NULL) : NULL;
+    jfloat *current_data = currents ? (*env)->GetPrimitiveArrayCritical(env, currents, NULL) : NULL;
+    const uint32_t *slots = (const uint32_t *)index_data;
+    int status = -1;
+    
+    // A NULL index array means the first slots of the channel, so an array
+    // that failed to pin must not be passed on as one
+    if ((indices && !index_data) || (currents && !current_data)) {
+        log_error("Failed to access input arrays");
+    } else if (channel < 0) {
+        status = spikes ? sim_inject_spikes(ctx, slots, (uint32_t)count)
+                        : sim_inject_currents(ctx, slots, current_data, (uint32_t)count);
+    } else {
+        status = spikes ? sim_inject_channel_spikes(ctx, (uint32_t)channel, slots, (uint32_t)count)
+                        : sim_inject_channel(ctx, (uint32_t)channel, slots, current_data, (uint32_t)count);
+    }
+    
+    if (current_data) {
+        (*env)->ReleasePrimitiveArrayCritical(env, currents, current_data, JNI_ABORT);
+    }
+    if (index_data) {
+        (*env)->ReleasePrimitiveArrayCritical(env, indices, index_data, JNI_ABORT);
+    }
+    return status;
+}
+
+// Queue sparse input currents for the next step
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectCurrents(
+    JNIEnv *env, jobject obj, jlong context, jintArray indices, jfloatArray currents) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || !indices) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return inject(env, ctx, 0, -1, indices, currents);
+}
+
+// Queue spike sources for the next step
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectSpikes(
+    JNIEnv *env, jobject obj, jlong context, jintArray indices) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || !indices) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return inject(env, ctx, 1, -1, indices, NULL);
+}
+
+// Name a range of neuron indices as an input channel
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_defineInputChannel(
+    JNIEnv *env, jobject obj, jlong context, jstring name, jint first, jint count) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || !name || first < 0 || count < 0) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    const char *chars = (*env)->GetStringUTFChars(env, name, NULL);
+    if (!chars) {
+        return -1;
+    }
+    
+    int channel = sim_define_input_channel(ctx, chars, (uint32_t)first, (uint32_t)count);
+    (*env)->ReleaseStringUTFChars(env, name, chars);
+    return channel;
+}
+
+// Queue input currents for a channel, by offset or for its first slots
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectChannel(
+    JNIEnv *env, jobject obj, jlong context, jint channel, jintArray offsets, jfloatArray currents) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || channel < 0 || !currents) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return inject(env, ctx, 0, channel, offsets, currents);
+}
+
+// Queue spike sources of a channel
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectChannelSpikes(
+    JNIEnv *env, jobject obj, jlong context, jint channel, jintArray offsets) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || channel < 0 || !offsets) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return inject(env, ctx, 1, channel, offsets, NULL);
+}
+
+// Start or stop recording spikes
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setSpikeRecording(
+    JNIEnv *env, jobject obj, jlong context, jboolean enabled, jlong maxBytes) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || maxBytes < 0) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return sim_record_spikes(ctx, enabled == JNI_TRUE, (size_t)maxBytes);
+}
+
+// Record only neurons in index ranges
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_selectRecording(
+    JNIEnv *env, jobject obj, jlong context, jintArray ranges) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    jsize length = ranges ? (*env)->GetArrayLength(env, ranges) : 0;
+    if (length % 2 != 0) {
+        log_error("Recording ranges must be (first, count) pairs");
+        return -1;
+    }
+    
+    jint *data = length > 0 ? (*env)->GetIntArrayElements(env, ranges, NULL) : NULL;
+    if (length > 0 && !data) {
+        return -1;
+    }
+    
+    // The pairs have the layout of spike_range_t
+    int status = sim_select_recording(ctx, (const spike_range_t *)data, (uint32_t)(length / 2));
+    
+    if (data) {
+        (*env)->ReleaseIntArrayElements(env, ranges, data, JNI_ABORT);
+    }
+    return status;
+}
+
+// Export the spike raster straight into a new Java array
+JNIEXPORT jbyteArray JNICALL Java_interop_NeuroBridge_exportSpikes(
+    JNIEnv *env, jobject obj, jlong context, jboolean clear) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return NULL;
+    }
+    
+    size_t size = sim_export_spikes(ctx, NULL, 0, 0);
+    if (size > 0x7fffffff) {
+        log_error("Spike raster of %zu bytes exceeds a Java array", size);
+        return NULL;
+    }
+    
+    jbyteArray result = (*env)->NewByteArray(env, (jsize)size);
+    if (result == NULL) {
+        return NULL;
+    }
+    
+    uint8_t *data = (*env)->GetPrimitiveArrayCritical(env, result, NULL);
+    if (!data) {
+        return NULL;
+    }
+    sim_export_spikes(ctx, data, size, clear == JNI_TRUE);
+    (*env)->ReleasePrimitiveArrayCritical(env, result, data, 0);
+    
+    return result;
+}
+
+// Keep running statistics of a range of neurons
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_definePopulation(
+    JNIEnv *env, jobject obj, jlong context, jint first, jint count) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || first < 0 || count < 0) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return sim_define_population(ctx, (uint32_t)first, (uint32_t)count);
+}
+
+// Get the statistics of a population as first, count, steps, sampled
+// steps, spikes, rate, spike Fano factor, potential mean and variance,
+// last mean and variance, and synchrony
+JNIEXPORT jdoubleArray JNICALL Java_interop_NeuroBridge_getPopulationStats(
+    JNIEnv *env, jobject obj, jlong context, jint population, jboolean clear) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || population < 0) {
+        log_error("NeuroCore not initialized");
+        return NULL;
+    }
+    
+    sim_population_stats_t stats;
+    if (sim_population_stats(ctx, (uint32_t)population, &stats, clear == JNI_TRUE) != 0) {
+        return NULL;
+    }
+    
+    jdouble fields[] = {
+        stats.first, stats.count, (jdouble)stats.steps, (jdouble)stats.sampled_steps,
+        (jdouble)stats.spikes, stats.rate, stats.spike_fano, stats.potential_mean,
+        stats.potential_var, stats.last_mean, stats.last_var, stats.synchrony
+    };
+    jsize count = (jsize)(sizeof(fields) / sizeof(fields[0]));
+    
+    jdoubleArray result = (*env)->NewDoubleArray(env, count);
+    if (result == NULL) {
+        return NULL;
+    }
+    
+    (*env)->SetDoubleArrayRegion(env, result, 0, count, fields);
+    return result;
+}
+
+// Copy the parameters of a neuron model from Java. Returns 1 if they were
+// given, 0 for null (the model's defaults) and -1 if they do not fit the
+// model.
+static int read_model_params(JNIEnv *env, jint model, jfloatArray params, float *out) {
+    const NeuronModel *entry = neuron_model_get((NeuronModelType)model);
+    if (!entry) {
+        log_error("Unknown neuron model %d", (int)model);
+        return -1;
+    }
+    
+    if (!params) {
+        return 0;
+    }
+    
+    if ((*env)->GetArrayLength(env, params) != (jsize)entry->num_params) {
+        log_error("The %s model takes %u parameters", entry->name, entry->num_params);
+        return -1;
+    }
+    (*env)->GetFloatArrayRegion(env, params, 0, (jsize)entry->num_params, out);
+    return 1;
+}
+
+// Generate a network from a topology spec. Returns the number of
+// synapses created, or -1 on failure
+JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_generateNetwork(
+    JNIEnv *env, jobject obj, jlong context, jint topology, jint numNeurons, jint firstId, jint degree,
+    jfloat probability, jfloat length, jfloat inhibitoryFraction, jfloat weight, jfloat inhibitoryWeight,
+    jfloat delay, jint activation, jint plasticity, jint model, jfloatArray modelParams, jlong seed) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    if (numNeurons <= 0 || firstId < 0 || degree < 0) {
+        log_error("Invalid network size");
+        return -1;
+    }
+    
+    float params[NEURON_MODEL_MAX_PARAMS];
+    int has_params = read_model_params(env, model, modelParams, params);
+    if (has_params < 0) {
+        return -1;
+    }
+    
+    sim_topology_t spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.kind = (sim_topology_kind_t)topology;
+    spec.num_neurons = (uint32_t)numNeurons;
+    spec.first_id = (uint32_t)firstId;
+    spec.degree = (uint32_t)degree;
+    spec.probability = probability;
+    spec.length = length;
+    spec.inhibitory_fraction = inhibitoryFraction;
+    spec.weight = weight;
+    spec.inhibitory_weight = inhibitoryWeight;
+    spec.delay = delay;
+    spec.activation = (ActivationFunction)activation;
+    spec.plasticity = (PlasticityType)plasticity;
+    spec.model = (NeuronModelType)model;
+    spec.model_params = has_params ? params : NULL;
+    spec.seed = (uint64_t)seed;
+    
+    uint32_t num_synapses = 0;
+    if (sim_generate_topology(ctx, &spec, &num_synapses) < 0) {
+        return -1;
+    }
+    return (jlong)num_synapses;
+}
+
+// Load synapses from parallel arrays of neuron IDs, weights and delays
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_loadSynapses(
+    JNIEnv *env, jobject obj, jlong context, jintArray preIds, jintArray postIds,
+    jfloatArray weights, jfloatArray delays, jint plasticity) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx || !preIds || !postIds) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    jsize count = (*env)->GetArrayLength(env, preIds);
+    if ((*env)->GetArrayLength(env, postIds) != count ||
+        (weights && (*env)->GetArrayLength(env, weights) != count) ||
+        (delays && (*env)->GetArrayLength(env, delays) != count)) {
+        log_error("Synapse arrays differ in length");
+        return -1;
+    }
+    
+    // Lists of this size are read in place rather than copied; the workers
+    // make no JNI calls while the arrays are pinned
+    sim_edge_list_t list;
+    list.pre_ids = (const uint32_t *)(*env)->GetPrimitiveArrayCritical(env, preIds, NULL);
+    list.post_ids = (const uint32_t *)(*env)->GetPrimitiveArrayCritical(env, postIds, NULL);
+    list.weights = weights ? (const float *)(*env)->GetPrimitiveArrayCritical(env, weights, NULL) : NULL;
+    list.delays = delays ? (const float *)(*env)->GetPrimitiveArrayCritical(env, delays, NULL) : NULL;
+    list.count = (uint32_t)count;
+    list.plasticity = (PlasticityType)plasticity;
+    
+    int status = -1;
+    if (list.pre_ids && list.post_ids && (!weights || list.weights) && (!delays || list.delays)) {
+        status = sim_load_synapses(ctx, &list);
+    }
+    
+    if (list.delays) {
+        (*env)->ReleasePrimitiveArrayCritical(env, delays, (void *)list.delays, JNI_ABORT);
+    }
+    if (list.weights) {
+        (*env)->ReleasePrimitiveArrayCritical(env, weights, (void *)list.weights, JNI_ABORT);
+    }
+    if (list.post_ids) {
+        (*env)->ReleasePrimitiveArrayCritical(env, postIds, (void *)list.post_ids, JNI_ABORT);
+    }
+    if (list.pre_ids) {
+        (*env)->ReleasePrimitiveArrayCritical(env, preIds, (void *)list.pre_ids, JNI_ABORT);
+    }
+    return status == 0 ? count : -1;
+}
+
+// Move the neurons to a locality-improving slot order
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_reorderNeurons(
+    JNIEnv *env, jobject obj, jlong context, jint method) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return sim_reorder_neurons(ctx, (sim_order_t)method);
+}
+
+// Get the ID of the neuron in every slot, the order of the step outputs
+JNIEXPORT jintArray JNICALL Java_interop_NeuroBridge_getNeuronIds(
+    JNIEnv *env, jobject obj, jlong context) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return NULL;
+    }
+    
+    jsize count = (jsize)ctx->neuron_count;
+    jint *ids = (jint *)mm_alloc((size_t)count * sizeof(jint) + 1);
+    if (!ids) {
+        return NULL;
+    }
+    for (jsize i = 0; i < count; i++) {
+        ids[i] = (jint)ctx->neurons[i]->id;
+    }
+    
+    jintArray result = (*env)->NewIntArray(env, count);
+    if (result != NULL) {
+        (*env)->SetIntArrayRegion(env, result, 0, count, ids);
+    }
+    mm_free(ids);
+    return result;
+}
+
+// Add a background input source over a range of neuron slots
+static jint add_background(sim_context_t *ctx, jint first, jint count, sim_noise_spec_t *spec) {
+    if (!ctx || first < 0 || count < 0) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    spec->first = (uint32_t)first;
+    spec->count = (uint32_t)count;
+    return sim_add_background(ctx, spec);
+}
+
+// Give a range of neurons Poisson background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_addPoissonInput(
+    JNIEnv *env, jobject obj, jlong context, jint first, jint count, jfloat rate, jfloat weight) {
+    
+    sim_noise_spec_t spec = { SIM_NOISE_POISSON, 0, 0, rate, weight, 0.0f, 0.0f };
+    return add_background((sim_context_t *)context, first, count, &spec);
+}
+
+// Give a range of neurons Gaussian background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_addGaussianInput(
+    JNIEnv *env, jobject obj, jlong context, jint first, jint count, jfloat mean, jfloat sigma) {
+    
+    sim_noise_spec_t spec = { SIM_NOISE_GAUSSIAN, 0, 0, 0.0f, 0.0f, mean, sigma };
+    return add_background((sim_context_t *)context, first, count, &spec);
+}
+
+// Remove every background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_clearBackgroundInput(
+    JNIEnv *env, jobject obj, jlong context) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    sim_clear_background(ctx);
+    return 0;
+}
+
+// Set the seed of the background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setNoiseSeed(
+    JNIEnv *env, jobject obj, jlong context, jlong seed) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    sim_set_noise_seed(ctx, (uint64_t)seed);
+    return 0;
+}
+
+// Create a population of neurons running one neuron model
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_createPopulation(
+    JNIEnv *env, jobject obj, jlong context, jint firstId, jint count, jint model, jfloatArray params,
+    jint activation) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    if (firstId < 0 || count <= 0 || (uint32_t)activation > TANH) {
+        log_error("Invalid population");
+        return -1;
+    }
+    
+    float values[NEURON_MODEL_MAX_PARAMS];
+    int has_params = read_model_params(env, model, params, values);
+    if (has_params < 0) {
+        return -1;
+    }
+    
+    sim_population_spec_t spec;
+    spec.first_id = (uint32_t)firstId;
+    spec.count = (uint32_t)count;
+    spec.model = (NeuronModelType)model;
+    spec.params = has_params ? values : NULL;
+    spec.activation = (ActivationFunction)activation;
+    return sim_create_population(ctx, &spec);
+}
+
+// Get the model state variables of a neuron besides its potential
+JNIEXPORT jfloatArray JNICALL Java_interop_NeuroBridge_getModelState(
+    JNIEnv *env, jobject obj, jlong context, jint neuronId) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return NULL;
+    }
+    
+    int slot = sim_find_neuron(ctx, (uint32_t)neuronId);
+    float values[NEURON_MODEL_MAX_STATE];
+    int count = slot >= 0 ? sim_get_model_state(ctx, (uint32_t)slot, values) : -1;
+    if (count < 0) {
+        log_error("Neuron with ID %d not found", (int)neuronId);
+        return NULL;
+    }
+    
+    jfloatArray result = (*env)->NewFloatArray(env, count);
+    if (result != NULL) {
+        (*env)->SetFloatArrayRegion(env, result, 0, count, values);
+    }
+    return result;
+}
+
+// Select the accuracy of sigmoid and tanh outputs
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setActivationAccuracy(
+    JNIEnv *env, jobject obj, jlong context, jint accuracy) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return sim_set_activation_accuracy(ctx, (ActivationAccuracy)accuracy);
+}
+
+// Set the cadence of slow plasticity and the homeostatic target rate
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setPlasticitySchedule(
+    JNIEnv *env, jobject obj, jlong context, jint hebbianPeriod, jint homeostaticPeriod, jfloat targetRate) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    if (hebbianPeriod < 0 || homeostaticPeriod < 0) {
+        log_error("Invalid plasticity period");
+        return -1;
+    }
+    
+    sim_set_rate_period(ctx, SIM_RATE_HEBBIAN, (uint32_t)hebbianPeriod);
+    sim_set_rate_period(ctx, SIM_RATE_HOMEOSTATIC, (uint32_t)homeostaticPeriod);
+    return sim_set_target_rate(ctx, targetRate);
+}
+
+// Select the encoding of the synapse index and its shared weight bounds
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setSynapseStorage(
+    JNIEnv *env, jobject obj, jlong context, jint storage, jfloat minWeight, jfloat maxWeight) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return sim_set_synapse_storage(ctx, (SynapseStorage)storage, minWeight, maxWeight);
+}
+
+// Select the representation of the neuron state
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setStateFormat(
+    JNIEnv *env, jobject obj, jlong context, jint format) {
+    
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
+        log_error("NeuroCore not initialized");
+        return -1;
+    }
+    
+    return sim_set_state_format(ctx, (StateFormat)format);
+}
+
+// Get memory usage statistics of all contexts in the process
 JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_getMemoryUsage(
-    JNIEnv *env, jobject obj) {
+    JNIEnv *env, jobject obj, jlong context) {
     
-    if (!g_initialized) {
+    sim_context_t *ctx = (sim_context_t *)context;
+    if (!ctx) {
         return 0;
     }
     
@@ -10,35 +10,152 @@
 extern "C" {
 #endif
 
-// Initialize the NeuroCore system
-JNIEXPORT jint JNICALL Java_interop_NeuroBridge_initCore(JNIEnv *env, jobject obj);
+// Create an independent simulation context stepped by numThreads workers,
+// or one per online CPU if 0. Returns the context handle, or 0 on failure
+JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_initCore(JNIEnv *env, jobject obj, jint numThreads);
 
-// Clean up the NeuroCore system
-JNIEXPORT void JNICALL Java_interop_NeuroBridge_cleanupCore(JNIEnv *env, jobject obj);
+// Destroy a simulation context
+JNIEXPORT void JNICALL Java_interop_NeuroBridge_cleanupCore(JNIEnv *env, jobject obj, jlong context);
 
 // Create a new neuron
 JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_createNeuron(
-    JNIEnv *env, jobject obj, jint id, jint type, jint activation);
+    JNIEnv *env, jobject obj, jlong context, jint id, jint type, jint activation);
 
 // Delete a neuron
 JNIEXPORT void JNICALL Java_interop_NeuroBridge_deleteNeuron(
-    JNIEnv *env, jobject obj, jlong neuronPtr);
+    JNIEnv *env, jobject obj, jlong context, jlong neuronPtr);
 
 // Connect two neurons
 JNIEXPORT jint JNICALL Java_interop_NeuroBridge_connectNeurons(
-    JNIEnv *env, jobject obj, jlong sourcePtr, jlong targetPtr);
+    JNIEnv *env, jobject obj, jlong context, jlong sourcePtr, jlong targetPtr);
+
+// Connect neurons from a list of (source, target) ID pairs
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_connectNeuronsBulk(
+    JNIEnv *env, jobject obj, jlong context, jintArray pairs);
 
 // Create a synapse between two neurons
 JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_createSynapse(
-    JNIEnv *env, jobject obj, jint id, jint preId, jint postId, jint type);
+    JNIEnv *env, jobject obj, jlong context, jint id, jint preId, jint postId, jint type);
+
+// Set the plasticity rule and weight bounds of a synapse
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setSynapsePlasticity(
+    JNIEnv *env, jobject obj, jlong context, jint id, jint plasticity, jfloat minWeight, jfloat maxWeight);
+
+// Get the current weight of a synapse
+JNIEXPORT jfloat JNICALL Java_interop_NeuroBridge_getSynapseWeight(
+    JNIEnv *env, jobject obj, jlong context, jint id);
 
 // Run a simulation step
 JNIEXPORT jfloatArray JNICALL Java_interop_NeuroBridge_runSimulationStep(
-    JNIEnv *env, jobject obj, jfloatArray inputs, jfloat timeStep);
+    JNIEnv *env, jobject obj, jlong context, jfloatArray inputs, jfloat timeStep);
+
+// Advance the simulation by several steps without copying outputs
+JNIEXPORT jfloat JNICALL Java_interop_NeuroBridge_advanceSimulation(
+    JNIEnv *env, jobject obj, jlong context, jfloat timeStep, jint numSteps);
+
+// Queue sparse input currents for the next step
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectCurrents(
+    JNIEnv *env, jobject obj, jlong context, jintArray indices, jfloatArray currents);
+
+// Queue spike sources for the next step
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectSpikes(
+    JNIEnv *env, jobject obj, jlong context, jintArray indices);
+
+// Name a range of neuron indices as an input channel
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_defineInputChannel(
+    JNIEnv *env, jobject obj, jlong context, jstring name, jint first, jint count);
+
+// Queue input currents for a channel, by offset or for its first slots
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectChannel(
+    JNIEnv *env, jobject obj, jlong context, jint channel, jintArray offsets, jfloatArray currents);
+
+// Queue spike sources of a channel
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_injectChannelSpikes(
+    JNIEnv *env, jobject obj, jlong context, jint channel, jintArray offsets);
+
+// Start or stop recording spikes, in a ring of maxBytes if positive
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setSpikeRecording(
+    JNIEnv *env, jobject obj, jlong context, jboolean enabled, jlong maxBytes);
+
+// Record only neurons in (first, count) index ranges, or all if empty
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_selectRecording(
+    JNIEnv *env, jobject obj, jlong context, jintArray ranges);
+
+// Export the recorded spike raster, and drop it if clear is set
+JNIEXPORT jbyteArray JNICALL Java_interop_NeuroBridge_exportSpikes(
+    JNIEnv *env, jobject obj, jlong context, jboolean clear);
+
+// Keep running statistics of the neurons [first, first + count)
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_definePopulation(
+    JNIEnv *env, jobject obj, jlong context, jint first, jint count);
+
+// Get the statistics of a population, and clear them if clear is set
+JNIEXPORT jdoubleArray JNICALL Java_interop_NeuroBridge_getPopulationStats(
+    JNIEnv *env, jobject obj, jlong context, jint population, jboolean clear);
+
+// Generate a network of numNeurons neurons and their synapses in one call
+JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_generateNetwork(
+    JNIEnv *env, jobject obj, jlong context, jint topology, jint numNeurons, jint firstId, jint degree,
+    jfloat probability, jfloat length, jfloat inhibitoryFraction, jfloat weight, jfloat inhibitoryWeight,
+    jfloat delay, jint activation, jint plasticity, jint model, jfloatArray modelParams, jlong seed);
+
+// Load synapses from parallel arrays of neuron IDs, weights and delays
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_loadSynapses(
+    JNIEnv *env, jobject obj, jlong context, jintArray preIds, jintArray postIds,
+    jfloatArray weights, jfloatArray delays, jint plasticity);
+
+// Move the neurons to a locality-improving slot order
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_reorderNeurons(
+    JNIEnv *env, jobject obj, jlong context, jint method);
+
+// Get the ID of the neuron in every slot, the order of the step outputs
+JNIEXPORT jintArray JNICALL Java_interop_NeuroBridge_getNeuronIds(
+    JNIEnv *env, jobject obj, jlong context);
+
+// Give the neurons [first, first + count) Poisson background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_addPoissonInput(
+    JNIEnv *env, jobject obj, jlong context, jint first, jint count, jfloat rate, jfloat weight);
+
+// Give the neurons [first, first + count) Gaussian background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_addGaussianInput(
+    JNIEnv *env, jobject obj, jlong context, jint first, jint count, jfloat mean, jfloat sigma);
+
+// Remove every background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_clearBackgroundInput(
+    JNIEnv *env, jobject obj, jlong context);
+
+// Set the seed of the background input
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setNoiseSeed(
+    JNIEnv *env, jobject obj, jlong context, jlong seed);
+
+// Create count neurons from firstId running one neuron model
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_createPopulation(
+    JNIEnv *env, jobject obj, jlong context, jint firstId, jint count, jint model, jfloatArray params,
+    jint activation);
+
+// Get the model state variables of a neuron besides its potential
+JNIEXPORT jfloatArray JNICALL Java_interop_NeuroBridge_getModelState(
+    JNIEnv *env, jobject obj, jlong context, jint neuronId);
+
+// Select the accuracy of sigmoid and tanh outputs
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setActivationAccuracy(
+    JNIEnv *env, jobject obj, jlong context, jint accuracy);
+
+// Set the cadence of slow plasticity and the homeostatic target rate
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setPlasticitySchedule(
+    JNIEnv *env, jobject obj, jlong context, jint hebbianPeriod, jint homeostaticPeriod, jfloat targetRate);
+
+// Select the encoding of the synapse index and its shared weight bounds
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setSynapseStorage(
+    JNIEnv *env, jobject obj, jlong context, jint storage, jfloat minWeight, jfloat maxWeight);
+
+// Select the representation of the neuron state
+JNIEXPORT jint JNICALL Java_interop_NeuroBridge_setStateFormat(
+    JNIEnv *env, jobject obj, jlong context, jint format);
 
-// Get memory usage statistics
+// Get memory usage statistics of all contexts in the process
 JNIEXPORT jlong JNICALL Java_interop_NeuroBridge_getMemoryUsage(
-    JNIEnv *env, jobject obj);
+    JNIEnv *env, jobject obj, jlong context);
 
 #ifdef __cplusplus
 }
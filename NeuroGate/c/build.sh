@@ -6,17 +6,17 @@
 mkdir -p ../build/lib
 
 # Set compiler flags
-CFLAGS="-Wall -Wextra -O2 -fPIC"
-LDFLAGS="-shared"
+CFLAGS="-Wall -Wextra -O2 -fPIC -pthread -ffp-contract=off"
+LDFLAGS="-shared -pthread -lm"
 
 # Source files
-CORE_SRC="core/neuron.c core/synapse.c"
+CORE_SRC="core/neuron.c core/synapse.c core/population.c core/csr.c core/spike_wheel.c core/population_kernels.c core/activation.c core/plasticity.c core/neuron_model.c"
 MEMORY_SRC="memory/mm.c"
-UTILS_SRC="utils/log.c"
+UTILS_SRC="utils/log.c utils/id_index.c"
 CRYPTO_SRC="crypto/hash.c"
 NET_SRC="net/transport.c"
 API_SRC="api/bridge.c"
-RUNTIME_SRC="runtime/exec.c"
+RUNTIME_SRC="runtime/exec.c runtime/sim_context.c runtime/sim_input.c runtime/spike_recorder.c runtime/sim_stats.c runtime/sim_bulk.c runtime/sim_topology.c runtime/sim_build.c runtime/sim_reorder.c runtime/sim_noise.c runtime/thread_pool.c runtime/scheduler.c"
 
 ALL_SRC="$CORE_SRC $MEMORY_SRC $UTILS_SRC $CRYPTO_SRC $NET_SRC $API_SRC $RUNTIME_SRC"
 
@@ -0,0 +1,140 @@
+#include "activation.h"
+#include "activation_avx2.h"
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+
+static float g_sigmoid_table[ACTIVATION_LUT_INTERVALS + 1];
+static pthread_once_t g_table_once = PTHREAD_ONCE_INIT;
+
+// Fill the sigmoid table at its sample points
+static void build_table(void) {
+    for (int i = 0; i <= ACTIVATION_LUT_INTERVALS; i++) {
+        double x = -ACTIVATION_LUT_LIMIT + (double)i / ACTIVATION_LUT_SCALE;
+        g_sigmoid_table[i] = (float)(1.0 / (1.0 + exp(-x)));
+    }
+}
+
+// Approximate exp(x): split x * log2(e) into an integer n and a fraction
+// f in [-0.5, 0.5], evaluate 2^f as a polynomial and scale it by 2^n
+static inline float fast_exp(float x) {
+    float t = x * ACTIVATION_LOG2E;
+    t = t > -ACTIVATION_EXP2_MAX ? t : -ACTIVATION_EXP2_MAX;
+    t = t < ACTIVATION_EXP2_MAX ? t : ACTIVATION_EXP2_MAX;
+    
+    float n = floorf(t + 0.5f);
+    float f = t - n;
+    float p = ACTIVATION_EXP2_C0 + f * (ACTIVATION_EXP2_C1 + f * (ACTIVATION_EXP2_C2 + f * ACTIVATION_EXP2_C3));
+    
+    int32_t bits = ((int32_t)n + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+// Sigmoid with the fast exponential
+float activation_sigmoid_fast(float x) {
+    return 1.0f / (1.0f + fast_exp(-x));
+}
+
+// tanh(x) = 2 * sigmoid(2x) - 1
+float activation_tanh_fast(float x) {
+    return 2.0f * activation_sigmoid_fast(2.0f * x) - 1.0f;
+}
+
+// Sigmoid by linear interpolation in the table
+float activation_sigmoid_lut(float x) {
+    pthread_once(&g_table_once, build_table);
+    
+    float u = (x + ACTIVATION_LUT_LIMIT) * ACTIVATION_LUT_SCALE;
+    u = u > 0.0f ? u : 0.0f;
+    u = u < (float)ACTIVATION_LUT_INTERVALS ? u : (float)ACTIVATION_LUT_INTERVALS;
+    
+    int32_t i = (int32_t)u;
+    i = i < ACTIVATION_LUT_INTERVALS - 1 ? i : ACTIVATION_LUT_INTERVALS - 1;
+    float frac = u - (float)i;
+    float lo = g_sigmoid_table[i];
+    return lo + frac * (g_sigmoid_table[i + 1] - lo);
+}
+
+// tanh(x) = 2 * sigmoid(2x) - 1
+float activation_tanh_lut(float x) {
+    return 2.0f * activation_sigmoid_lut(2.0f * x) - 1.0f;
+}
+
+// Sigmoid table, built on first use
+const float *activation_sigmoid_table(void) {
+    pthread_once(&g_table_once, build_table);
+    return g_sigmoid_table;
+}
+
+// Apply an activation function at the given accuracy
+float activation_apply(ActivationFunction func, float value, ActivationAccuracy accuracy) {
+    switch (func) {
+        case SIGMOID:
+            if (accuracy == ACTIVATION_FAST) return activation_sigmoid_fast(value);
+            if (accuracy == ACTIVATION_LUT) return activation_sigmoid_lut(value);
+            return neuron_apply_activation(func, value);
+        case TANH:
+            if (accuracy == ACTIVATION_FAST) return activation_tanh_fast(value);
+            if (accuracy == ACTIVATION_LUT) return activation_tanh_lut(value);
+            return neuron_apply_activation(func, value);
+        default:
+            return neuron_apply_activation(func, value);
+    }
+}
+
+#ifdef ACTIVATION_X86
+
+// Batch evaluation: blocks of 8 slots that share a function run in vector
+// registers, mixed blocks and exact sigmoid and tanh run per slot
+__attribute__((target("avx2")))
+static void apply_batch_avx2(const uint8_t *functions, float *values, uint32_t begin, uint32_t end,
+                             ActivationAccuracy accuracy) {
+    const float *table = g_sigmoid_table;
+    uint32_t i = begin;
+    
+    for (; i + 8 <= end; i += 8) {
+        uint64_t block;
+        memcpy(&block, functions + i, sizeof(block));
+        uint8_t func = functions[i];
+        
+        if (block != func * 0x0101010101010101ULL ||
+            (accuracy == ACTIVATION_EXACT && (func == SIGMOID || func == TANH))) {
+            for (uint32_t k = i; k < i + 8; k++) {
+                values[k] = activation_apply((ActivationFunction)functions[k], values[k], accuracy);
+            }
+            continue;
+        }
+        
+        _mm256_storeu_ps(values + i, activation_avx2(_mm256_loadu_ps(values + i), func, accuracy, table));
+    }
+    
+    // Leave the upper register halves clean for the SSE code that follows
+    _mm256_zeroupper();
+    
+    for (; i < end; i++) {
+        values[i] = activation_apply((ActivationFunction)functions[i], values[i], accuracy);
+    }
+}
+
+#endif
+
+// Apply each slot's activation function to a range of values
+void activation_apply_batch(const uint8_t *functions, float *values, uint32_t begin, uint32_t end,
+                            ActivationAccuracy accuracy) {
+    if (accuracy == ACTIVATION_LUT) {
+        pthread_once(&g_table_once, build_table);
+    }
+    
+#ifdef ACTIVATION_X86
+    if (__builtin_cpu_supports("avx2")) {
+        apply_batch_avx2(functions, values, begin, end, accuracy);
+        return;
+    }
+#endif
+    
+    for (uint32_t i = begin; i < end; i++) {
+        values[i] = activation_apply((ActivationFunction)functions[i], values[i], accuracy);
+    }
+}
\ No newline at end of file
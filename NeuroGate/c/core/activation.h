@@ -0,0 +1,34 @@
+#ifndef ACTIVATION_H
+#define ACTIVATION_H
+
+#include <stdint.h>
+#include "neuron.h"
+
+// Accuracy of SIGMOID and TANH in batch evaluation. LINEAR and RELU are
+// always exact. Maximum absolute errors over all finite inputs:
+//
+//   ACTIVATION_EXACT  libm expf / tanhf
+//   ACTIVATION_FAST   sigmoid 2.5e-5, tanh 5e-5 (degree-3 exp2 polynomial)
+//   ACTIVATION_LUT    sigmoid 4.6e-5, tanh 9.1e-5 (512-interval table on
+//                     [-10, 10] with linear interpolation, clamped outside)
+typedef enum {
+    ACTIVATION_EXACT,
+    ACTIVATION_FAST,
+    ACTIVATION_LUT
+} ActivationAccuracy;
+
+// Function declarations
+float activation_sigmoid_fast(float x);
+float activation_tanh_fast(float x);
+float activation_sigmoid_lut(float x);
+float activation_tanh_lut(float x);
+const float *activation_sigmoid_table(void);
+float activation_apply(ActivationFunction func, float value, ActivationAccuracy accuracy);
+
+// Apply the activation function of each slot to values[begin, end) in
+// place. Runs of slots with the same function are evaluated 8 at a time
+// when the CPU supports AVX2; results are bit-identical to activation_apply.
+void activation_apply_batch(const uint8_t *functions, float *values, uint32_t begin, uint32_t end,
+                            ActivationAccuracy accuracy);
+
+#endif // ACTIVATION_H
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef ACTIVATION_AVX2_H
+#define ACTIVATION_AVX2_H
+
+#include "activation.h"
+
+// Constants and 8-lane helpers shared by the batch activation and the
+// specialized step kernels, so both produce the same bits
+
+// exp(x) = 2^(x * log2(e)); the exponent is clamped to stay normal
+#define ACTIVATION_LOG2E 1.44269504f
+#define ACTIVATION_EXP2_MAX 126.0f
+
+// Near-minimax coefficients of 2^f on [-0.5, 0.5], max relative error 1e-4
+#define ACTIVATION_EXP2_C0 0.99992456f
+#define ACTIVATION_EXP2_C1 0.69313673f
+#define ACTIVATION_EXP2_C2 0.24263948f
+#define ACTIVATION_EXP2_C3 0.05583828f
+
+// Sigmoid lookup table on [-LIMIT, LIMIT]
+#define ACTIVATION_LUT_INTERVALS 512
+#define ACTIVATION_LUT_LIMIT 10.0f
+#define ACTIVATION_LUT_SCALE (ACTIVATION_LUT_INTERVALS / (2.0f * ACTIVATION_LUT_LIMIT))
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ACTIVATION_X86 1
+#endif
+
+#ifdef ACTIVATION_X86
+
+// 8-lane fast_exp, same operations as the scalar version
+__attribute__((target("avx2")))
+static inline __m256 fast_exp_avx2(__m256 x) {
+    __m256 t = _mm256_mul_ps(x, _mm256_set1_ps(ACTIVATION_LOG2E));
+    t = _mm256_max_ps(t, _mm256_set1_ps(-ACTIVATION_EXP2_MAX));
+    t = _mm256_min_ps(t, _mm256_set1_ps(ACTIVATION_EXP2_MAX));
+    
+    __m256 n = _mm256_floor_ps(_mm256_add_ps(t, _mm256_set1_ps(0.5f)));
+    __m256 f = _mm256_sub_ps(t, n);
+    __m256 p = _mm256_add_ps(_mm256_set1_ps(ACTIVATION_EXP2_C2), _mm256_mul_ps(f, _mm256_set1_ps(ACTIVATION_EXP2_C3)));
+    p = _mm256_add_ps(_mm256_set1_ps(ACTIVATION_EXP2_C1), _mm256_mul_ps(f, p));
+    p = _mm256_add_ps(_mm256_set1_ps(ACTIVATION_EXP2_C0), _mm256_mul_ps(f, p));
+    
+    __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+
+// 8-lane sigmoid at FAST or LUT accuracy; table is the sigmoid table
+__attribute__((target("avx2")))
+static inline __m256 sigmoid_avx2(__m256 x, ActivationAccuracy accuracy, const float *table) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    
+    if (accuracy == ACTIVATION_FAST) {
+        __m256 e = fast_exp_avx2(_mm256_xor_ps(x, _mm256_set1_ps(-0.0f)));
+        return _mm256_div_ps(one, _mm256_add_ps(one, e));
+    }
+    
+    __m256 u = _mm256_mul_ps(_mm256_add_ps(x, _mm256_set1_ps(ACTIVATION_LUT_LIMIT)),
+                             _mm256_set1_ps(ACTIVATION_LUT_SCALE));
+    u = _mm256_max_ps(u, _mm256_setzero_ps());
+    u = _mm256_min_ps(u, _mm256_set1_ps((float)ACTIVATION_LUT_INTERVALS));
+    
+    __m256i i = _mm256_cvttps_epi32(u);
+    i = _mm256_min_epi32(i, _mm256_set1_epi32(ACTIVATION_LUT_INTERVALS - 1));
+    __m256 frac = _mm256_sub_ps(u, _mm256_cvtepi32_ps(i));
+    __m256 lo = _mm256_i32gather_ps(table, i, 4);
+    __m256 hi = _mm256_i32gather_ps(table + 1, i, 4);
+    return _mm256_add_ps(lo, _mm256_mul_ps(frac, _mm256_sub_ps(hi, lo)));
+}
+
+// 8-lane activation of a function at FAST or LUT accuracy (LINEAR and
+// RELU at any accuracy)
+__attribute__((target("avx2")))
+static inline __m256 activation_avx2(__m256 x, int func, ActivationAccuracy accuracy, const float *table) {
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    
+    switch (func) {
+        case SIGMOID:
+            return sigmoid_avx2(x, accuracy, table);
+        case RELU:
+            return _mm256_max_ps(x, _mm256_setzero_ps());
+        case TANH:
+            return _mm256_sub_ps(_mm256_mul_ps(two, sigmoid_avx2(_mm256_mul_ps(two, x), accuracy, table)), one);
+        default:
+            return x;
+    }
+}
+
+#endif
+
+#endif // ACTIVATION_AVX2_H
\ No newline at end of file
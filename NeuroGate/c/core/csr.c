@@ -0,0 +1,416 @@
+#include "csr.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Initialize an empty index
+int csr_init(SynapseCSR *csr) {
+    if (!csr) {
+        log_error("NULL index in csr_init");
+        return -1;
+    }
+    
+    memset(csr, 0, sizeof(SynapseCSR));
+    csr->storage = SYNAPSE_STORAGE_FULL;
+    csr->min_weight = -1.0f;
+    csr->max_weight = 1.0f;
+    csr->dirty = 1;
+    return 0;
+}
+
+// Release every array and forget the capacities
+static void csr_free_arrays(SynapseCSR *csr) {
+    mm_free(csr->offsets);
+    mm_free(csr->targets);
+    mm_free(csr->weights);
+    mm_free(csr->weights_bf16);
+    mm_free(csr->weights_q8);
+    mm_free(csr->row_scales);
+    mm_free(csr->delays);
+    mm_free(csr->delay_steps);
+    mm_free(csr->delay_steps8);
+    mm_free(csr->synapse_index);
+    mm_free(csr->min_weights);
+    mm_free(csr->max_weights);
+    mm_free(csr->plasticity);
+    mm_free(csr->in_offsets);
+    mm_free(csr->in_edges);
+    mm_free(csr->in_sources);
+    
+    SynapseStorage storage = csr->storage;
+    float min_weight = csr->min_weight;
+    float max_weight = csr->max_weight;
+    memset(csr, 0, sizeof(SynapseCSR));
+    csr->storage = storage;
+    csr->min_weight = min_weight;
+    csr->max_weight = max_weight;
+    csr->dirty = 1;
+}
+
+// Free the index arrays
+void csr_free(SynapseCSR *csr) {
+    if (!csr) return;
+    
+    csr_free_arrays(csr);
+    csr->storage = SYNAPSE_STORAGE_FULL;
+}
+
+// Select the encoding of weights and delays, and the bounds shared by all
+// edges in compact storage. The index must be rebuilt afterwards.
+int csr_set_storage(SynapseCSR *csr, SynapseStorage storage, float min_weight, float max_weight) {
+    if (!csr || storage < SYNAPSE_STORAGE_FULL || storage > SYNAPSE_STORAGE_INT8 ||
+        !(min_weight <= max_weight)) {
+        log_error("Invalid synapse storage");
+        return -1;
+    }
+    
+    if (storage != csr->storage) {
+        csr_free_arrays(csr);
+        csr->storage = storage;
+    }
+    csr->min_weight = min_weight;
+    csr->max_weight = max_weight;
+    csr->dirty = 1;
+    return 0;
+}
+
+// Grow one array to hold count entries of size bytes
+static int csr_grow(void **array, uint32_t count, size_t size) {
+    void *grown = mm_realloc(*array, (size_t)count * size);
+    if (!grown) {
+        return -1;
+    }
+    *array = grown;
+    return 0;
+}
+
+// Grow the row and edge arrays of the current storage to hold the given
+// sizes, and the incoming index when it is needed
+static int csr_reserve(SynapseCSR *csr, uint32_t num_rows, uint32_t num_edges, int incoming) {
+    int compact = csr->storage != SYNAPSE_STORAGE_FULL;
+    int status = 0;
+    
+    if (num_rows + 1 > csr->row_capacity) {
+        uint32_t capacity = num_rows + 1;
+        status |= csr_grow((void **)&csr->offsets, capacity, sizeof(uint32_t));
+        status |= csr_grow((void **)&csr->in_offsets, capacity, sizeof(uint32_t));
+        if (csr->storage == SYNAPSE_STORAGE_INT8) {
+            status |= csr_grow((void **)&csr->row_scales, capacity, sizeof(float));
+        }
+        if (status != 0) {
+            return -1;
+        }
+        csr->row_capacity = capacity;
+    }
+    
+    if (num_edges > csr->edge_capacity) {
+        uint32_t capacity = num_edges;
+        status |= csr_grow((void **)&csr->targets, capacity, sizeof(uint32_t));
+        status |= csr_grow((void **)&csr->synapse_index, capacity, sizeof(uint32_t));
+        status |= csr_grow((void **)&csr->plasticity, capacity, sizeof(uint8_t));
+        if (!compact) {
+            status |= csr_grow((void **)&csr->weights, capacity, sizeof(float));
+            status |= csr_grow((void **)&csr->delays, capacity, sizeof(float));
+            status |= csr_grow((void **)&csr->delay_steps, capacity, sizeof(uint16_t));
+            status |= csr_grow((void **)&csr->min_weights, capacity, sizeof(float));
+            status |= csr_grow((void **)&csr->max_weights, capacity, sizeof(float));
+        } else {
+            if (csr->storage == SYNAPSE_STORAGE_BF16) {
+                status |= csr_grow((void **)&csr->weights_bf16, capacity, sizeof(uint16_t));
+            } else {
+                status |= csr_grow((void **)&csr->weights_q8, capacity, sizeof(int8_t));
+            }
+            status |= csr_grow((void **)&csr->delay_steps8, capacity, sizeof(uint8_t));
+        }
+        if (status != 0) {
+            return -1;
+        }
+        csr->edge_capacity = capacity;
+    }
+    
+    if (incoming && num_edges > csr->in_capacity) {
+        uint32_t capacity = num_edges;
+        status |= csr_grow((void **)&csr->in_edges, capacity, sizeof(uint32_t));
+        status |= csr_grow((void **)&csr->in_sources, capacity, sizeof(uint32_t));
+        if (status != 0) {
+            return -1;
+        }
+        csr->in_capacity = capacity;
+    }
+    
+    return 0;
+}
+
+// Widen the scale of a row to cover an edge of the given weight. Plastic
+// edges also cover the bounds, so learned weights are never cut short by
+// the encoding.
+static inline void csr_cover_weight(float *scale, float weight, uint8_t plasticity, float bound) {
+    float magnitude = fabsf(weight);
+    if (plasticity != 0 && bound > magnitude) {
+        magnitude = bound;
+    }
+    if (magnitude > *scale) {
+        *scale = magnitude;
+    }
+}
+
+// Pick the scale of each row for INT8 storage: the largest magnitude in the
+// row maps to 127 units
+static void csr_compute_row_scales(SynapseCSR *csr, const CSREdge *edges, uint32_t num_edges,
+                                   const CSREdgeArrays *bulk, uint32_t num_rows) {
+    float bound = fmaxf(fabsf(csr->min_weight), fabsf(csr->max_weight));
+    
+    memset(csr->row_scales, 0, num_rows * sizeof(float));
+    for (uint32_t i = 0; i < num_edges; i++) {
+        csr_cover_weight(&csr->row_scales[edges[i].pre], edges[i].weight, edges[i].plasticity, bound);
+    }
+    for (uint32_t i = 0; i < bulk->count; i++) {
+        csr_cover_weight(&csr->row_scales[bulk->pre[i]], bulk->weights[i], bulk->plasticity[i], bound);
+    }
+    
+    for (uint32_t r = 0; r < num_rows; r++) {
+        csr->row_scales[r] /= 127.0f;
+    }
+}
+
+// Delay in ms as whole steps of dt, at least one step so a spike always
+// lands in a later step
+static inline uint32_t csr_delay_steps(float delay, float dt, uint32_t limit) {
+    float steps = delay / dt + 0.5f;
+    return steps < 1.0f ? 1 : (steps > (float)limit ? limit : (uint32_t)steps);
+}
+
+// Store an edge at packed position e of its row. Compact storage keeps the
+// delay in steps; the largest is tracked in max_steps, and delays that do
+// not fit are counted in clipped.
+static inline void csr_place_edge(SynapseCSR *csr, uint32_t e, uint32_t pre, uint32_t post,
+                                  float weight, float delay, uint32_t synapse, uint8_t plasticity,
+                                  float min_weight, float max_weight, float dt,
+                                  uint32_t *max_steps, uint32_t *clipped) {
+    csr->targets[e] = post;
+    csr->synapse_index[e] = synapse;
+    csr->plasticity[e] = plasticity;
+    
+    if (csr->storage == SYNAPSE_STORAGE_FULL) {
+        csr->weights[e] = weight;
+        csr->delays[e] = delay;
+        csr->min_weights[e] = min_weight;
+        csr->max_weights[e] = max_weight;
+        return;
+    }
+    
+    csr_set_weight(csr, pre, e, weight);
+    uint32_t steps = csr_delay_steps(delay, dt, CSR_MAX_COMPACT_DELAY);
+    *clipped += delay / dt + 0.5f >= (float)(CSR_MAX_COMPACT_DELAY + 1);
+    csr->delay_steps8[e] = (uint8_t)steps;
+    if (steps > *max_steps) {
+        *max_steps = steps;
+    }
+}
+
+// Count the plastic edges among edges [begin, end), numbered across the
+// records and then the bulk edges, and add the out-degree of every row of
+// them to counts when it is given
+uint32_t csr_count_rows(const CSREdge *edges, uint32_t num_edges, const CSREdgeArrays *bulk,
+                        uint32_t begin, uint32_t end, uint32_t *counts) {
+    uint32_t num_plastic = 0;
+    uint32_t split = end < num_edges ? end : num_edges;
+    for (uint32_t i = begin; i < split; i++) {
+        num_plastic += edges[i].plasticity != 0;
+        if (counts) {
+            counts[edges[i].pre]++;
+        }
+    }
+    for (uint32_t i = (begin > num_edges ? begin : num_edges); i < end; i++) {
+        num_plastic += bulk->plasticity[i - num_edges] != 0;
+        if (counts) {
+            counts[bulk->pre[i - num_edges]]++;
+        }
+    }
+    return num_plastic;
+}
+
+// Check the input of a build and size the arrays for it. The row scales
+// of INT8 storage are picked here, before any edge is placed.
+int csr_prepare(SynapseCSR *csr, uint32_t num_rows, const CSREdge *edges, uint32_t num_edges,
+                const CSREdgeArrays *bulk, uint32_t num_plastic, float dt) {
+    if (!csr || (num_edges > 0 && !edges) || !bulk || bulk->count > UINT32_MAX - num_edges) {
+        log_error("Invalid parameters for csr_build");
+        return -1;
+    }
+    
+    if (csr->storage != SYNAPSE_STORAGE_FULL && dt <= 0.0f) {
+        log_error("Compact synapse storage needs the time step");
+        return -1;
+    }
+    
+    uint32_t total = num_edges + bulk->count;
+    if (csr_reserve(csr, num_rows, total, num_plastic > 0) != 0) {
+        log_error("Failed to allocate synapse index for %u edges", total);
+        return -1;
+    }
+    
+    if (csr->storage == SYNAPSE_STORAGE_INT8) {
+        csr_compute_row_scales(csr, edges, num_edges, bulk, num_rows);
+    }
+    return 0;
+}
+
+// Place edges [begin, end) into their rows. Edge of row r goes to
+// starts[r] + cursors[r], or cursors[r] without starts, and advances the
+// cursor. max_steps and clipped collect the delays of compact storage.
+void csr_scatter_rows(SynapseCSR *csr, const CSREdge *edges, uint32_t num_edges, const CSREdgeArrays *bulk,
+                      uint32_t begin, uint32_t end, const uint32_t *starts, uint32_t *cursors, float dt,
+                      uint32_t *max_steps, uint32_t *clipped) {
+    uint32_t split = end < num_edges ? end : num_edges;
+    for (uint32_t i = begin; i < split; i++) {
+        const CSREdge *edge = &edges[i];
+        uint32_t e = (starts ? starts[edge->pre] : 0) + cursors[edge->pre]++;
+        csr_place_edge(csr, e, edge->pre, edge->post, edge->weight, edge->delay,
+                       edge->synapse, edge->plasticity, edge->min_weight, edge->max_weight, dt,
+                       max_steps, clipped);
+    }
+    for (uint32_t i = (begin > num_edges ? begin : num_edges); i < end; i++) {
+        uint32_t b = i - num_edges;
+        uint32_t pre = bulk->pre[b];
+        uint32_t e = (starts ? starts[pre] : 0) + cursors[pre]++;
+        csr_place_edge(csr, e, pre, bulk->post[b], bulk->weights[b], bulk->delays[b],
+                       bulk->first_synapse + b, bulk->plasticity[b], csr->min_weight, csr->max_weight, dt,
+                       max_steps, clipped);
+    }
+}
+
+// Add the in-degree of every slot from the packed rows [row_begin, row_end)
+// to counts
+void csr_count_columns(const SynapseCSR *csr, uint32_t row_begin, uint32_t row_end, uint32_t *counts) {
+    for (uint32_t e = csr->offsets[row_begin]; e < csr->offsets[row_end]; e++) {
+        counts[csr->targets[e]]++;
+    }
+}
+
+// List the edges of the packed rows [row_begin, row_end) in the incoming
+// index, with the same cursors as csr_scatter_rows
+void csr_scatter_columns(SynapseCSR *csr, uint32_t row_begin, uint32_t row_end,
+                         const uint32_t *starts, uint32_t *cursors) {
+    for (uint32_t r = row_begin; r < row_end; r++) {
+        for (uint32_t e = csr->offsets[r]; e < csr->offsets[r + 1]; e++) {
+            uint32_t target = csr->targets[e];
+            uint32_t k = (starts ? starts[target] : 0) + cursors[target]++;
+            csr->in_edges[k] = e;
+            csr->in_sources[k] = r;
+        }
+    }
+}
+
+// Record the shape of a finished build and quantize the delays of full
+// storage for dt
+void csr_finish(SynapseCSR *csr, uint32_t num_rows, uint32_t num_edges, uint32_t num_plastic, float dt,
+                uint32_t max_steps, uint32_t clipped) {
+    if (clipped > 0) {
+        log_warn("%u synapse delays exceed %u steps and were shortened", clipped, CSR_MAX_COMPACT_DELAY);
+    }
+    
+    csr->num_plastic = num_plastic;
+    csr->num_rows = num_rows;
+    csr->num_edges = num_edges;
+    csr->dirty = 0;
+    
+    if (csr->storage != SYNAPSE_STORAGE_FULL) {
+        csr->delay_dt = dt;
+        csr->max_delay_steps = max_steps;
+    } else {
+        csr->delay_dt = 0.0f;
+        if (dt > 0.0f) {
+            csr_quantize_delays(csr, dt);
+        }
+    }
+    
+    log_debug("Built synapse index: %u rows, %u edges", num_rows, num_edges);
+}
+
+// Build the index from an unordered edge list and optional bulk edges with
+// a counting sort on the presynaptic slot. Edges keep their relative order
+// within a row, records before bulk edges. Delays are quantized for dt
+// when it is positive; compact storage requires it.
+int csr_build(SynapseCSR *csr, uint32_t num_rows, const CSREdge *edges, uint32_t num_edges,
+              const CSREdgeArrays *bulk, float dt) {
+    CSREdgeArrays none = { NULL, NULL, NULL, NULL, NULL, 0, 0 };
+    if (!bulk) {
+        bulk = &none;
+    }
+    
+    if (!csr || (num_edges > 0 && !edges) || bulk->count > UINT32_MAX - num_edges) {
+        log_error("Invalid parameters for csr_build");
+        return -1;
+    }
+    
+    uint32_t total = num_edges + bulk->count;
+    uint32_t num_plastic = csr_count_rows(edges, num_edges, bulk, 0, total, NULL);
+    if (csr_prepare(csr, num_rows, edges, num_edges, bulk, num_plastic, dt) != 0) {
+        return -1;
+    }
+    
+    // Count the out-degree of every row and prefix sum into row starts
+    uint32_t *offsets = csr->offsets;
+    memset(offsets, 0, (num_rows + 1) * sizeof(uint32_t));
+    csr_count_rows(edges, num_edges, bulk, 0, total, &offsets[1]);
+    for (uint32_t r = 0; r < num_rows; r++) {
+        offsets[r + 1] += offsets[r];
+    }
+    
+    // Scatter edges into their rows, using offsets[r] as the cursor and
+    // shifting the starts back afterwards
+    uint32_t max_steps = 1;
+    uint32_t clipped = 0;
+    csr_scatter_rows(csr, edges, num_edges, bulk, 0, total, NULL, offsets, dt, &max_steps, &clipped);
+    memmove(&offsets[1], &offsets[0], num_rows * sizeof(uint32_t));
+    offsets[0] = 0;
+    
+    // Same counting sort on the postsynaptic slot for the incoming index,
+    // walking the packed rows so that each column lists edges in order
+    uint32_t *in_offsets = csr->in_offsets;
+    memset(in_offsets, 0, (num_rows + 1) * sizeof(uint32_t));
+    if (num_plastic > 0) {
+        csr_count_columns(csr, 0, num_rows, &in_offsets[1]);
+        for (uint32_t r = 0; r < num_rows; r++) {
+            in_offsets[r + 1] += in_offsets[r];
+        }
+        csr_scatter_columns(csr, 0, num_rows, NULL, in_offsets);
+        memmove(&in_offsets[1], &in_offsets[0], num_rows * sizeof(uint32_t));
+        in_offsets[0] = 0;
+    }
+    
+    csr_finish(csr, num_rows, total, num_plastic, dt, max_steps, clipped);
+    return 0;
+}
+
+// Convert every delay to whole steps of dt. Compact storage only keeps
+// the steps, so there the delays can only be re-read by a rebuild. Returns
+// the largest delay in steps.
+uint32_t csr_quantize_delays(SynapseCSR *csr, float dt) {
+    if (!csr || dt <= 0.0f) {
+        return 0;
+    }
+    
+    if (csr->storage != SYNAPSE_STORAGE_FULL) {
+        if (csr->delay_dt != dt) {
+            csr->dirty = 1;
+        }
+        return csr->max_delay_steps;
+    }
+    
+    uint32_t max_steps = 1;
+    for (uint32_t e = 0; e < csr->num_edges; e++) {
+        uint32_t d = csr_delay_steps(csr->delays[e], dt, 65535);
+        csr->delay_steps[e] = (uint16_t)d;
+        if (d > max_steps) {
+            max_steps = d;
+        }
+    }
+    
+    csr->delay_dt = dt;
+    csr->max_delay_steps = max_steps;
+    return max_steps;
+}
\ No newline at end of file
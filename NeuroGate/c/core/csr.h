@@ -0,0 +1,180 @@
+#ifndef CSR_H
+#define CSR_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Largest delay in steps that compact storage can hold
+#define CSR_MAX_COMPACT_DELAY 255
+
+// Encoding of the per-edge weights, delays and bounds
+typedef enum {
+    SYNAPSE_STORAGE_FULL,        // Float weights, 16-bit delays, bounds per edge
+    SYNAPSE_STORAGE_BF16,        // bfloat16 weights, 8-bit delays, shared bounds
+    SYNAPSE_STORAGE_INT8         // int8 weights scaled per row, 8-bit delays, shared bounds
+} SynapseStorage;
+
+// Synapse as an edge between population slots, input to csr_build
+typedef struct {
+    uint32_t pre;                // Presynaptic slot
+    uint32_t post;               // Postsynaptic slot
+    float weight;                // Synaptic weight
+    float delay;                 // Transmission delay in ms
+    uint32_t synapse;            // Index of the Synapse record
+    float min_weight;            // Lower weight bound for plasticity
+    float max_weight;            // Upper weight bound for plasticity
+    uint8_t plasticity;          // PlasticityType of the synapse
+} CSREdge;
+
+// Synapses kept as parallel arrays instead of records, such as those of a
+// generated network, input to csr_build next to the edge list. Edge i
+// becomes synapse first_synapse + i and is bounded by the shared bounds of
+// the index.
+typedef struct {
+    const uint32_t *pre;         // Presynaptic slot per edge
+    const uint32_t *post;        // Postsynaptic slot per edge
+    const float *weights;        // Synaptic weight per edge
+    const float *delays;         // Transmission delay per edge in ms
+    const uint8_t *plasticity;   // PlasticityType per edge
+    uint32_t count;              // Number of edges
+    uint32_t first_synapse;      // Synapse index of the first edge
+} CSREdgeArrays;
+
+// Compressed-sparse-row outgoing synapse index. The synapses leaving slot i
+// are the packed edges [offsets[i], offsets[i + 1]), so delivering a spike
+// is a single contiguous sweep over one row. A second index lists the
+// edges arriving at slot j in in_edges[in_offsets[j], in_offsets[j + 1]),
+// for rules that act on a neuron's inputs; it is only built when some
+// edge is plastic.
+//
+// Full storage keeps float weights and per-edge bounds. Compact storage
+// keeps a 16- or 8-bit weight and an 8-bit delay per edge, with one pair
+// of bounds for all edges, which cuts the bytes streamed per delivered
+// spike from 10 to 6 or 5. Delays are then only kept in steps, so a new
+// time step requires a rebuild.
+typedef struct {
+    uint32_t num_rows;           // Number of presynaptic slots
+    uint32_t num_edges;          // Number of packed synapses
+    uint32_t row_capacity;       // Allocated rows
+    uint32_t edge_capacity;      // Allocated edges
+    uint32_t in_capacity;        // Allocated incoming entries
+    SynapseStorage storage;      // Encoding of weights and delays
+    uint32_t *offsets;           // Row start per slot (num_rows + 1 entries)
+    uint32_t *targets;           // Postsynaptic slot per edge
+    float *weights;              // Synaptic weight per edge (full storage)
+    uint16_t *weights_bf16;      // bfloat16 weight per edge (BF16 storage)
+    int8_t *weights_q8;          // Weight per edge in units of its row scale (INT8 storage)
+    float *row_scales;           // Weight of one int8 unit per row (INT8 storage)
+    float *delays;               // Transmission delay per edge in ms (full storage)
+    uint16_t *delay_steps;       // Delay per edge in whole steps of delay_dt (full storage)
+    uint8_t *delay_steps8;       // Delay per edge in whole steps of delay_dt (compact storage)
+    uint32_t *synapse_index;     // Synapse record per edge
+    float *min_weights;          // Lower weight bound per edge (full storage)
+    float *max_weights;          // Upper weight bound per edge (full storage)
+    float min_weight;            // Lower weight bound of every edge (compact storage) and bulk edges
+    float max_weight;            // Upper weight bound of every edge (compact storage) and bulk edges
+    uint8_t *plasticity;         // PlasticityType per edge
+    uint32_t *in_offsets;        // Column start per slot (num_rows + 1 entries)
+    uint32_t *in_edges;          // Edge per incoming entry, by postsynaptic slot
+    uint32_t *in_sources;        // Presynaptic slot per incoming entry
+    uint32_t num_plastic;        // Number of edges with plasticity other than STATIC
+    float delay_dt;              // Time step delay_steps were computed for
+    uint32_t max_delay_steps;    // Largest delay in steps
+    int dirty;                   // Set when the index must be rebuilt
+} SynapseCSR;
+
+// Round a float to the nearest bfloat16, ties to even
+static inline uint16_t csr_float_to_bf16(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u) {
+        return (uint16_t)((bits >> 16) | 0x0040u);   // Keep NaN quiet
+    }
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return (uint16_t)(bits >> 16);
+}
+
+// Widen a bfloat16 to a float
+static inline float csr_bf16_to_float(uint16_t value) {
+    uint32_t bits = (uint32_t)value << 16;
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+// Weight of edge e in row
+static inline float csr_get_weight(const SynapseCSR *csr, uint32_t row, uint32_t e) {
+    switch (csr->storage) {
+        case SYNAPSE_STORAGE_BF16:
+            return csr_bf16_to_float(csr->weights_bf16[e]);
+        case SYNAPSE_STORAGE_INT8:
+            return (float)csr->weights_q8[e] * csr->row_scales[row];
+        default:
+            return csr->weights[e];
+    }
+}
+
+// Store the weight of edge e in row, rounded to the storage precision
+static inline void csr_set_weight(SynapseCSR *csr, uint32_t row, uint32_t e, float weight) {
+    switch (csr->storage) {
+        case SYNAPSE_STORAGE_BF16:
+            csr->weights_bf16[e] = csr_float_to_bf16(weight);
+            break;
+        case SYNAPSE_STORAGE_INT8: {
+            float units = csr->row_scales[row] > 0.0f ? weight / csr->row_scales[row] : 0.0f;
+            units = units < -127.0f ? -127.0f : (units > 127.0f ? 127.0f : units);
+            csr->weights_q8[e] = (int8_t)(units < 0.0f ? units - 0.5f : units + 0.5f);
+            break;
+        }
+        default:
+            csr->weights[e] = weight;
+            break;
+    }
+}
+
+// Delay of edge e in steps
+static inline uint32_t csr_get_delay(const SynapseCSR *csr, uint32_t e) {
+    return csr->storage == SYNAPSE_STORAGE_FULL ? csr->delay_steps[e] : csr->delay_steps8[e];
+}
+
+// Keep a weight of edge e within its bounds
+static inline float csr_clamp_weight(const SynapseCSR *csr, uint32_t e, float weight) {
+    int full = csr->storage == SYNAPSE_STORAGE_FULL;
+    float max_weight = full ? csr->max_weights[e] : csr->max_weight;
+    float min_weight = full ? csr->min_weights[e] : csr->min_weight;
+    
+    if (weight > max_weight) {
+        return max_weight;
+    }
+    if (weight < min_weight) {
+        return min_weight;
+    }
+    return weight;
+}
+
+// Function declarations
+int csr_init(SynapseCSR *csr);
+void csr_free(SynapseCSR *csr);
+int csr_set_storage(SynapseCSR *csr, SynapseStorage storage, float min_weight, float max_weight);
+int csr_build(SynapseCSR *csr, uint32_t num_rows, const CSREdge *edges, uint32_t num_edges,
+              const CSREdgeArrays *bulk, float dt);
+uint32_t csr_quantize_delays(SynapseCSR *csr, float dt);
+
+// Stages of csr_build, for callers that split the edges between threads.
+// Edges are numbered across the records and then the bulk edges; rows and
+// columns are counted into per-caller histograms, which become cursors
+// once the caller has summed them into offsets and in_offsets.
+uint32_t csr_count_rows(const CSREdge *edges, uint32_t num_edges, const CSREdgeArrays *bulk,
+                        uint32_t begin, uint32_t end, uint32_t *counts);
+int csr_prepare(SynapseCSR *csr, uint32_t num_rows, const CSREdge *edges, uint32_t num_edges,
+                const CSREdgeArrays *bulk, uint32_t num_plastic, float dt);
+void csr_scatter_rows(SynapseCSR *csr, const CSREdge *edges, uint32_t num_edges, const CSREdgeArrays *bulk,
+                      uint32_t begin, uint32_t end, const uint32_t *starts, uint32_t *cursors, float dt,
+                      uint32_t *max_steps, uint32_t *clipped);
+void csr_count_columns(const SynapseCSR *csr, uint32_t row_begin, uint32_t row_end, uint32_t *counts);
+void csr_scatter_columns(SynapseCSR *csr, uint32_t row_begin, uint32_t row_end,
+                         const uint32_t *starts, uint32_t *cursors);
+void csr_finish(SynapseCSR *csr, uint32_t num_rows, uint32_t num_edges, uint32_t num_plastic, float dt,
+                uint32_t max_steps, uint32_t clipped);
+
+#endif // CSR_H
\ No newline at end of file
@@ -23,6 +23,7 @@ Neuron *neuron_create(uint32_t id, NeuronType type, ActivationFunction activatio
     neuron->last_fired = -1000.0f;      // Set to a large negative to ensure it can fire immediately
     neuron->connected_neurons = NULL;
     neuron->num_connections = 0;
+    neuron->connection_capacity = 0;
     neuron->user_data = NULL;
 
     log_debug("Created neuron with ID %u", id);
@@ -41,6 +42,22 @@ void neuron_destroy(Neuron *neuron) {
     log_debug("Destroyed neuron");
 }
 
+// Position of the first connection to a target ID or above, by binary
+// search over the sorted connections
+static uint32_t find_connection(const Neuron *neuron, uint32_t target_id) {
+    uint32_t low = 0;
+    uint32_t high = neuron->num_connections;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (neuron->connected_neurons[mid] < target_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
 // Connect two neurons
 int neuron_connect(Neuron *source, Neuron *target) {
     if (!source || !target) {
@@ -49,32 +66,172 @@ int neuron_connect(Neuron *source, Neuron *target) {
     }
 
     // Check if connection already exists
-    for (uint32_t i = 0; i < source->num_connections; i++) {
-        if (source->connected_neurons[i] == target->id) {
-            log_warn("Connection already exists between neurons %u and %u", source->id, target->id);
-            return 0;
-        }
+    uint32_t position = find_connection(source, target->id);
+    if (position < source->num_connections && source->connected_neurons[position] == target->id) {
+        log_warn("Connection already exists between neurons %u and %u", source->id, target->id);
+        return 0;
     }
 
-    // Allocate or reallocate memory for connections
-    uint32_t *new_connections = (uint32_t *)mm_realloc(
-        source->connected_neurons, 
-        (source->num_connections + 1) * sizeof(uint32_t)
-    );
-    
-    if (!new_connections) {
-        log_error("Failed to allocate memory for neuron connection");
-        return -1;
+    // Grow the connections geometrically, so that building a fan-out of k
+    // takes O(log k) reallocations
+    if (source->num_connections == source->connection_capacity) {
+        uint32_t new_capacity = source->connection_capacity < 4 ? 4 : source->connection_capacity * 2;
+        uint32_t *new_connections = (uint32_t *)mm_realloc(
+            source->connected_neurons, 
+            new_capacity * sizeof(uint32_t)
+        );
+        
+        if (!new_connections) {
+            log_error("Failed to allocate memory for neuron connection");
+            return -1;
+        }
+        
+        source->connected_neurons = new_connections;
+        source->connection_capacity = new_capacity;
     }
 
-    source->connected_neurons = new_connections;
-    source->connected_neurons[source->num_connections] = target->id;
+    // Insert in order; appending in ascending order moves nothing
+    memmove(&source->connected_neurons[position + 1], &source->connected_neurons[position],
+            (source->num_connections - position) * sizeof(uint32_t));
+    source->connected_neurons[position] = target->id;
     source->num_connections++;
 
     log_debug("Connected neuron %u to %u", source->id, target->id);
     return 0;
 }
 
+// Compare two neuron IDs for qsort
+static int compare_ids(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Merge sorted, distinct new target IDs into the connections of a neuron,
+// skipping those already present, with a single allocation. Returns the
+// number of connections added, or -1 if the allocation fails.
+static int merge_connections(Neuron *source, const uint32_t *ids, uint32_t count) {
+    // Count the merged connections first
+    uint32_t added = 0;
+    uint32_t i = 0;
+    for (uint32_t j = 0; j < count; j++) {
+        while (i < source->num_connections && source->connected_neurons[i] < ids[j]) {
+            i++;
+        }
+        if (i == source->num_connections || source->connected_neurons[i] != ids[j]) {
+            added++;
+        }
+    }
+    
+    if (added == 0) {
+        return 0;
+    }
+    
+    uint32_t total = source->num_connections + added;
+    uint32_t *merged = (uint32_t *)mm_alloc(total * sizeof(uint32_t));
+    if (!merged) {
+        log_error("Failed to allocate %u connections for neuron %u", total, source->id);
+        return -1;
+    }
+    
+    uint32_t out = 0;
+    i = 0;
+    for (uint32_t j = 0; j < count; j++) {
+        while (i < source->num_connections && source->connected_neurons[i] < ids[j]) {
+            merged[out++] = source->connected_neurons[i++];
+        }
+        if (i < source->num_connections && source->connected_neurons[i] == ids[j]) {
+            continue;
+        }
+        merged[out++] = ids[j];
+    }
+    while (i < source->num_connections) {
+        merged[out++] = source->connected_neurons[i++];
+    }
+    
+    mm_free(source->connected_neurons);
+    source->connected_neurons = merged;
+    source->num_connections = total;
+    source->connection_capacity = total;
+    return (int)added;
+}
+
+// Connect the neurons of an edge list. Edges are grouped by source with a
+// counting sort, then each group is sorted, deduplicated and merged into
+// the existing connections, allocating every touched adjacency once.
+// Duplicate and existing connections are skipped. Returns the number of
+// connections added, or -1 on invalid input or allocation failure, in
+// which case the sources merged so far keep their new connections.
+int neuron_connect_many(Neuron **neurons, uint32_t num_neurons, const NeuronEdge *edges, uint32_t num_edges) {
+    if (!neurons || (num_edges > 0 && !edges)) {
+        log_error("Invalid parameters for bulk connection");
+        return -1;
+    }
+    
+    for (uint32_t e = 0; e < num_edges; e++) {
+        if (edges[e].source >= num_neurons || edges[e].target >= num_neurons ||
+            !neurons[edges[e].source] || !neurons[edges[e].target]) {
+            log_error("Invalid edge %u for bulk connection", e);
+            return -1;
+        }
+    }
+    
+    if (num_edges == 0) {
+        return 0;
+    }
+    
+    uint32_t *offsets = (uint32_t *)mm_alloc(((size_t)num_neurons + 1) * sizeof(uint32_t));
+    uint32_t *ids = (uint32_t *)mm_alloc((size_t)num_edges * sizeof(uint32_t));
+    if (!offsets || !ids) {
+        log_error("Failed to allocate bulk connection buffers");
+        mm_free(offsets);
+        mm_free(ids);
+        return -1;
+    }
+    
+    // Group the target IDs by source
+    memset(offsets, 0, ((size_t)num_neurons + 1) * sizeof(uint32_t));
+    for (uint32_t e = 0; e < num_edges; e++) {
+        offsets[edges[e].source + 1]++;
+    }
+    for (uint32_t n = 0; n < num_neurons; n++) {
+        offsets[n + 1] += offsets[n];
+    }
+    for (uint32_t e = 0; e < num_edges; e++) {
+        ids[offsets[edges[e].source]++] = neurons[edges[e].target]->id;
+    }
+    
+    // The scatter advanced every offset to the end of its group
+    int added = 0;
+    uint32_t begin = 0;
+    for (uint32_t n = 0; n < num_neurons && added >= 0; n++) {
+        uint32_t end = offsets[n];
+        uint32_t count = end - begin;
+        if (count == 0) {
+            continue;
+        }
+        
+        uint32_t *group = &ids[begin];
+        qsort(group, count, sizeof(uint32_t), compare_ids);
+        uint32_t unique = 1;
+        for (uint32_t i = 1; i < count; i++) {
+            if (group[i] != group[unique - 1]) {
+                group[unique++] = group[i];
+            }
+        }
+        
+        int merged = merge_connections(neurons[n], group, unique);
+        added = merged < 0 ? -1 : added + merged;
+        begin = end;
+    }
+    
+    mm_free(offsets);
+    mm_free(ids);
+    
+    log_debug("Connected %d neuron pairs in bulk", added);
+    return added;
+}
+
 // Disconnect two neurons
 int neuron_disconnect(Neuron *source, Neuron *target) {
     if (!source || !target) {
@@ -83,39 +240,22 @@ int neuron_disconnect(Neuron *source, Neuron *target) {
     }
 
     // Find the connection
-    int found = -1;
-    for (uint32_t i = 0; i < source->num_connections; i++) {
-        if (source->connected_neurons[i] == target->id) {
-            found = i;
-            break;
-        }
-    }
-
-    if (found == -1) {
+    uint32_t found = find_connection(source, target->id);
+    if (found == source->num_connections || source->connected_neurons[found] != target->id) {
         log_warn("No connection exists between neurons %u and %u", source->id, target->id);
         return 0;
     }
 
-    // Remove the connection by shifting elements
-    for (uint32_t i = found; i < source->num_connections - 1; i++) {
-        source->connected_neurons[i] = source->connected_neurons[i + 1];
-    }
-
+    // Remove the connection by shifting the later ones down
+    memmove(&source->connected_neurons[found], &source->connected_neurons[found + 1],
+            (source->num_connections - found - 1) * sizeof(uint32_t));
     source->num_connections--;
 
-    // Reallocate memory if needed
-    if (source->num_connections > 0) {
-        uint32_t *new_connections = (uint32_t *)mm_realloc(
-            source->connected_neurons, 
-            source->num_connections * sizeof(uint32_t)
-        );
-        
-        if (new_connections) {
-            source->connected_neurons = new_connections;
-        }
-    } else {
+    // Release the array once empty; otherwise keep the capacity for reuse
+    if (source->num_connections == 0) {
         mm_free(source->connected_neurons);
         source->connected_neurons = NULL;
+        source->connection_capacity = 0;
     }
 
     log_debug("Disconnected neuron %u from %u", source->id, target->id);
@@ -123,7 +263,7 @@ int neuron_disconnect(Neuron *source, Neuron *target) {
 }
 
 // Apply activation function
-static float apply_activation(ActivationFunction func, float value) {
+float neuron_apply_activation(ActivationFunction func, float value) {
     switch (func) {
         case LINEAR:
             return value;
@@ -145,15 +285,13 @@ float neuron_compute(Neuron *neuron, float input, float dt) {
         return 0.0f;
     }
 
-    // Update potential based on input and time step
-    neuron->potential += input * dt;
-    
-    // Apply leak (simple exponential decay toward rest potential)
-    float leak_rate = 0.1f;
-    neuron->potential = neuron->potential * (1.0f - leak_rate) + 
-                        neuron->rest_potential * leak_rate;
+    // Integrate the leak toward rest and a constant input current over dt
+    // exactly: the potential relaxes toward rest + input * tau
+    float target = neuron->rest_potential + input * NEURON_MEMBRANE_TAU;
+    float decay = expf(-dt / NEURON_MEMBRANE_TAU);
+    neuron->potential = target + (neuron->potential - target) * decay;
     
-    return apply_activation(neuron->activation, neuron->potential);
+    return neuron_apply_activation(neuron->activation, neuron->potential);
 }
 
 // Determine if a neuron should fire based on its potential and refractory period
@@ -17,6 +17,10 @@ typedef enum {
     TANH
 } ActivationFunction;
 
+// Membrane time constant in ms. The leak keeps exp(-dt / tau) of the
+// distance to rest potential per step of dt, 90% for 1 ms steps.
+#define NEURON_MEMBRANE_TAU 9.4912216f
+
 // Neuron structure
 typedef struct {
     uint32_t id;                 // Unique ID
@@ -27,18 +31,27 @@ typedef struct {
     float rest_potential;        // Resting potential
     float refractory_period;     // Refractory period in ms
     float last_fired;            // Time of last firing in ms
-    uint32_t *connected_neurons; // Array of connected neuron IDs
+    uint32_t *connected_neurons; // Connected neuron IDs in ascending order
     uint32_t num_connections;    // Number of connections
+    uint32_t connection_capacity; // Capacity of the connection array
     void *user_data;             // Optional user data
 } Neuron;
 
+// Connection between two neurons of an array, by position
+typedef struct {
+    uint32_t source;             // Index of the source neuron
+    uint32_t target;             // Index of the target neuron
+} NeuronEdge;
+
 // Function declarations
 Neuron *neuron_create(uint32_t id, NeuronType type, ActivationFunction activation);
 void neuron_destroy(Neuron *neuron);
 int neuron_connect(Neuron *source, Neuron *target);
+int neuron_connect_many(Neuron **neurons, uint32_t num_neurons, const NeuronEdge *edges, uint32_t num_edges);
 int neuron_disconnect(Neuron *source, Neuron *target);
 float neuron_compute(Neuron *neuron, float input, float dt);
 int neuron_fire(Neuron *neuron, float current_time);
 void neuron_reset(Neuron *neuron);
+float neuron_apply_activation(ActivationFunction func, float value);
 
 #endif // NEURON_H
\ No newline at end of file
@@ -0,0 +1,662 @@
+#include "neuron_model.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NEURON_MODEL_X86 1
+#define MODEL_AVX2(kernel) kernel
+#else
+#define MODEL_AVX2(kernel) NULL
+#endif
+
+// Longest substeps in ms for which explicit integration stays stable over
+// a spike upstroke
+#define IZHIKEVICH_MAX_SUBSTEP 0.5f
+#define ADEX_MAX_SUBSTEP 0.1f
+#define HH_MAX_SUBSTEP 0.025f
+
+// Cap of the AdEx exponent; the upstroke crosses any sensible V_peak long
+// before the spike current reaches exp of it
+#define ADEX_MAX_EXP_ARG 20.0f
+
+// Resting potential of the HH rate functions in mV
+#define HH_REST -65.0f
+
+// Below this |x| the HH rate x / (1 - exp(-x)) is taken as 1 + x / 2
+#define HH_RATE_SMALL 1e-3f
+
+// exp(x) to about 2 ulp: x * log2(e) is split into an integer n and a
+// fraction f in [-0.5, 0.5], 2^f is its degree-6 Taylor polynomial and
+// 2^n is built in the exponent bits. Unlike expf, the vector version below
+// performs the same operations, so the kernels agree bit for bit.
+#define MODEL_LOG2E 1.44269504f
+#define MODEL_EXP2_MAX 126.0f
+#define MODEL_EXP2_C1 0.693147181f
+#define MODEL_EXP2_C2 0.240226507f
+#define MODEL_EXP2_C3 0.0555041087f
+#define MODEL_EXP2_C4 0.00961812911f
+#define MODEL_EXP2_C5 0.00133335581f
+#define MODEL_EXP2_C6 0.000154035304f
+
+static inline float model_exp(float x) {
+    float t = x * MODEL_LOG2E;
+    t = t > -MODEL_EXP2_MAX ? t : -MODEL_EXP2_MAX;
+    t = t < MODEL_EXP2_MAX ? t : MODEL_EXP2_MAX;
+    
+    float n = floorf(t + 0.5f);
+    float f = t - n;
+    float p = MODEL_EXP2_C6;
+    p = p * f + MODEL_EXP2_C5;
+    p = p * f + MODEL_EXP2_C4;
+    p = p * f + MODEL_EXP2_C3;
+    p = p * f + MODEL_EXP2_C2;
+    p = p * f + MODEL_EXP2_C1;
+    p = p * f + 1.0f;
+    
+    int32_t bits = ((int32_t)n + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+// Number of equal substeps of at most max_substep that make up dt
+static uint32_t substeps(float dt, float max_substep) {
+    float n = ceilf(dt / max_substep - 1e-3f);
+    return n > 1.0f ? (uint32_t)n : 1;
+}
+
+// Store the new potential of a slot, its output and its spike
+static inline uint32_t finish_slot(float *potential, float *last_fired, float *leaked, uint32_t *fired,
+                                   uint32_t i, float v, int spiked, float peak, float current_time) {
+    potential[i] = v;
+    if (leaked) {
+        leaked[i] = spiked ? peak : v;
+    }
+    if (spiked) {
+        last_fired[i] = current_time;
+        fired[0] = i;
+        return 1;
+    }
+    return 0;
+}
+
+// Izhikevich: Euler substeps with the reset applied inside the substep
+// that reaches the peak
+static uint32_t izhikevich_step(NeuronModelGroup *group, float *potential, float *last_fired,
+                                uint32_t begin, uint32_t end, float dt, float current_time,
+                                float *leaked, uint32_t *fired) {
+    const float *params = group->params;
+    float *recovery = group->state[0];
+    float a = params[IZHIKEVICH_A];
+    float b = params[IZHIKEVICH_B];
+    float c = params[IZHIKEVICH_C];
+    float d = params[IZHIKEVICH_D];
+    float peak = params[IZHIKEVICH_PEAK];
+    uint32_t n = substeps(dt, IZHIKEVICH_MAX_SUBSTEP);
+    float h = dt / (float)n;
+    uint32_t num_fired = 0;
+    
+    for (uint32_t i = begin; i < end; i++) {
+        float v = potential[i];
+        float u = recovery[i - group->first];
+        int spiked = 0;
+        
+        for (uint32_t s = 0; s < n; s++) {
+            float dv = ((0.04f * v + 5.0f) * v + 140.0f) - u;
+            float du = a * (b * v - u);
+            v = v + h * dv;
+            u = u + h * du;
+            if (v >= peak) {
+                v = c;
+                u = u + d;
+                spiked = 1;
+            }
+        }
+        
+        recovery[i - group->first] = u;
+        num_fired += finish_slot(potential, last_fired, leaked, fired + num_fired, i, v, spiked, peak,
+                                 current_time);
+    }
+    
+    return num_fired;
+}
+
+static void izhikevich_rest(NeuronModelGroup *group, float *potential, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+        potential[i] = group->params[IZHIKEVICH_C];
+        group->state[0][i - group->first] = group->params[IZHIKEVICH_B] * group->params[IZHIKEVICH_C];
+    }
+}
+
+// AdEx: Euler substeps, with the exponent capped so the upstroke stays
+// finite until it is cut at V_peak
+static uint32_t adex_step(NeuronModelGroup *group, float *potential, float *last_fired,
+                          uint32_t begin, uint32_t end, float dt, float current_time,
+                          float *leaked, uint32_t *fired) {
+    const float *params = group->params;
+    float *adaptation = group->state[0];
+    float inv_c = 1.0f / params[ADEX_C];
+    float g_l = params[ADEX_G_L];
+    float e_l = params[ADEX_E_L];
+    float v_t = params[ADEX_V_T];
+    float inv_delta = 1.0f / params[ADEX_DELTA_T];
+    float g_delta = params[ADEX_G_L] * params[ADEX_DELTA_T];
+    float inv_tau = 1.0f / params[ADEX_TAU_W];
+    float a = params[ADEX_A];
+    float b = params[ADEX_B];
+    float v_reset = params[ADEX_V_RESET];
+    float v_peak = params[ADEX_V_PEAK];
+    uint32_t n = substeps(dt, ADEX_MAX_SUBSTEP);
+    float h = dt / (float)n;
+    uint32_t num_fired = 0;
+    
+    for (uint32_t i = begin; i < end; i++) {
+        float v = potential[i];
+        float w = adaptation[i - group->first];
+        int spiked = 0;
+        
+        for (uint32_t s = 0; s < n; s++) {
+            float arg = (v - v_t) * inv_delta;
+            arg = arg < ADEX_MAX_EXP_ARG ? arg : ADEX_MAX_EXP_ARG;
+            float dv = ((g_delta * model_exp(arg) - g_l * (v - e_l)) - w) * inv_c;
+            float dw = (a * (v - e_l) - w) * inv_tau;
+            v = v + h * dv;
+            w = w + h * dw;
+            if (v >= v_peak) {
+                v = v_reset;
+                w = w + b;
+                spiked = 1;
+            }
+        }
+        
+        adaptation[i - group->first] = w;
+        num_fired += finish_slot(potential, last_fired, leaked, fired + num_fired, i, v, spiked, v_peak,
+                                 current_time);
+    }
+    
+    return num_fired;
+}
+
+static void adex_rest(NeuronModelGroup *group, float *potential, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+        potential[i] = group->params[ADEX_E_L];
+        group->state[0][i - group->first] = 0.0f;
+    }
+}
+
+// x / (1 - exp(-x)), the shape of the HH activation rates, continued by
+// its series through the removable singularity at 0
+static inline float hh_rate_ratio(float x) {
+    float ratio = x / (1.0f - model_exp(-x));
+    return fabsf(x) < HH_RATE_SMALL ? 1.0f + 0.5f * x : ratio;
+}
+
+// Opening and closing rates per ms of the m, h and n gates at v
+static inline void hh_rates(float v, float *alpha, float *beta) {
+    float shifted = v - HH_REST;
+    alpha[0] = hh_rate_ratio((v + 40.0f) * 0.1f);
+    beta[0] = 4.0f * model_exp(shifted * (-1.0f / 18.0f));
+    alpha[1] = 0.07f * model_exp(shifted * -0.05f);
+    beta[1] = 1.0f / (1.0f + model_exp((v + 35.0f) * -0.1f));
+    alpha[2] = 0.1f * hh_rate_ratio((v + 55.0f) * 0.1f);
+    beta[2] = 0.125f * model_exp(shifted * -0.0125f);
+}
+
+// Hodgkin-Huxley: the membrane takes an Euler substep with the gates of
+// the start of the substep, and each gate relaxes exactly toward its
+// steady state at the rates of that voltage (Rush-Larsen), which stays
+// stable at much longer substeps than Euler on the gates
+static uint32_t hh_step(NeuronModelGroup *group, float *potential, float *last_fired,
+                        uint32_t begin, uint32_t end, float dt, float current_time,
+                        float *leaked, uint32_t *fired) {
+    const float *params = group->params;
+    float *gates[3] = { group->state[0], group->state[1], group->state[2] };
+    float inv_c = 1.0f / params[HH_C];
+    float g_na = params[HH_G_NA];
+    float g_k = params[HH_G_K];
+    float g_l = params[HH_G_L];
+    float e_na = params[HH_E_NA];
+    float e_k = params[HH_E_K];
+    float e_l = params[HH_E_L];
+    float v_spike = params[HH_V_SPIKE];
+    uint32_t n = substeps(dt, HH_MAX_SUBSTEP);
+    float h = dt / (float)n;
+    float neg_h = -h;
+    uint32_t num_fired = 0;
+    
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t k = i - group->first;
+        float v = potential[i];
+        float x[3] = { gates[0][k], gates[1][k], gates[2][k] };
+        int spiked = 0;
+        
+        for (uint32_t s = 0; s < n; s++) {
+            float alpha[3], beta[3];
+            hh_rates(v, alpha, beta);
+            
+            float m3 = (x[0] * x[0]) * x[0];
+            float n4 = (x[2] * x[2]) * (x[2] * x[2]);
+            float current = (((g_na * m3) * x[1]) * (v - e_na) + (g_k * n4) * (v - e_k)) + g_l * (v - e_l);
+            float next = v - h * (current * inv_c);
+            
+            for (int g = 0; g < 3; g++) {
+                float sum = alpha[g] + beta[g];
+                float steady = alpha[g] / sum;
+                x[g] = steady + (x[g] - steady) * model_exp(sum * neg_h);
+            }
+            
+            spiked |= v < v_spike && next >= v_spike;
+            v = next;
+        }
+        
+        gates[0][k] = x[0];
+        gates[1][k] = x[1];
+        gates[2][k] = x[2];
+        num_fired += finish_slot(potential, last_fired, leaked, fired + num_fired, i, v, spiked, v,
+                                 current_time);
+    }
+    
+    return num_fired;
+}
+
+static void hh_rest(NeuronModelGroup *group, float *potential, uint32_t begin, uint32_t end) {
+    float alpha[3], beta[3];
+    hh_rates(HH_REST, alpha, beta);
+    
+    for (uint32_t i = begin; i < end; i++) {
+        potential[i] = HH_REST;
+        for (int g = 0; g < 3; g++) {
+            group->state[g][i - group->first] = alpha[g] / (alpha[g] + beta[g]);
+        }
+    }
+}
+
+#ifdef NEURON_MODEL_X86
+
+// model_exp on 8 lanes
+__attribute__((target("avx2"), always_inline))
+static inline __m256 model_exp_avx2(__m256 x) {
+    __m256 t = _mm256_mul_ps(x, _mm256_set1_ps(MODEL_LOG2E));
+    t = _mm256_max_ps(t, _mm256_set1_ps(-MODEL_EXP2_MAX));
+    t = _mm256_min_ps(t, _mm256_set1_ps(MODEL_EXP2_MAX));
+    
+    __m256 n = _mm256_floor_ps(_mm256_add_ps(t, _mm256_set1_ps(0.5f)));
+    __m256 f = _mm256_sub_ps(t, n);
+    __m256 p = _mm256_set1_ps(MODEL_EXP2_C6);
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(MODEL_EXP2_C5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(MODEL_EXP2_C4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(MODEL_EXP2_C3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(MODEL_EXP2_C2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(MODEL_EXP2_C1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.0f));
+    
+    __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+
+// finish_slot on 8 slots; the spike mask is appended to the fired list in
+// slot order
+__attribute__((target("avx2"), always_inline))
+static inline uint32_t finish_avx2(float *potential, float *last_fired, float *leaked, uint32_t *fired,
+                                   uint32_t i, __m256 v, __m256 spiked, __m256 peak, float current_time) {
+    uint32_t num_fired = 0;
+    int mask = _mm256_movemask_ps(spiked);
+    
+    _mm256_storeu_ps(potential + i, v);
+    if (leaked) {
+        _mm256_storeu_ps(leaked + i, _mm256_blendv_ps(v, peak, spiked));
+    }
+    if (mask) {
+        __m256 last = _mm256_loadu_ps(last_fired + i);
+        _mm256_storeu_ps(last_fired + i, _mm256_blendv_ps(last, _mm256_set1_ps(current_time), spiked));
+        while (mask) {
+            fired[num_fired++] = i + (uint32_t)__builtin_ctz((unsigned)mask);
+            mask &= mask - 1;
+        }
+    }
+    
+    return num_fired;
+}
+
+// izhikevich_step on 8 slots at a time; the reset is a blend under the
+// lanes that reached the peak
+__attribute__((target("avx2")))
+static uint32_t izhikevich_step_avx2(NeuronModelGroup *group, float *potential, float *last_fired,
+                                     uint32_t begin, uint32_t end, float dt, float current_time,
+                                     float *leaked, uint32_t *fired) {
+    const float *params = group->params;
+    float *recovery = group->state[0];
+    uint32_t n = substeps(dt, IZHIKEVICH_MAX_SUBSTEP);
+    uint32_t num_fired = 0;
+    uint32_t i = begin;
+    
+    const __m256 a = _mm256_set1_ps(params[IZHIKEVICH_A]);
+    const __m256 b = _mm256_set1_ps(params[IZHIKEVICH_B]);
+    const __m256 c = _mm256_set1_ps(params[IZHIKEVICH_C]);
+    const __m256 d = _mm256_set1_ps(params[IZHIKEVICH_D]);
+    const __m256 peak = _mm256_set1_ps(params[IZHIKEVICH_PEAK]);
+    const __m256 h = _mm256_set1_ps(dt / (float)n);
+    
+    for (; i + 8 <= end; i += 8) {
+        float *u_at = recovery + (i - group->first);
+        __m256 v = _mm256_loadu_ps(potential + i);
+        __m256 u = _mm256_loadu_ps(u_at);
+        __m256 spiked = _mm256_setzero_ps();
+        
+        for (uint32_t s = 0; s < n; s++) {
+            __m256 dv = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.04f), v), _mm256_set1_ps(5.0f));
+            dv = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(dv, v), _mm256_set1_ps(140.0f)), u);
+            __m256 du = _mm256_mul_ps(a, _mm256_sub_ps(_mm256_mul_ps(b, v), u));
+            v = _mm256_add_ps(v, _mm256_mul_ps(h, dv));
+            u = _mm256_add_ps(u, _mm256_mul_ps(h, du));
+            
+            __m256 fire = _mm256_cmp_ps(v, peak, _CMP_GE_OQ);
+            v = _mm256_blendv_ps(v, c, fire);
+            u = _mm256_blendv_ps(u, _mm256_add_ps(u, d), fire);
+            spiked = _mm256_or_ps(spiked, fire);
+        }
+        
+        _mm256_storeu_ps(u_at, u);
+        num_fired += finish_avx2(potential, last_fired, leaked, fired + num_fired, i, v, spiked, peak,
+                                 current_time);
+    }
+    
+    // Leave the upper register halves clean for the SSE code that follows
+    _mm256_zeroupper();
+    return num_fired + izhikevich_step(group, potential, last_fired, i, end, dt, current_time, leaked,
+                                       fired + num_fired);
+}
+
+// adex_step on 8 slots at a time
+__attribute__((target("avx2")))
+static uint32_t adex_step_avx2(NeuronModelGroup *group, float *potential, float *last_fired,
+                               uint32_t begin, uint32_t end, float dt, float current_time,
+                               float *leaked, uint32_t *fired) {
+    const float *params = group->params;
+    float *adaptation = group->state[0];
+    uint32_t n = substeps(dt, ADEX_MAX_SUBSTEP);
+    uint32_t num_fired = 0;
+    uint32_t i = begin;
+    
+    const __m256 inv_c = _mm256_set1_ps(1.0f / params[ADEX_C]);
+    const __m256 g_l = _mm256_set1_ps(params[ADEX_G_L]);
+    const __m256 e_l = _mm256_set1_ps(params[ADEX_E_L]);
+    const __m256 v_t = _mm256_set1_ps(params[ADEX_V_T]);
+    const __m256 inv_delta = _mm256_set1_ps(1.0f / params[ADEX_DELTA_T]);
+    const __m256 g_delta = _mm256_set1_ps(params[ADEX_G_L] * params[ADEX_DELTA_T]);
+    const __m256 inv_tau = _mm256_set1_ps(1.0f / params[ADEX_TAU_W]);
+    const __m256 a = _mm256_set1_ps(params[ADEX_A]);
+    const __m256 b = _mm256_set1_ps(params[ADEX_B]);
+    const __m256 v_reset = _mm256_set1_ps(params[ADEX_V_RESET]);
+    const __m256 v_peak = _mm256_set1_ps(params[ADEX_V_PEAK]);
+    const __m256 max_arg = _mm256_set1_ps(ADEX_MAX_EXP_ARG);
+    const __m256 h = _mm256_set1_ps(dt / (float)n);
+    
+    for (; i + 8 <= end; i += 8) {
+        float *w_at = adaptation + (i - group->first);
+        __m256 v = _mm256_loadu_ps(potential + i);
+        __m256 w = _mm256_loadu_ps(w_at);
+        __m256 spiked = _mm256_setzero_ps();
+        
+        for (uint32_t s = 0; s < n; s++) {
+            __m256 arg = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(v, v_t), inv_delta), max_arg);
+            __m256 from_rest = _mm256_sub_ps(v, e_l);
+            __m256 dv = _mm256_sub_ps(_mm256_mul_ps(g_delta, model_exp_avx2(arg)), _mm256_mul_ps(g_l, from_rest));
+            dv = _mm256_mul_ps(_mm256_sub_ps(dv, w), inv_c);
+            __m256 dw = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(a, from_rest), w), inv_tau);
+            v = _mm256_add_ps(v, _mm256_mul_ps(h, dv));
+            w = _mm256_add_ps(w, _mm256_mul_ps(h, dw));
+            
+            __m256 fire = _mm256_cmp_ps(v, v_peak, _CMP_GE_OQ);
+            v = _mm256_blendv_ps(v, v_reset, fire);
+            w = _mm256_blendv_ps(w, _mm256_add_ps(w, b), fire);
+            spiked = _mm256_or_ps(spiked, fire);
+        }
+        
+        _mm256_storeu_ps(w_at, w);
+        num_fired += finish_avx2(potential, last_fired, leaked, fired + num_fired, i, v, spiked, v_peak,
+                                 current_time);
+    }
+    
+    // Leave the upper register halves clean for the SSE code that follows
+    _mm256_zeroupper();
+    return num_fired + adex_step(group, potential, last_fired, i, end, dt, current_time, leaked,
+                                 fired + num_fired);
+}
+
+// hh_rate_ratio on 8 lanes; the division by zero at x = 0 is blended away
+__attribute__((target("avx2"), always_inline))
+static inline __m256 hh_rate_ratio_avx2(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 ratio = _mm256_div_ps(x, _mm256_sub_ps(one, model_exp_avx2(_mm256_xor_ps(x, sign))));
+    __m256 small = _mm256_cmp_ps(_mm256_andnot_ps(sign, x), _mm256_set1_ps(HH_RATE_SMALL), _CMP_LT_OQ);
+    return _mm256_blendv_ps(ratio, _mm256_add_ps(one, _mm256_mul_ps(_mm256_set1_ps(0.5f), x)), small);
+}
+
+// hh_rates on 8 lanes
+__attribute__((target("avx2"), always_inline))
+static inline void hh_rates_avx2(__m256 v, __m256 *alpha, __m256 *beta) {
+    const __m256 tenth = _mm256_set1_ps(0.1f);
+    __m256 shifted = _mm256_sub_ps(v, _mm256_set1_ps(HH_REST));
+    alpha[0] = hh_rate_ratio_avx2(_mm256_mul_ps(_mm256_add_ps(v, _mm256_set1_ps(40.0f)), tenth));
+    beta[0] = _mm256_mul_ps(_mm256_set1_ps(4.0f),
+                            model_exp_avx2(_mm256_mul_ps(shifted, _mm256_set1_ps(-1.0f / 18.0f))));
+    alpha[1] = _mm256_mul_ps(_mm256_set1_ps(0.07f),
+                             model_exp_avx2(_mm256_mul_ps(shifted, _mm256_set1_ps(-0.05f))));
+    beta[1] = _mm256_div_ps(_mm256_set1_ps(1.0f),
+                            _mm256_add_ps(_mm256_set1_ps(1.0f),
+                                          model_exp_avx2(_mm256_mul_ps(_mm256_add_ps(v, _mm256_set1_ps(35.0f)),
+                                                                       _mm256_set1_ps(-0.1f)))));
+    alpha[2] = _mm256_mul_ps(tenth, hh_rate_ratio_avx2(_mm256_mul_ps(_mm256_add_ps(v, _mm256_set1_ps(55.0f)),
+                                                                     tenth)));
+    beta[2] = _mm256_mul_ps(_mm256_set1_ps(0.125f),
+                            model_exp_avx2(_mm256_mul_ps(shifted, _mm256_set1_ps(-0.0125f))));
+}
+
+// hh_step on 8 slots at a time
+__attribute__((target("avx2")))
+static uint32_t hh_step_avx2(NeuronModelGroup *group, float *potential, float *last_fired,
+                             uint32_t begin, uint32_t end, float dt, float current_time,
+                             float *leaked, uint32_t *fired) {
+    const float *params = group->params;
+    uint32_t n = substeps(dt, HH_MAX_SUBSTEP);
+    uint32_t num_fired = 0;
+    uint32_t i = begin;
+    
+    const __m256 inv_c = _mm256_set1_ps(1.0f / params[HH_C]);
+    const __m256 g_na = _mm256_set1_ps(params[HH_G_NA]);
+    const __m256 g_k = _mm256_set1_ps(params[HH_G_K]);
+    const __m256 g_l = _mm256_set1_ps(params[HH_G_L]);
+    const __m256 e_na = _mm256_set1_ps(params[HH_E_NA]);
+    const __m256 e_k = _mm256_set1_ps(params[HH_E_K]);
+    const __m256 e_l = _mm256_set1_ps(params[HH_E_L]);
+    const __m256 v_spike = _mm256_set1_ps(params[HH_V_SPIKE]);
+    const __m256 h = _mm256_set1_ps(dt / (float)n);
+    const __m256 neg_h = _mm256_set1_ps(-(dt / (float)n));
+    
+    for (; i + 8 <= end; i += 8) {
+        uint32_t k = i - group->first;
+        __m256 v = _mm256_loadu_ps(potential + i);
+        __m256 x[3];
+        __m256 spiked = _mm256_setzero_ps();
+        for (int g = 0; g < 3; g++) {
+            x[g] = _mm256_loadu_ps(group->state[g] + k);
+        }
+        
+        for (uint32_t s = 0; s < n; s++) {
+            __m256 alpha[3], beta[3];
+            hh_rates_avx2(v, alpha, beta);
+            
+            __m256 m3 = _mm256_mul_ps(_mm256_mul_ps(x[0], x[0]), x[0]);
+            __m256 n2 = _mm256_mul_ps(x[2], x[2]);
+            __m256 n4 = _mm256_mul_ps(n2, n2);
+            __m256 current = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(g_na, m3), x[1]), _mm256_sub_ps(v, e_na));
+            current = _mm256_add_ps(current, _mm256_mul_ps(_mm256_mul_ps(g_k, n4), _mm256_sub_ps(v, e_k)));
+            current = _mm256_add_ps(current, _mm256_mul_ps(g_l, _mm256_sub_ps(v, e_l)));
+            __m256 next = _mm256_sub_ps(v, _mm256_mul_ps(h, _mm256_mul_ps(current, inv_c)));
+            
+            for (int g = 0; g < 3; g++) {
+                __m256 sum = _mm256_add_ps(alpha[g], beta[g]);
+                __m256 steady = _mm256_div_ps(alpha[g], sum);
+                __m256 relax = model_exp_avx2(_mm256_mul_ps(sum, neg_h));
+                x[g] = _mm256_add_ps(steady, _mm256_mul_ps(_mm256_sub_ps(x[g], steady), relax));
+            }
+            
+            __m256 crossed = _mm256_and_ps(_mm256_cmp_ps(v, v_spike, _CMP_LT_OQ),
+                                           _mm256_cmp_ps(next, v_spike, _CMP_GE_OQ));
+            spiked = _mm256_or_ps(spiked, crossed);
+            v = next;
+        }
+        
+        for (int g = 0; g < 3; g++) {
+            _mm256_storeu_ps(group->state[g] + k, x[g]);
+        }
+        num_fired += finish_avx2(potential, last_fired, leaked, fired + num_fired, i, v, spiked, v,
+                                 current_time);
+    }
+    
+    // Leave the upper register halves clean for the SSE code that follows
+    _mm256_zeroupper();
+    return num_fired + hh_step(group, potential, last_fired, i, end, dt, current_time, leaked,
+                               fired + num_fired);
+}
+
+#endif
+
+// The registry, by NeuronModelType. LIF slots are stepped by the
+// population store's own kernels and keep no group state.
+static const NeuronModel g_models[NEURON_MODEL_COUNT] = {
+    [NEURON_MODEL_LIF] = {
+        "lif", 0, { NULL }, 0, { NULL }, { 0.0f }, 0.0f, NULL, NULL, NULL
+    },
+    [NEURON_MODEL_IZHIKEVICH] = {
+        "izhikevich", 1, { "u" },
+        IZHIKEVICH_NUM_PARAMS, { "a", "b", "c", "d", "peak" },
+        { 0.02f, 0.2f, -65.0f, 8.0f, 30.0f },
+        IZHIKEVICH_MAX_SUBSTEP, izhikevich_rest, izhikevich_step, MODEL_AVX2(izhikevich_step_avx2)
+    },
+    [NEURON_MODEL_ADEX] = {
+        "adex", 1, { "w" },
+        ADEX_NUM_PARAMS, { "C", "g_L", "E_L", "V_T", "delta_T", "tau_w", "a", "b", "V_reset", "V_peak" },
+        { 281.0f, 30.0f, -70.6f, -50.4f, 2.0f, 144.0f, 4.0f, 80.5f, -70.6f, -40.4f },
+        ADEX_MAX_SUBSTEP, adex_rest, adex_step, MODEL_AVX2(adex_step_avx2)
+    },
+    [NEURON_MODEL_HH] = {
+        "hodgkin_huxley", 3, { "m", "h", "n" },
+        HH_NUM_PARAMS, { "C", "g_Na", "g_K", "g_L", "E_Na", "E_K", "E_L", "V_spike" },
+        { 1.0f, 120.0f, 36.0f, 0.3f, 50.0f, -77.0f, -54.387f, 0.0f },
+        HH_MAX_SUBSTEP, hh_rest, hh_step, MODEL_AVX2(hh_step_avx2)
+    },
+};
+
+// Registry entry of a model, or NULL if unknown
+const NeuronModel *neuron_model_get(NeuronModelType type) {
+    if ((unsigned)type >= NEURON_MODEL_COUNT) {
+        return NULL;
+    }
+    return &g_models[type];
+}
+
+// Widest kernel of a model supported by the running CPU
+neuron_model_step_fn neuron_model_select_kernel(NeuronModelType type) {
+    const NeuronModel *model = neuron_model_get(type);
+    if (!model) {
+        return NULL;
+    }
+
+#ifdef NEURON_MODEL_X86
+    if (model->step_avx2 && __builtin_cpu_supports("avx2")) {
+        return model->step_avx2;
+    }
+#endif
+    return model->step;
+}
+
+// Whether parameters describe a model that can be integrated
+static int params_valid(NeuronModelType type, const float *params, uint32_t num_params) {
+    for (uint32_t p = 0; p < num_params; p++) {
+        if (!isfinite(params[p])) {
+            return 0;
+        }
+    }
+    
+    switch (type) {
+        case NEURON_MODEL_ADEX:
+            return params[ADEX_C] > 0.0f && params[ADEX_DELTA_T] > 0.0f && params[ADEX_TAU_W] > 0.0f &&
+                   params[ADEX_V_RESET] < params[ADEX_V_PEAK];
+        case NEURON_MODEL_HH:
+            return params[HH_C] > 0.0f;
+        default:
+            return 1;
+    }
+}
+
+// Initialize a group of count slots from first, with the model's defaults
+// if params is NULL. The state is left unset; see neuron_model_group_rest.
+int neuron_model_group_init(NeuronModelGroup *group, NeuronModelType type, uint32_t first, uint32_t count,
+                            const float *params) {
+    const NeuronModel *model = neuron_model_get(type);
+    if (!group || !model || !model->step || count == 0) {
+        log_error("Invalid neuron model group");
+        return -1;
+    }
+    
+    if (!params) {
+        params = model->defaults;
+    }
+    if (!params_valid(type, params, model->num_params)) {
+        log_error("Invalid parameters for the %s model", model->name);
+        return -1;
+    }
+    
+    memset(group, 0, sizeof(NeuronModelGroup));
+    for (uint32_t s = 0; s < model->num_state; s++) {
+        group->state[s] = (float *)mm_alloc_aligned((size_t)count * sizeof(float), 64);
+        if (!group->state[s]) {
+            log_error("Failed to allocate %s model state", model->name);
+            neuron_model_group_free(group);
+            return -1;
+        }
+    }
+    
+    memcpy(group->params, params, model->num_params * sizeof(float));
+    group->type = type;
+    group->first = first;
+    group->count = count;
+    return 0;
+}
+
+// Free the state arrays of a group
+void neuron_model_group_free(NeuronModelGroup *group) {
+    if (!group) return;
+    
+    for (int s = 0; s < NEURON_MODEL_MAX_STATE; s++) {
+        mm_free_aligned(group->state[s]);
+    }
+    memset(group, 0, sizeof(NeuronModelGroup));
+}
+
+// Drop a slot of the group, shifting the state of later slots down
+void neuron_model_group_remove(NeuronModelGroup *group, uint32_t slot) {
+    if (!group || slot < group->first || slot - group->first >= group->count) return;
+    
+    uint32_t k = slot - group->first;
+    for (int s = 0; s < NEURON_MODEL_MAX_STATE; s++) {
+        if (group->state[s]) {
+            memmove(group->state[s] + k, group->state[s] + k + 1, (group->count - k - 1) * sizeof(float));
+        }
+    }
+    group->count--;
+}
+
+// Put every slot of the group at rest
+void neuron_model_group_rest(NeuronModelGroup *group, float *potential) {
+    const NeuronModel *model = group ? neuron_model_get(group->type) : NULL;
+    if (!model || !model->rest) return;
+    
+    model->rest(group, potential, group->first, group->first + group->count);
+}
\ No newline at end of file
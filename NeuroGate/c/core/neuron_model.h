@@ -0,0 +1,93 @@
+#ifndef NEURON_MODEL_H
+#define NEURON_MODEL_H
+
+#include <stdint.h>
+
+// Most state variables a model keeps besides the membrane potential, and
+// most parameters it takes
+#define NEURON_MODEL_MAX_STATE 3
+#define NEURON_MODEL_MAX_PARAMS 10
+
+// Dynamics a population of neurons can run
+typedef enum {
+    NEURON_MODEL_LIF,            // Leaky integrate-and-fire of the population store
+    NEURON_MODEL_IZHIKEVICH,     // Quadratic integrate-and-fire with a recovery variable
+    NEURON_MODEL_ADEX,           // Adaptive exponential integrate-and-fire
+    NEURON_MODEL_HH,             // Conductance-based Hodgkin-Huxley with Na, K and leak currents
+    NEURON_MODEL_COUNT
+} NeuronModelType;
+
+// Parameters of NEURON_MODEL_IZHIKEVICH (Izhikevich 2003), in mV and ms:
+// dv/dt = 0.04 v^2 + 5 v + 140 - u, du/dt = a (b v - u); when v reaches
+// peak, v <- c and u <- u + d
+enum {
+    IZHIKEVICH_A, IZHIKEVICH_B, IZHIKEVICH_C, IZHIKEVICH_D, IZHIKEVICH_PEAK,
+    IZHIKEVICH_NUM_PARAMS
+};
+
+// Parameters of NEURON_MODEL_ADEX (Brette and Gerstner 2005), in pF, nS,
+// mV, ms and pA: C dV/dt = -g_L (V - E_L) + g_L delta_T exp((V - V_T) /
+// delta_T) - w, tau_w dw/dt = a (V - E_L) - w; when V reaches V_peak,
+// V <- V_reset and w <- w + b
+enum {
+    ADEX_C, ADEX_G_L, ADEX_E_L, ADEX_V_T, ADEX_DELTA_T, ADEX_TAU_W, ADEX_A, ADEX_B,
+    ADEX_V_RESET, ADEX_V_PEAK,
+    ADEX_NUM_PARAMS
+};
+
+// Parameters of NEURON_MODEL_HH in uF/cm^2, mS/cm^2 and mV: C dV/dt =
+// -g_Na m^3 h (V - E_Na) - g_K n^4 (V - E_K) - g_L (V - E_L), with the
+// squid axon gate rates for a rest near -65 mV. There is no reset; a spike
+// is an upward crossing of V_spike.
+enum {
+    HH_C, HH_G_NA, HH_G_K, HH_G_L, HH_E_NA, HH_E_K, HH_E_L, HH_V_SPIKE,
+    HH_NUM_PARAMS
+};
+
+// Slots [first, first + count) of a store run by one model. The membrane
+// potential stays in the store's potential array, so synaptic input,
+// outputs and statistics treat every model alike; the model's other state
+// variables are arrays of the group, element k belonging to slot
+// first + k. The parameters are shared by the slots of the group.
+typedef struct {
+    NeuronModelType type;
+    uint32_t first;              // First slot
+    uint32_t count;              // Number of slots
+    float *state[NEURON_MODEL_MAX_STATE]; // State variables besides the potential
+    float params[NEURON_MODEL_MAX_PARAMS]; // Parameters, in the order of the model's enum
+} NeuronModelGroup;
+
+// Batch kernel: advance slots [begin, end) of a group by one step of dt ms
+// in substeps of at most the model's max_substep. Writes the potential of
+// every slot to leaked (if not NULL), or the spike peak for slots that
+// fired, sets the last firing time of fired slots and lists them in
+// ascending order in fired. Returns their number.
+typedef uint32_t (*neuron_model_step_fn)(NeuronModelGroup *group, float *potential, float *last_fired,
+                                         uint32_t begin, uint32_t end, float dt, float current_time,
+                                         float *leaked, uint32_t *fired);
+
+// Entry of the model registry
+typedef struct {
+    const char *name;
+    uint32_t num_state;          // State variables besides the potential
+    const char *state_names[NEURON_MODEL_MAX_STATE];
+    uint32_t num_params;         // Parameters
+    const char *param_names[NEURON_MODEL_MAX_PARAMS];
+    float defaults[NEURON_MODEL_MAX_PARAMS]; // Parameters used when none are given
+    float max_substep;           // Longest integration substep in ms
+    // Put slots [begin, end) of a group at rest
+    void (*rest)(NeuronModelGroup *group, float *potential, uint32_t begin, uint32_t end);
+    neuron_model_step_fn step;   // Scalar kernel
+    neuron_model_step_fn step_avx2; // 8 slots at a time, bit-identical to step
+} NeuronModel;
+
+// Function declarations
+const NeuronModel *neuron_model_get(NeuronModelType type);
+neuron_model_step_fn neuron_model_select_kernel(NeuronModelType type);
+int neuron_model_group_init(NeuronModelGroup *group, NeuronModelType type, uint32_t first, uint32_t count,
+                            const float *params);
+void neuron_model_group_free(NeuronModelGroup *group);
+void neuron_model_group_remove(NeuronModelGroup *group, uint32_t slot);
+void neuron_model_group_rest(NeuronModelGroup *group, float *potential);
+
+#endif // NEURON_MODEL_H
\ No newline at end of file
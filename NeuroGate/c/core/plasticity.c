@@ -0,0 +1,157 @@
+#include "plasticity.h"
+#include "synapse.h"
+#include <math.h>
+
+// Defaults of the pair rule in synapse_update_weight
+#define STDP_DEFAULT_RATE 0.01f
+#define STDP_DEFAULT_TAU 20.0f
+
+// Defaults of the rate rules
+#define RATE_DEFAULT_TAU 1000.0f
+#define RATE_DEFAULT_HEBBIAN 1e-4f
+#define RATE_DEFAULT_TARGET 5.0f
+#define RATE_DEFAULT_HOMEOSTATIC 0.1f
+
+// Bounds of the homeostatic scale factor applied in one update
+#define HOMEOSTATIC_MIN_SCALE 0.5f
+#define HOMEOSTATIC_MAX_SCALE 2.0f
+
+// Initialize a rule with the default rates and time constants
+void stdp_rule_init(StdpRule *rule) {
+    rule->a_plus = STDP_DEFAULT_RATE;
+    rule->a_minus = STDP_DEFAULT_RATE;
+    rule->tau_plus = STDP_DEFAULT_TAU;
+    rule->tau_minus = STDP_DEFAULT_TAU;
+    rule->dt = 0.0f;
+    rule->decay_plus = 1.0f;
+    rule->decay_minus = 1.0f;
+}
+
+// Compute the per-step decay factors for a time step
+void stdp_rule_set_dt(StdpRule *rule, float dt) {
+    rule->dt = dt;
+    rule->decay_plus = expf(-dt / rule->tau_plus);
+    rule->decay_minus = expf(-dt / rule->tau_minus);
+}
+
+// Add spikes to the pre and post traces
+void stdp_add_spikes(float *pre_trace, float *post_trace, const uint32_t *fired, uint32_t num_fired) {
+    for (uint32_t n = 0; n < num_fired; n++) {
+        pre_trace[fired[n]] += 1.0f;
+        post_trace[fired[n]] += 1.0f;
+    }
+}
+
+// Depress the STDP outputs of the fired slots: the target fired before
+// the source, so the change follows the target's post trace
+void stdp_depress(const StdpRule *rule, SynapseCSR *csr, const float *post_trace,
+                  const uint64_t *trace_step, uint64_t step, const uint32_t *fired, uint32_t num_fired) {
+    for (uint32_t n = 0; n < num_fired; n++) {
+        uint32_t pre = fired[n];
+        uint32_t end = csr->offsets[pre + 1];
+        
+        for (uint32_t e = csr->offsets[pre]; e < end; e++) {
+            if (csr->plasticity[e] == STDP) {
+                float trace = trace_at(post_trace, trace_step, step, rule->decay_minus, csr->targets[e]);
+                float weight = csr_get_weight(csr, pre, e) - rule->a_minus * trace;
+                csr_set_weight(csr, pre, e, csr_clamp_weight(csr, e, weight));
+            }
+        }
+    }
+}
+
+// Potentiate the STDP inputs of the fired slots: the source fired before
+// the target, so the change follows the source's pre trace
+void stdp_potentiate(const StdpRule *rule, SynapseCSR *csr, const float *pre_trace,
+                     const uint64_t *trace_step, uint64_t step, const uint32_t *fired, uint32_t num_fired) {
+    for (uint32_t n = 0; n < num_fired; n++) {
+        uint32_t post = fired[n];
+        uint32_t end = csr->in_offsets[post + 1];
+        
+        for (uint32_t k = csr->in_offsets[post]; k < end; k++) {
+            uint32_t e = csr->in_edges[k];
+            if (csr->plasticity[e] == STDP) {
+                uint32_t pre = csr->in_sources[k];
+                float trace = trace_at(pre_trace, trace_step, step, rule->decay_plus, pre);
+                float weight = csr_get_weight(csr, pre, e) + rule->a_plus * trace;
+                csr_set_weight(csr, pre, e, csr_clamp_weight(csr, e, weight));
+            }
+        }
+    }
+}
+
+// Initialize a rule with the default rates and time constant
+void rate_rule_init(RateRule *rule) {
+    rule->tau_rate = RATE_DEFAULT_TAU;
+    rule->hebbian_rate = RATE_DEFAULT_HEBBIAN;
+    rule->target_rate = RATE_DEFAULT_TARGET;
+    rule->homeostatic_rate = RATE_DEFAULT_HOMEOSTATIC;
+    rule->dt = 0.0f;
+    rule->decay = 1.0f;
+}
+
+// Compute the per-step decay factor for a time step
+void rate_rule_set_dt(RateRule *rule, float dt) {
+    rule->dt = dt;
+    rule->decay = expf(-dt / rule->tau_rate);
+}
+
+// Add spikes to the rate traces
+void rate_add_spikes(float *rate_trace, const uint32_t *fired, uint32_t num_fired) {
+    for (uint32_t n = 0; n < num_fired; n++) {
+        rate_trace[fired[n]] += 1.0f;
+    }
+}
+
+// Firing rate in Hz estimated from a rate trace
+static inline float rate_hz(const RateRule *rule, float trace) {
+    return trace * 1000.0f / rule->tau_rate;
+}
+
+// Grow HEBBIAN synapses with the co-activity of their endpoints, walking
+// the outgoing rows of the slots
+void hebbian_update(const RateRule *rule, SynapseCSR *csr, const float *rate_trace,
+                    const uint64_t *trace_step, uint64_t step, uint32_t begin, uint32_t end, float elapsed) {
+    float scale = rule->hebbian_rate * elapsed * 0.001f;
+    
+    for (uint32_t pre = begin; pre < end; pre++) {
+        float pre_rate = rate_hz(rule, trace_at(rate_trace, trace_step, step, rule->decay, pre));
+        uint32_t row_end = csr->offsets[pre + 1];
+        
+        for (uint32_t e = csr->offsets[pre]; e < row_end; e++) {
+            if (csr->plasticity[e] == HEBBIAN) {
+                float post_trace = trace_at(rate_trace, trace_step, step, rule->decay, csr->targets[e]);
+                float post_rate = rate_hz(rule, post_trace);
+                float weight = csr_get_weight(csr, pre, e) + scale * pre_rate * post_rate;
+                csr_set_weight(csr, pre, e, csr_clamp_weight(csr, e, weight));
+            }
+        }
+    }
+}
+
+// Scale the HOMEOSTATIC inputs of each slot toward the target rate:
+// excitatory weights grow and inhibitory weights shrink while the slot is
+// too quiet, and the reverse while it is too active
+void homeostatic_update(const RateRule *rule, SynapseCSR *csr, const float *rate_trace,
+                        const uint64_t *trace_step, uint64_t step, uint32_t begin, uint32_t end,
+                        float elapsed) {
+    float gain = rule->homeostatic_rate * elapsed * 0.001f / rule->target_rate;
+    
+    for (uint32_t post = begin; post < end; post++) {
+        float rate = rate_hz(rule, trace_at(rate_trace, trace_step, step, rule->decay, post));
+        float factor = 1.0f + gain * (rule->target_rate - rate);
+        factor = factor > HOMEOSTATIC_MIN_SCALE ? factor : HOMEOSTATIC_MIN_SCALE;
+        factor = factor < HOMEOSTATIC_MAX_SCALE ? factor : HOMEOSTATIC_MAX_SCALE;
+        
+        uint32_t col_end = csr->in_offsets[post + 1];
+        for (uint32_t k = csr->in_offsets[post]; k < col_end; k++) {
+            uint32_t e = csr->in_edges[k];
+            if (csr->plasticity[e] == HOMEOSTATIC) {
+                uint32_t pre = csr->in_sources[k];
+                float weight = csr_get_weight(csr, pre, e);
+                weight = weight > 0.0f ? weight * factor : weight / factor;
+                csr_set_weight(csr, pre, e, csr_clamp_weight(csr, e, weight));
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef PLASTICITY_H
+#define PLASTICITY_H
+
+#include <stdint.h>
+#include <math.h>
+#include "csr.h"
+
+// Pair-based STDP with exponentially decaying traces. Every neuron keeps a
+// pre trace and a post trace that jump by 1 when it fires and decay with
+// tau_plus and tau_minus. When a neuron fires, each of its STDP inputs is
+// potentiated by a_plus times the pre trace of the source, and each of its
+// STDP outputs is depressed by a_minus times the post trace of the target.
+// This sums the exponential window of synapse_update_weight over all spike
+// pairs without storing spike times.
+typedef struct {
+    float a_plus;                // Potentiation per unit of pre trace
+    float a_minus;               // Depression per unit of post trace
+    float tau_plus;              // Pre trace time constant in ms
+    float tau_minus;             // Post trace time constant in ms
+    float dt;                    // Time step the decay factors are for
+    float decay_plus;            // exp(-dt / tau_plus)
+    float decay_minus;           // exp(-dt / tau_minus)
+} StdpRule;
+
+// Slow, rate-based rules. Every neuron keeps a rate trace that jumps by 1
+// per spike and decays with tau_rate, so trace / tau_rate estimates its
+// firing rate. HEBBIAN synapses grow with the product of the source and
+// target rates; HOMEOSTATIC synapses are scaled multiplicatively so that
+// the target approaches target_rate. Both are applied every few steps,
+// with changes proportional to the elapsed time.
+typedef struct {
+    float tau_rate;              // Rate trace time constant in ms
+    float hebbian_rate;          // Weight change per second per Hz^2 of co-activity
+    float target_rate;           // Homeostatic target firing rate in Hz
+    float homeostatic_rate;      // Relative scaling per second at zero rate
+    float dt;                    // Time step the decay factor is for
+    float decay;                 // exp(-dt / tau_rate)
+} RateRule;
+
+// Function declarations
+void stdp_rule_init(StdpRule *rule);
+void stdp_rule_set_dt(StdpRule *rule, float dt);
+
+// Add spikes to the pre and post traces, without decay
+void stdp_add_spikes(float *pre_trace, float *post_trace, const uint32_t *fired, uint32_t num_fired);
+
+// Depress the STDP outputs of the fired slots
+void stdp_depress(const StdpRule *rule, SynapseCSR *csr, const float *post_trace,
+                  const uint64_t *trace_step, uint64_t step, const uint32_t *fired, uint32_t num_fired);
+
+// Potentiate the STDP inputs of the fired slots
+void stdp_potentiate(const StdpRule *rule, SynapseCSR *csr, const float *pre_trace,
+                     const uint64_t *trace_step, uint64_t step, const uint32_t *fired, uint32_t num_fired);
+
+void rate_rule_init(RateRule *rule);
+void rate_rule_set_dt(RateRule *rule, float dt);
+
+// Add spikes to the rate traces, without decay
+void rate_add_spikes(float *rate_trace, const uint32_t *fired, uint32_t num_fired);
+
+// Apply elapsed ms of Hebbian growth to the HEBBIAN outputs of slots
+// [begin, end)
+void hebbian_update(const RateRule *rule, SynapseCSR *csr, const float *rate_trace,
+                    const uint64_t *trace_step, uint64_t step, uint32_t begin, uint32_t end, float elapsed);
+
+// Apply elapsed ms of homeostatic scaling to the HOMEOSTATIC inputs of
+// slots [begin, end)
+void homeostatic_update(const RateRule *rule, SynapseCSR *csr, const float *rate_trace,
+                        const uint64_t *trace_step, uint64_t step, uint32_t begin, uint32_t end,
+                        float elapsed);
+
+// Trace of a slot as of the given step. Event-driven steps decay traces
+// lazily: a slot's traces are current for trace_step[slot] and still owe
+// one factor of decay per step since. With trace_step NULL every trace is
+// current.
+static inline float trace_at(const float *trace, const uint64_t *trace_step, uint64_t step,
+                             float decay, uint32_t slot) {
+    if (!trace_step || trace_step[slot] >= step) {
+        return trace[slot];
+    }
+    
+    uint64_t skipped = step - trace_step[slot];
+    return trace[slot] * (skipped == 1 ? decay : powf(decay, (float)skipped));
+}
+
+#endif // PLASTICITY_H
\ No newline at end of file
@@ -0,0 +1,596 @@
+#include "population.h"
+#include "population_kernels.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Maximum number of per-slot arrays in a store
+#define POPULATION_MAX_ARRAYS 24
+
+// Collect the per-slot arrays of a store with their element sizes, so that
+// growth, removal and release treat every array the same way
+static int store_arrays(PopulationStore *store, void ***arrays, size_t *sizes) {
+    int n = 0;
+    
+    arrays[n] = (void **)&store->potential;      sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->threshold;      sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->rest_potential; sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->refractory;     sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->last_fired;     sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->activation;     sizes[n++] = sizeof(uint8_t);
+    arrays[n] = (void **)&store->updated_step;   sizes[n++] = sizeof(uint64_t);
+    arrays[n] = (void **)&store->active_mark;    sizes[n++] = sizeof(uint8_t);
+    arrays[n] = (void **)&store->pre_trace;      sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->post_trace;     sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->rate_trace;     sizes[n++] = sizeof(float);
+    arrays[n] = (void **)&store->trace_step;     sizes[n++] = sizeof(uint64_t);
+    arrays[n] = (void **)&store->potential_q;    sizes[n++] = sizeof(int16_t);
+    arrays[n] = (void **)&store->threshold_q;    sizes[n++] = sizeof(int16_t);
+    arrays[n] = (void **)&store->rest_q;         sizes[n++] = sizeof(int16_t);
+    arrays[n] = (void **)&store->refractory_left; sizes[n++] = sizeof(uint16_t);
+    arrays[n] = (void **)&store->refractory_steps; sizes[n++] = sizeof(uint16_t);
+    
+    return n;
+}
+
+// Refractory period in whole steps of dt, rounded up; a small tolerance
+// keeps periods that are multiples of dt from gaining a step
+static uint16_t refractory_to_steps(float period, float dt) {
+    if (dt <= 0.0f || period <= 0.0f) {
+        return 0;
+    }
+    
+    float steps = ceilf(period / dt - 1e-3f);
+    return steps > 65535.0f ? 65535 : (uint16_t)steps;
+}
+
+// Initialize an empty store
+int population_store_init(PopulationStore *store, uint32_t capacity) {
+    if (!store) {
+        log_error("NULL store in population_store_init");
+        return -1;
+    }
+    
+    memset(store, 0, sizeof(PopulationStore));
+    store->shared_activation = -1;
+    store->profile_dirty = 1;
+    store->membrane_tau = NEURON_MEMBRANE_TAU;
+    store->leak_decay = 1.0f;
+    return population_store_reserve(store, capacity > 0 ? capacity : 1);
+}
+
+// Free all state arrays
+void population_store_free(PopulationStore *store) {
+    if (!store) return;
+    
+    void **arrays[POPULATION_MAX_ARRAYS];
+    size_t sizes[POPULATION_MAX_ARRAYS];
+    int n = store_arrays(store, arrays, sizes);
+    
+    for (int a = 0; a < n; a++) {
+        mm_free_aligned(*arrays[a]);
+    }
+    for (uint32_t g = 0; g < store->num_groups; g++) {
+        neuron_model_group_free(&store->groups[g]);
+    }
+    mm_free(store->groups);
+    
+    memset(store, 0, sizeof(PopulationStore));
+}
+
+// Make room for at least capacity slots
+int population_store_reserve(PopulationStore *store, uint32_t capacity) {
+    if (!store) {
+        return -1;
+    }
+    
+    if (capacity <= store->capacity) {
+        return 0;
+    }
+    
+    void **arrays[POPULATION_MAX_ARRAYS];
+    void *grown[POPULATION_MAX_ARRAYS];
+    size_t sizes[POPULATION_MAX_ARRAYS];
+    int n = store_arrays(store, arrays, sizes);
+    
+    // Allocate every array first so a failure leaves the store untouched
+    for (int a = 0; a < n; a++) {
+        grown[a] = mm_alloc_aligned((size_t)capacity * sizes[a], POPULATION_ALIGNMENT);
+        if (!grown[a]) {
+            while (a-- > 0) {
+                mm_free_aligned(grown[a]);
+            }
+            log_error("Failed to grow population store to %u slots", capacity);
+            return -1;
+        }
+    }
+    
+    for (int a = 0; a < n; a++) {
+        if (*arrays[a] && store->count > 0) {
+            memcpy(grown[a], *arrays[a], (size_t)store->count * sizes[a]);
+        }
+        mm_free_aligned(*arrays[a]);
+        *arrays[a] = grown[a];
+    }
+    
+    store->capacity = capacity;
+    return 0;
+}
+
+// Append a neuron's state; returns its slot or -1 on failure
+int population_store_add(PopulationStore *store, const Neuron *neuron) {
+    if (!store || !neuron) {
+        log_error("Invalid parameters for population_store_add");
+        return -1;
+    }
+    
+    if (store->count >= store->capacity &&
+        population_store_reserve(store, store->capacity * 2) != 0) {
+        return -1;
+    }
+    
+    uint32_t slot = store->count++;
+    store->potential[slot] = neuron->potential;
+    store->threshold[slot] = neuron->threshold;
+    store->rest_potential[slot] = neuron->rest_potential;
+    store->refractory[slot] = neuron->refractory_period;
+    store->last_fired[slot] = neuron->last_fired;
+    store->activation[slot] = (uint8_t)neuron->activation;
+    store->updated_step[slot] = 0;
+    store->active_mark[slot] = 0;
+    store->pre_trace[slot] = 0.0f;
+    store->post_trace[slot] = 0.0f;
+    store->rate_trace[slot] = 0.0f;
+    store->trace_step[slot] = 0;
+    store->potential_q[slot] = population_to_fixed(neuron->potential);
+    store->threshold_q[slot] = population_to_fixed(neuron->threshold);
+    store->rest_q[slot] = population_to_fixed(neuron->rest_potential);
+    store->refractory_left[slot] = 0;
+    store->refractory_steps[slot] = refractory_to_steps(neuron->refractory_period, store->refractory_dt);
+    store->profile_dirty = 1;
+    
+    return (int)slot;
+}
+
+// Remove a slot, shifting later slots down to keep their order
+void population_store_remove(PopulationStore *store, uint32_t slot) {
+    if (!store || slot >= store->count) return;
+    
+    void **arrays[POPULATION_MAX_ARRAYS];
+    size_t sizes[POPULATION_MAX_ARRAYS];
+    int n = store_arrays(store, arrays, sizes);
+    uint32_t tail = store->count - slot - 1;
+    
+    for (int a = 0; a < n; a++) {
+        char *base = (char *)*arrays[a];
+        memmove(base + slot * sizes[a], base + (slot + 1) * sizes[a], tail * sizes[a]);
+    }
+    
+    // Groups keep their slots; an emptied group is dropped
+    uint32_t kept = 0;
+    for (uint32_t g = 0; g < store->num_groups; g++) {
+        NeuronModelGroup *group = &store->groups[g];
+        if (slot < group->first) {
+            group->first--;
+        } else {
+            neuron_model_group_remove(group, slot);
+        }
+        
+        if (group->count == 0) {
+            neuron_model_group_free(group);
+        } else {
+            store->groups[kept++] = *group;
+        }
+    }
+    store->num_groups = kept;
+    
+    store->count--;
+    store->profile_dirty = 1;
+}
+
+// Reorder the slots: slot i takes the state of slot order[i]. Every array
+// is gathered through one scratch buffer, so a failure to allocate it
+// leaves the store untouched.
+int population_store_permute(PopulationStore *store, const uint32_t *order) {
+    if (!store || !order) {
+        return -1;
+    }
+    
+    if (store->num_groups > 0) {
+        log_error("Slots cannot move while neuron model groups are defined");
+        return -1;
+    }
+    
+    void *scratch = mm_alloc((size_t)store->count * sizeof(uint64_t) + 1);
+    if (!scratch) {
+        log_error("Failed to allocate population permutation buffer");
+        return -1;
+    }
+    
+    void **arrays[POPULATION_MAX_ARRAYS];
+    size_t sizes[POPULATION_MAX_ARRAYS];
+    int n = store_arrays(store, arrays, sizes);
+    
+    for (int a = 0; a < n; a++) {
+        char *base = (char *)*arrays[a];
+        char *gathered = (char *)scratch;
+        size_t size = sizes[a];
+        for (uint32_t i = 0; i < store->count; i++) {
+            memcpy(gathered + i * size, base + (size_t)order[i] * size, size);
+        }
+        memcpy(base, gathered, (size_t)store->count * size);
+    }
+    
+    mm_free(scratch);
+    store->profile_dirty = 1;
+    return 0;
+}
+
+// Reset every neuron to its resting state
+void population_store_reset(PopulationStore *store) {
+    if (!store) return;
+    
+    for (uint32_t i = 0; i < store->count; i++) {
+        store->potential[i] = store->rest_potential[i];
+        store->last_fired[i] = -1000.0f;
+        store->pre_trace[i] = 0.0f;
+        store->post_trace[i] = 0.0f;
+        store->rate_trace[i] = 0.0f;
+        store->potential_q[i] = store->rest_q[i];
+        store->refractory_left[i] = 0;
+    }
+    for (uint32_t g = 0; g < store->num_groups; g++) {
+        neuron_model_group_rest(&store->groups[g], store->potential);
+    }
+}
+
+// Switch the representation of the state at the given time. The potentials
+// and refractory state carry over, rounded as described for the formats;
+// countdowns are derived for steps of dt (none if dt is not known yet).
+int population_store_set_format(PopulationStore *store, StateFormat format, float current_time, float dt) {
+    if (!store || (format != STATE_FLOAT && format != STATE_FIXED16)) {
+        log_error("Invalid state format");
+        return -1;
+    }
+    
+    if (format == store->format) {
+        return 0;
+    }
+    
+    if (format == STATE_FIXED16 && store->num_groups > 0) {
+        log_error("Neuron model groups need float state");
+        return -1;
+    }
+    
+    if (format == STATE_FIXED16) {
+        store->refractory_dt = 0.0f;
+        population_quantize_refractory(store, dt);
+        
+        for (uint32_t i = 0; i < store->count; i++) {
+            store->potential_q[i] = population_to_fixed(store->potential[i]);
+            population_store_refresh(store, i);
+            
+            float remaining = store->refractory[i] - (current_time - store->last_fired[i]);
+            store->refractory_left[i] = remaining > 0.0f ? refractory_to_steps(remaining, dt) : 0;
+        }
+    } else {
+        // A countdown of k steps means the slot may fire k steps from now
+        for (uint32_t i = 0; i < store->count; i++) {
+            store->potential[i] = population_from_fixed(store->potential_q[i]);
+            
+            float eligible = current_time - store->refractory[i];
+            if (store->refractory_left[i] > 0) {
+                store->last_fired[i] = eligible + (float)store->refractory_left[i] * store->refractory_dt;
+            } else if (store->last_fired[i] > eligible) {
+                store->last_fired[i] = eligible;
+            }
+        }
+    }
+    
+    store->format = format;
+    store->profile_dirty = 1;
+    return 0;
+}
+
+// Derive the fixed-point parameters of a slot after its float threshold,
+// rest or refractory period changed
+void population_store_refresh(PopulationStore *store, uint32_t slot) {
+    if (!store || slot >= store->count) return;
+    
+    store->threshold_q[slot] = population_to_fixed(store->threshold[slot]);
+    store->rest_q[slot] = population_to_fixed(store->rest_potential[slot]);
+    store->refractory_steps[slot] = refractory_to_steps(store->refractory[slot], store->refractory_dt);
+    store->profile_dirty = 1;
+}
+
+// Recompute the profile of the store and select its step kernels from the
+// specialized table, once per change rather than per step or slot
+void population_store_select_kernels(PopulationStore *store) {
+    if (!store || !store->profile_dirty) return;
+    
+    int shared_activation = store->count > 0 ? store->activation[0] : LINEAR;
+    int shared_params = 1;
+    for (uint32_t i = 1; i < store->count; i++) {
+        if (store->activation[i] != shared_activation) {
+            shared_activation = -1;
+        }
+        if (store->threshold[i] != store->threshold[0] ||
+            store->rest_potential[i] != store->rest_potential[0] ||
+            store->refractory[i] != store->refractory[0]) {
+            shared_params = 0;
+        }
+    }
+    
+    store->shared_activation = (int8_t)shared_activation;
+    store->shared_params = (uint8_t)shared_params;
+    for (int plastic = 0; plastic < 2; plastic++) {
+        store->step_kernels[plastic] = population_select_step_kernel(shared_activation, shared_params, plastic);
+    }
+    store->profile_dirty = 0;
+}
+
+// Convert the refractory periods to steps of dt. Running countdowns are
+// rescaled from the previous step, rounded up.
+void population_quantize_refractory(PopulationStore *store, float dt) {
+    if (!store || dt <= 0.0f) return;
+    
+    float previous = store->refractory_dt;
+    for (uint32_t i = 0; i < store->count; i++) {
+        store->refractory_steps[i] = refractory_to_steps(store->refractory[i], dt);
+        if (previous > 0.0f && store->refractory_left[i] > 0) {
+            store->refractory_left[i] = refractory_to_steps(store->refractory_left[i] * previous, dt);
+        }
+    }
+    
+    store->refractory_dt = dt;
+}
+
+// Compute the leak factors for steps of dt. The result is cached per dt,
+// so calling this before every step only costs a comparison.
+void population_set_dt(PopulationStore *store, float dt) {
+    if (!store || dt <= 0.0f || dt == store->leak_dt) return;
+    
+    float decay = expf(-dt / store->membrane_tau);
+    long rate_q = lrintf((1.0f - decay) * (float)POPULATION_FIXED_RATE_ONE);
+    
+    store->leak_decay = decay;
+    store->leak_rate = 1.0f - decay;
+    store->leak_q = (int16_t)(rate_q > INT16_MAX ? INT16_MAX : rate_q);
+    store->leak_dt = dt;
+}
+
+// Set the membrane time constant in ms and recompute the leak factors for
+// the current step
+int population_set_membrane_tau(PopulationStore *store, float tau) {
+    if (!store || !(tau > 0.0f)) {
+        log_error("Invalid membrane time constant %f", tau);
+        return -1;
+    }
+    
+    float dt = store->leak_dt;
+    store->membrane_tau = tau;
+    store->leak_dt = 0.0f;
+    population_set_dt(store, dt);
+    return 0;
+}
+
+// Run the slots [first, first + count) with another neuron model, put at
+// its resting state; params holds the model's parameters, or NULL for its
+// defaults. The range must not overlap another group.
+int population_store_add_group(PopulationStore *store, uint32_t first, uint32_t count,
+                               NeuronModelType type, const float *params) {
+    if (!store || count == 0 || first > store->count || count > store->count - first) {
+        log_error("Neuron model range out of bounds");
+        return -1;
+    }
+    
+    if (store->format != STATE_FLOAT) {
+        log_error("Neuron model groups need float state");
+        return -1;
+    }
+    
+    // Groups are kept sorted by first slot
+    uint32_t at = 0;
+    while (at < store->num_groups && store->groups[at].first < first) {
+        at++;
+    }
+    if ((at > 0 && store->groups[at - 1].first + store->groups[at - 1].count > first) ||
+        (at < store->num_groups && store->groups[at].first < first + count)) {
+        log_error("Neuron model range overlaps another model");
+        return -1;
+    }
+    
+    if (store->num_groups >= store->group_capacity) {
+        uint32_t capacity = store->group_capacity > 0 ? store->group_capacity * 2 : 4;
+        NeuronModelGroup *grown = (NeuronModelGroup *)mm_realloc(store->groups,
+                                                                 capacity * sizeof(NeuronModelGroup));
+        if (!grown) {
+            log_error("Failed to grow neuron model groups");
+            return -1;
+        }
+        store->groups = grown;
+        store->group_capacity = capacity;
+    }
+    
+    NeuronModelGroup group;
+    if (neuron_model_group_init(&group, type, first, count, params) != 0) {
+        return -1;
+    }
+    neuron_model_group_rest(&group, store->potential);
+    
+    memmove(&store->groups[at + 1], &store->groups[at], (store->num_groups - at) * sizeof(NeuronModelGroup));
+    store->groups[at] = group;
+    store->num_groups++;
+    return 0;
+}
+
+// Model group running a slot, or NULL for the leaky integrator
+NeuronModelGroup *population_find_group(const PopulationStore *store, uint32_t slot) {
+    for (uint32_t g = 0; g < store->num_groups; g++) {
+        NeuronModelGroup *group = &store->groups[g];
+        if (slot < group->first) {
+            break;
+        }
+        if (slot - group->first < group->count) {
+            return group;
+        }
+    }
+    return NULL;
+}
+
+// Advance [begin, end) of a model group by one step, with the same outputs
+// as the leaky kernels
+static uint32_t update_group(PopulationStore *store, NeuronModelGroup *group, uint32_t begin, uint32_t end,
+                             float current_time, float *outputs, uint32_t *fired,
+                             const PopulationTraceDecay *decay, PopulationMoments *moments) {
+    neuron_model_step_fn step = neuron_model_select_kernel(group->type);
+    uint32_t num_fired = step(group, store->potential, store->last_fired, begin, end, store->leak_dt,
+                              current_time, outputs, fired);
+    
+    if (outputs) {
+        activation_apply_batch(store->activation, outputs, begin, end, store->accuracy);
+    }
+    if (decay) {
+        population_decay_traces(store, begin, end, decay);
+    }
+    if (moments) {
+        double sum = 0.0;
+        double sum_sq = 0.0;
+        for (uint32_t i = begin; i < end; i++) {
+            double p = store->potential[i];
+            sum += p;
+            sum_sq += p * p;
+        }
+        moments->sum += sum;
+        moments->sum_sq += sum_sq;
+    }
+    
+    return num_fired;
+}
+
+// Advance a range of leaky slots by one step. Float stores run the step kernel
+// selected for their profile, or the generic one if the profile is stale.
+// Fixed-point stores run the widest fixed-point kernel, then apply the
+// activations in batch to the leaked potentials it left in outputs.
+static uint32_t update_leaky(PopulationStore *store, uint32_t begin, uint32_t end,
+                             float current_time, float *outputs, uint32_t *fired,
+                             const PopulationTraceDecay *decay, PopulationMoments *moments) {
+    if (store->format == STATE_FLOAT) {
+        population_step_fn step = store->profile_dirty ? population_step_generic
+                                                       : store->step_kernels[decay != NULL];
+        return step(store, begin, end, current_time, outputs, fired, decay, moments);
+    }
+    
+    population_kernel_fn kernel = population_select_fixed_kernel();
+    uint32_t num_fired = kernel(store, begin, end, current_time, outputs, fired, moments);
+    
+    if (outputs) {
+        activation_apply_batch(store->activation, outputs, begin, end, store->accuracy);
+    }
+    if (decay) {
+        population_decay_traces(store, begin, end, decay);
+    }
+    
+    return num_fired;
+}
+
+// Advance a range of slots by one step, split at the boundaries of the
+// model groups
+uint32_t population_update(PopulationStore *store, uint32_t begin, uint32_t end,
+                           float current_time, float *outputs, uint32_t *fired,
+                           const PopulationTraceDecay *decay, PopulationMoments *moments) {
+    if (store->num_groups == 0) {
+        return update_leaky(store, begin, end, current_time, outputs, fired, decay, moments);
+    }
+    
+    uint32_t num_fired = 0;
+    uint32_t g = 0;
+    while (g < store->num_groups && store->groups[g].first + store->groups[g].count <= begin) {
+        g++;
+    }
+    
+    while (begin < end) {
+        NeuronModelGroup *group = g < store->num_groups ? &store->groups[g] : NULL;
+        uint32_t stop;
+        
+        if (group && group->first <= begin) {
+            stop = group->first + group->count < end ? group->first + group->count : end;
+            num_fired += update_group(store, group, begin, stop, current_time, outputs, fired + num_fired,
+                                      decay, moments);
+            g++;
+        } else {
+            stop = group && group->first < end ? group->first : end;
+            num_fired += update_leaky(store, begin, stop, current_time, outputs, fired + num_fired,
+                                      decay, moments);
+        }
+        begin = stop;
+    }
+    
+    return num_fired;
+}
+
+// Advance the model slots of a range by one step in event-driven mode
+uint32_t population_update_models(PopulationStore *store, uint32_t begin, uint32_t end,
+                                  uint64_t step, float current_time, uint32_t *fired) {
+    uint32_t num_fired = 0;
+    
+    for (uint32_t g = 0; g < store->num_groups; g++) {
+        NeuronModelGroup *group = &store->groups[g];
+        uint32_t first = group->first > begin ? group->first : begin;
+        uint32_t last = group->first + group->count < end ? group->first + group->count : end;
+        if (first >= last) {
+            continue;
+        }
+        
+        num_fired += update_group(store, group, first, last, current_time, NULL, fired + num_fired,
+                                  NULL, NULL);
+        for (uint32_t i = first; i < last; i++) {
+            store->updated_step[i] = step;
+        }
+    }
+    
+    return num_fired;
+}
+
+// Advance a list of slots by one step in event-driven mode
+uint32_t population_update_active(PopulationStore *store, const uint32_t *slots, uint32_t count,
+                                  uint64_t step, float current_time, uint32_t *fired) {
+    float *potential = store->potential;
+    const float *threshold = store->threshold;
+    const float *rest_potential = store->rest_potential;
+    const float *refractory = store->refractory;
+    float *last_fired = store->last_fired;
+    uint32_t num_fired = 0;
+    
+    if (store->format == STATE_FIXED16) {
+        for (uint32_t n = 0; n < count; n++) {
+            uint32_t i = slots[n];
+            population_catch_up(store, i, step - 1);
+            store->updated_step[i] = step;
+            if (population_fixed_step(store, i, NULL)) {
+                fired[num_fired++] = i;
+            }
+        }
+        return num_fired;
+    }
+    
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t i = slots[n];
+        
+        // Apply the leak of the skipped steps, then this step's leak
+        population_catch_up(store, i, step - 1);
+        float p = potential[i] * store->leak_decay + rest_potential[i] * store->leak_rate;
+        store->updated_step[i] = step;
+        
+        if (current_time - last_fired[i] >= refractory[i] && p >= threshold[i]) {
+            last_fired[i] = current_time;
+            p = rest_potential[i];
+            fired[num_fired++] = i;
+        }
+        
+        potential[i] = p;
+    }
+    
+    return num_fired;
+}
@@ -0,0 +1,281 @@
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include <stdint.h>
+#include <math.h>
+#include "neuron.h"
+#include "activation.h"
+#include "neuron_model.h"
+
+// Alignment of every state array (one cache line)
+#define POPULATION_ALIGNMENT 64
+
+// Fixed-point state: potentials in Q8.8 mV and the leak rate in Q0.15
+#define POPULATION_FIXED_ONE 256
+#define POPULATION_FIXED_RATE_ONE 32768
+
+// Activation index of populations whose slots use different functions
+#define POPULATION_MIXED_ACTIVATION 4
+
+// Representation of the neuron state streamed by the step
+typedef enum {
+    STATE_FLOAT,                 // 32-bit float potentials, refractory by last firing time
+    STATE_FIXED16                // 16-bit fixed-point potentials, refractory step countdown
+} StateFormat;
+
+// Per-step decay factors of the learning traces, for step kernels that
+// decay them in the same pass as the neuron update
+typedef struct {
+    float pre;                   // STDP pre trace
+    float post;                  // STDP post trace
+    float rate;                  // Firing-rate trace
+} PopulationTraceDecay;
+
+// Running sums of the membrane potential in mV over the slots a step
+// kernel updated, taken after the reset of the fired slots. Kernels add
+// to them, so one accumulator can span several calls.
+typedef struct {
+    double sum;                  // Sum of the potentials
+    double sum_sq;               // Sum of the squared potentials
+} PopulationMoments;
+
+struct PopulationStore;
+
+// Step kernel for slots [begin, end): leak by the store's cached factors,
+// refractory and threshold test, reset, activation of the leaked
+// potentials into outputs (if not NULL), decay of the learning traces (if
+// decay is not NULL), and the moments of the new potentials (if moments is
+// not NULL). Writes the fired slots in ascending order and returns their
+// number.
+typedef uint32_t (*population_step_fn)(struct PopulationStore *store, uint32_t begin, uint32_t end,
+                                       float current_time, float *outputs, uint32_t *fired,
+                                       const PopulationTraceDecay *decay, PopulationMoments *moments);
+
+// Structure-of-arrays store for the hot neuron state. Slot i of every array
+// belongs to the same neuron, so the per-step update streams each field
+// through contiguous, cache-line aligned memory instead of chasing a
+// pointer to a full Neuron struct per neuron.
+//
+// In STATE_FIXED16 format the step streams 16-bit copies of the state
+// instead, half the bytes of the float arrays. Potentials are Q8.8 mV:
+// they saturate at -128 and +127.996 mV and are rounded to the nearest
+// 1/256 mV, so input and parameters lose at most 0.002 mV. The leak is
+// (rest - p) * leak_q / 32768, rounded to nearest, with the leak rate
+// rounded to Q0.15, and rest - p saturates at 128 mV. The refractory period
+// is rounded up to whole steps and counted down per step, so a slot may
+// fire again in the first step at least the period after its last spike,
+// as in float format when the period is a multiple of the step. The float
+// threshold, rest and refractory arrays stay the source of the parameters;
+// the float potential and last firing time are only current in float
+// format.
+//
+// The float step runs a kernel specialized for the store's profile: the
+// activation all slots share (if any), whether all slots share threshold,
+// rest and refractory period, and whether trace decay is fused in. The
+// profile is recomputed and the kernels reselected by
+// population_store_select_kernels after slots or parameters change.
+//
+// The leak integrates dp/dt = (rest - p) / tau exactly between inputs:
+// each step of dt keeps leak_decay = exp(-dt / tau) of the distance to
+// rest, so results do not depend on the step size. The factors are
+// computed once per dt by population_set_dt and reused by every step.
+//
+// Slots of model groups run another neuron model instead of the leak (see
+// NeuronModelGroup): the step hands each group's range to its model's
+// batch kernel. Groups need float format, and their threshold, rest and
+// refractory period are unused.
+typedef struct PopulationStore {
+    float *potential;            // Current membrane potential in mV
+    float *threshold;            // Firing threshold in mV
+    float *rest_potential;       // Resting potential in mV
+    float *refractory;           // Refractory period in ms
+    float *last_fired;           // Time of last firing in ms
+    uint8_t *activation;         // ActivationFunction of each neuron
+    uint64_t *updated_step;      // Step the potential is current for (event-driven mode)
+    uint8_t *active_mark;        // Set while a slot is in the active set
+    float *pre_trace;            // STDP trace of the slot's spikes as a source
+    float *post_trace;           // STDP trace of the slot's spikes as a target
+    float *rate_trace;           // Slow trace of the slot's spikes for its firing rate
+    uint64_t *trace_step;        // Step the learning traces are current for (event-driven mode)
+    int16_t *potential_q;        // Membrane potential in Q8.8 mV (fixed-point format)
+    int16_t *threshold_q;        // Firing threshold in Q8.8 mV (fixed-point format)
+    int16_t *rest_q;             // Resting potential in Q8.8 mV (fixed-point format)
+    uint16_t *refractory_left;   // Steps until the slot may fire again (fixed-point format)
+    uint16_t *refractory_steps;  // Refractory period in steps of refractory_dt (fixed-point format)
+    uint32_t count;              // Number of occupied slots
+    uint32_t capacity;           // Number of allocated slots
+    ActivationAccuracy accuracy; // Accuracy of SIGMOID and TANH outputs
+    StateFormat format;          // Representation streamed by the step
+    float refractory_dt;         // Time step refractory_steps were computed for
+    float membrane_tau;          // Membrane time constant in ms
+    float leak_dt;               // Time step the leak factors were computed for
+    float leak_decay;            // Fraction of the distance to rest kept per step
+    float leak_rate;             // Fraction of the distance to rest leaked per step
+    int16_t leak_q;              // leak_rate in Q0.15 (fixed-point format)
+    int8_t shared_activation;    // ActivationFunction of every slot, or -1 if mixed
+    uint8_t shared_params;       // Set when all slots share threshold, rest and refractory period
+    uint8_t profile_dirty;       // Set when slots or parameters changed since the last selection
+    population_step_fn step_kernels[2]; // Float step kernel without and with trace decay
+    NeuronModelGroup *groups;    // Slots run by other neuron models, by first slot
+    uint32_t num_groups;         // Number of model groups
+    uint32_t group_capacity;     // Capacity of groups
+} PopulationStore;
+
+// Function declarations
+int population_store_init(PopulationStore *store, uint32_t capacity);
+void population_store_free(PopulationStore *store);
+int population_store_reserve(PopulationStore *store, uint32_t capacity);
+int population_store_add(PopulationStore *store, const Neuron *neuron);
+void population_store_remove(PopulationStore *store, uint32_t slot);
+int population_store_permute(PopulationStore *store, const uint32_t *order);
+void population_store_reset(PopulationStore *store);
+int population_store_set_format(PopulationStore *store, StateFormat format, float current_time, float dt);
+void population_store_refresh(PopulationStore *store, uint32_t slot);
+void population_quantize_refractory(PopulationStore *store, float dt);
+void population_store_select_kernels(PopulationStore *store);
+void population_set_dt(PopulationStore *store, float dt);
+int population_set_membrane_tau(PopulationStore *store, float tau);
+int population_store_add_group(PopulationStore *store, uint32_t first, uint32_t count,
+                               NeuronModelType type, const float *params);
+NeuronModelGroup *population_find_group(const PopulationStore *store, uint32_t slot);
+
+// Advance slots [begin, end) by one step: leak with the factors of the
+// last population_set_dt, threshold and refractory test, reset. Writes the
+// activation of every slot to outputs (if not NULL) and the slots that
+// fired to fired, decays the learning traces if decay is not NULL, and
+// adds the moments of the new potentials to moments if not NULL. Returns
+// the number of fired slots.
+uint32_t population_update(PopulationStore *store, uint32_t begin, uint32_t end,
+                           float current_time, float *outputs, uint32_t *fired,
+                           const PopulationTraceDecay *decay, PopulationMoments *moments);
+
+// Advance the listed slots by one step, event-driven: each slot first
+// receives the leak of the steps it skipped since it was last updated
+uint32_t population_update_active(PopulationStore *store, const uint32_t *slots, uint32_t count,
+                                  uint64_t step, float current_time, uint32_t *fired);
+
+// Advance the model slots of [begin, end) by one step in event-driven
+// mode. Models have no closed form for skipped steps, so their slots are
+// stepped every step and kept out of the active set.
+uint32_t population_update_models(PopulationStore *store, uint32_t begin, uint32_t end,
+                                  uint64_t step, float current_time, uint32_t *fired);
+
+// Saturate to the int16 range
+static inline int16_t population_saturate16(int32_t value) {
+    return (int16_t)(value < INT16_MIN ? INT16_MIN : (value > INT16_MAX ? INT16_MAX : value));
+}
+
+// Convert mV to Q8.8, rounded to nearest and saturated
+static inline int16_t population_to_fixed(float mv) {
+    float q = mv * (float)POPULATION_FIXED_ONE;
+    q = q < (float)INT16_MIN ? (float)INT16_MIN : (q > (float)INT16_MAX ? (float)INT16_MAX : q);
+    return (int16_t)lrintf(q);
+}
+
+// Convert Q8.8 to mV (exact)
+static inline float population_from_fixed(int16_t q) {
+    return (float)q * (1.0f / (float)POPULATION_FIXED_ONE);
+}
+
+// One fixed-point leak step toward rest at a Q0.15 rate. Matches
+// _mm256_mulhrs_epi16 on the saturated difference, so the vector kernel is
+// bit-identical.
+static inline int16_t population_fixed_leak(int16_t p, int16_t rest, int16_t leak_q) {
+    int32_t diff = population_saturate16((int32_t)rest - p);
+    return population_saturate16(p + ((diff * leak_q + 0x4000) >> 15));
+}
+
+// Potential of a slot in mV, in either format
+static inline float population_get_potential(const PopulationStore *store, uint32_t slot) {
+    return store->format == STATE_FIXED16 ? population_from_fixed(store->potential_q[slot])
+                                          : store->potential[slot];
+}
+
+// Set the potential of a slot in mV
+static inline void population_set_potential(PopulationStore *store, uint32_t slot, float mv) {
+    if (store->format == STATE_FIXED16) {
+        store->potential_q[slot] = population_to_fixed(mv);
+    } else {
+        store->potential[slot] = mv;
+    }
+}
+
+// Add synaptic input in mV to a slot, saturating in fixed-point format
+static inline void population_add_input(PopulationStore *store, uint32_t slot, float mv) {
+    if (store->format == STATE_FIXED16) {
+        store->potential_q[slot] = population_saturate16((int32_t)store->potential_q[slot] +
+                                                         population_to_fixed(mv));
+    } else {
+        store->potential[slot] += mv;
+    }
+}
+
+// Bring a quiescent slot up to date with the given step. Without input the
+// leak is p <- rest + (p - rest) * leak_decay per step, so k skipped steps
+// are applied at once as a factor of leak_decay^k; the skipped steps must
+// all have the current dt. In fixed-point format the integer leak of the
+// dense kernel is repeated instead, so both modes agree bit for bit; it
+// stops changing the potential once the rounded leak is zero, within about
+// 7 / leak_rate steps. The refractory countdown advances by the skipped
+// steps.
+static inline void population_catch_up(PopulationStore *store, uint32_t slot, uint64_t step) {
+    uint64_t skipped = step - store->updated_step[slot];
+    
+    if (store->updated_step[slot] >= step) {
+        return;
+    }
+    
+    if (store->format == STATE_FIXED16) {
+        int16_t rest = store->rest_q[slot];
+        int16_t p = store->potential_q[slot];
+        for (uint64_t k = 0; k < skipped; k++) {
+            int16_t next = population_fixed_leak(p, rest, store->leak_q);
+            if (next == p) break;
+            p = next;
+        }
+        store->potential_q[slot] = p;
+        uint16_t left = store->refractory_left[slot];
+        store->refractory_left[slot] = left > skipped ? (uint16_t)(left - skipped) : 0;
+    } else {
+        float rest = store->rest_potential[slot];
+        float decay = skipped == 1 ? store->leak_decay : powf(store->leak_decay, (float)skipped);
+        store->potential[slot] = rest + (store->potential[slot] - rest) * decay;
+    }
+    store->updated_step[slot] = step;
+}
+
+// Bring the learning traces of a slot up to date with the given step.
+// Traces only decay between spikes, so event-driven steps leave quiescent
+// slots alone and apply the k skipped steps at once as decay^k, like the
+// leak in population_catch_up.
+static inline void population_catch_up_traces(PopulationStore *store, uint32_t slot, uint64_t step,
+                                              const PopulationTraceDecay *decay) {
+    uint64_t skipped = step - store->trace_step[slot];
+    
+    if (store->trace_step[slot] >= step) {
+        return;
+    }
+    
+    if (skipped == 1) {
+        store->pre_trace[slot] *= decay->pre;
+        store->post_trace[slot] *= decay->post;
+        store->rate_trace[slot] *= decay->rate;
+    } else {
+        store->pre_trace[slot] *= powf(decay->pre, (float)skipped);
+        store->post_trace[slot] *= powf(decay->post, (float)skipped);
+        store->rate_trace[slot] *= powf(decay->rate, (float)skipped);
+    }
+    store->trace_step[slot] = step;
+}
+
+// Whether a slot can fire without further input, i.e. must stay active
+static inline int population_is_pending(const PopulationStore *store, uint32_t slot) {
+    if (store->format == STATE_FIXED16) {
+        return store->potential_q[slot] >= store->threshold_q[slot] ||
+               store->rest_q[slot] >= store->threshold_q[slot];
+    }
+    return store->potential[slot] >= store->threshold[slot] ||
+           store->rest_potential[slot] >= store->threshold[slot];
+}
+
+#endif // POPULATION_H
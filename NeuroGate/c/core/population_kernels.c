@@ -0,0 +1,546 @@
+#include "population_kernels.h"
+#include "activation_avx2.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define POPULATION_KERNELS_X86 1
+#endif
+
+// Scalar kernel, also used for the tails of the vector kernels
+uint32_t population_kernel_scalar(PopulationStore *store, uint32_t begin, uint32_t end,
+                                  float current_time, float *leaked, uint32_t *fired,
+                                  PopulationMoments *moments) {
+    float *potential = store->potential;
+    const float *threshold = store->threshold;
+    const float *rest_potential = store->rest_potential;
+    const float *refractory = store->refractory;
+    float *last_fired = store->last_fired;
+    float keep = store->leak_decay;
+    float leak = store->leak_rate;
+    uint32_t num_fired = 0;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    
+    for (uint32_t i = begin; i < end; i++) {
+        // Exact leak toward rest potential over one step
+        float p = potential[i] * keep + rest_potential[i] * leak;
+        
+        if (leaked) {
+            leaked[i] = p;
+        }
+        
+        // Threshold and refractory test, as in neuron_fire
+        if (current_time - last_fired[i] >= refractory[i] && p >= threshold[i]) {
+            last_fired[i] = current_time;
+            p = rest_potential[i];
+            fired[num_fired++] = i;
+        }
+        
+        potential[i] = p;
+        if (moments) {
+            sum += p;
+            sum_sq += (double)p * p;
+        }
+    }
+    
+    if (moments) {
+        moments->sum += sum;
+        moments->sum_sq += sum_sq;
+    }
+    return num_fired;
+}
+
+// Add exact sums of Q8.8 potentials and of their squares to moments in mV
+static void add_fixed_moments(PopulationMoments *moments, int64_t sum, uint64_t sum_sq) {
+    moments->sum += (double)sum / POPULATION_FIXED_ONE;
+    moments->sum_sq += (double)sum_sq / ((double)POPULATION_FIXED_ONE * POPULATION_FIXED_ONE);
+}
+
+// Scalar fixed-point kernel, also used for the tails of the vector one
+uint32_t population_kernel_fixed_scalar(PopulationStore *store, uint32_t begin, uint32_t end,
+                                        float current_time, float *leaked, uint32_t *fired,
+                                        PopulationMoments *moments) {
+    uint32_t num_fired = 0;
+    int64_t sum = 0;
+    uint64_t sum_sq = 0;
+    
+    (void)current_time;
+    for (uint32_t i = begin; i < end; i++) {
+        if (population_fixed_step(store, i, leaked ? leaked + i : NULL)) {
+            fired[num_fired++] = i;
+        }
+        if (moments) {
+            int32_t q = store->potential_q[i];
+            sum += q;
+            sum_sq += (uint64_t)(q * q);
+        }
+    }
+    
+    if (moments) {
+        add_fixed_moments(moments, sum, sum_sq);
+    }
+    return num_fired;
+}
+
+// Decay the learning traces of a range of slots
+void population_decay_traces(PopulationStore *store, uint32_t begin, uint32_t end,
+                             const PopulationTraceDecay *decay) {
+    for (uint32_t i = begin; i < end; i++) {
+        store->pre_trace[i] *= decay->pre;
+        store->post_trace[i] *= decay->post;
+        store->rate_trace[i] *= decay->rate;
+    }
+}
+
+// Step kernel for any profile, in separate passes
+uint32_t population_step_generic(PopulationStore *store, uint32_t begin, uint32_t end,
+                                 float current_time, float *outputs, uint32_t *fired,
+                                 const PopulationTraceDecay *decay, PopulationMoments *moments) {
+    population_kernel_fn kernel = population_select_kernel();
+    uint32_t num_fired = kernel(store, begin, end, current_time, outputs, fired, moments);
+    
+    if (outputs) {
+        activation_apply_batch(store->activation, outputs, begin, end, store->accuracy);
+    }
+    if (decay) {
+        population_decay_traces(store, begin, end, decay);
+    }
+    
+    return num_fired;
+}
+
+#ifdef POPULATION_KERNELS_X86
+
+// Add the potentials of 8 slots and their squares to 4 double lanes each.
+// Squares of floats are exact in double.
+__attribute__((target("avx2"), always_inline))
+static inline void moments_add_avx2(__m256 p, __m256d *sum, __m256d *sum_sq) {
+    __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(p));
+    __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(p, 1));
+    *sum = _mm256_add_pd(*sum, _mm256_add_pd(low, high));
+    *sum_sq = _mm256_add_pd(*sum_sq, _mm256_add_pd(_mm256_mul_pd(low, low), _mm256_mul_pd(high, high)));
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline void moments_store_avx2(PopulationMoments *moments, __m256d sum, __m256d sum_sq) {
+    double s[4], q[4];
+    _mm256_storeu_pd(s, sum);
+    _mm256_storeu_pd(q, sum_sq);
+    moments->sum += (s[0] + s[1]) + (s[2] + s[3]);
+    moments->sum_sq += (q[0] + q[1]) + (q[2] + q[3]);
+}
+
+// 16 slots of Q8.8 potentials: madd sums pairs of slots in 32 bits, and
+// the squares of a pair fit in 32 bits unsigned, before both are widened
+// to 4 int64 lanes by in-lane unpacks
+__attribute__((target("avx2"), always_inline))
+static inline void moments_add_fixed_avx2(__m256i p, __m256i *sum, __m256i *sum_sq) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i pairs = _mm256_madd_epi16(p, _mm256_set1_epi16(1));
+    __m256i squares = _mm256_madd_epi16(p, p);
+    __m256i sign = _mm256_srai_epi32(pairs, 31);
+    *sum = _mm256_add_epi64(*sum, _mm256_add_epi64(_mm256_unpacklo_epi32(pairs, sign),
+                                                   _mm256_unpackhi_epi32(pairs, sign)));
+    *sum_sq = _mm256_add_epi64(*sum_sq, _mm256_add_epi64(_mm256_unpacklo_epi32(squares, zero),
+                                                         _mm256_unpackhi_epi32(squares, zero)));
+}
+
+// 8 slots at a time. The fire mask selects the reset values with blends and
+// its set bits are appended to the fired list in slot order.
+__attribute__((target("avx2")))
+uint32_t population_kernel_avx2(PopulationStore *store, uint32_t begin, uint32_t end,
+                                float current_time, float *leaked, uint32_t *fired,
+                                PopulationMoments *moments) {
+    float *potential = store->potential;
+    const float *threshold = store->threshold;
+    const float *rest_potential = store->rest_potential;
+    const float *refractory = store->refractory;
+    float *last_fired = store->last_fired;
+    uint32_t num_fired = 0;
+    uint32_t i = begin;
+    
+    const __m256 keep = _mm256_set1_ps(store->leak_decay);
+    const __m256 leak = _mm256_set1_ps(store->leak_rate);
+    const __m256 now = _mm256_set1_ps(current_time);
+    __m256d sum = _mm256_setzero_pd();
+    __m256d sum_sq = _mm256_setzero_pd();
+    
+    for (; i + 8 <= end; i += 8) {
+        __m256 rest = _mm256_loadu_ps(rest_potential + i);
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(potential + i), keep),
+                                 _mm256_mul_ps(rest, leak));
+        
+        if (leaked) {
+            _mm256_storeu_ps(leaked + i, p);
+        }
+        
+        __m256 last = _mm256_loadu_ps(last_fired + i);
+        __m256 ready = _mm256_cmp_ps(_mm256_sub_ps(now, last), _mm256_loadu_ps(refractory + i), _CMP_GE_OQ);
+        __m256 above = _mm256_cmp_ps(p, _mm256_loadu_ps(threshold + i), _CMP_GE_OQ);
+        __m256 fire = _mm256_and_ps(ready, above);
+        int mask = _mm256_movemask_ps(fire);
+        
+        if (mask) {
+            p = _mm256_blendv_ps(p, rest, fire);
+            _mm256_storeu_ps(last_fired + i, _mm256_blendv_ps(last, now, fire));
+            while (mask) {
+                fired[num_fired++] = i + (uint32_t)__builtin_ctz((unsigned)mask);
+                mask &= mask - 1;
+            }
+        }
+        
+        _mm256_storeu_ps(potential + i, p);
+        if (moments) {
+            moments_add_avx2(p, &sum, &sum_sq);
+        }
+    }
+    
+    if (moments) {
+        moments_store_avx2(moments, sum, sum_sq);
+    }
+    
+    // Leave the upper register halves clean for the SSE code that follows
+    _mm256_zeroupper();
+    return num_fired + population_kernel_scalar(store, i, end, current_time, leaked, fired + num_fired, moments);
+}
+
+// 16 slots at a time. Fired slots are written with a compress store of the
+// slot indices selected by the fire mask.
+__attribute__((target("avx512f")))
+uint32_t population_kernel_avx512(PopulationStore *store, uint32_t begin, uint32_t end,
+                                  float current_time, float *leaked, uint32_t *fired,
+                                  PopulationMoments *moments) {
+    float *potential = store->potential;
+    const float *threshold = store->threshold;
+    const float *rest_potential = store->rest_potential;
+    const float *refractory = store->refractory;
+    float *last_fired = store->last_fired;
+    uint32_t num_fired = 0;
+    uint32_t i = begin;
+    
+    const __m512 keep = _mm512_set1_ps(store->leak_decay);
+    const __m512 leak = _mm512_set1_ps(store->leak_rate);
+    const __m512 now = _mm512_set1_ps(current_time);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512d sum = _mm512_setzero_pd();
+    __m512d sum_sq = _mm512_setzero_pd();
+    
+    for (; i + 16 <= end; i += 16) {
+        __m512 rest = _mm512_loadu_ps(rest_potential + i);
+        __m512 p = _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(potential + i), keep),
+                                 _mm512_mul_ps(rest, leak));
+        
+        if (leaked) {
+            _mm512_storeu_ps(leaked + i, p);
+        }
+        
+        __m512 last = _mm512_loadu_ps(last_fired + i);
+        __mmask16 ready = _mm512_cmp_ps_mask(_mm512_sub_ps(now, last), _mm512_loadu_ps(refractory + i), _CMP_GE_OQ);
+        __mmask16 fire = _mm512_mask_cmp_ps_mask(ready, p, _mm512_loadu_ps(threshold + i), _CMP_GE_OQ);
+        
+        if (fire) {
+            p = _mm512_mask_mov_ps(p, fire, rest);
+            _mm512_storeu_ps(last_fired + i, _mm512_mask_mov_ps(last, fire, now));
+            _mm512_mask_compressstoreu_epi32(fired + num_fired, fire,
+                                             _mm512_add_epi32(_mm512_set1_epi32((int)i), lanes));
+            num_fired += (uint32_t)__builtin_popcount((unsigned)fire);
+        }
+        
+        _mm512_storeu_ps(potential + i, p);
+        if (moments) {
+            __m512d low = _mm512_cvtps_pd(_mm512_castps512_ps256(p));
+            __m512d high = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(p), 1)));
+            sum = _mm512_add_pd(sum, _mm512_add_pd(low, high));
+            sum_sq = _mm512_add_pd(sum_sq, _mm512_add_pd(_mm512_mul_pd(low, low), _mm512_mul_pd(high, high)));
+        }
+    }
+    
+    if (moments) {
+        moments->sum += _mm512_reduce_add_pd(sum);
+        moments->sum_sq += _mm512_reduce_add_pd(sum_sq);
+    }
+    
+    _mm256_zeroupper();
+    return num_fired + population_kernel_scalar(store, i, end, current_time, leaked, fired + num_fired, moments);
+}
+
+// 16 slots of 16-bit state at a time, twice the slots per instruction of
+// the float kernel. mulhrs computes the rounded Q0.15 leak product and the
+// refractory countdown uses an unsigned saturating subtract.
+__attribute__((target("avx2")))
+uint32_t population_kernel_fixed_avx2(PopulationStore *store, uint32_t begin, uint32_t end,
+                                      float current_time, float *leaked, uint32_t *fired,
+                                      PopulationMoments *moments) {
+    int16_t *potential = store->potential_q;
+    const int16_t *threshold = store->threshold_q;
+    const int16_t *rest_potential = store->rest_q;
+    uint16_t *refractory_left = store->refractory_left;
+    const uint16_t *refractory_steps = store->refractory_steps;
+    uint32_t num_fired = 0;
+    uint32_t i = begin;
+    
+    const __m256i leak = _mm256_set1_epi16(store->leak_q);
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 unit = _mm256_set1_ps(1.0f / (float)POPULATION_FIXED_ONE);
+    __m256i sum = _mm256_setzero_si256();
+    __m256i sum_sq = _mm256_setzero_si256();
+    
+    for (; i + 16 <= end; i += 16) {
+        __m256i rest = _mm256_loadu_si256((const __m256i *)(rest_potential + i));
+        __m256i p = _mm256_loadu_si256((const __m256i *)(potential + i));
+        p = _mm256_adds_epi16(p, _mm256_mulhrs_epi16(_mm256_subs_epi16(rest, p), leak));
+        
+        if (leaked) {
+            __m256i low = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(p));
+            __m256i high = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(p, 1));
+            _mm256_storeu_ps(leaked + i, _mm256_mul_ps(_mm256_cvtepi32_ps(low), unit));
+            _mm256_storeu_ps(leaked + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(high), unit));
+        }
+        
+        __m256i left = _mm256_subs_epu16(_mm256_loadu_si256((const __m256i *)(refractory_left + i)), one);
+        __m256i ready = _mm256_cmpeq_epi16(left, zero);
+        __m256i below = _mm256_cmpgt_epi16(_mm256_loadu_si256((const __m256i *)(threshold + i)), p);
+        __m256i fire = _mm256_andnot_si256(below, ready);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(fire);
+        
+        if (mask) {
+            p = _mm256_blendv_epi8(p, rest, fire);
+            left = _mm256_blendv_epi8(left, _mm256_loadu_si256((const __m256i *)(refractory_steps + i)), fire);
+            
+            // Two mask bits per 16-bit lane
+            mask &= 0x55555555u;
+            while (mask) {
+                fired[num_fired++] = i + (uint32_t)__builtin_ctz(mask) / 2;
+                mask &= mask - 1;
+            }
+        }
+        
+        _mm256_storeu_si256((__m256i *)(potential + i), p);
+        _mm256_storeu_si256((__m256i *)(refractory_left + i), left);
+        if (moments) {
+            moments_add_fixed_avx2(p, &sum, &sum_sq);
+        }
+    }
+    
+    if (moments) {
+        int64_t s[4], q[4];
+        _mm256_storeu_si256((__m256i *)s, sum);
+        _mm256_storeu_si256((__m256i *)q, sum_sq);
+        add_fixed_moments(moments, s[0] + s[1] + s[2] + s[3], (uint64_t)(q[0] + q[1] + q[2] + q[3]));
+    }
+    
+    _mm256_zeroupper();
+    return num_fired + population_kernel_fixed_scalar(store, i, end, current_time, leaked, fired + num_fired, moments);
+}
+
+// Body of the specialized step kernels. It is inlined into every instance
+// below with constant activation, shared and plastic, so the branches on
+// them fold away: shared parameters stay in registers instead of being
+// loaded per slot, with the rest term of the leak computed once, the
+// activation is applied in the same pass without a per-slot switch, and
+// the trace decay rides along with the update. The moments, when
+// requested, are summed from the potentials in registers.
+__attribute__((target("avx2"), always_inline))
+static inline uint32_t step_avx2(PopulationStore *store, uint32_t begin, uint32_t end,
+                                 float current_time, float *outputs, uint32_t *fired,
+                                 const PopulationTraceDecay *decay, PopulationMoments *moments,
+                                 int activation, int shared, int plastic) {
+    float *potential = store->potential;
+    const float *threshold = store->threshold;
+    const float *rest_potential = store->rest_potential;
+    const float *refractory = store->refractory;
+    float *last_fired = store->last_fired;
+    float *pre_trace = store->pre_trace;
+    float *post_trace = store->post_trace;
+    float *rate_trace = store->rate_trace;
+    ActivationAccuracy accuracy = store->accuracy;
+    uint32_t num_fired = 0;
+    uint32_t i = begin;
+    
+    if (begin >= end) {
+        return 0;
+    }
+    
+    // Exact SIGMOID and TANH go through libm per slot after the pass
+    int sigmoidal = activation == SIGMOID || activation == TANH;
+    int fused = activation == LINEAR || activation == RELU || (sigmoidal && accuracy != ACTIVATION_EXACT);
+    const float *table = sigmoidal && accuracy == ACTIVATION_LUT ? activation_sigmoid_table() : NULL;
+    
+    const __m256 keep = _mm256_set1_ps(store->leak_decay);
+    const __m256 leak = _mm256_set1_ps(store->leak_rate);
+    const __m256 now = _mm256_set1_ps(current_time);
+    const __m256 shared_threshold = _mm256_set1_ps(threshold[begin]);
+    const __m256 shared_rest = _mm256_set1_ps(rest_potential[begin]);
+    const __m256 shared_rest_leak = _mm256_mul_ps(shared_rest, leak);
+    const __m256 shared_refractory = _mm256_set1_ps(refractory[begin]);
+    const __m256 decay_pre = _mm256_set1_ps(plastic ? decay->pre : 1.0f);
+    const __m256 decay_post = _mm256_set1_ps(plastic ? decay->post : 1.0f);
+    const __m256 decay_rate = _mm256_set1_ps(plastic ? decay->rate : 1.0f);
+    __m256d sum = _mm256_setzero_pd();
+    __m256d sum_sq = _mm256_setzero_pd();
+    
+    for (; i + 8 <= end; i += 8) {
+        __m256 rest = shared ? shared_rest : _mm256_loadu_ps(rest_potential + i);
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(potential + i), keep),
+                                 shared ? shared_rest_leak : _mm256_mul_ps(rest, leak));
+        
+        if (outputs) {
+            _mm256_storeu_ps(outputs + i, fused ? activation_avx2(p, activation, accuracy, table) : p);
+        }
+        
+        __m256 period = shared ? shared_refractory : _mm256_loadu_ps(refractory + i);
+        __m256 limit = shared ? shared_threshold : _mm256_loadu_ps(threshold + i);
+        __m256 last = _mm256_loadu_ps(last_fired + i);
+        __m256 ready = _mm256_cmp_ps(_mm256_sub_ps(now, last), period, _CMP_GE_OQ);
+        __m256 fire = _mm256_and_ps(ready, _mm256_cmp_ps(p, limit, _CMP_GE_OQ));
+        int mask = _mm256_movemask_ps(fire);
+        
+        if (mask) {
+            p = _mm256_blendv_ps(p, rest, fire);
+            _mm256_storeu_ps(last_fired + i, _mm256_blendv_ps(last, now, fire));
+            while (mask) {
+                fired[num_fired++] = i + (uint32_t)__builtin_ctz((unsigned)mask);
+                mask &= mask - 1;
+            }
+        }
+        
+        _mm256_storeu_ps(potential + i, p);
+        if (moments) {
+            moments_add_avx2(p, &sum, &sum_sq);
+        }
+        
+        if (plastic) {
+            _mm256_storeu_ps(pre_trace + i, _mm256_mul_ps(_mm256_loadu_ps(pre_trace + i), decay_pre));
+            _mm256_storeu_ps(post_trace + i, _mm256_mul_ps(_mm256_loadu_ps(post_trace + i), decay_post));
+            _mm256_storeu_ps(rate_trace + i, _mm256_mul_ps(_mm256_loadu_ps(rate_trace + i), decay_rate));
+        }
+    }
+    
+    if (moments) {
+        moments_store_avx2(moments, sum, sum_sq);
+    }
+    _mm256_zeroupper();
+    
+    // Tail slots, and the activations that could not be fused
+    num_fired += population_kernel_scalar(store, i, end, current_time, outputs, fired + num_fired, moments);
+    if (outputs) {
+        activation_apply_batch(store->activation, outputs, fused ? i : begin, end, accuracy);
+    }
+    if (plastic) {
+        population_decay_traces(store, i, end, decay);
+    }
+    
+    return num_fired;
+}
+
+// One instance of the step body
+#define POPULATION_STEP_KERNEL(NAME, ACTIVATION, SHARED, PLASTIC)                                    \
+    __attribute__((target("avx2")))                                                                \
+    static uint32_t NAME(PopulationStore *store, uint32_t begin, uint32_t end, float current_time, \
+                         float *outputs, uint32_t *fired, const PopulationTraceDecay *decay,      \
+                         PopulationMoments *moments) {                                            \
+        return step_avx2(store, begin, end, current_time, outputs, fired, decay, moments,         \
+                         ACTIVATION, SHARED, PLASTIC);                                            \
+    }
+
+// The per-slot/shared and static/plastic instances of one activation
+#define POPULATION_STEP_VARIANTS(NAME, ACTIVATION)                              \
+    POPULATION_STEP_KERNEL(step_##NAME##_slot, ACTIVATION, 0, 0)                \
+    POPULATION_STEP_KERNEL(step_##NAME##_slot_plastic, ACTIVATION, 0, 1)        \
+    POPULATION_STEP_KERNEL(step_##NAME##_shared, ACTIVATION, 1, 0)              \
+    POPULATION_STEP_KERNEL(step_##NAME##_shared_plastic, ACTIVATION, 1, 1)
+
+#define POPULATION_STEP_ROW(NAME)                                \
+    { { step_##NAME##_slot, step_##NAME##_slot_plastic },        \
+      { step_##NAME##_shared, step_##NAME##_shared_plastic } }
+
+POPULATION_STEP_VARIANTS(linear, LINEAR)
+POPULATION_STEP_VARIANTS(sigmoid, SIGMOID)
+POPULATION_STEP_VARIANTS(relu, RELU)
+POPULATION_STEP_VARIANTS(tanh, TANH)
+POPULATION_STEP_VARIANTS(mixed, POPULATION_MIXED_ACTIVATION)
+
+// Indexed by activation (POPULATION_MIXED_ACTIVATION if mixed), shared
+// parameters and fused trace decay
+static const population_step_fn g_step_kernels[POPULATION_MIXED_ACTIVATION + 1][2][2] = {
+    POPULATION_STEP_ROW(linear),
+    POPULATION_STEP_ROW(sigmoid),
+    POPULATION_STEP_ROW(relu),
+    POPULATION_STEP_ROW(tanh),
+    POPULATION_STEP_ROW(mixed)
+};
+
+// Specialized step kernel for a profile. On AVX-512 CPUs the generic
+// kernel is twice as wide, so it is kept when there is nothing to fold.
+population_step_fn population_select_step_kernel(int shared_activation, int shared_params, int plastic) {
+    int activation = shared_activation >= 0 && shared_activation < POPULATION_MIXED_ACTIVATION
+                   ? shared_activation : POPULATION_MIXED_ACTIVATION;
+    
+    if (!__builtin_cpu_supports("avx2")) {
+        return population_step_generic;
+    }
+    if (activation == POPULATION_MIXED_ACTIVATION && !shared_params && !plastic &&
+        __builtin_cpu_supports("avx512f")) {
+        return population_step_generic;
+    }
+    
+    return g_step_kernels[activation][shared_params != 0][plastic != 0];
+}
+
+// Widest kernel supported by the running CPU
+population_kernel_fn population_select_kernel(void) {
+    if (__builtin_cpu_supports("avx512f")) {
+        return population_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return population_kernel_avx2;
+    }
+    return population_kernel_scalar;
+}
+
+// Widest fixed-point kernel supported by the running CPU
+population_kernel_fn population_select_fixed_kernel(void) {
+    if (__builtin_cpu_supports("avx2")) {
+        return population_kernel_fixed_avx2;
+    }
+    return population_kernel_fixed_scalar;
+}
+
+#else
+
+// Without x86 vector units the wide kernels fall back to the scalar one
+uint32_t population_kernel_avx2(PopulationStore *store, uint32_t begin, uint32_t end,
+                                float current_time, float *leaked, uint32_t *fired,
+                                PopulationMoments *moments) {
+    return population_kernel_scalar(store, begin, end, current_time, leaked, fired, moments);
+}
+
+uint32_t population_kernel_avx512(PopulationStore *store, uint32_t begin, uint32_t end,
+                                  float current_time, float *leaked, uint32_t *fired,
+                                  PopulationMoments *moments) {
+    return population_kernel_scalar(store, begin, end, current_time, leaked, fired, moments);
+}
+
+uint32_t population_kernel_fixed_avx2(PopulationStore *store, uint32_t begin, uint32_t end,
+                                      float current_time, float *leaked, uint32_t *fired,
+                                      PopulationMoments *moments) {
+    return population_kernel_fixed_scalar(store, begin, end, current_time, leaked, fired, moments);
+}
+
+population_kernel_fn population_select_kernel(void) {
+    return population_kernel_scalar;
+}
+
+population_kernel_fn population_select_fixed_kernel(void) {
+    return population_kernel_fixed_scalar;
+}
+
+population_step_fn population_select_step_kernel(int shared_activation, int shared_params, int plastic) {
+    (void)shared_activation;
+    (void)shared_params;
+    (void)plastic;
+    return population_step_generic;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef POPULATION_KERNELS_H
+#define POPULATION_KERNELS_H
+
+#include <stdint.h>
+#include "population.h"
+
+// Batch update kernel for slots [begin, end): leak by the store's cached
+// factors, refractory and threshold test, reset of the fired slots. Writes
+// the leaked potential of every slot to leaked[i] (if not NULL) and the
+// fired slots, in ascending order, to fired, and adds the moments of the
+// new potentials to moments (if not NULL). Returns the number of fired
+// slots.
+//
+// All variants produce bit-identical results: they evaluate the same
+// single-precision operations in the same order, and the library is built
+// with -ffp-contract=off so that no variant fuses the leak into an FMA.
+// The fixed-point kernels advance the 16-bit state of STATE_FIXED16 stores
+// instead and ignore current_time; they are bit-identical to each other.
+// Only the moments differ between float variants, in the rounding of
+// their double-precision sums; fixed-point moments are summed exactly.
+typedef uint32_t (*population_kernel_fn)(PopulationStore *store, uint32_t begin, uint32_t end,
+                                         float current_time, float *leaked, uint32_t *fired,
+                                         PopulationMoments *moments);
+
+// One fixed-point step of a slot: refractory countdown, leak, threshold
+// test and reset. Writes the leaked potential in mV to leaked (if not
+// NULL) and returns whether the slot fired.
+static inline int population_fixed_step(PopulationStore *store, uint32_t i, float *leaked) {
+    int16_t rest = store->rest_q[i];
+    int16_t p = population_fixed_leak(store->potential_q[i], rest, store->leak_q);
+    uint16_t left = store->refractory_left[i];
+    int fire;
+    
+    left = left > 0 ? (uint16_t)(left - 1) : 0;
+    if (leaked) {
+        *leaked = population_from_fixed(p);
+    }
+    
+    fire = left == 0 && p >= store->threshold_q[i];
+    if (fire) {
+        p = rest;
+        left = store->refractory_steps[i];
+    }
+    
+    store->potential_q[i] = p;
+    store->refractory_left[i] = left;
+    return fire;
+}
+
+// Function declarations
+uint32_t population_kernel_scalar(PopulationStore *store, uint32_t begin, uint32_t end,
+                                  float current_time, float *leaked, uint32_t *fired,
+                                  PopulationMoments *moments);
+uint32_t population_kernel_avx2(PopulationStore *store, uint32_t begin, uint32_t end,
+                                float current_time, float *leaked, uint32_t *fired,
+                                PopulationMoments *moments);
+uint32_t population_kernel_avx512(PopulationStore *store, uint32_t begin, uint32_t end,
+                                  float current_time, float *leaked, uint32_t *fired,
+                                  PopulationMoments *moments);
+uint32_t population_kernel_fixed_scalar(PopulationStore *store, uint32_t begin, uint32_t end,
+                                        float current_time, float *leaked, uint32_t *fired,
+                                        PopulationMoments *moments);
+uint32_t population_kernel_fixed_avx2(PopulationStore *store, uint32_t begin, uint32_t end,
+                                      float current_time, float *leaked, uint32_t *fired,
+                                      PopulationMoments *moments);
+
+// Widest kernel supported by the running CPU
+population_kernel_fn population_select_kernel(void);
+
+// Widest fixed-point kernel supported by the running CPU
+population_kernel_fn population_select_fixed_kernel(void);
+
+// Decay the learning traces of slots [begin, end) by one step
+void population_decay_traces(PopulationStore *store, uint32_t begin, uint32_t end,
+                             const PopulationTraceDecay *decay);
+
+// Step kernel for any profile: the widest batch kernel, then batch
+// activation and trace decay as separate passes
+uint32_t population_step_generic(PopulationStore *store, uint32_t begin, uint32_t end,
+                                 float current_time, float *outputs, uint32_t *fired,
+                                 const PopulationTraceDecay *decay, PopulationMoments *moments);
+
+// Step kernel specialized for a profile: the activation shared by all
+// slots (-1 if mixed), whether they share their parameters, and whether
+// trace decay is fused in. Results are bit-identical to the generic one.
+population_step_fn population_select_step_kernel(int shared_activation, int shared_params, int plastic);
+
+#endif // POPULATION_KERNELS_H
\ No newline at end of file
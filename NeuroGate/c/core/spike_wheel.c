@@ -0,0 +1,187 @@
+#include "spike_wheel.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Initial number of events per bucket
+#define SPIKE_BUCKET_INITIAL 64
+
+// Smallest power of two that holds delays of up to max_delay steps
+static uint32_t wheel_size_for(uint32_t max_delay) {
+    uint32_t size = 2;
+    while (size <= max_delay) {
+        size <<= 1;
+    }
+    return size;
+}
+
+// Initialize a wheel for delays of up to max_delay steps
+int spike_wheel_init(SpikeWheel *wheel, uint32_t max_delay, uint32_t producers, uint32_t partitions) {
+    if (!wheel || producers == 0 || partitions == 0) {
+        log_error("Invalid parameters for spike_wheel_init");
+        return -1;
+    }
+    
+    wheel->size = wheel_size_for(max_delay);
+    wheel->producers = producers;
+    wheel->partitions = partitions;
+    wheel->lanes = producers * partitions;
+    
+    size_t count = (size_t)wheel->size * wheel->lanes;
+    wheel->buckets = (SpikeBucket *)mm_alloc(count * sizeof(SpikeBucket));
+    if (!wheel->buckets) {
+        log_error("Failed to allocate spike wheel");
+        wheel->size = 0;
+        return -1;
+    }
+    
+    memset(wheel->buckets, 0, count * sizeof(SpikeBucket));
+    return 0;
+}
+
+// Free the wheel and all pending events
+void spike_wheel_free(SpikeWheel *wheel) {
+    if (!wheel || !wheel->buckets) return;
+    
+    for (size_t b = 0; b < (size_t)wheel->size * wheel->lanes; b++) {
+        mm_free(wheel->buckets[b].events);
+    }
+    mm_free(wheel->buckets);
+    
+    wheel->buckets = NULL;
+    wheel->size = 0;
+}
+
+// Drop all pending events
+void spike_wheel_clear(SpikeWheel *wheel) {
+    if (!wheel) return;
+    
+    for (size_t b = 0; b < (size_t)wheel->size * wheel->lanes; b++) {
+        wheel->buckets[b].count = 0;
+    }
+}
+
+// Double the capacity of a full bucket
+int spike_wheel_grow_bucket(SpikeBucket *bucket) {
+    uint32_t capacity = bucket->capacity > 0 ? bucket->capacity * 2 : SPIKE_BUCKET_INITIAL;
+    SpikeEvent *events = (SpikeEvent *)mm_realloc(bucket->events, capacity * sizeof(SpikeEvent));
+    if (!events) {
+        log_error("Failed to grow spike bucket to %u events", capacity);
+        return -1;
+    }
+    
+    bucket->events = events;
+    bucket->capacity = capacity;
+    return 0;
+}
+
+// Make the wheel large enough for delays of up to max_delay steps. Pending
+// events keep their due step: the bucket at distance k from the current
+// step moves to the bucket at distance k in the larger wheel.
+int spike_wheel_reserve(SpikeWheel *wheel, uint32_t max_delay, uint64_t current_step) {
+    if (!wheel) {
+        return -1;
+    }
+    
+    if (max_delay < wheel->size) {
+        return 0;
+    }
+    
+    uint32_t size = wheel_size_for(max_delay);
+    uint32_t lanes = wheel->lanes;
+    SpikeBucket *buckets = (SpikeBucket *)mm_alloc((size_t)size * lanes * sizeof(SpikeBucket));
+    if (!buckets) {
+        log_error("Failed to grow spike wheel to %u steps", size);
+        return -1;
+    }
+    memset(buckets, 0, (size_t)size * lanes * sizeof(SpikeBucket));
+    
+    for (uint32_t k = 0; k < wheel->size; k++) {
+        uint64_t due = current_step + k;
+        memcpy(&buckets[(due & (size - 1)) * lanes],
+               &wheel->buckets[(due & (wheel->size - 1)) * lanes],
+               lanes * sizeof(SpikeBucket));
+    }
+    
+    mm_free(wheel->buckets);
+    wheel->buckets = buckets;
+    wheel->size = size;
+    
+    log_debug("Spike wheel resized to %u steps", size);
+    return 0;
+}
+
+// Drop events for a removed slot and renumber the slots after it
+void spike_wheel_remove_target(SpikeWheel *wheel, uint32_t slot) {
+    if (!wheel) return;
+    
+    for (size_t b = 0; b < (size_t)wheel->size * wheel->lanes; b++) {
+        SpikeBucket *bucket = &wheel->buckets[b];
+        uint32_t kept = 0;
+        
+        for (uint32_t i = 0; i < bucket->count; i++) {
+            SpikeEvent event = bucket->events[i];
+            if (event.target == slot) continue;
+            if (event.target > slot) event.target--;
+            bucket->events[kept++] = event;
+        }
+        bucket->count = kept;
+    }
+}
+
+
+// Point every pending event at the new slot of its target, slot_map[old].
+// The lanes are refiled by spike_wheel_repartition afterwards.
+void spike_wheel_remap_targets(SpikeWheel *wheel, const uint32_t *slot_map) {
+    if (!wheel || !slot_map) return;
+    
+    for (size_t b = 0; b < (size_t)wheel->size * wheel->lanes; b++) {
+        SpikeBucket *bucket = &wheel->buckets[b];
+        for (uint32_t i = 0; i < bucket->count; i++) {
+            bucket->events[i].target = slot_map[bucket->events[i].target];
+        }
+    }
+}
+
+// Move every pending event to the lane of the partition that now owns its
+// target, after the partition layout changed. Events keep their due step
+// and are filed under producer 0.
+int spike_wheel_repartition(SpikeWheel *wheel, uint32_t partition_size) {
+    if (!wheel || partition_size == 0) {
+        return -1;
+    }
+    
+    SpikeBucket pending = { NULL, 0, 0 };
+    int status = 0;
+    
+    for (uint32_t step = 0; step < wheel->size && status == 0; step++) {
+        SpikeBucket *row = &wheel->buckets[(size_t)step * wheel->lanes];
+        
+        // Collect the events of all lanes of this step
+        pending.count = 0;
+        for (uint32_t lane = 0; lane < wheel->lanes && status == 0; lane++) {
+            for (uint32_t i = 0; i < row[lane].count; i++) {
+                if (pending.count == pending.capacity && spike_wheel_grow_bucket(&pending) != 0) {
+                    status = -1;
+                    break;
+                }
+                pending.events[pending.count++] = row[lane].events[i];
+            }
+            row[lane].count = 0;
+        }
+        
+        // File them again by owning partition
+        for (uint32_t i = 0; i < pending.count && status == 0; i++) {
+            uint32_t partition = pending.events[i].target / partition_size;
+            if (partition >= wheel->partitions) {
+                partition = wheel->partitions - 1;
+            }
+            status = spike_wheel_push(wheel, step, 0, partition,
+                                      pending.events[i].target, pending.events[i].weight);
+        }
+    }
+    
+    mm_free(pending.events);
+    return status;
+}
\ No newline at end of file
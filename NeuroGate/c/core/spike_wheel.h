@@ -0,0 +1,68 @@
+#ifndef SPIKE_WHEEL_H
+#define SPIKE_WHEEL_H
+
+#include <stdint.h>
+
+// Synaptic input waiting for delivery
+typedef struct {
+    uint32_t target;             // Postsynaptic slot
+    float weight;                // Charge delivered to the target
+} SpikeEvent;
+
+// Events due in one step
+typedef struct {
+    SpikeEvent *events;
+    uint32_t count;
+    uint32_t capacity;
+} SpikeBucket;
+
+// Time wheel of pending synaptic input indexed by integer step. A spike
+// fired in step s over a synapse with a delay of d steps is deposited in
+// the bucket of step s + d, and every step drains exactly one bucket, so
+// enqueue and dequeue are O(1) and deliveries are applied in batches.
+//
+// Each step has one bucket per (producer, partition) lane: a worker only
+// appends to its own producer lanes, split by the partition that owns the
+// target, and only drains the lanes of its own partition. Workers
+// therefore never share a bucket and need no atomics.
+typedef struct {
+    SpikeBucket *buckets;        // size * lanes buckets, step-major
+    uint32_t size;               // Number of steps in the wheel (power of two)
+    uint32_t producers;          // Workers that deposit events
+    uint32_t partitions;         // Target partitions
+    uint32_t lanes;              // producers * partitions
+} SpikeWheel;
+
+// Function declarations
+int spike_wheel_init(SpikeWheel *wheel, uint32_t max_delay, uint32_t producers, uint32_t partitions);
+void spike_wheel_free(SpikeWheel *wheel);
+void spike_wheel_clear(SpikeWheel *wheel);
+int spike_wheel_reserve(SpikeWheel *wheel, uint32_t max_delay, uint64_t current_step);
+int spike_wheel_grow_bucket(SpikeBucket *bucket);
+void spike_wheel_remove_target(SpikeWheel *wheel, uint32_t slot);
+void spike_wheel_remap_targets(SpikeWheel *wheel, const uint32_t *slot_map);
+int spike_wheel_repartition(SpikeWheel *wheel, uint32_t partition_size);
+
+// Bucket of one producer for one target partition in a step
+static inline SpikeBucket *spike_wheel_bucket(SpikeWheel *wheel, uint64_t step,
+                                              uint32_t producer, uint32_t partition) {
+    uint64_t row = (step & (wheel->size - 1)) * wheel->lanes;
+    return &wheel->buckets[row + producer * wheel->partitions + partition];
+}
+
+// Deposit an event due in the given step
+static inline int spike_wheel_push(SpikeWheel *wheel, uint64_t due_step, uint32_t producer,
+                                   uint32_t partition, uint32_t target, float weight) {
+    SpikeBucket *bucket = spike_wheel_bucket(wheel, due_step, producer, partition);
+    
+    if (bucket->count == bucket->capacity && spike_wheel_grow_bucket(bucket) != 0) {
+        return -1;
+    }
+    
+    bucket->events[bucket->count].target = target;
+    bucket->events[bucket->count].weight = weight;
+    bucket->count++;
+    return 0;
+}
+
+#endif // SPIKE_WHEEL_H
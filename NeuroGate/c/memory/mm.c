@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
 
 // Memory block header structure
 typedef struct memory_block {
@@ -24,6 +26,9 @@ static size_t g_total_memory = 0;
 static size_t g_block_count = 0;
 static int g_initialized = 0;
 
+// Guards the block list and statistics; simulation workers allocate too
+static pthread_mutex_t g_mm_lock = PTHREAD_MUTEX_INITIALIZER;
+
 // Initialize memory management system
 int mm_init(void) {
     if (g_initialized) {
@@ -94,6 +99,7 @@ void *mm_alloc(size_t size) {
     block->magic = MEMORY_MAGIC;
     
     // Add block to linked list
+    pthread_mutex_lock(&g_mm_lock);
     block->next = g_memory_blocks;
     block->prev = NULL;
     
@@ -106,6 +112,7 @@ void *mm_alloc(size_t size) {
     // Update statistics
     g_total_memory += size;
     g_block_count++;
+    pthread_mutex_unlock(&g_mm_lock);
     
     log_debug("Allocated %zu bytes at %p", size, block->data);
     
@@ -135,14 +142,19 @@ void *mm_realloc(void *ptr, size_t new_size) {
         return NULL;
     }
     
+    // The block may move, so its neighbours are relinked under the lock
+    pthread_mutex_lock(&g_mm_lock);
+    
     // Update statistics
-    g_total_memory -= block->size;
+    size_t old_size = block->size;
+    g_total_memory -= old_size;
     
     // Allocate new block
     memory_block_t *new_block = (memory_block_t *)realloc(block, sizeof(memory_block_t) + new_size);
     if (!new_block) {
         // Reallocation failed, restore original statistics
-        g_total_memory += block->size;
+        g_total_memory += old_size;
+        pthread_mutex_unlock(&g_mm_lock);
         log_error("Memory reallocation failed for %zu bytes", new_size);
         return NULL;
     }
@@ -165,9 +177,10 @@ void *mm_realloc(void *ptr, size_t new_size) {
     
     // Update statistics
     g_total_memory += new_size;
+    pthread_mutex_unlock(&g_mm_lock);
     
     log_debug("Reallocated from %zu to %zu bytes at %p", 
-              block->size, new_size, new_block->data);
+              old_size, new_size, new_block->data);
     
     return new_block->data;
 }
@@ -188,6 +201,7 @@ void mm_free(void *ptr) {
     }
     
     // Remove block from linked list
+    pthread_mutex_lock(&g_mm_lock);
     if (block->prev != NULL) {
         block->prev->next = block->next;
     } else {
@@ -201,6 +215,7 @@ void mm_free(void *ptr) {
     // Update statistics
     g_total_memory -= block->size;
     g_block_count--;
+    pthread_mutex_unlock(&g_mm_lock);
     
     log_debug("Freed %zu bytes at %p", block->size, ptr);
     
@@ -211,6 +226,35 @@ void mm_free(void *ptr) {
     free(block);
 }
 
+// Allocate aligned memory
+void *mm_alloc_aligned(size_t size, size_t alignment) {
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+        log_error("Invalid alignment %zu", alignment);
+        return NULL;
+    }
+    
+    // Over-allocate so an aligned address can be carved out, and keep the
+    // original pointer in the word just before it
+    void *raw = mm_alloc(size + alignment - 1 + sizeof(void *));
+    if (!raw) {
+        return NULL;
+    }
+    
+    uintptr_t addr = ((uintptr_t)raw + sizeof(void *) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    ((void **)addr)[-1] = raw;
+    
+    return (void *)addr;
+}
+
+// Free aligned memory
+void mm_free_aligned(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    
+    mm_free(((void **)ptr)[-1]);
+}
+
 // Get current memory usage
 size_t mm_get_used_memory(void) {
     return g_total_memory;
@@ -18,6 +18,12 @@ void *mm_realloc(void *ptr, size_t new_size);
 // Free memory
 void mm_free(void *ptr);
 
+// Allocate memory aligned to a power-of-two boundary (e.g. a cache line)
+void *mm_alloc_aligned(size_t size, size_t alignment);
+
+// Free memory returned by mm_alloc_aligned
+void mm_free_aligned(void *ptr);
+
 // Get current memory usage statistics
 size_t mm_get_used_memory(void);
 size_t mm_get_allocated_blocks(void);
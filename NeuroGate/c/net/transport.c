@@ -1,11 +1,13 @@
 #include "transport.h"
 #include "../utils/log.h"
 #include "../memory/mm.h"
+#include "../utils/rng.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
 
 // Protocol constants
 #define TRANSPORT_MAGIC 0x4E474154  // "NGAT" in ASCII
@@ -23,8 +25,38 @@
 #define FLAG_URGENT 0x0010
 #define FLAG_RELIABLE 0x0020
 
+// Key of the initial sequence numbers and the number of connections
+// opened under it. Connection n takes a word of the Philox block of
+// counter n, so concurrent connects need no lock and a fixed seed repeats.
+static uint64_t g_seq_seed;
+static uint64_t g_seq_count;
+static int g_seq_seeded;
+
+// Draw the initial sequence number of a new connection
+static uint32_t next_sequence_number(void) {
+    uint64_t n = __atomic_fetch_add(&g_seq_count, 1, __ATOMIC_RELAXED);
+    uint64_t seed = __atomic_load_n(&g_seq_seed, __ATOMIC_RELAXED);
+    return rng_philox((uint32_t)n, (uint32_t)(n >> 32), 0, 0, seed).v[0];
+}
+
+// Key the initial sequence numbers
+void transport_set_seed(uint64_t seed) {
+    __atomic_store_n(&g_seq_seed, seed, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_seq_count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_seq_seeded, 1, __ATOMIC_RELAXED);
+}
+
 // Initialize transport layer
 int transport_init(void) {
+    // Without a seed set, sequence numbers differ between processes
+    if (!__atomic_load_n(&g_seq_seeded, __ATOMIC_RELAXED)) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        uint64_t seed = ((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec) ^
+                        ((uint64_t)getpid() << 32);
+        __atomic_store_n(&g_seq_seed, seed, __ATOMIC_RELAXED);
+    }
+    
     log_info("Transport layer initialized");
     return 1;
 }
@@ -51,7 +83,7 @@ transport_connection_t *transport_connect(const char *address, uint16_t port) {
     // Initialize connection
     memset(conn, 0, sizeof(transport_connection_t));
     conn->remote_port = port;
-    conn->seq_num = (uint32_t)rand();  // Random initial sequence number
+    conn->seq_num = next_sequence_number();
     conn->ack_num = 0;
     conn->mtu = TRANSPORT_DEFAULT_MTU;
     
@@ -79,7 +111,7 @@ transport_connection_t *transport_accept(int listen_socket) {
     
     // Initialize connection
     memset(conn, 0, sizeof(transport_connection_t));
-    conn->seq_num = (uint32_t)rand();  // Random initial sequence number
+    conn->seq_num = next_sequence_number();
     conn->ack_num = 0;
     conn->mtu = TRANSPORT_DEFAULT_MTU;
     
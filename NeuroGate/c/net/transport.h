@@ -48,6 +48,11 @@ int transport_init(void);
 // Clean up transport layer
 void transport_cleanup(void);
 
+// Key the initial sequence numbers, so that the n-th connection opened
+// after this call always draws the same number. Otherwise transport_init
+// keys them from the clock and process ID.
+void transport_set_seed(uint64_t seed);
+
 // Create a new connection
 transport_connection_t *transport_connect(const char *address, uint16_t port);
 
@@ -6,125 +6,48 @@
 #include <stdlib.h>
 #include <string.h>
 
-// Global state
-static int g_initialized = 0;
-static int g_running = 0;
-
-// Simulation state
-static Neuron **g_neurons = NULL;
-static int g_neuron_count = 0;
-static int g_neuron_capacity = 0;
-static Synapse **g_synapses = NULL;
-static int g_synapse_count = 0;
-static int g_synapse_capacity = 0;
-static float g_simulation_time = 0.0f;
-
-// Initialize command executor
-int exec_init(void) {
-    if (g_initialized) {
-        log_warn("Command executor already initialized");
-        return 0;
-    }
-    
-    // Initialize memory and logging subsystems
-    log_init(NULL, LOG_DEBUG);
-    mm_init();
-    
-    // Allocate neuron and synapse arrays
-    g_neuron_capacity = 100;
-    g_neurons = (Neuron **)mm_alloc(g_neuron_capacity * sizeof(Neuron *));
-    if (!g_neurons) {
-        log_error("Failed to allocate neuron array");
-        return -1;
+// Create a command executor session
+sim_context_t *exec_init(uint32_t num_threads) {
+    sim_context_t *ctx = sim_context_create(num_threads);
+    if (!ctx) {
+        return NULL;
     }
     
-    g_synapse_capacity = 500;
-    g_synapses = (Synapse **)mm_alloc(g_synapse_capacity * sizeof(Synapse *));
-    if (!g_synapses) {
-        mm_free(g_neurons);
-        g_neurons = NULL;
-        log_error("Failed to allocate synapse array");
-        return -1;
-    }
-    
-    g_neuron_count = 0;
-    g_synapse_count = 0;
-    g_simulation_time = 0.0f;
-    
-    g_initialized = 1;
-    g_running = 1;
-    
     log_info("Command executor initialized");
-    return 0;
+    return ctx;
 }
 
-// Clean up command executor
-void exec_cleanup(void) {
-    if (!g_initialized) return;
-    
-    // Free neurons and synapses
-    for (int i = 0; i < g_neuron_count; i++) {
-        if (g_neurons[i]) {
-            neuron_destroy(g_neurons[i]);
-        }
-    }
-    
-    for (int i = 0; i < g_synapse_count; i++) {
-        if (g_synapses[i]) {
-            synapse_destroy(g_synapses[i]);
-        }
-    }
-    
-    mm_free(g_neurons);
-    mm_free(g_synapses);
-    
-    g_neurons = NULL;
-    g_synapses = NULL;
-    g_neuron_count = 0;
-    g_neuron_capacity = 0;
-    g_synapse_count = 0;
-    g_synapse_capacity = 0;
-    
-    mm_cleanup();
-    log_cleanup();
-    
-    g_initialized = 0;
-    g_running = 0;
+// Clean up a command executor session
+void exec_cleanup(sim_context_t *ctx) {
+    if (!ctx) return;
     
+    // Free neurons, synapses and population state
     log_info("Command executor cleaned up");
+    sim_context_destroy(ctx);
 }
 
 // Find neuron by ID
-static Neuron *find_neuron(uint32_t id) {
-    for (int i = 0; i < g_neuron_count; i++) {
-        if (g_neurons[i] && g_neurons[i]->id == id) {
-            return g_neurons[i];
-        }
-    }
-    return NULL;
+static Neuron *find_neuron(sim_context_t *ctx, uint32_t id) {
+    int slot = sim_find_neuron(ctx, id);
+    return slot >= 0 ? ctx->neurons[slot] : NULL;
 }
 
 // Find synapse by ID
-static Synapse *find_synapse(uint32_t id) {
-    for (int i = 0; i < g_synapse_count; i++) {
-        if (g_synapses[i] && g_synapses[i]->id == id) {
-            return g_synapses[i];
-        }
-    }
-    return NULL;
+static Synapse *find_synapse(sim_context_t *ctx, uint32_t id) {
+    return sim_find_synapse(ctx, id);
 }
 
 // Execute a command
-command_result_t exec_command(command_type_t type, const command_params_t *params) {
+command_result_t exec_command(sim_context_t *ctx, command_type_t type, const command_params_t *params) {
     command_result_t result = {0};
     
-    if (!g_initialized) {
+    if (!ctx) {
         log_error("Command executor not initialized");
         result.status = -1;
         return result;
     }
     
-    if (!g_running) {
+    if (!ctx->running) {
         log_error("Command executor not running");
         result.status = -1;
         return result;
@@ -135,7 +58,7 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             // No operation
             result.status = 0;
             break;
-            
+        
         case CMD_CREATE_NEURON: {
             // Create a new neuron
             if (!params) {
@@ -145,7 +68,7 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             }
             
             // Check if neuron with this ID already exists
-            if (find_neuron(params->neuron_id)) {
+            if (sim_find_neuron(ctx, params->neuron_id) >= 0) {
                 log_error("Neuron with ID %u already exists", params->neuron_id);
                 result.status = -1;
                 break;
@@ -177,29 +100,20 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
                 neuron->refractory_period = params->refractory_period;
             }
             
-            // Add to array
-            if (g_neuron_count >= g_neuron_capacity) {
-                // Expand array
-                int new_capacity = g_neuron_capacity * 2;
-                Neuron **new_array = (Neuron **)mm_realloc(g_neurons, new_capacity * sizeof(Neuron *));
-                if (!new_array) {
-                    neuron_destroy(neuron);
-                    log_error("Failed to expand neuron array");
-                    result.status = -1;
-                    break;
-                }
-                g_neurons = new_array;
-                g_neuron_capacity = new_capacity;
+            // Add to simulation
+            if (sim_add_neuron(ctx, neuron) < 0) {
+                neuron_destroy(neuron);
+                log_error("Failed to add neuron %u", params->neuron_id);
+                result.status = -1;
+                break;
             }
             
-            g_neurons[g_neuron_count++] = neuron;
-            
             log_info("Created neuron with ID %u", params->neuron_id);
             result.status = 0;
             result.id = params->neuron_id;
             break;
         }
-            
+        
         case CMD_DELETE_NEURON: {
             // Delete a neuron
             if (!params) {
@@ -209,33 +123,21 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             }
             
             // Find the neuron
-            Neuron *neuron = find_neuron(params->neuron_id);
-            if (!neuron) {
+            int slot = sim_find_neuron(ctx, params->neuron_id);
+            if (slot < 0) {
                 log_error("Neuron with ID %u not found", params->neuron_id);
                 result.status = -1;
                 break;
             }
             
-            // Remove from array
-            for (int i = 0; i < g_neuron_count; i++) {
-                if (g_neurons[i] == neuron) {
-                    // Shift remaining elements
-                    for (int j = i; j < g_neuron_count - 1; j++) {
-                        g_neurons[j] = g_neurons[j + 1];
-                    }
-                    g_neuron_count--;
-                    break;
-                }
-            }
-            
-            // Destroy the neuron
-            neuron_destroy(neuron);
+            // Remove from the simulation and destroy the neuron
+            sim_remove_neuron(ctx, (uint32_t)slot);
             
             log_info("Deleted neuron with ID %u", params->neuron_id);
             result.status = 0;
             break;
         }
-            
+        
         case CMD_CONNECT_NEURONS: {
             // Connect two neurons
             if (!params) {
@@ -245,8 +147,8 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             }
             
             // Find the neurons
-            Neuron *source = find_neuron(params->neuron_id);
-            Neuron *target = find_neuron(params->target_id);
+            Neuron *source = find_neuron(ctx, params->neuron_id);
+            Neuron *target = find_neuron(ctx, params->target_id);
             
             if (!source || !target) {
                 log_error("Source or target neuron not found");
@@ -266,7 +168,7 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             result.status = 0;
             break;
         }
-            
+        
         case CMD_CREATE_SYNAPSE: {
             // Create a synapse
             if (!params) {
@@ -276,15 +178,15 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             }
             
             // Check if synapse with this ID already exists
-            if (find_synapse(params->synapse_id)) {
+            if (find_synapse(ctx, params->synapse_id)) {
                 log_error("Synapse with ID %u already exists", params->synapse_id);
                 result.status = -1;
                 break;
             }
             
             // Find the neurons
-            Neuron *pre = find_neuron(params->neuron_id);
-            Neuron *post = find_neuron(params->target_id);
+            Neuron *pre = find_neuron(ctx, params->neuron_id);
+            Neuron *post = find_neuron(ctx, params->target_id);
             
             if (!pre || !post) {
                 log_error("Pre or post neuron not found");
@@ -315,30 +217,20 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
                 synapse->delay = params->delay;
             }
             
-            // Add to array
-            if (g_synapse_count >= g_synapse_capacity) {
-                // Expand array
-                int new_capacity = g_synapse_capacity * 2;
-                Synapse **new_array = (Synapse **)mm_realloc(g_synapses, new_capacity * sizeof(Synapse *));
-                if (!new_array) {
-                    synapse_destroy(synapse);
-                    log_error("Failed to expand synapse array");
-                    result.status = -1;
-                    break;
-                }
-                g_synapses = new_array;
-                g_synapse_capacity = new_capacity;
+            // Add to simulation
+            if (sim_add_synapse(ctx, synapse) != 0) {
+                synapse_destroy(synapse);
+                result.status = -1;
+                break;
             }
             
-            g_synapses[g_synapse_count++] = synapse;
-            
             log_info("Created synapse with ID %u from %u to %u", 
                      params->synapse_id, params->neuron_id, params->target_id);
             result.status = 0;
             result.id = params->synapse_id;
             break;
         }
-            
+        
         case CMD_RUN_SIMULATION: {
             // Run simulation for a number of steps
             if (!params) {
@@ -352,76 +244,33 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             
             log_info("Running simulation for %u steps with time step %.2f", num_steps, time_step);
             
-            // Run simulation
+            // Run simulation, stopping at the first step that fails
             for (uint32_t step = 0; step < num_steps; step++) {
-                // Update simulation time
-                g_simulation_time += time_step;
-                
-                // Process neurons
-                for (int i = 0; i < g_neuron_count; i++) {
-                    if (g_neurons[i]) {
-                        // Compute neuron state
-                        neuron_compute(g_neurons[i], 0.0f, time_step);
-                        
-                        // Check for firing
-                        int fired = neuron_fire(g_neurons[i], g_simulation_time);
-                        
-                        // If neuron fired, propagate signal to connected neurons
-                        if (fired) {
-                            for (uint32_t j = 0; j < g_neurons[i]->num_connections; j++) {
-                                uint32_t target_id = g_neurons[i]->connected_neurons[j];
-                                
-                                // Find target neuron
-                                Neuron *target = find_neuron(target_id);
-                                if (target) {
-                                    // Find synapse between these neurons
-                                    for (int s = 0; s < g_synapse_count; s++) {
-                                        if (g_synapses[s] && 
-                                            g_synapses[s]->pre_neuron_id == g_neurons[i]->id &&
-                                            g_synapses[s]->post_neuron_id == target_id) {
-                                            
-                                            // Activate synapse
-                                            float signal = synapse_activate(g_synapses[s], 1.0f, g_simulation_time);
-                                            
-                                            // Apply signal to target neuron
-                                            target->potential += signal;
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
+                if (sim_step(ctx, time_step, NULL) < 0) {
+                    log_error("Simulation step %u failed", step);
+                    result.status = -1;
+                    break;
                 }
             }
+            if (result.status != 0) {
+                break;
+            }
             
-            log_info("Simulation completed, time: %.2f", g_simulation_time);
+            log_info("Simulation completed, time: %.2f", ctx->time);
             result.status = 0;
-            result.value = g_simulation_time;
+            result.value = ctx->time;
             break;
         }
-            
+        
         case CMD_RESET_SIMULATION: {
             // Reset simulation state
-            for (int i = 0; i < g_neuron_count; i++) {
-                if (g_neurons[i]) {
-                    neuron_reset(g_neurons[i]);
-                }
-            }
-            
-            for (int i = 0; i < g_synapse_count; i++) {
-                if (g_synapses[i]) {
-                    synapse_reset(g_synapses[i]);
-                }
-            }
-            
-            g_simulation_time = 0.0f;
+            sim_reset(ctx);
             
             log_info("Simulation reset");
             result.status = 0;
             break;
         }
-            
+        
         case CMD_GET_NEURON_STATE: {
             // Get neuron state
             if (!params) {
@@ -431,19 +280,21 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             }
             
             // Find the neuron
-            Neuron *neuron = find_neuron(params->neuron_id);
-            if (!neuron) {
+            int slot = sim_find_neuron(ctx, params->neuron_id);
+            if (slot < 0) {
                 log_error("Neuron with ID %u not found", params->neuron_id);
                 result.status = -1;
                 break;
             }
             
+            sim_sync_neuron(ctx, (uint32_t)slot);
+            
             result.status = 0;
-            result.id = neuron->id;
-            result.value = neuron->potential;
+            result.id = params->neuron_id;
+            result.value = population_get_potential(&ctx->population, (uint32_t)slot);
             break;
         }
-            
+        
         case CMD_SET_NEURON_PARAM: {
             // Set neuron parameter
             if (!params) {
@@ -453,26 +304,33 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             }
             
             // Find the neuron
-            Neuron *neuron = find_neuron(params->neuron_id);
-            if (!neuron) {
+            int slot = sim_find_neuron(ctx, params->neuron_id);
+            if (slot < 0) {
                 log_error("Neuron with ID %u not found", params->neuron_id);
                 result.status = -1;
                 break;
             }
+            Neuron *neuron = ctx->neurons[slot];
+            PopulationStore *population = &ctx->population;
+            sim_sync_neuron(ctx, (uint32_t)slot);
             
             // Set the parameter based on target_id (used as parameter ID)
             switch (params->target_id) {
                 case 1:  // Threshold
                     neuron->threshold = params->value;
+                    population->threshold[slot] = params->value;
                     break;
                 case 2:  // Rest potential
                     neuron->rest_potential = params->value;
+                    population->rest_potential[slot] = params->value;
                     break;
                 case 3:  // Refractory period
                     neuron->refractory_period = params->value;
+                    population->refractory[slot] = params->value;
                     break;
                 case 4:  // Potential
                     neuron->potential = params->value;
+                    population_set_potential(population, (uint32_t)slot, params->value);
                     break;
                 default:
                     log_error("Unknown parameter ID %u", params->target_id);
@@ -480,12 +338,17 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
                     return result;
             }
             
+            population_store_refresh(population, (uint32_t)slot);
+            
+            // The new value may let the neuron fire without input
+            sim_touch_neuron(ctx, (uint32_t)slot);
+            
             log_info("Set parameter %u of neuron %u to %.4f", 
                      params->target_id, params->neuron_id, params->value);
             result.status = 0;
             break;
         }
-            
+        
         case CMD_GET_MEMORY_STATS: {
             // Get memory usage statistics
             result.status = 0;
@@ -493,15 +356,468 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
             log_info("Memory usage: %zu bytes", (size_t)result.value);
             break;
         }
-            
+        
         case CMD_SHUTDOWN: {
             // Shut down the executor
             log_info("Shutdown command received");
-            g_running = 0;
+            ctx->running = 0;
+            result.status = 0;
+            break;
+        }
+        
+        case CMD_SET_SIM_OPTION: {
+            // Set a simulation option
+            if (!params) {
+                log_error("NULL params for SET_SIM_OPTION");
+                result.status = -1;
+                break;
+            }
+            
+            // The option ID is passed in target_id, as for SET_NEURON_PARAM
+            switch (params->target_id) {
+                case SIM_OPTION_EVENT_DRIVEN:
+                    sim_set_event_driven(ctx, params->value != 0.0f);
+                    break;
+                case SIM_OPTION_ACTIVATION_ACCURACY:
+                    if (sim_set_activation_accuracy(ctx, (ActivationAccuracy)params->value) != 0) {
+                        result.status = -1;
+                        return result;
+                    }
+                    break;
+                case SIM_OPTION_HEBBIAN_PERIOD:
+                    sim_set_rate_period(ctx, SIM_RATE_HEBBIAN, (uint32_t)params->value);
+                    break;
+                case SIM_OPTION_HOMEOSTATIC_PERIOD:
+                    sim_set_rate_period(ctx, SIM_RATE_HOMEOSTATIC, (uint32_t)params->value);
+                    break;
+                case SIM_OPTION_TARGET_RATE:
+                    if (sim_set_target_rate(ctx, params->value) != 0) {
+                        result.status = -1;
+                        return result;
+                    }
+                    break;
+                case SIM_OPTION_SYNAPSE_STORAGE:
+                case SIM_OPTION_MIN_WEIGHT:
+                case SIM_OPTION_MAX_WEIGHT: {
+                    SynapseStorage storage = ctx->csr.storage;
+                    float min_weight = ctx->csr.min_weight;
+                    float max_weight = ctx->csr.max_weight;
+                    if (params->target_id == SIM_OPTION_SYNAPSE_STORAGE) {
+                        storage = (SynapseStorage)params->value;
+                    } else if (params->target_id == SIM_OPTION_MIN_WEIGHT) {
+                        min_weight = params->value;
+                    } else {
+                        max_weight = params->value;
+                    }
+                    if (sim_set_synapse_storage(ctx, storage, min_weight, max_weight) != 0) {
+                        result.status = -1;
+                        return result;
+                    }
+                    break;
+                }
+                case SIM_OPTION_STATE_FORMAT:
+                    if (sim_set_state_format(ctx, (StateFormat)params->value) != 0) {
+                        result.status = -1;
+                        return result;
+                    }
+                    break;
+                case SIM_OPTION_MEMBRANE_TAU:
+                    if (sim_set_membrane_tau(ctx, params->value) != 0) {
+                        result.status = -1;
+                        return result;
+                    }
+                    break;
+                default:
+                    log_error("Unknown simulation option %u", params->target_id);
+                    result.status = -1;
+                    return result;
+            }
+            
+            log_info("Set simulation option %u to %.4f", params->target_id, params->value);
+            result.status = 0;
+            break;
+        }
+        
+        case CMD_SET_SYNAPSE_PARAM: {
+            // Set synapse parameter
+            if (!params) {
+                log_error("NULL params for SET_SYNAPSE_PARAM");
+                result.status = -1;
+                break;
+            }
+            
+            Synapse *synapse = find_synapse(ctx, params->synapse_id);
+            if (!synapse) {
+                log_error("Synapse with ID %u not found", params->synapse_id);
+                result.status = -1;
+                break;
+            }
+            
+            // Bring the record up to date with learning before editing it
+            sim_sync_synapses(ctx);
+            
+            // Set the parameter based on target_id (used as parameter ID)
+            switch (params->target_id) {
+                case 1:  // Weight
+                    synapse->weight = params->value;
+                    break;
+                case 2:  // Delay
+                    synapse->delay = params->value;
+                    break;
+                case 3:  // Plasticity type
+                    synapse->plasticity = (PlasticityType)params->value;
+                    break;
+                case 4:  // Maximum weight
+                    synapse->max_weight = params->value;
+                    break;
+                case 5:  // Minimum weight
+                    synapse->min_weight = params->value;
+                    break;
+                default:
+                    log_error("Unknown parameter ID %u", params->target_id);
+                    result.status = -1;
+                    return result;
+            }
+            
+            log_info("Set parameter %u of synapse %u to %.4f", 
+                     params->target_id, params->synapse_id, params->value);
+            result.status = 0;
+            break;
+        }
+        
+        case CMD_GET_SYNAPSE_STATE: {
+            // Get synapse weight, including learned changes
+            if (!params) {
+                log_error("NULL params for GET_SYNAPSE_STATE");
+                result.status = -1;
+                break;
+            }
+            
+            Synapse *synapse = find_synapse(ctx, params->synapse_id);
+            if (!synapse) {
+                log_error("Synapse with ID %u not found", params->synapse_id);
+                result.status = -1;
+                break;
+            }
+            
+            result.status = 0;
+            result.id = params->synapse_id;
+            result.value = sim_get_synapse_weight(ctx, synapse);
+            break;
+        }
+        
+        case CMD_INJECT_CURRENTS: {
+            // Queue sparse input currents
+            if (!params || (params->data_size > 0 && !params->data) ||
+                params->data_size % sizeof(sim_current_t) != 0) {
+                log_error("Invalid params for INJECT_CURRENTS");
+                result.status = -1;
+                break;
+            }
+            
+            // Split the pairs into slots and values, so that one call
+            // validates them all and queues either all or none
+            const sim_current_t *currents = (const sim_current_t *)params->data;
+            uint32_t count = (uint32_t)(params->data_size / sizeof(sim_current_t));
+            uint32_t *slots = (uint32_t *)mm_alloc((count > 0 ? count : 1) * sizeof(uint32_t));
+            float *values = (float *)mm_alloc((count > 0 ? count : 1) * sizeof(float));
+            if (!slots || !values) {
+                log_error("Failed to allocate input currents");
+                mm_free(slots);
+                mm_free(values);
+                result.status = -1;
+                break;
+            }
+            
+            for (uint32_t i = 0; i < count; i++) {
+                slots[i] = currents[i].slot;
+                values[i] = currents[i].value;
+            }
+            result.status = sim_inject_currents(ctx, slots, values, count);
+            
+            mm_free(slots);
+            mm_free(values);
+            break;
+        }
+        
+        case CMD_INJECT_SPIKES: {
+            // Queue spike sources
+            if (!params || (params->data_size > 0 && !params->data)) {
+                log_error("Invalid params for INJECT_SPIKES");
+                result.status = -1;
+                break;
+            }
+            
+            result.status = sim_inject_spikes(ctx, (const uint32_t *)params->data,
+                                              (uint32_t)(params->data_size / sizeof(uint32_t)));
+            break;
+        }
+        
+        case CMD_DEFINE_INPUT_CHANNEL: {
+            // Name a range of slots
+            if (!params || !params->data || params->data_size == 0) {
+                log_error("Invalid params for DEFINE_INPUT_CHANNEL");
+                result.status = -1;
+                break;
+            }
+            
+            // The name must be terminated inside the data and fit a channel
+            const char *name = (const char *)params->data;
+            const char *terminator = memchr(name, '\0', params->data_size);
+            if (!terminator || terminator - name >= SIM_INPUT_NAME_MAX) {
+                log_error("Input channel name is unterminated or too long");
+                result.status = -1;
+                break;
+            }
+            
+            int channel = sim_define_input_channel(ctx, name, params->neuron_id, params->target_id);
+            result.status = channel < 0 ? -1 : 0;
+            result.id = channel < 0 ? 0 : (uint32_t)channel;
+            break;
+        }
+        
+        case CMD_INJECT_CHANNEL: {
+            // Queue input for the first slots of a channel
+            if (!params || (params->data_size > 0 && !params->data)) {
+                log_error("Invalid params for INJECT_CHANNEL");
+                result.status = -1;
+                break;
+            }
+            
+            result.status = sim_inject_channel(ctx, params->target_id, NULL, (const float *)params->data,
+                                               (uint32_t)(params->data_size / sizeof(float)));
+            break;
+        }
+        
+        case CMD_INJECT_CHANNEL_SPIKES: {
+            // Queue spike sources of a channel
+            if (!params || (params->data_size > 0 && !params->data)) {
+                log_error("Invalid params for INJECT_CHANNEL_SPIKES");
+                result.status = -1;
+                break;
+            }
+            
+            result.status = sim_inject_channel_spikes(ctx, params->target_id, (const uint32_t *)params->data,
+                                                      (uint32_t)(params->data_size / sizeof(uint32_t)));
+            break;
+        }
+        
+        case CMD_RECORD_SPIKES: {
+            // Start or stop the spike raster
+            if (!params || params->value < 0.0f) {
+                log_error("Invalid params for RECORD_SPIKES");
+                result.status = -1;
+                break;
+            }
+            
+            size_t max_bytes = (size_t)((double)params->value * 1024.0 * 1024.0);
+            result.status = sim_record_spikes(ctx, params->neuron_id != 0, max_bytes);
+            break;
+        }
+        
+        case CMD_SELECT_RECORDING: {
+            // Restrict the raster to ranges of slots
+            if (!params || (params->data_size > 0 && !params->data)) {
+                log_error("Invalid params for SELECT_RECORDING");
+                result.status = -1;
+                break;
+            }
+            
+            result.status = sim_select_recording(ctx, (const spike_range_t *)params->data,
+                                                 (uint32_t)(params->data_size / sizeof(spike_range_t)));
+            break;
+        }
+        
+        case CMD_EXPORT_SPIKES: {
+            // Copy out the spike raster
+            size_t size = sim_export_spikes(ctx, NULL, 0, 0);
+            uint8_t *data = (uint8_t *)mm_alloc(size);
+            if (!data) {
+                log_error("Failed to allocate spike export of %zu bytes", size);
+                result.status = -1;
+                break;
+            }
+            
+            sim_export_spikes(ctx, data, size, params && params->neuron_id != 0);
             result.status = 0;
+            result.data = data;
+            result.data_size = size;
             break;
         }
+        
+        case CMD_DEFINE_POPULATION: {
+            // Keep running statistics of a range of slots
+            if (!params) {
+                log_error("Invalid params for DEFINE_POPULATION");
+                result.status = -1;
+                break;
+            }
+            
+            int population = sim_define_population(ctx, params->neuron_id, params->target_id);
+            if (population < 0) {
+                result.status = -1;
+                break;
+            }
+            
+            result.status = 0;
+            result.id = (uint32_t)population;
+            break;
+        }
+        
+        case CMD_GET_POPULATION_STATS: {
+            // Collect the statistics of one population
+            if (!params) {
+                log_error("Invalid params for GET_POPULATION_STATS");
+                result.status = -1;
+                break;
+            }
             
+            sim_population_stats_t *stats = (sim_population_stats_t *)mm_alloc(sizeof(sim_population_stats_t));
+            if (!stats) {
+                result.status = -1;
+                break;
+            }
+            
+            if (sim_population_stats(ctx, params->target_id, stats, params->neuron_id != 0) != 0) {
+                mm_free(stats);
+                result.status = -1;
+                break;
+            }
+            
+            result.status = 0;
+            result.id = params->target_id;
+            result.value = stats->rate;
+            result.data = stats;
+            result.data_size = sizeof(sim_population_stats_t);
+            break;
+        }
+        
+        case CMD_GENERATE_TOPOLOGY: {
+            // Create a whole network from a topology spec
+            if (!params || !params->data || params->data_size != sizeof(sim_topology_t)) {
+                log_error("Invalid params for GENERATE_TOPOLOGY");
+                result.status = -1;
+                break;
+            }
+            
+            uint32_t num_synapses = 0;
+            if (sim_generate_topology(ctx, (const sim_topology_t *)params->data, &num_synapses) < 0) {
+                result.status = -1;
+                break;
+            }
+            
+            result.status = 0;
+            result.id = num_synapses;
+            break;
+        }
+        
+        case CMD_CONNECT_NEURONS_BULK: {
+            // Connect an edge list of neuron IDs
+            if (!params || (params->data_size > 0 && !params->data) ||
+                params->data_size % (2 * sizeof(uint32_t)) != 0) {
+                log_error("Invalid params for CONNECT_NEURONS_BULK");
+                result.status = -1;
+                break;
+            }
+            
+            uint32_t count = (uint32_t)(params->data_size / (2 * sizeof(uint32_t)));
+            int added = sim_connect_neurons(ctx, (const uint32_t *)params->data, count);
+            if (added < 0) {
+                result.status = -1;
+                break;
+            }
+            
+            result.status = 0;
+            result.id = (uint32_t)added;
+            break;
+        }
+        
+        case CMD_LOAD_SYNAPSES: {
+            // Load an edge list of synapses into the bulk store
+            if (!params || !params->data || params->data_size != sizeof(sim_edge_list_t)) {
+                log_error("Invalid params for LOAD_SYNAPSES");
+                result.status = -1;
+                break;
+            }
+            
+            const sim_edge_list_t *list = (const sim_edge_list_t *)params->data;
+            result.status = sim_load_synapses(ctx, list);
+            result.id = result.status == 0 ? list->count : 0;
+            break;
+        }
+        
+        case CMD_REORDER_NEURONS: {
+            // Move the neurons to a locality-improving slot order
+            if (!params) {
+                log_error("NULL params for REORDER_NEURONS");
+                result.status = -1;
+                break;
+            }
+            
+            result.status = sim_reorder_neurons(ctx, (sim_order_t)params->target_id);
+            break;
+        }
+        
+        case CMD_ADD_BACKGROUND_INPUT: {
+            // Drive a range of slots with noise drawn in the step
+            if (!params || !params->data || params->data_size != sizeof(sim_noise_spec_t)) {
+                log_error("Invalid params for ADD_BACKGROUND_INPUT");
+                result.status = -1;
+                break;
+            }
+            
+            int source = sim_add_background(ctx, (const sim_noise_spec_t *)params->data);
+            if (source < 0) {
+                result.status = -1;
+                break;
+            }
+            
+            result.status = 0;
+            result.id = (uint32_t)source;
+            break;
+        }
+        
+        case CMD_CLEAR_BACKGROUND_INPUT: {
+            // Stop every background input
+            sim_clear_background(ctx);
+            result.status = 0;
+            break;
+        }
+        
+        case CMD_SET_NOISE_SEED: {
+            // Key the background input draws
+            if (!params || !params->data || params->data_size != sizeof(uint64_t)) {
+                log_error("Invalid params for SET_NOISE_SEED");
+                result.status = -1;
+                break;
+            }
+            
+            uint64_t seed;
+            memcpy(&seed, params->data, sizeof(seed));
+            sim_set_noise_seed(ctx, seed);
+            result.status = 0;
+            break;
+        }
+        
+        case CMD_CREATE_POPULATION: {
+            // Create neurons running one neuron model
+            if (!params || !params->data || params->data_size != sizeof(sim_population_spec_t)) {
+                log_error("Invalid params for CREATE_POPULATION");
+                result.status = -1;
+                break;
+            }
+            
+            int first = sim_create_population(ctx, (const sim_population_spec_t *)params->data);
+            if (first < 0) {
+                result.status = -1;
+                break;
+            }
+            
+            result.status = 0;
+            result.id = (uint32_t)first;
+            break;
+        }
+        
         default:
             log_error("Unknown command type %d", type);
             result.status = -1;
@@ -512,13 +828,13 @@ command_result_t exec_command(command_type_t type, const command_params_t *param
 }
 
 // Process commands from a buffer
-int exec_process_buffer(const void *buffer, size_t size, void *result_buffer, size_t *result_size) {
+int exec_process_buffer(sim_context_t *ctx, const void *buffer, size_t size, void *result_buffer, size_t *result_size) {
     if (!buffer || !result_buffer || !result_size) {
         log_error("Invalid parameters for process_buffer");
         return -1;
     }
     
-    if (!g_initialized || !g_running) {
+    if (!ctx || !ctx->running) {
         log_error("Command executor not initialized or not running");
         return -1;
     }
@@ -550,14 +866,16 @@ int exec_process_buffer(const void *buffer, size_t size, void *result_buffer, si
     }
     
     // Execute command
-    command_result_t result = exec_command(cmd_type, &params);
+    command_result_t result = exec_command(ctx, cmd_type, &params);
     
     // Write result to buffer
     if (*result_size >= sizeof(command_result_t)) {
         memcpy(result_buffer, &result, sizeof(command_result_t));
         *result_size = sizeof(command_result_t);
     } else {
+        // The caller never sees the result, so its data is released here
         log_error("Result buffer too small");
+        mm_free(result.data);
         return -1;
     }
     
@@ -565,6 +883,6 @@ int exec_process_buffer(const void *buffer, size_t size, void *result_buffer, si
 }
 
 // Check if executor is running
-int exec_is_running(void) {
-    return g_running;
+int exec_is_running(const sim_context_t *ctx) {
+    return ctx && ctx->running;
 }
\ No newline at end of file
@@ -3,6 +3,10 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "sim_context.h"
+#include "sim_topology.h"
+#include "sim_build.h"
+#include "sim_reorder.h"
 
 // Command types
 typedef enum {
@@ -16,9 +20,44 @@ typedef enum {
     CMD_GET_NEURON_STATE,
     CMD_SET_NEURON_PARAM,
     CMD_GET_MEMORY_STATS,
-    CMD_SHUTDOWN
+    CMD_SHUTDOWN,
+    CMD_SET_SIM_OPTION,
+    CMD_SET_SYNAPSE_PARAM,
+    CMD_GET_SYNAPSE_STATE,
+    CMD_INJECT_CURRENTS,         // data: sim_current_t pairs for the next step
+    CMD_INJECT_SPIKES,           // data: uint32_t spike source slots for the next step
+    CMD_DEFINE_INPUT_CHANNEL,    // data: NUL-terminated name; slots [neuron_id, neuron_id + target_id)
+    CMD_INJECT_CHANNEL,          // target_id: channel; data: float input for its first slots
+    CMD_INJECT_CHANNEL_SPIKES,   // target_id: channel; data: uint32_t offsets of spike sources
+    CMD_RECORD_SPIKES,           // neuron_id: non-zero records; value: ring budget in MiB, 0 keeps all
+    CMD_SELECT_RECORDING,        // data: spike_range_t ranges of recorded slots; none records all
+    CMD_EXPORT_SPIKES,           // neuron_id: non-zero drops the raster after export
+    CMD_DEFINE_POPULATION,       // Monitor slots [neuron_id, neuron_id + target_id)
+    CMD_GET_POPULATION_STATS,    // target_id: population; neuron_id: non-zero clears its statistics
+    CMD_GENERATE_TOPOLOGY,       // data: sim_topology_t; result id: number of synapses created
+    CMD_CONNECT_NEURONS_BULK,    // data: uint32_t (source, target) ID pairs; result id: connections added
+    CMD_LOAD_SYNAPSES,           // data: sim_edge_list_t; synapses without records, loaded in parallel
+    CMD_REORDER_NEURONS,         // target_id: sim_order_t; moves neurons to new slots, IDs stay
+    CMD_ADD_BACKGROUND_INPUT,    // data: sim_noise_spec_t; result id: source index
+    CMD_CLEAR_BACKGROUND_INPUT,  // Remove every background input
+    CMD_SET_NOISE_SEED,          // data: uint64_t key of the background input draws
+    CMD_CREATE_POPULATION        // data: sim_population_spec_t; result id: slot of the first neuron
 } command_type_t;
 
+// Simulation options for CMD_SET_SIM_OPTION (option in target_id, setting in value)
+typedef enum {
+    SIM_OPTION_EVENT_DRIVEN = 1,  // Non-zero: update only active neurons
+    SIM_OPTION_ACTIVATION_ACCURACY = 2, // 0 = exact, 1 = fast, 2 = lookup table
+    SIM_OPTION_HEBBIAN_PERIOD = 3,      // Steps between HEBBIAN updates; 0 disables
+    SIM_OPTION_HOMEOSTATIC_PERIOD = 4,  // Steps between HOMEOSTATIC updates; 0 disables
+    SIM_OPTION_TARGET_RATE = 5,         // HOMEOSTATIC target firing rate in Hz
+    SIM_OPTION_SYNAPSE_STORAGE = 6,     // 0 = full, 1 = bfloat16, 2 = int8
+    SIM_OPTION_MIN_WEIGHT = 7,          // Lower weight bound in compact storage
+    SIM_OPTION_MAX_WEIGHT = 8,          // Upper weight bound in compact storage
+    SIM_OPTION_STATE_FORMAT = 9,        // 0 = float, 1 = 16-bit fixed point
+    SIM_OPTION_MEMBRANE_TAU = 10        // Membrane time constant in ms
+} sim_option_t;
+
 // Command parameters
 typedef struct {
     uint32_t neuron_id;
@@ -32,6 +71,7 @@ typedef struct {
     uint32_t synapse_type;
     float weight;
     float delay;
+    float value;
     float sim_time;
     float time_step;
     uint32_t num_steps;
@@ -39,7 +79,9 @@ typedef struct {
     size_t data_size;
 } command_params_t;
 
-// Command result
+// Command result. CMD_EXPORT_SPIKES returns its raster and
+// CMD_GET_POPULATION_STATS a sim_population_stats_t in data, allocated
+// with mm_alloc; the caller frees it with mm_free.
 typedef struct {
     int status;
     uint32_t id;
@@ -48,19 +90,22 @@ typedef struct {
     size_t data_size;
 } command_result_t;
 
-// Initialize command executor
-int exec_init(void);
+// Create a command executor session with its own simulation, stepped by
+// num_threads workers or one per online CPU if num_threads is 0. Returns
+// the session handle, or NULL on failure. Sessions are independent and may
+// run concurrently on different threads.
+sim_context_t *exec_init(uint32_t num_threads);
 
-// Clean up command executor
-void exec_cleanup(void);
+// Clean up a command executor session
+void exec_cleanup(sim_context_t *ctx);
 
 // Execute a command
-command_result_t exec_command(command_type_t type, const command_params_t *params);
+command_result_t exec_command(sim_context_t *ctx, command_type_t type, const command_params_t *params);
 
 // Process commands from a buffer
-int exec_process_buffer(const void *buffer, size_t size, void *result_buffer, size_t *result_size);
+int exec_process_buffer(sim_context_t *ctx, const void *buffer, size_t size, void *result_buffer, size_t *result_size);
 
-// Check if executor is running
-int exec_is_running(void);
+// Check if a session is running
+int exec_is_running(const sim_context_t *ctx);
 
 #endif // EXEC_H
\ No newline at end of file
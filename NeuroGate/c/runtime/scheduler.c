@@ -0,0 +1,149 @@
+#include "scheduler.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+// Initial number of tasks per deque
+#define SCHEDULER_DEQUE_INITIAL 64
+
+// Initialize a scheduler with one deque per worker
+int scheduler_init(scheduler_t *scheduler, uint32_t num_workers) {
+    if (!scheduler || num_workers == 0) {
+        log_error("Invalid parameters for scheduler_init");
+        return -1;
+    }
+    
+    scheduler->deques = (scheduler_deque_t *)mm_alloc_aligned(num_workers * sizeof(scheduler_deque_t), 64);
+    if (!scheduler->deques) {
+        log_error("Failed to allocate scheduler deques");
+        return -1;
+    }
+    
+    memset(scheduler->deques, 0, num_workers * sizeof(scheduler_deque_t));
+    for (uint32_t w = 0; w < num_workers; w++) {
+        pthread_mutex_init(&scheduler->deques[w].mutex, NULL);
+    }
+    
+    scheduler->num_workers = num_workers;
+    scheduler->producing = 0;
+    scheduler->outstanding = 0;
+    return 0;
+}
+
+// Free the deques of a scheduler
+void scheduler_free(scheduler_t *scheduler) {
+    if (!scheduler || !scheduler->deques) return;
+    
+    for (uint32_t w = 0; w < scheduler->num_workers; w++) {
+        pthread_mutex_destroy(&scheduler->deques[w].mutex);
+        mm_free(scheduler->deques[w].tasks);
+    }
+    mm_free_aligned(scheduler->deques);
+    
+    scheduler->deques = NULL;
+    scheduler->num_workers = 0;
+}
+
+// Start a parallel region in which num_workers workers take part. Must be
+// called before the workers start.
+void scheduler_begin(scheduler_t *scheduler, uint32_t num_workers) {
+    __atomic_store_n(&scheduler->producing, num_workers, __ATOMIC_RELAXED);
+    __atomic_store_n(&scheduler->outstanding, 0, __ATOMIC_RELAXED);
+}
+
+// Double the ring of a full deque, unwrapping it at the same time
+static int grow_deque(scheduler_deque_t *deque) {
+    uint32_t capacity = deque->capacity > 0 ? deque->capacity * 2 : SCHEDULER_DEQUE_INITIAL;
+    scheduler_task_t *tasks = (scheduler_task_t *)mm_alloc(capacity * sizeof(scheduler_task_t));
+    if (!tasks) {
+        log_error("Failed to grow scheduler deque to %u tasks", capacity);
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < deque->count; i++) {
+        tasks[i] = deque->tasks[(deque->head + i) & (deque->capacity - 1)];
+    }
+    
+    mm_free(deque->tasks);
+    deque->tasks = tasks;
+    deque->head = 0;
+    deque->capacity = capacity;
+    return 0;
+}
+
+// Queue a task on the deque of a worker
+int scheduler_push(scheduler_t *scheduler, uint32_t worker, const scheduler_task_t *task) {
+    scheduler_deque_t *deque = &scheduler->deques[worker];
+    
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->count == deque->capacity && grow_deque(deque) != 0) {
+        pthread_mutex_unlock(&deque->mutex);
+        return -1;
+    }
+    
+    // Count the task before it becomes visible so the region cannot end early
+    __atomic_add_fetch(&scheduler->outstanding, 1, __ATOMIC_RELAXED);
+    deque->tasks[(deque->head + deque->count) & (deque->capacity - 1)] = *task;
+    __atomic_store_n(&deque->count, deque->count + 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&deque->mutex);
+    return 0;
+}
+
+// Signal that the calling worker will push no more tasks in this region
+void scheduler_finish_producing(scheduler_t *scheduler) {
+    __atomic_sub_fetch(&scheduler->producing, 1, __ATOMIC_RELEASE);
+}
+
+// Take the newest task of the own deque, or the oldest of another one.
+// The count is also read without the lock to skip empty deques cheaply.
+static int take_task(scheduler_deque_t *deque, int steal, scheduler_task_t *task) {
+    if (__atomic_load_n(&deque->count, __ATOMIC_RELAXED) == 0) {
+        return 0;
+    }
+    
+    int found = 0;
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->count > 0) {
+        if (steal) {
+            *task = deque->tasks[deque->head];
+            deque->head = (deque->head + 1) & (deque->capacity - 1);
+        } else {
+            *task = deque->tasks[(deque->head + deque->count - 1) & (deque->capacity - 1)];
+        }
+        __atomic_store_n(&deque->count, deque->count - 1, __ATOMIC_RELAXED);
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return found;
+}
+
+// Run tasks until every worker has finished producing and no task is
+// left. Own tasks are taken newest first while they are still in cache;
+// idle workers steal the oldest, which tend to be the largest remaining
+// share of another worker's work.
+void scheduler_run(scheduler_t *scheduler, uint32_t worker, scheduler_task_fn fn, void *arg) {
+    uint32_t num_workers = scheduler->num_workers;
+    scheduler_task_t task;
+    
+    for (;;) {
+        int found = take_task(&scheduler->deques[worker], 0, &task);
+        
+        for (uint32_t k = 1; !found && k < num_workers; k++) {
+            found = take_task(&scheduler->deques[(worker + k) % num_workers], 1, &task);
+        }
+        
+        if (found) {
+            fn(arg, &task, worker);
+            __atomic_sub_fetch(&scheduler->outstanding, 1, __ATOMIC_RELEASE);
+            continue;
+        }
+        
+        if (__atomic_load_n(&scheduler->producing, __ATOMIC_ACQUIRE) == 0 &&
+            __atomic_load_n(&scheduler->outstanding, __ATOMIC_ACQUIRE) == 0) {
+            break;
+        }
+        sched_yield();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// Unit of stealable work: a range plus two task-specific words
+typedef struct {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t arg0;
+    uint32_t arg1;
+} scheduler_task_t;
+
+// Function that executes one task on a worker
+typedef void (*scheduler_task_fn)(void *arg, const scheduler_task_t *task, uint32_t worker);
+
+// Double-ended task queue of one worker. The owner pushes and pops at the
+// tail; thieves take the oldest tasks from the head. Padded to a cache line
+// so that workers do not contend on each other's queue state.
+typedef struct {
+    pthread_mutex_t mutex;
+    scheduler_task_t *tasks;     // Ring buffer of tasks
+    uint32_t head;               // Oldest task
+    uint32_t count;              // Number of queued tasks
+    uint32_t capacity;           // Ring size (power of two)
+} __attribute__((aligned(64))) scheduler_deque_t;
+
+// Work-stealing scheduler for one parallel region. Workers queue tasks on
+// their own deque, run them, and steal from other deques when idle; the
+// region ends when no worker can produce or run any more tasks.
+typedef struct {
+    scheduler_deque_t *deques;   // One deque per worker
+    uint32_t num_workers;        // Number of deques
+    uint32_t producing;          // Workers that may still push tasks
+    uint32_t outstanding;        // Tasks pushed but not yet finished
+} scheduler_t;
+
+// Function declarations
+int scheduler_init(scheduler_t *scheduler, uint32_t num_workers);
+void scheduler_free(scheduler_t *scheduler);
+void scheduler_begin(scheduler_t *scheduler, uint32_t num_workers);
+int scheduler_push(scheduler_t *scheduler, uint32_t worker, const scheduler_task_t *task);
+void scheduler_finish_producing(scheduler_t *scheduler);
+void scheduler_run(scheduler_t *scheduler, uint32_t worker, scheduler_task_fn fn, void *arg);
+
+#endif // SCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "sim_build.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Stages of a parallel index build, run one after another on the pool
+typedef enum {
+    BUILD_COUNT_ROWS,            // Histogram the rows of each edge chunk
+    BUILD_SUM_ROWS,              // Turn the row histograms into cursors
+    BUILD_SCATTER_ROWS,          // Place each edge chunk
+    BUILD_COUNT_COLUMNS,         // Histogram the columns of each row block
+    BUILD_SUM_COLUMNS,           // Turn the column histograms into cursors
+    BUILD_SCATTER_COLUMNS        // List each row block in the incoming index
+} build_stage_t;
+
+// Share of a build done by one worker
+typedef struct {
+    uint32_t *counts;            // Histogram, then cursors, allocated by the worker
+    uint32_t begin;              // First edge of the chunk
+    uint32_t end;                // End of the chunk
+    uint32_t row_begin;          // First row of the block for the incoming index
+    uint32_t row_end;            // End of the block
+    uint32_t num_plastic;        // Plastic edges in the chunk
+    uint32_t max_steps;          // Largest compact delay placed
+    uint32_t clipped;            // Compact delays shortened
+    int status;                  // Non-zero if the histogram could not be allocated
+} build_worker_t;
+
+// State of a parallel index build
+typedef struct {
+    SynapseCSR *csr;
+    const CSREdge *edges;
+    uint32_t num_edges;
+    const CSREdgeArrays *bulk;
+    uint32_t num_rows;
+    float dt;
+    build_stage_t stage;
+    build_worker_t *workers;
+    uint32_t num_active;         // Workers taking part, at most the pool size
+} build_job_t;
+
+// Sum the histograms of rows [begin, end) across workers into totals, and
+// leave each worker with the count of the workers before it
+static void sum_histograms(build_job_t *job, uint32_t begin, uint32_t end, uint32_t *totals) {
+    for (uint32_t r = begin; r < end; r++) {
+        uint32_t running = 0;
+        for (uint32_t w = 0; w < job->num_active; w++) {
+            uint32_t count = job->workers[w].counts[r];
+            job->workers[w].counts[r] = running;
+            running += count;
+        }
+        totals[r + 1] = running;
+    }
+}
+
+// Worker body of every stage
+static void build_worker(void *arg, uint32_t worker, uint32_t num_workers) {
+    build_job_t *job = (build_job_t *)arg;
+    (void)num_workers;
+    
+    // Only the first num_active workers of the pool take part
+    if (worker >= job->num_active) {
+        return;
+    }
+    
+    build_worker_t *self = &job->workers[worker];
+    SynapseCSR *csr = job->csr;
+    size_t histogram_size = (size_t)job->num_rows * sizeof(uint32_t);
+    uint32_t row_begin = (uint32_t)((uint64_t)job->num_rows * worker / job->num_active);
+    uint32_t row_end = (uint32_t)((uint64_t)job->num_rows * (worker + 1) / job->num_active);
+    
+    switch (job->stage) {
+        case BUILD_COUNT_ROWS:
+            // The worker allocates and first touches its own histogram
+            self->counts = (uint32_t *)mm_alloc(histogram_size > 0 ? histogram_size : 1);
+            if (!self->counts) {
+                self->status = -1;
+                return;
+            }
+            memset(self->counts, 0, histogram_size);
+            self->num_plastic = csr_count_rows(job->edges, job->num_edges, job->bulk,
+                                               self->begin, self->end, self->counts);
+            break;
+        case BUILD_SUM_ROWS:
+            sum_histograms(job, row_begin, row_end, csr->offsets);
+            break;
+        case BUILD_SCATTER_ROWS:
+            csr_scatter_rows(csr, job->edges, job->num_edges, job->bulk, self->begin, self->end,
+                             csr->offsets, self->counts, job->dt, &self->max_steps, &self->clipped);
+            break;
+        case BUILD_COUNT_COLUMNS:
+            memset(self->counts, 0, histogram_size);
+            csr_count_columns(csr, self->row_begin, self->row_end, self->counts);
+            break;
+        case BUILD_SUM_COLUMNS:
+            sum_histograms(job, row_begin, row_end, csr->in_offsets);
+            break;
+        case BUILD_SCATTER_COLUMNS:
+            csr_scatter_columns(csr, self->row_begin, self->row_end, csr->in_offsets, self->counts);
+            break;
+    }
+}
+
+// Run one stage on the pool
+static void run_stage(thread_pool_t *pool, build_job_t *job, build_stage_t stage) {
+    job->stage = stage;
+    thread_pool_run(pool, build_worker, job);
+}
+
+// Turn per-row totals in offsets[1..num_rows] into row starts
+static void prefix_sum(uint32_t *offsets, uint32_t num_rows) {
+    offsets[0] = 0;
+    for (uint32_t r = 0; r < num_rows; r++) {
+        offsets[r + 1] += offsets[r];
+    }
+}
+
+// First row whose edges start at or after edge
+static uint32_t row_at_edge(const uint32_t *offsets, uint32_t num_rows, uint32_t edge) {
+    uint32_t low = 0;
+    uint32_t high = num_rows;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (offsets[mid] < edge) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Build the synapse index on the workers of a pool
+int sim_build_synapse_index(thread_pool_t *pool, SynapseCSR *csr, uint32_t num_rows, const CSREdge *edges,
+                            uint32_t num_edges, const CSREdgeArrays *bulk, float dt) {
+    CSREdgeArrays none = { NULL, NULL, NULL, NULL, NULL, 0, 0 };
+    if (!bulk) {
+        bulk = &none;
+    }
+    
+    if (!pool || !csr || (num_edges > 0 && !edges) || bulk->count > UINT32_MAX - num_edges) {
+        return csr_build(csr, num_rows, edges, num_edges, bulk, dt);
+    }
+    
+    // Every worker sums all rows of its histogram, so workers beyond the
+    // average degree cost more than they save
+    uint32_t total = num_edges + bulk->count;
+    uint32_t num_active = pool->num_workers;
+    if (num_rows > 0 && total / num_rows < num_active) {
+        num_active = total / num_rows;
+    }
+    if (num_active < 2 || total < SIM_BUILD_MIN_EDGES) {
+        return csr_build(csr, num_rows, edges, num_edges, bulk, dt);
+    }
+    
+    build_worker_t *workers = (build_worker_t *)mm_alloc(num_active * sizeof(build_worker_t));
+    if (!workers) {
+        return csr_build(csr, num_rows, edges, num_edges, bulk, dt);
+    }
+    
+    memset(workers, 0, num_active * sizeof(build_worker_t));
+    for (uint32_t w = 0; w < num_active; w++) {
+        workers[w].begin = (uint32_t)((uint64_t)total * w / num_active);
+        workers[w].end = (uint32_t)((uint64_t)total * (w + 1) / num_active);
+        workers[w].max_steps = 1;
+    }
+    
+    build_job_t job = { csr, edges, num_edges, bulk, num_rows, dt, BUILD_COUNT_ROWS, workers, num_active };
+    run_stage(pool, &job, BUILD_COUNT_ROWS);
+    
+    // Fall back to the serial build, which needs no histograms, if any of
+    // them could not be allocated
+    uint32_t num_plastic = 0;
+    int status = 0;
+    for (uint32_t w = 0; w < num_active; w++) {
+        num_plastic += workers[w].num_plastic;
+        status |= workers[w].status;
+    }
+    
+    int result = 0;
+    if (status != 0) {
+        log_warn("Building synapse index on one thread");
+        result = csr_build(csr, num_rows, edges, num_edges, bulk, dt);
+    } else if (csr_prepare(csr, num_rows, edges, num_edges, bulk, num_plastic, dt) != 0) {
+        result = -1;
+    } else {
+        run_stage(pool, &job, BUILD_SUM_ROWS);
+        prefix_sum(csr->offsets, num_rows);
+        run_stage(pool, &job, BUILD_SCATTER_ROWS);
+        
+        // The incoming index splits the packed rows into blocks of about
+        // equal edges, so each column again lists edges in order
+        memset(csr->in_offsets, 0, (num_rows + 1) * sizeof(uint32_t));
+        if (num_plastic > 0) {
+            for (uint32_t w = 0; w < num_active; w++) {
+                workers[w].row_begin = row_at_edge(csr->offsets, num_rows, workers[w].begin);
+                workers[w].row_end = w + 1 < num_active ?
+                                     row_at_edge(csr->offsets, num_rows, workers[w].end) : num_rows;
+            }
+            run_stage(pool, &job, BUILD_COUNT_COLUMNS);
+            run_stage(pool, &job, BUILD_SUM_COLUMNS);
+            prefix_sum(csr->in_offsets, num_rows);
+            run_stage(pool, &job, BUILD_SCATTER_COLUMNS);
+        }
+        
+        uint32_t max_steps = 1;
+        uint32_t clipped = 0;
+        for (uint32_t w = 0; w < num_active; w++) {
+            max_steps = workers[w].max_steps > max_steps ? workers[w].max_steps : max_steps;
+            clipped += workers[w].clipped;
+        }
+        csr_finish(csr, num_rows, total, num_plastic, dt, max_steps, clipped);
+    }
+    
+    for (uint32_t w = 0; w < num_active; w++) {
+        mm_free(workers[w].counts);
+    }
+    mm_free(workers);
+    return result;
+}
+
+// State of a parallel edge list load
+typedef struct {
+    sim_context_t *ctx;
+    const sim_edge_list_t *list;
+    uint32_t base;               // Bulk position of the first edge
+    int *status;                 // Per worker, non-zero on an unknown ID
+} load_job_t;
+
+// Translate and store a contiguous chunk of the edge list
+static void load_worker(void *arg, uint32_t worker, uint32_t num_workers) {
+    load_job_t *job = (load_job_t *)arg;
+    const sim_edge_list_t *list = job->list;
+    sim_bulk_t *bulk = &job->ctx->bulk;
+    uint32_t begin = (uint32_t)((uint64_t)list->count * worker / num_workers);
+    uint32_t end = (uint32_t)((uint64_t)list->count * (worker + 1) / num_workers);
+    uint8_t plasticity = (uint8_t)list->plasticity;
+    
+    for (uint32_t i = begin; i < end; i++) {
+        int pre = sim_find_neuron(job->ctx, list->pre_ids[i]);
+        int post = sim_find_neuron(job->ctx, list->post_ids[i]);
+        if (pre < 0 || post < 0) {
+            job->status[worker] = -1;
+            return;
+        }
+        
+        uint32_t position = job->base + i;
+        bulk->pre[position] = (uint32_t)pre;
+        bulk->post[position] = (uint32_t)post;
+        bulk->weights[position] = list->weights ? list->weights[i] : 0.5f;
+        bulk->delays[position] = list->delays ? list->delays[i] : 1.0f;
+        bulk->plasticity[position] = plasticity;
+    }
+}
+
+// Append an edge list to the bulk store
+int sim_load_synapses(sim_context_t *ctx, const sim_edge_list_t *list) {
+    if (!ctx || !list || (list->count > 0 && (!list->pre_ids || !list->post_ids)) ||
+        (uint32_t)list->plasticity > HOMEOSTATIC) {
+        log_error("Invalid parameters for sim_load_synapses");
+        return -1;
+    }
+    
+    if (list->count == 0) {
+        return 0;
+    }
+    
+    if (list->count > SIM_BULK_MAX_SYNAPSES - ctx->bulk.count) {
+        log_error("Loading %u synapses exceeds the bulk store", list->count);
+        return -1;
+    }
+    
+    uint32_t num_workers = ctx->pool->num_workers;
+    int *status = (int *)mm_alloc(num_workers * sizeof(int));
+    if (!status) {
+        log_error("Failed to allocate synapse loader");
+        return -1;
+    }
+    memset(status, 0, num_workers * sizeof(int));
+    
+    // Learned weights go back before the index is marked stale
+    sim_sync_synapses(ctx);
+    if (sim_bulk_reserve(&ctx->bulk, ctx->bulk.count + list->count) != 0) {
+        mm_free(status);
+        return -1;
+    }
+    
+    load_job_t job = { ctx, list, ctx->bulk.count, status };
+    if (list->count >= SIM_BUILD_MIN_EDGES) {
+        thread_pool_run(ctx->pool, load_worker, &job);
+    } else {
+        for (uint32_t w = 0; w < num_workers; w++) {
+            load_worker(&job, w, num_workers);
+        }
+    }
+    
+    int result = 0;
+    for (uint32_t w = 0; w < num_workers; w++) {
+        result |= status[w];
+    }
+    mm_free(status);
+    
+    if (result != 0) {
+        log_error("Synapse list refers to an unknown neuron");
+        return -1;
+    }
+    
+    ctx->bulk.count += list->count;
+    log_info("Loaded %u synapses", list->count);
+    return 0;
+}
\ No newline at end of file
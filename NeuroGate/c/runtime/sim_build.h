@@ -0,0 +1,36 @@
+#ifndef SIM_BUILD_H
+#define SIM_BUILD_H
+
+#include <stdint.h>
+#include "sim_context.h"
+
+// Fewest edges worth splitting between workers
+#define SIM_BUILD_MIN_EDGES 65536
+
+// Synapses given as an edge list between neuron IDs, input to
+// sim_load_synapses. Weights and delays may be NULL for the defaults of
+// synapse_create.
+typedef struct {
+    const uint32_t *pre_ids;     // Presynaptic neuron ID per synapse
+    const uint32_t *post_ids;    // Postsynaptic neuron ID per synapse
+    const float *weights;        // Weight per synapse, or NULL
+    const float *delays;         // Transmission delay per synapse in ms, or NULL
+    uint32_t count;              // Number of synapses
+    PlasticityType plasticity;   // Plasticity of every synapse
+} sim_edge_list_t;
+
+// Build the synapse index like csr_build, on every worker of a pool. Each
+// worker counts the rows of a contiguous chunk of edges into a histogram
+// of its own, the histograms are summed into row offsets and per-worker
+// cursors, and each worker scatters its chunk through its cursors; the
+// incoming index is built the same way over blocks of rows. The result is
+// identical to csr_build. Small builds run csr_build directly.
+int sim_build_synapse_index(thread_pool_t *pool, SynapseCSR *csr, uint32_t num_rows, const CSREdge *edges,
+                            uint32_t num_edges, const CSREdgeArrays *bulk, float dt);
+
+// Append an edge list to the bulk store, translating the neuron IDs to
+// slots on every worker. Nothing is loaded if an ID is unknown. The index
+// is rebuilt by the next step.
+int sim_load_synapses(sim_context_t *ctx, const sim_edge_list_t *list);
+
+#endif // SIM_BUILD_H
\ No newline at end of file
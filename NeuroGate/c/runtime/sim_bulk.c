@@ -0,0 +1,106 @@
+#include "sim_bulk.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Initialize an empty store
+int sim_bulk_init(sim_bulk_t *bulk) {
+    if (!bulk) {
+        return -1;
+    }
+    
+    memset(bulk, 0, sizeof(sim_bulk_t));
+    return 0;
+}
+
+// Free the synapse arrays
+void sim_bulk_free(sim_bulk_t *bulk) {
+    if (!bulk) return;
+    
+    mm_free(bulk->pre);
+    mm_free(bulk->post);
+    mm_free(bulk->weights);
+    mm_free(bulk->delays);
+    mm_free(bulk->plasticity);
+    memset(bulk, 0, sizeof(sim_bulk_t));
+}
+
+// Grow one array to hold capacity entries of size bytes
+static int grow(void **array, uint32_t capacity, size_t size) {
+    void *grown = mm_realloc(*array, (size_t)capacity * size);
+    if (!grown) {
+        return -1;
+    }
+    *array = grown;
+    return 0;
+}
+
+// Make room for capacity synapses in total, so that a generator can write
+// them in place
+int sim_bulk_reserve(sim_bulk_t *bulk, uint32_t capacity) {
+    if (!bulk || capacity > SIM_BULK_MAX_SYNAPSES) {
+        log_error("Too many bulk synapses");
+        return -1;
+    }
+    
+    if (capacity <= bulk->capacity) {
+        return 0;
+    }
+    
+    if (grow((void **)&bulk->pre, capacity, sizeof(uint32_t)) != 0 ||
+        grow((void **)&bulk->post, capacity, sizeof(uint32_t)) != 0 ||
+        grow((void **)&bulk->weights, capacity, sizeof(float)) != 0 ||
+        grow((void **)&bulk->delays, capacity, sizeof(float)) != 0 ||
+        grow((void **)&bulk->plasticity, capacity, sizeof(uint8_t)) != 0) {
+        log_error("Failed to allocate %u bulk synapses", capacity);
+        return -1;
+    }
+    
+    bulk->capacity = capacity;
+    return 0;
+}
+
+// Drop the synapses of a removed slot and shift the later slots down, in
+// one pass that keeps the order of the others
+void sim_bulk_remove_slot(sim_bulk_t *bulk, uint32_t slot) {
+    if (!bulk) return;
+    
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < bulk->count; i++) {
+        uint32_t pre = bulk->pre[i];
+        uint32_t post = bulk->post[i];
+        if (pre == slot || post == slot) {
+            continue;
+        }
+        
+        bulk->pre[kept] = pre - (pre > slot);
+        bulk->post[kept] = post - (post > slot);
+        bulk->weights[kept] = bulk->weights[i];
+        bulk->delays[kept] = bulk->delays[i];
+        bulk->plasticity[kept] = bulk->plasticity[i];
+        kept++;
+    }
+    bulk->count = kept;
+}
+
+// Point the synapses at the new slots of their neurons, slot_map[old]
+void sim_bulk_remap_slots(sim_bulk_t *bulk, const uint32_t *slot_map) {
+    if (!bulk || !slot_map) return;
+    
+    for (uint32_t i = 0; i < bulk->count; i++) {
+        bulk->pre[i] = slot_map[bulk->pre[i]];
+        bulk->post[i] = slot_map[bulk->post[i]];
+    }
+}
+
+// View the synapses as input to csr_build
+void sim_bulk_edges(const sim_bulk_t *bulk, CSREdgeArrays *edges) {
+    edges->pre = bulk->pre;
+    edges->post = bulk->post;
+    edges->weights = bulk->weights;
+    edges->delays = bulk->delays;
+    edges->plasticity = bulk->plasticity;
+    edges->count = bulk->count;
+    edges->first_synapse = SIM_BULK_SYNAPSE;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef SIM_BULK_H
+#define SIM_BULK_H
+
+#include <stdint.h>
+#include "../core/csr.h"
+
+// Synapse index entries at or above this refer to bulk synapses, by
+// position; entries below refer to Synapse records
+#define SIM_BULK_SYNAPSE 0x80000000u
+
+// Largest number of bulk synapses
+#define SIM_BULK_MAX_SYNAPSES SIM_BULK_SYNAPSE
+
+// Synapses created in bulk, e.g. by a topology generator, kept as parallel
+// arrays between population slots instead of Synapse records. They have no
+// IDs and are only reached through the synapse index, which lists them
+// after the records. Learned weights are written back here like those of
+// records, and plastic bulk synapses use the shared weight bounds of the
+// index. Slots follow their neurons when other neurons are removed.
+typedef struct {
+    uint32_t *pre;               // Presynaptic slot per synapse
+    uint32_t *post;              // Postsynaptic slot per synapse
+    float *weights;              // Synaptic weight per synapse
+    float *delays;               // Transmission delay per synapse in ms
+    uint8_t *plasticity;         // PlasticityType per synapse
+    uint32_t count;              // Number of synapses
+    uint32_t capacity;           // Capacity of the arrays
+} sim_bulk_t;
+
+// Function declarations
+int sim_bulk_init(sim_bulk_t *bulk);
+void sim_bulk_free(sim_bulk_t *bulk);
+int sim_bulk_reserve(sim_bulk_t *bulk, uint32_t capacity);
+void sim_bulk_remove_slot(sim_bulk_t *bulk, uint32_t slot);
+void sim_bulk_remap_slots(sim_bulk_t *bulk, const uint32_t *slot_map);
+void sim_bulk_edges(const sim_bulk_t *bulk, CSREdgeArrays *edges);
+
+#endif // SIM_BULK_H
\ No newline at end of file
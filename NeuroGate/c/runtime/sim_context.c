@@ -0,0 +1,1498 @@
+#include "sim_context.h"
+#include "sim_build.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Contexts created by sim_context_create and not yet destroyed
+static uint32_t g_live_contexts = 0;
+static pthread_mutex_t g_context_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Step each slot's learning traces are current for while event-driven
+// steps decay them lazily, or NULL while every trace is current
+static const uint64_t *trace_steps(const sim_context_t *ctx) {
+    return ctx->active_valid ? ctx->population.trace_step : NULL;
+}
+
+// Slow plasticity of HEBBIAN synapses, by source partition
+static void hebbian_task(sim_context_t *ctx, const sim_partition_t *part, float elapsed) {
+    hebbian_update(&ctx->rates, &ctx->csr, ctx->population.rate_trace, trace_steps(ctx), ctx->step,
+                   part->begin, part->end, elapsed);
+}
+
+// Slow plasticity of HOMEOSTATIC synapses, by target partition
+static void homeostatic_task(sim_context_t *ctx, const sim_partition_t *part, float elapsed) {
+    homeostatic_update(&ctx->rates, &ctx->csr, ctx->population.rate_trace, trace_steps(ctx), ctx->step,
+                       part->begin, part->end, elapsed);
+}
+
+// Per-step decay factors of the learning traces for the current dt
+static PopulationTraceDecay trace_decay(const sim_context_t *ctx) {
+    PopulationTraceDecay decay = { ctx->stdp.decay_plus, ctx->stdp.decay_minus, ctx->rates.decay };
+    return decay;
+}
+
+// Initialize an empty simulation
+int sim_context_init(sim_context_t *ctx, uint32_t num_threads) {
+    if (!ctx) {
+        log_error("NULL context in sim_context_init");
+        return -1;
+    }
+    
+    memset(ctx, 0, sizeof(sim_context_t));
+    
+    // Allocate neuron and synapse arrays
+    ctx->neuron_capacity = 100;
+    ctx->neurons = (Neuron **)mm_alloc(ctx->neuron_capacity * sizeof(Neuron *));
+    if (!ctx->neurons) {
+        log_error("Failed to allocate neuron array");
+        return -1;
+    }
+    
+    ctx->synapse_capacity = 500;
+    ctx->synapses = (Synapse **)mm_alloc(ctx->synapse_capacity * sizeof(Synapse *));
+    if (!ctx->synapses) {
+        mm_free(ctx->neurons);
+        ctx->neurons = NULL;
+        log_error("Failed to allocate synapse array");
+        return -1;
+    }
+    
+    // Allocate the population store and the fired list alongside it
+    if (population_store_init(&ctx->population, ctx->neuron_capacity) != 0) {
+        mm_free(ctx->neurons);
+        mm_free(ctx->synapses);
+        ctx->neurons = NULL;
+        ctx->synapses = NULL;
+        return -1;
+    }
+    
+    ctx->fired = (uint32_t *)mm_alloc(ctx->neuron_capacity * sizeof(uint32_t));
+    ctx->active = (uint32_t *)mm_alloc(ctx->neuron_capacity * sizeof(uint32_t));
+    ctx->next_active = (uint32_t *)mm_alloc(ctx->neuron_capacity * sizeof(uint32_t));
+    if (!ctx->fired || !ctx->active || !ctx->next_active) {
+        sim_context_free(ctx);
+        log_error("Failed to allocate fired and active lists");
+        return -1;
+    }
+    
+    csr_init(&ctx->csr);
+    stdp_rule_init(&ctx->stdp);
+    rate_rule_init(&ctx->rates);
+    sim_add_rate_task(ctx, hebbian_task, SIM_DEFAULT_RATE_PERIOD);
+    sim_add_rate_task(ctx, homeostatic_task, SIM_DEFAULT_RATE_PERIOD);
+    
+    // One partition and one set of wheel lanes per worker
+    ctx->pool = thread_pool_create(num_threads);
+    if (!ctx->pool) {
+        sim_context_free(ctx);
+        return -1;
+    }
+    
+    ctx->num_partitions = ctx->pool->num_workers;
+    ctx->partitions = (sim_partition_t *)mm_alloc_aligned(ctx->num_partitions * sizeof(sim_partition_t), 64);
+    if (!ctx->partitions) {
+        sim_context_free(ctx);
+        log_error("Failed to allocate partitions");
+        return -1;
+    }
+    memset(ctx->partitions, 0, ctx->num_partitions * sizeof(sim_partition_t));
+    ctx->partitions_dirty = 1;
+    ctx->running = 1;
+    
+    if (scheduler_init(&ctx->scheduler, ctx->num_partitions) != 0 ||
+        spike_wheel_init(&ctx->wheel, 1, ctx->num_partitions, ctx->num_partitions) != 0 ||
+        id_index_init(&ctx->neuron_index, ctx->neuron_capacity) != 0 ||
+        id_index_init(&ctx->synapse_index, ctx->synapse_capacity) != 0 ||
+        sim_input_init(&ctx->input) != 0 ||
+        spike_recorder_init(&ctx->recorder, ctx->num_partitions) != 0 ||
+        sim_stats_init(&ctx->stats, ctx->num_partitions) != 0 ||
+        sim_noise_init(&ctx->noise) != 0 ||
+        sim_bulk_init(&ctx->bulk) != 0) {
+        sim_context_free(ctx);
+        return -1;
+    }
+    
+    return 0;
+}
+
+// Destroy all neurons and synapses and free the simulation state
+void sim_context_free(sim_context_t *ctx) {
+    if (!ctx) return;
+    
+    for (uint32_t i = 0; i < ctx->neuron_count; i++) {
+        if (ctx->neurons[i]) {
+            neuron_destroy(ctx->neurons[i]);
+        }
+    }
+    
+    for (uint32_t i = 0; i < ctx->synapse_count; i++) {
+        if (ctx->synapses[i]) {
+            synapse_destroy(ctx->synapses[i]);
+        }
+    }
+    
+    mm_free(ctx->neurons);
+    mm_free(ctx->synapses);
+    mm_free(ctx->fired);
+    mm_free(ctx->active);
+    mm_free(ctx->next_active);
+    population_store_free(&ctx->population);
+    csr_free(&ctx->csr);
+    spike_wheel_free(&ctx->wheel);
+    id_index_free(&ctx->neuron_index);
+    id_index_free(&ctx->synapse_index);
+    thread_pool_destroy(ctx->pool);
+    scheduler_free(&ctx->scheduler);
+    mm_free_aligned(ctx->partitions);
+    sim_input_free(&ctx->input);
+    spike_recorder_free(&ctx->recorder);
+    sim_stats_free(&ctx->stats);
+    sim_noise_free(&ctx->noise);
+    sim_bulk_free(&ctx->bulk);
+    
+    memset(ctx, 0, sizeof(sim_context_t));
+}
+
+// Shut down logging and the memory manager after the last context
+static void release_subsystems(void) {
+    pthread_mutex_lock(&g_context_lock);
+    if (--g_live_contexts == 0) {
+        mm_cleanup();
+        log_cleanup();
+    }
+    pthread_mutex_unlock(&g_context_lock);
+}
+
+// Allocate and initialize a context
+sim_context_t *sim_context_create(uint32_t num_threads) {
+    pthread_mutex_lock(&g_context_lock);
+    if (g_live_contexts++ == 0) {
+        log_init(NULL, LOG_DEBUG);
+        mm_init();
+    }
+    pthread_mutex_unlock(&g_context_lock);
+    
+    sim_context_t *ctx = (sim_context_t *)mm_alloc_aligned(sizeof(sim_context_t), 64);
+    if (!ctx || sim_context_init(ctx, num_threads) != 0) {
+        log_error("Failed to create simulation context");
+        mm_free_aligned(ctx);
+        release_subsystems();
+        return NULL;
+    }
+    
+    return ctx;
+}
+
+// Free a context returned by sim_context_create
+void sim_context_destroy(sim_context_t *ctx) {
+    if (!ctx) return;
+    
+    sim_context_free(ctx);
+    mm_free_aligned(ctx);
+    release_subsystems();
+}
+
+// Bring every slot up to date and drop the active set; the next
+// event-driven step starts again from all slots
+static void invalidate_active_set(sim_context_t *ctx) {
+    if (ctx->event_driven && ctx->active_valid) {
+        PopulationTraceDecay decay = trace_decay(ctx);
+        for (uint32_t i = 0; i < ctx->population.count; i++) {
+            population_catch_up(&ctx->population, i, ctx->step);
+            if (ctx->csr.num_plastic > 0) {
+                population_catch_up_traces(&ctx->population, i, ctx->step, &decay);
+            }
+        }
+    }
+    ctx->active_valid = 0;
+}
+
+// Grow the neuron array, the per-slot lists and the population store to
+// hold count more neurons, at least doubling them
+int sim_reserve_neurons(sim_context_t *ctx, uint32_t count) {
+    if (!ctx || count > UINT32_MAX - ctx->neuron_count) {
+        log_error("Invalid parameters for sim_reserve_neurons");
+        return -1;
+    }
+    
+    uint32_t needed = ctx->neuron_count + count;
+    if (needed <= ctx->neuron_capacity) {
+        return 0;
+    }
+    
+    uint32_t new_capacity = ctx->neuron_capacity * 2;
+    if (new_capacity < needed) {
+        new_capacity = needed;
+    }
+    
+    Neuron **new_array = (Neuron **)mm_realloc(ctx->neurons, new_capacity * sizeof(Neuron *));
+    if (!new_array) {
+        log_error("Failed to expand neuron array");
+        return -1;
+    }
+    ctx->neurons = new_array;
+    
+    uint32_t **lists[] = { &ctx->fired, &ctx->active, &ctx->next_active };
+    for (size_t l = 0; l < sizeof(lists) / sizeof(lists[0]); l++) {
+        uint32_t *list = (uint32_t *)mm_realloc(*lists[l], new_capacity * sizeof(uint32_t));
+        if (!list) {
+            log_error("Failed to expand per-slot lists");
+            return -1;
+        }
+        *lists[l] = list;
+    }
+    
+    if (new_capacity > ctx->population.capacity &&
+        population_store_reserve(&ctx->population, new_capacity) != 0) {
+        return -1;
+    }
+    ctx->neuron_capacity = new_capacity;
+    return 0;
+}
+
+// Add a neuron to the simulation
+int sim_add_neuron(sim_context_t *ctx, Neuron *neuron) {
+    if (!ctx || !neuron) {
+        log_error("Invalid parameters for sim_add_neuron");
+        return -1;
+    }
+    
+    if (id_index_get(&ctx->neuron_index, neuron->id) >= 0) {
+        log_error("Neuron with ID %u already exists", neuron->id);
+        return -1;
+    }
+    
+    if (ctx->neuron_count >= ctx->neuron_capacity &&
+        sim_reserve_neurons(ctx, ctx->neuron_capacity - ctx->neuron_count + 1) != 0) {
+        return -1;
+    }
+    
+    if (id_index_put(&ctx->neuron_index, neuron->id, ctx->neuron_count) != 0) {
+        return -1;
+    }
+    invalidate_active_set(ctx);
+    
+    int slot = population_store_add(&ctx->population, neuron);
+    if (slot < 0) {
+        id_index_remove(&ctx->neuron_index, neuron->id);
+        return -1;
+    }
+    
+    ctx->neurons[ctx->neuron_count++] = neuron;
+    ctx->partitions_dirty = 1;
+    return slot;
+}
+
+// Remove and destroy the neuron in a slot
+int sim_remove_neuron(sim_context_t *ctx, uint32_t slot) {
+    if (!ctx || slot >= ctx->neuron_count) {
+        return -1;
+    }
+    
+    Neuron *neuron = ctx->neurons[slot];
+    id_index_remove(&ctx->neuron_index, neuron->id);
+    
+    // Event-driven state must be current before slots move
+    invalidate_active_set(ctx);
+    
+    // Shift remaining elements and move their index entries with them
+    for (uint32_t j = slot; j < ctx->neuron_count - 1; j++) {
+        ctx->neurons[j] = ctx->neurons[j + 1];
+        id_index_put(&ctx->neuron_index, ctx->neurons[j]->id, j);
+    }
+    ctx->neuron_count--;
+    population_store_remove(&ctx->population, slot);
+    spike_wheel_remove_target(&ctx->wheel, slot);
+    sim_input_remove_slot(&ctx->input, slot);
+    spike_recorder_remove_slot(&ctx->recorder, slot);
+    sim_stats_remove_slot(&ctx->stats, slot);
+    sim_noise_remove_slot(&ctx->noise, slot);
+    sim_sync_synapses(ctx);
+    sim_bulk_remove_slot(&ctx->bulk, slot);
+    ctx->partitions_dirty = 1;
+    
+    neuron_destroy(neuron);
+    return 0;
+}
+
+// Find neuron slot by ID
+int sim_find_neuron(const sim_context_t *ctx, uint32_t id) {
+    return (int)id_index_get(&ctx->neuron_index, id);
+}
+
+// Connect neurons by ID in bulk
+int sim_connect_neurons(sim_context_t *ctx, const uint32_t *pairs, uint32_t count) {
+    if (!ctx || (count > 0 && !pairs)) {
+        log_error("Invalid parameters for sim_connect_neurons");
+        return -1;
+    }
+    
+    if (count == 0) {
+        return 0;
+    }
+    
+    NeuronEdge *edges = (NeuronEdge *)mm_alloc((size_t)count * sizeof(NeuronEdge));
+    if (!edges) {
+        log_error("Failed to allocate %u edges", count);
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        int source = sim_find_neuron(ctx, pairs[2 * i]);
+        int target = sim_find_neuron(ctx, pairs[2 * i + 1]);
+        if (source < 0 || target < 0) {
+            log_error("Neuron %u or %u not found", pairs[2 * i], pairs[2 * i + 1]);
+            mm_free(edges);
+            return -1;
+        }
+        edges[i].source = (uint32_t)source;
+        edges[i].target = (uint32_t)target;
+    }
+    
+    int added = neuron_connect_many(ctx->neurons, ctx->neuron_count, edges, count);
+    mm_free(edges);
+    return added;
+}
+
+// Move the neurons to new slots
+int sim_permute_neurons(sim_context_t *ctx, const uint32_t *order) {
+    if (!ctx || !order) {
+        log_error("Invalid parameters for sim_permute_neurons");
+        return -1;
+    }
+    
+    if (ctx->input.num_channels > 0 || ctx->stats.num_populations > 0 || ctx->noise.num_sources > 0 ||
+        ctx->population.num_groups > 0 || ctx->recorder.enabled || ctx->recorder.num_ranges > 0) {
+        log_error("Neurons cannot move while channels, populations, background input, neuron models "
+                  "or recording are defined");
+        return -1;
+    }
+    
+    uint32_t count = ctx->neuron_count;
+    uint32_t *slot_map = (uint32_t *)mm_alloc((size_t)count * sizeof(uint32_t) + 1);
+    Neuron **moved = (Neuron **)mm_alloc((size_t)count * sizeof(Neuron *) + 1);
+    if (!slot_map || !moved) {
+        log_error("Failed to allocate neuron permutation");
+        mm_free(slot_map);
+        mm_free(moved);
+        return -1;
+    }
+    
+    // Invert the order, checking that it is a permutation
+    memset(slot_map, 0xff, (size_t)count * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        if (order[i] >= count || slot_map[order[i]] != UINT32_MAX) {
+            log_error("Neuron order is not a permutation of %u slots", count);
+            mm_free(slot_map);
+            mm_free(moved);
+            return -1;
+        }
+        slot_map[order[i]] = i;
+    }
+    
+    // Event-driven state must be current and learned weights written back
+    // before slots move
+    invalidate_active_set(ctx);
+    sim_sync_synapses(ctx);
+    if (population_store_permute(&ctx->population, order) != 0) {
+        mm_free(slot_map);
+        mm_free(moved);
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        moved[i] = ctx->neurons[order[i]];
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        ctx->neurons[i] = moved[i];
+        id_index_put(&ctx->neuron_index, moved[i]->id, i);
+    }
+    
+    spike_wheel_remap_targets(&ctx->wheel, slot_map);
+    sim_input_remap_slots(&ctx->input, slot_map);
+    sim_bulk_remap_slots(&ctx->bulk, slot_map);
+    ctx->partitions_dirty = 1;
+    
+    mm_free(slot_map);
+    mm_free(moved);
+    return 0;
+}
+
+// Add a synapse to the simulation
+int sim_add_synapse(sim_context_t *ctx, Synapse *synapse) {
+    if (!ctx || !synapse) {
+        log_error("Invalid parameters for sim_add_synapse");
+        return -1;
+    }
+    
+    if (id_index_get(&ctx->synapse_index, synapse->id) >= 0) {
+        log_error("Synapse with ID %u already exists", synapse->id);
+        return -1;
+    }
+    
+    if (ctx->synapse_count >= ctx->synapse_capacity) {
+        // Expand array
+        uint32_t new_capacity = ctx->synapse_capacity * 2;
+        Synapse **new_array = (Synapse **)mm_realloc(ctx->synapses, new_capacity * sizeof(Synapse *));
+        if (!new_array) {
+            log_error("Failed to expand synapse array");
+            return -1;
+        }
+        ctx->synapses = new_array;
+        ctx->synapse_capacity = new_capacity;
+    }
+    
+    if (id_index_put(&ctx->synapse_index, synapse->id, ctx->synapse_count) != 0) {
+        return -1;
+    }
+    
+    sim_sync_synapses(ctx);
+    ctx->synapses[ctx->synapse_count++] = synapse;
+    return 0;
+}
+
+// Find synapse by ID
+Synapse *sim_find_synapse(const sim_context_t *ctx, uint32_t id) {
+    int64_t position = id_index_get(&ctx->synapse_index, id);
+    return position >= 0 ? ctx->synapses[position] : NULL;
+}
+
+// Write the packed weights back to the synapse records and bulk synapses
+// and schedule a rebuild. Learning updates the packed weights only, so
+// this must run before synapses are edited or the index is repacked.
+void sim_sync_synapses(sim_context_t *ctx) {
+    SynapseCSR *csr = &ctx->csr;
+    
+    if (csr->dirty) {
+        return;
+    }
+    
+    for (uint32_t row = 0; row < csr->num_rows; row++) {
+        for (uint32_t e = csr->offsets[row]; e < csr->offsets[row + 1]; e++) {
+            uint32_t synapse = csr->synapse_index[e];
+            float weight = csr_get_weight(csr, row, e);
+            if (synapse >= SIM_BULK_SYNAPSE) {
+                ctx->bulk.weights[synapse - SIM_BULK_SYNAPSE] = weight;
+            } else {
+                ctx->synapses[synapse]->weight = weight;
+            }
+        }
+    }
+    csr->dirty = 1;
+}
+
+// Current weight of a synapse, including learned changes
+float sim_get_synapse_weight(const sim_context_t *ctx, const Synapse *synapse) {
+    const SynapseCSR *csr = &ctx->csr;
+    int pre = sim_find_neuron(ctx, synapse->pre_neuron_id);
+    
+    if (csr->dirty || pre < 0) {
+        return synapse->weight;
+    }
+    
+    for (uint32_t e = csr->offsets[pre]; e < csr->offsets[pre + 1]; e++) {
+        uint32_t index = csr->synapse_index[e];
+        if (index < SIM_BULK_SYNAPSE && ctx->synapses[index] == synapse) {
+            return csr_get_weight(csr, (uint32_t)pre, e);
+        }
+    }
+    return synapse->weight;
+}
+
+// Reset simulation state
+void sim_reset(sim_context_t *ctx) {
+    if (!ctx) return;
+    
+    for (uint32_t i = 0; i < ctx->neuron_count; i++) {
+        if (ctx->neurons[i]) {
+            neuron_reset(ctx->neurons[i]);
+        }
+    }
+    population_store_reset(&ctx->population);
+    
+    for (uint32_t i = 0; i < ctx->synapse_count; i++) {
+        if (ctx->synapses[i]) {
+            synapse_reset(ctx->synapses[i]);
+        }
+    }
+    spike_wheel_clear(&ctx->wheel);
+    sim_input_clear(&ctx->input);
+    spike_recorder_clear(&ctx->recorder);
+    sim_stats_clear(&ctx->stats);
+    
+    ctx->time = 0.0f;
+    ctx->step = 0;
+    ctx->dt = 0.0f;
+    ctx->segment_start = 0.0;
+    ctx->segment_step = 0;
+    ctx->active_valid = 0;
+    
+    for (uint32_t p = 0; p < ctx->num_partitions; p++) {
+        ctx->partitions[p].fired_count = 0;
+    }
+    for (uint32_t t = 0; t < ctx->num_rate_tasks; t++) {
+        ctx->rate_tasks[t].last_time = 0.0f;
+    }
+}
+
+// Rebuild the outgoing synapse index
+int sim_rebuild_synapse_index(sim_context_t *ctx, float dt) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    if (!ctx->csr.dirty) {
+        return 0;
+    }
+    
+    // Learned weights were written back when the index was marked dirty
+    SynapseCSR *csr = &ctx->csr;
+    CSREdge *edges = NULL;
+    if (ctx->synapse_count > 0) {
+        edges = (CSREdge *)mm_alloc(ctx->synapse_count * sizeof(CSREdge));
+        if (!edges) {
+            log_error("Failed to allocate edge list");
+            return -1;
+        }
+    }
+    
+    // Synapses whose endpoints no longer exist are left out of the index
+    uint32_t num_edges = 0;
+    for (uint32_t s = 0; s < ctx->synapse_count; s++) {
+        Synapse *synapse = ctx->synapses[s];
+        if (!synapse) continue;
+        
+        int pre = sim_find_neuron(ctx, synapse->pre_neuron_id);
+        int post = sim_find_neuron(ctx, synapse->post_neuron_id);
+        if (pre < 0 || post < 0) continue;
+        
+        edges[num_edges].pre = (uint32_t)pre;
+        edges[num_edges].post = (uint32_t)post;
+        edges[num_edges].weight = synapse->weight;
+        edges[num_edges].delay = synapse->delay;
+        edges[num_edges].synapse = s;
+        edges[num_edges].min_weight = synapse->min_weight;
+        edges[num_edges].max_weight = synapse->max_weight;
+        edges[num_edges].plasticity = (uint8_t)synapse->plasticity;
+        num_edges++;
+    }
+    
+    CSREdgeArrays bulk;
+    sim_bulk_edges(&ctx->bulk, &bulk);
+    int status = sim_build_synapse_index(ctx->pool, csr, ctx->neuron_count, edges, num_edges, &bulk, dt);
+    
+    mm_free(edges);
+    return status;
+}
+
+// Select the encoding of the synapse index
+int sim_set_synapse_storage(sim_context_t *ctx, SynapseStorage storage, float min_weight, float max_weight) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    // Learned weights go back to the records before the arrays are dropped
+    sim_sync_synapses(ctx);
+    return csr_set_storage(&ctx->csr, storage, min_weight, max_weight);
+}
+
+// Switch between dense and event-driven stepping
+int sim_set_event_driven(sim_context_t *ctx, int enabled) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    // Dense stepping expects every potential to be current
+    invalidate_active_set(ctx);
+    ctx->event_driven = enabled ? 1 : 0;
+    return 0;
+}
+
+// Select the accuracy of SIGMOID and TANH in the per-step outputs
+int sim_set_activation_accuracy(sim_context_t *ctx, ActivationAccuracy accuracy) {
+    if (!ctx || accuracy < ACTIVATION_EXACT || accuracy > ACTIVATION_LUT) {
+        log_error("Invalid activation accuracy");
+        return -1;
+    }
+    
+    ctx->population.accuracy = accuracy;
+    return 0;
+}
+
+// Select the representation of the neuron state
+int sim_set_state_format(sim_context_t *ctx, StateFormat format) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    // Skipped leak is applied in the format it accumulated in
+    invalidate_active_set(ctx);
+    return population_store_set_format(&ctx->population, format, ctx->time, ctx->dt);
+}
+
+// Set the membrane time constant of the population
+int sim_set_membrane_tau(sim_context_t *ctx, float tau) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    // Skipped leak is applied with the factors it accumulated under
+    invalidate_active_set(ctx);
+    return population_set_membrane_tau(&ctx->population, tau);
+}
+
+// Queue input currents for the next step
+int sim_inject_currents(sim_context_t *ctx, const uint32_t *slots, const float *values, uint32_t count) {
+    if (!ctx || (count > 0 && !slots)) {
+        return -1;
+    }
+    
+    return sim_input_add_currents(&ctx->input, 0, ctx->population.count, slots, values, count);
+}
+
+// Queue spike sources for the next step
+int sim_inject_spikes(sim_context_t *ctx, const uint32_t *slots, uint32_t count) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    return sim_input_add_spikes(&ctx->input, 0, ctx->population.count, slots, count);
+}
+
+// Name a range of slots as an input channel
+int sim_define_input_channel(sim_context_t *ctx, const char *name, uint32_t first, uint32_t count) {
+    if (!ctx || first > ctx->population.count || count > ctx->population.count - first) {
+        log_error("Input channel range out of bounds");
+        return -1;
+    }
+    
+    return sim_input_define_channel(&ctx->input, name, first, count);
+}
+
+// Queue input currents for a channel
+int sim_inject_channel(sim_context_t *ctx, uint32_t channel, const uint32_t *offsets,
+                       const float *values, uint32_t count) {
+    if (!ctx || channel >= ctx->input.num_channels) {
+        log_error("Unknown input channel %u", channel);
+        return -1;
+    }
+    
+    const sim_input_channel_t *range = &ctx->input.channels[channel];
+    return sim_input_add_currents(&ctx->input, range->first, range->count, offsets, values, count);
+}
+
+// Queue spike sources of a channel
+int sim_inject_channel_spikes(sim_context_t *ctx, uint32_t channel, const uint32_t *offsets, uint32_t count) {
+    if (!ctx || channel >= ctx->input.num_channels) {
+        log_error("Unknown input channel %u", channel);
+        return -1;
+    }
+    
+    const sim_input_channel_t *range = &ctx->input.channels[channel];
+    return sim_input_add_spikes(&ctx->input, range->first, range->count, offsets, count);
+}
+
+// Start or stop recording spikes
+int sim_record_spikes(sim_context_t *ctx, int enabled, size_t max_bytes) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    if (enabled) {
+        spike_recorder_start(&ctx->recorder, max_bytes);
+    } else {
+        spike_recorder_stop(&ctx->recorder);
+    }
+    return 0;
+}
+
+// Restrict recording to ranges of slots
+int sim_select_recording(sim_context_t *ctx, const spike_range_t *ranges, uint32_t num_ranges) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    return spike_recorder_select(&ctx->recorder, ranges, num_ranges);
+}
+
+// Export the recorded raster
+size_t sim_export_spikes(sim_context_t *ctx, uint8_t *out, size_t capacity, int clear) {
+    if (!ctx) {
+        return 0;
+    }
+    
+    size_t size = spike_recorder_export(&ctx->recorder, out, capacity);
+    if (clear && out && capacity >= size) {
+        spike_recorder_clear(&ctx->recorder);
+    }
+    return size;
+}
+
+// Monitor the statistics of a range of slots
+int sim_define_population(sim_context_t *ctx, uint32_t first, uint32_t count) {
+    if (!ctx || first > ctx->population.count || count > ctx->population.count - first) {
+        log_error("Population range out of bounds");
+        return -1;
+    }
+    
+    return sim_stats_define(&ctx->stats, first, count);
+}
+
+// Get the statistics of a population
+int sim_population_stats(sim_context_t *ctx, uint32_t population, sim_population_stats_t *out, int clear) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    return sim_stats_collect(&ctx->stats, population, out, clear);
+}
+
+// Add a background input source
+int sim_add_background(sim_context_t *ctx, const sim_noise_spec_t *spec) {
+    if (!ctx || !spec || spec->first > ctx->population.count ||
+        spec->count > ctx->population.count - spec->first) {
+        log_error("Background input range out of bounds");
+        return -1;
+    }
+    
+    return sim_noise_add(&ctx->noise, spec);
+}
+
+// Remove every background input source
+void sim_clear_background(sim_context_t *ctx) {
+    if (!ctx) return;
+    
+    sim_noise_clear(&ctx->noise);
+}
+
+// Set the seed of the background input
+void sim_set_noise_seed(sim_context_t *ctx, uint64_t seed) {
+    if (!ctx) return;
+    
+    ctx->noise.seed = seed;
+}
+
+// Run a range of slots with a neuron model
+int sim_set_neuron_model(sim_context_t *ctx, uint32_t first, uint32_t count, NeuronModelType model,
+                         const float *params) {
+    if (!ctx || first > ctx->population.count || count > ctx->population.count - first) {
+        log_error("Neuron model range out of bounds");
+        return -1;
+    }
+    
+    if (model == NEURON_MODEL_LIF) {
+        return 0;
+    }
+    
+    // The slots leave the active set, so they must be current first
+    invalidate_active_set(ctx);
+    return population_store_add_group(&ctx->population, first, count, model, params);
+}
+
+// Create a population of new neurons
+int sim_create_population(sim_context_t *ctx, const sim_population_spec_t *spec) {
+    if (!ctx || !spec || spec->count == 0 || spec->first_id > UINT32_MAX - (spec->count - 1) ||
+        !neuron_model_get(spec->model)) {
+        log_error("Invalid population spec");
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < spec->count; i++) {
+        if (id_index_get(&ctx->neuron_index, spec->first_id + i) >= 0) {
+            log_error("Neuron ID %u already in use", spec->first_id + i);
+            return -1;
+        }
+    }
+    
+    if (sim_reserve_neurons(ctx, spec->count) != 0) {
+        return -1;
+    }
+    
+    uint32_t first = ctx->neuron_count;
+    for (uint32_t i = 0; i < spec->count; i++) {
+        Neuron *neuron = neuron_create(spec->first_id + i, EXCITATORY, spec->activation);
+        if (!neuron || sim_add_neuron(ctx, neuron) < 0) {
+            neuron_destroy(neuron);
+            break;
+        }
+    }
+    
+    if (ctx->neuron_count - first == spec->count &&
+        sim_set_neuron_model(ctx, first, spec->count, spec->model, spec->params) == 0) {
+        return (int)first;
+    }
+    
+    while (ctx->neuron_count > first) {
+        sim_remove_neuron(ctx, ctx->neuron_count - 1);
+    }
+    return -1;
+}
+
+// Read the model state variables of a slot
+int sim_get_model_state(const sim_context_t *ctx, uint32_t slot, float *values) {
+    if (!ctx || slot >= ctx->population.count || !values) {
+        return -1;
+    }
+    
+    const NeuronModelGroup *group = population_find_group(&ctx->population, slot);
+    if (!group) {
+        return 0;
+    }
+    
+    const NeuronModel *model = neuron_model_get(group->type);
+    for (uint32_t s = 0; s < model->num_state; s++) {
+        values[s] = group->state[s][slot - group->first];
+    }
+    return (int)model->num_state;
+}
+
+// Bring the state of a slot up to date with the current step
+void sim_sync_neuron(sim_context_t *ctx, uint32_t slot) {
+    if (ctx->event_driven && ctx->active_valid) {
+        population_catch_up(&ctx->population, slot, ctx->step);
+    }
+}
+
+// Add a slot to the set updated in the next step, in the list of the
+// partition that owns it
+static void activate(sim_context_t *ctx, uint32_t slot) {
+    if (!ctx->population.active_mark[slot]) {
+        sim_partition_t *part = &ctx->partitions[slot / ctx->partition_size];
+        ctx->population.active_mark[slot] = 1;
+        ctx->active[part->begin + part->active_count++] = slot;
+    }
+}
+
+// Sync a slot and schedule it for the next step
+void sim_touch_neuron(sim_context_t *ctx, uint32_t slot) {
+    if (ctx->event_driven && ctx->active_valid) {
+        sim_sync_neuron(ctx, slot);
+        activate(ctx, slot);
+    }
+}
+
+// Start event-driven stepping from the current state: every slot is
+// current and active, and quiescent ones drop out after one step. Slots of
+// model groups are stepped every step instead, so they stay marked and
+// never enter the lists.
+static void seed_active_set(sim_context_t *ctx) {
+    PopulationStore *population = &ctx->population;
+    
+    for (uint32_t p = 0; p < ctx->num_partitions; p++) {
+        sim_partition_t *part = &ctx->partitions[p];
+        part->active_count = 0;
+        for (uint32_t i = part->begin; i < part->end; i++) {
+            population->updated_step[i] = ctx->step;
+            population->trace_step[i] = ctx->step;
+            population->active_mark[i] = 1;
+            if (population->num_groups == 0 || !population_find_group(population, i)) {
+                ctx->active[part->begin + part->active_count++] = i;
+            }
+        }
+    }
+    ctx->active_valid = 1;
+}
+
+// Split the slots into one contiguous partition per worker. Partitions are
+// multiples of 16 slots so that no two workers write the same cache line
+// of the population arrays. Pending input is refiled under the partition
+// that now owns its target.
+static int update_partitions(sim_context_t *ctx) {
+    uint32_t count = ctx->population.count;
+    uint32_t parts = ctx->num_partitions;
+    uint32_t size = ((count + parts - 1) / parts + 15) & ~15u;
+    if (size == 0) {
+        size = 16;
+    }
+    
+    for (uint32_t p = 0; p < parts; p++) {
+        sim_partition_t *part = &ctx->partitions[p];
+        uint64_t begin = (uint64_t)p * size;
+        part->begin = begin < count ? (uint32_t)begin : count;
+        part->end = begin + size < count ? (uint32_t)(begin + size) : count;
+        part->fired_count = 0;
+        part->active_count = 0;
+        part->next_count = 0;
+    }
+    ctx->partition_size = size;
+    
+    if (spike_wheel_repartition(&ctx->wheel, size) != 0) {
+        return -1;
+    }
+    
+    ctx->partitions_dirty = 0;
+    return 0;
+}
+
+// Advance the integer step clock. Time is derived from the step count of
+// the current dt segment, so it does not accumulate rounding error.
+static void advance_clock(sim_context_t *ctx, float dt) {
+    if (dt != ctx->dt) {
+        ctx->segment_start += (double)(ctx->step - ctx->segment_step) * ctx->dt;
+        ctx->segment_step = ctx->step;
+        ctx->dt = dt;
+    }
+    
+    ctx->step++;
+    ctx->time = (float)(ctx->segment_start + (double)(ctx->step - ctx->segment_step) * dt);
+}
+
+// Deposit the spikes carried by a range of edges of one synapse index row
+// in the lanes of the producing worker, split by the partition that owns
+// each target
+static int deposit_edges(sim_context_t *ctx, uint32_t producer, uint32_t row,
+                         uint32_t begin, uint32_t end) {
+    SynapseCSR *csr = &ctx->csr;
+    uint32_t partition_size = ctx->partition_size;
+    
+    for (uint32_t e = begin; e < end; e++) {
+        uint32_t target = csr->targets[e];
+        if (spike_wheel_push(&ctx->wheel, ctx->step + csr_get_delay(csr, e), producer,
+                             target / partition_size, target, csr_get_weight(csr, row, e)) != 0) {
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+// Scatter the input injected since the last step into the lanes of worker
+// 0: currents are due in this step, and spike sources deposit over their
+// synapses like slots that fire in this step. Runs before the workers
+// start, so lane 0 is not shared.
+static int apply_input(sim_context_t *ctx) {
+    sim_input_t *input = &ctx->input;
+    const SynapseCSR *csr = &ctx->csr;
+    int status = 0;
+    
+    for (uint32_t i = 0; i < input->num_currents && status == 0; i++) {
+        uint32_t slot = input->currents[i].slot;
+        status = spike_wheel_push(&ctx->wheel, ctx->step, 0, slot / ctx->partition_size,
+                                  slot, input->currents[i].value);
+    }
+    
+    for (uint32_t i = 0; i < input->num_spikes && status == 0; i++) {
+        uint32_t pre = input->spikes[i];
+        if (pre < csr->num_rows) {
+            status = deposit_edges(ctx, 0, pre, csr->offsets[pre], csr->offsets[pre + 1]);
+        }
+    }
+    
+    sim_input_clear(input);
+    return status;
+}
+
+// Delivery task: fired list positions [begin, end), whole rows, or when
+// arg1 is non-zero the edges [arg0, arg1) of the single slot at begin
+static void deliver_task(void *arg, const scheduler_task_t *task, uint32_t worker) {
+    sim_context_t *ctx = (sim_context_t *)arg;
+    const uint32_t *offsets = ctx->csr.offsets;
+    int status = 0;
+    
+    if (task->arg1 != 0) {
+        status = deposit_edges(ctx, worker, ctx->fired[task->begin], task->arg0, task->arg1);
+    } else {
+        for (uint32_t i = task->begin; i < task->end && status == 0; i++) {
+            uint32_t pre = ctx->fired[i];
+            status = deposit_edges(ctx, worker, pre, offsets[pre], offsets[pre + 1]);
+        }
+    }
+    
+    if (status != 0) {
+        ctx->partitions[worker].status = -1;
+    }
+}
+
+// Queue the delivery of a partition's spikes on a worker's deque. Slots
+// with small fan-out are batched up to about SIM_DELIVERY_CHUNK synapses
+// per task; larger fan-outs are split into chunks that idle workers can
+// steal.
+static int queue_delivery(sim_context_t *ctx, uint32_t worker, const sim_partition_t *part) {
+    const uint32_t *offsets = ctx->csr.offsets;
+    uint32_t end = part->begin + part->fired_count;
+    uint32_t batch_begin = part->begin;
+    uint32_t batch_edges = 0;
+    scheduler_task_t task;
+    
+    for (uint32_t i = part->begin; i < end; i++) {
+        uint32_t pre = ctx->fired[i];
+        uint32_t row_begin = offsets[pre];
+        uint32_t row_end = offsets[pre + 1];
+        
+        if (row_end - row_begin > SIM_DELIVERY_CHUNK) {
+            // Close the current batch, then split this row
+            if (i > batch_begin) {
+                task = (scheduler_task_t){ batch_begin, i, 0, 0 };
+                if (scheduler_push(&ctx->scheduler, worker, &task) != 0) return -1;
+            }
+            for (uint32_t e = row_begin; e < row_end; e += SIM_DELIVERY_CHUNK) {
+                uint32_t chunk_end = row_end - e > SIM_DELIVERY_CHUNK ? e + SIM_DELIVERY_CHUNK : row_end;
+                task = (scheduler_task_t){ i, i + 1, e, chunk_end };
+                if (scheduler_push(&ctx->scheduler, worker, &task) != 0) return -1;
+            }
+            batch_begin = i + 1;
+            batch_edges = 0;
+            continue;
+        }
+        
+        batch_edges += row_end - row_begin;
+        if (batch_edges >= SIM_DELIVERY_CHUNK) {
+            task = (scheduler_task_t){ batch_begin, i + 1, 0, 0 };
+            if (scheduler_push(&ctx->scheduler, worker, &task) != 0) return -1;
+            batch_begin = i + 1;
+            batch_edges = 0;
+        }
+    }
+    
+    if (end > batch_begin) {
+        task = (scheduler_task_t){ batch_begin, end, 0, 0 };
+        if (scheduler_push(&ctx->scheduler, worker, &task) != 0) return -1;
+    }
+    
+    return 0;
+}
+
+// Add the background input of the sources overlapping a partition. Dense
+// steps add it to every slot; event-driven steps only touch the slots that
+// draw a non-zero input, which become active like targets of a spike.
+static void apply_background(sim_context_t *ctx, const sim_partition_t *part, int event_driven) {
+    PopulationStore *population = &ctx->population;
+    float values[SIM_NOISE_BLOCK];
+    
+    for (uint32_t i = 0; i < ctx->noise.num_sources; i++) {
+        const sim_noise_spec_t *spec = &ctx->noise.sources[i].spec;
+        uint32_t begin = spec->first > part->begin ? spec->first : part->begin;
+        uint32_t end = spec->first + spec->count < part->end ? spec->first + spec->count : part->end;
+        
+        for (uint32_t block = begin; block < end; block += SIM_NOISE_BLOCK) {
+            uint32_t count = end - block < SIM_NOISE_BLOCK ? end - block : SIM_NOISE_BLOCK;
+            sim_noise_draw(&ctx->noise, i, ctx->step, block, block + count, values);
+            
+            if (event_driven) {
+                for (uint32_t n = 0; n < count; n++) {
+                    if (values[n] != 0.0f) {
+                        population_catch_up(population, block + n, ctx->step - 1);
+                        population_add_input(population, block + n, values[n]);
+                        activate(ctx, block + n);
+                    }
+                }
+            } else if (population->format == STATE_FIXED16) {
+                for (uint32_t n = 0; n < count; n++) {
+                    population_add_input(population, block + n, values[n]);
+                }
+            } else {
+                float *potential = population->potential + block;
+                for (uint32_t n = 0; n < count; n++) {
+                    potential[n] += values[n];
+                }
+            }
+        }
+    }
+}
+
+// Event-driven step of one partition: drain this step's input into its
+// targets, update the active slots, then carry over the ones that can
+// still fire on their own
+static void step_partition_event_driven(sim_context_t *ctx, sim_partition_t *part, uint32_t index) {
+    PopulationStore *population = &ctx->population;
+    
+    // Every target that receives input becomes active; it first gets the
+    // leak of the steps it skipped
+    for (uint32_t producer = 0; producer < ctx->wheel.producers; producer++) {
+        SpikeBucket *bucket = spike_wheel_bucket(&ctx->wheel, ctx->step, producer, index);
+        for (uint32_t n = 0; n < bucket->count; n++) {
+            uint32_t target = bucket->events[n].target;
+            population_catch_up(population, target, ctx->step - 1);
+            population_add_input(population, target, bucket->events[n].weight);
+            activate(ctx, target);
+        }
+        bucket->count = 0;
+    }
+    apply_background(ctx, part, 1);
+    
+    uint32_t *current = ctx->active + part->begin;
+    uint32_t count = part->active_count;
+    part->fired_count = population_update_active(population, current, count, ctx->step,
+                                                 ctx->time, ctx->fired + part->begin);
+    if (population->num_groups > 0) {
+        part->fired_count += population_update_models(population, part->begin, part->end, ctx->step,
+                                                      ctx->time, ctx->fired + part->begin + part->fired_count);
+    }
+    
+    for (uint32_t n = 0; n < count; n++) {
+        population->active_mark[current[n]] = 0;
+    }
+    
+    uint32_t *next = ctx->next_active + part->begin;
+    part->next_count = 0;
+    for (uint32_t n = 0; n < count; n++) {
+        if (population_is_pending(population, current[n])) {
+            population->active_mark[current[n]] = 1;
+            next[part->next_count++] = current[n];
+        }
+    }
+}
+
+// Dense update of a partition split at the boundaries of the monitored
+// populations, so that each kernel call sums the moments and spikes of one
+// segment into the partition's row
+static uint32_t update_segments(sim_context_t *ctx, const sim_partition_t *part, uint32_t index,
+                                float *outputs, const PopulationTraceDecay *decay) {
+    sim_stats_segment_t *row = sim_stats_row(&ctx->stats, index);
+    uint32_t *fired = ctx->fired + part->begin;
+    uint32_t num_fired = 0;
+    uint32_t begin = part->begin;
+    
+    while (begin < part->end) {
+        uint32_t next;
+        uint32_t segment = sim_stats_locate(&ctx->stats, begin, &next);
+        uint32_t end = next < part->end ? next : part->end;
+        
+        uint32_t count = population_update(&ctx->population, begin, end, ctx->time, outputs,
+                                           fired + num_fired, decay,
+                                           segment != SIM_STATS_NONE ? &row[segment].moments : NULL);
+        if (segment != SIM_STATS_NONE) {
+            row[segment].fired += count;
+        }
+        num_fired += count;
+        begin = end;
+    }
+    
+    return num_fired;
+}
+
+// Dense step of one partition: apply this step's input, then stream the
+// neuron update through the population store
+static void step_partition_dense(sim_context_t *ctx, sim_partition_t *part, uint32_t index, float *outputs,
+                                 const PopulationTraceDecay *decay) {
+    PopulationStore *population = &ctx->population;
+    float *potential = population->potential;
+    
+    for (uint32_t producer = 0; producer < ctx->wheel.producers; producer++) {
+        SpikeBucket *bucket = spike_wheel_bucket(&ctx->wheel, ctx->step, producer, index);
+        if (population->format == STATE_FIXED16) {
+            for (uint32_t n = 0; n < bucket->count; n++) {
+                population_add_input(population, bucket->events[n].target, bucket->events[n].weight);
+            }
+        } else {
+            for (uint32_t n = 0; n < bucket->count; n++) {
+                potential[bucket->events[n].target] += bucket->events[n].weight;
+            }
+        }
+        bucket->count = 0;
+    }
+    apply_background(ctx, part, 0);
+    
+    if (ctx->stats.num_populations > 0) {
+        part->fired_count = update_segments(ctx, part, index, outputs, decay);
+    } else {
+        part->fired_count = population_update(&ctx->population, part->begin, part->end,
+                                              ctx->time, outputs, ctx->fired + part->begin, decay, NULL);
+    }
+}
+
+// Arguments of one parallel step
+typedef struct {
+    sim_context_t *ctx;
+    float *outputs;
+    int event_driven;
+    const PopulationTraceDecay *decay; // Trace decay fused into the dense update, or NULL
+} step_task_t;
+
+// Worker body of a step. Each worker reduces the input lanes of its own
+// partitions and updates them, then queues the delivery of their spikes.
+// Delivery tasks are run by whichever worker takes them and deposit into
+// that worker's producer lanes. Input is always due at least one step
+// later, so the lanes being drained are never written in the same step.
+static void step_worker(void *arg, uint32_t worker, uint32_t num_workers) {
+    step_task_t *task = (step_task_t *)arg;
+    sim_context_t *ctx = task->ctx;
+    
+    for (uint32_t p = worker; p < ctx->num_partitions; p += num_workers) {
+        sim_partition_t *part = &ctx->partitions[p];
+        
+        // Learning traces take the previous step's spikes before they are
+        // overwritten; the dense update decays them in the same pass. The
+        // event-driven update leaves them alone, so a fired slot first
+        // catches up with the decay it skipped.
+        if (task->decay) {
+            stdp_add_spikes(ctx->population.pre_trace, ctx->population.post_trace,
+                            ctx->fired + part->begin, part->fired_count);
+            rate_add_spikes(ctx->population.rate_trace, ctx->fired + part->begin, part->fired_count);
+        } else if (ctx->csr.num_plastic > 0) {
+            PopulationTraceDecay decay = trace_decay(ctx);
+            for (uint32_t n = 0; n < part->fired_count; n++) {
+                population_catch_up_traces(&ctx->population, ctx->fired[part->begin + n],
+                                           ctx->step - 1, &decay);
+            }
+            stdp_add_spikes(ctx->population.pre_trace, ctx->population.post_trace,
+                            ctx->fired + part->begin, part->fired_count);
+            rate_add_spikes(ctx->population.rate_trace, ctx->fired + part->begin, part->fired_count);
+        }
+        
+        if (task->event_driven) {
+            step_partition_event_driven(ctx, part, p);
+            if (ctx->stats.num_populations > 0) {
+                sim_stats_count_spikes(&ctx->stats, p, ctx->fired + part->begin, part->fired_count);
+            }
+        } else {
+            step_partition_dense(ctx, part, p, task->outputs, task->decay);
+        }
+        
+        // Each partition records into its own stream of the raster
+        if (ctx->recorder.enabled &&
+            spike_recorder_add(&ctx->recorder, p, ctx->step, ctx->fired + part->begin, part->fired_count) != 0) {
+            ctx->partitions[worker].status = -1;
+        }
+        
+        if (queue_delivery(ctx, worker, part) != 0) {
+            ctx->partitions[worker].status = -1;
+        }
+    }
+    
+    scheduler_finish_producing(&ctx->scheduler);
+    scheduler_run(&ctx->scheduler, worker, deliver_task, ctx);
+}
+
+// Depress the outgoing STDP synapses of the partitions' fired slots. Rows
+// belong to one source slot, so workers never update the same edge.
+static void depress_worker(void *arg, uint32_t worker, uint32_t num_workers) {
+    sim_context_t *ctx = (sim_context_t *)arg;
+    
+    for (uint32_t p = worker; p < ctx->num_partitions; p += num_workers) {
+        sim_partition_t *part = &ctx->partitions[p];
+        stdp_depress(&ctx->stdp, &ctx->csr, ctx->population.post_trace, trace_steps(ctx), ctx->step,
+                     ctx->fired + part->begin, part->fired_count);
+    }
+}
+
+// Potentiate the incoming STDP synapses of the partitions' fired slots.
+// Columns belong to one target slot, so workers never update the same edge.
+static void potentiate_worker(void *arg, uint32_t worker, uint32_t num_workers) {
+    sim_context_t *ctx = (sim_context_t *)arg;
+    
+    for (uint32_t p = worker; p < ctx->num_partitions; p += num_workers) {
+        sim_partition_t *part = &ctx->partitions[p];
+        stdp_potentiate(&ctx->stdp, &ctx->csr, ctx->population.pre_trace, trace_steps(ctx), ctx->step,
+                        ctx->fired + part->begin, part->fired_count);
+    }
+}
+
+// Apply the step's STDP weight changes in two batched passes, after all
+// spikes of the step were delivered with the old weights
+static void apply_plasticity(sim_context_t *ctx, int parallel) {
+    if (parallel) {
+        thread_pool_run(ctx->pool, depress_worker, ctx);
+        thread_pool_run(ctx->pool, potentiate_worker, ctx);
+    } else {
+        depress_worker(ctx, 0, 1);
+        potentiate_worker(ctx, 0, 1);
+    }
+}
+
+// Register a task run every period steps
+int sim_add_rate_task(sim_context_t *ctx, sim_rate_fn run, uint32_t period) {
+    if (!ctx || !run || ctx->num_rate_tasks >= SIM_MAX_RATE_TASKS) {
+        log_error("Cannot register rate task");
+        return -1;
+    }
+    
+    sim_rate_task_t *task = &ctx->rate_tasks[ctx->num_rate_tasks];
+    task->run = run;
+    task->period = period;
+    task->last_time = ctx->time;
+    task->due = 0;
+    return (int)ctx->num_rate_tasks++;
+}
+
+// Change the cadence of a task
+int sim_set_rate_period(sim_context_t *ctx, uint32_t task, uint32_t period) {
+    if (!ctx || task >= ctx->num_rate_tasks) {
+        return -1;
+    }
+    
+    ctx->rate_tasks[task].period = period;
+    return 0;
+}
+
+// Set the firing rate that HOMEOSTATIC synapses steer towards
+int sim_set_target_rate(sim_context_t *ctx, float rate_hz) {
+    if (!ctx || !(rate_hz > 0.0f)) {
+        log_error("Invalid target rate");
+        return -1;
+    }
+    
+    ctx->rates.target_rate = rate_hz;
+    return 0;
+}
+
+// Run every due slow-cadence task on the worker's partitions. The built-in
+// tasks touch disjoint synapses (by plasticity type), and each partition's
+// rows and columns belong to it alone, so tasks need no synchronization.
+static void rate_worker(void *arg, uint32_t worker, uint32_t num_workers) {
+    sim_context_t *ctx = (sim_context_t *)arg;
+    
+    for (uint32_t t = 0; t < ctx->num_rate_tasks; t++) {
+        sim_rate_task_t *task = &ctx->rate_tasks[t];
+        if (!task->due) continue;
+        
+        float elapsed = ctx->time - task->last_time;
+        for (uint32_t p = worker; p < ctx->num_partitions; p += num_workers) {
+            task->run(ctx, &ctx->partitions[p], elapsed);
+        }
+    }
+}
+
+// Multi-rate scheduling: run the tasks whose cadence divides the step
+// count, all in one parallel region
+static void run_rate_tasks(sim_context_t *ctx, int parallel) {
+    int any_due = 0;
+    
+    for (uint32_t t = 0; t < ctx->num_rate_tasks; t++) {
+        sim_rate_task_t *task = &ctx->rate_tasks[t];
+        task->due = task->period > 0 && ctx->step % task->period == 0;
+        any_due |= task->due;
+    }
+    
+    if (!any_due) {
+        return;
+    }
+    
+    if (parallel) {
+        thread_pool_run(ctx->pool, rate_worker, ctx);
+    } else {
+        rate_worker(ctx, 0, 1);
+    }
+    
+    for (uint32_t t = 0; t < ctx->num_rate_tasks; t++) {
+        if (ctx->rate_tasks[t].due) {
+            ctx->rate_tasks[t].last_time = ctx->time;
+        }
+    }
+}
+
+// Advance the simulation by one time step
+int sim_step(sim_context_t *ctx, float dt, float *outputs) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    // Compact storage only keeps delays in steps, so a new dt repacks
+    if (ctx->csr.storage != SYNAPSE_STORAGE_FULL && ctx->csr.delay_dt != dt) {
+        sim_sync_synapses(ctx);
+    }
+    
+    // Repack synapses after creates or deletes
+    int repacked = ctx->csr.dirty;
+    if (repacked && sim_rebuild_synapse_index(ctx, dt) != 0) {
+        return -1;
+    }
+    
+    // Delays are kept in whole steps of dt
+    if (ctx->csr.delay_dt != dt) {
+        csr_quantize_delays(&ctx->csr, dt);
+        repacked = 1;
+    }
+    if (repacked && spike_wheel_reserve(&ctx->wheel, ctx->csr.max_delay_steps, ctx->step) != 0) {
+        return -1;
+    }
+    
+    // Fixed-point refractory periods are kept in whole steps of dt
+    if (ctx->population.format == STATE_FIXED16 && ctx->population.refractory_dt != dt) {
+        population_quantize_refractory(&ctx->population, dt);
+    }
+    
+    // The leak factors are cached per dt; quiescent slots first catch up
+    // with the factors of the steps they skipped
+    if (ctx->population.leak_dt != dt) {
+        invalidate_active_set(ctx);
+        population_set_dt(&ctx->population, dt);
+    }
+    
+    // Split the neurons across workers after creates or deletes
+    if (ctx->partitions_dirty && update_partitions(ctx) != 0) {
+        return -1;
+    }
+    
+    // Outputs need every neuron, so those steps run dense
+    int event_driven = ctx->event_driven && !outputs;
+    if (!event_driven) {
+        invalidate_active_set(ctx);
+    } else if (!ctx->active_valid) {
+        seed_active_set(ctx);
+    }
+    
+    advance_clock(ctx, dt);
+    
+    if ((ctx->input.num_currents > 0 || ctx->input.num_spikes > 0) && apply_input(ctx) != 0) {
+        return -1;
+    }
+    
+    for (uint32_t p = 0; p < ctx->num_partitions; p++) {
+        ctx->partitions[p].status = 0;
+    }
+    
+    if (ctx->csr.num_plastic > 0 && ctx->stdp.dt != dt) {
+        stdp_rule_set_dt(&ctx->stdp, dt);
+        rate_rule_set_dt(&ctx->rates, dt);
+    }
+    
+    // Pick the step kernels for the population's profile after changes
+    population_store_select_kernels(&ctx->population);
+    
+    if (ctx->stats.num_populations > 0 && sim_stats_prepare(&ctx->stats) != 0) {
+        return -1;
+    }
+    sim_noise_prepare(&ctx->noise, dt);
+    
+    // Dense steps decay the learning traces inside the neuron update
+    PopulationTraceDecay decay = trace_decay(ctx);
+    int fuse_decay = ctx->csr.num_plastic > 0 && !event_driven;
+    
+    int parallel = ctx->population.count >= SIM_PARALLEL_MIN_NEURONS;
+    step_task_t task = { ctx, outputs, event_driven, fuse_decay ? &decay : NULL };
+    if (parallel) {
+        scheduler_begin(&ctx->scheduler, ctx->pool->num_workers);
+        thread_pool_run(ctx->pool, step_worker, &task);
+    } else {
+        scheduler_begin(&ctx->scheduler, 1);
+        step_worker(&task, 0, 1);
+    }
+    
+    uint32_t num_fired = 0;
+    int status = 0;
+    for (uint32_t p = 0; p < ctx->num_partitions; p++) {
+        num_fired += ctx->partitions[p].fired_count;
+        status |= ctx->partitions[p].status;
+    }
+    
+    // Event-driven steps leave quiescent potentials behind, so only dense
+    // steps sample the moments
+    if (ctx->stats.num_populations > 0) {
+        sim_stats_finish_step(&ctx->stats, dt, !event_driven);
+    }
+    
+    if (ctx->csr.num_plastic > 0) {
+        if (num_fired > 0) {
+            apply_plasticity(ctx, parallel);
+        }
+        run_rate_tasks(ctx, parallel);
+    }
+    
+    // The carried-over slots form the active set of the next step
+    if (event_driven) {
+        uint32_t *current = ctx->active;
+        ctx->active = ctx->next_active;
+        ctx->next_active = current;
+        
+        for (uint32_t p = 0; p < ctx->num_partitions; p++) {
+            ctx->partitions[p].active_count = ctx->partitions[p].next_count;
+            ctx->partitions[p].next_count = 0;
+        }
+    }
+    
+    return status != 0 ? -1 : (int)num_fired;
+}
\ No newline at end of file
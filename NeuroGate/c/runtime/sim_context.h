@@ -0,0 +1,303 @@
+#ifndef SIM_CONTEXT_H
+#define SIM_CONTEXT_H
+
+#include <stdint.h>
+#include "../core/neuron.h"
+#include "../core/synapse.h"
+#include "../core/population.h"
+#include "../core/csr.h"
+#include "../core/spike_wheel.h"
+#include "../core/plasticity.h"
+#include "../utils/id_index.h"
+#include "thread_pool.h"
+#include "scheduler.h"
+#include "sim_input.h"
+#include "spike_recorder.h"
+#include "sim_stats.h"
+#include "sim_bulk.h"
+#include "sim_noise.h"
+
+// Networks smaller than this are stepped on the calling thread only
+#define SIM_PARALLEL_MIN_NEURONS 4096
+
+// Spike delivery is scheduled in tasks of about this many synapses; the
+// fan-out of a neuron with more synapses is split into several tasks
+#define SIM_DELIVERY_CHUNK 256
+
+// Population of new neurons created in one call: count neurons with the
+// IDs first_id.., all running model with parameters params (the model's
+// defaults if NULL; see neuron_model.h for their order and units)
+typedef struct {
+    uint32_t first_id;           // ID of the first neuron
+    uint32_t count;              // Neurons to create
+    NeuronModelType model;       // Dynamics of every neuron
+    const float *params;         // Model parameters, or NULL
+    ActivationFunction activation; // Activation of every neuron's output
+} sim_population_spec_t;
+
+// Contiguous range of slots stepped by one worker. Per-partition lists
+// live at offset begin of the shared fired and active arrays. Padded to a
+// cache line so that workers never write the same line.
+typedef struct {
+    uint32_t begin;              // First slot
+    uint32_t end;                // One past the last slot
+    uint32_t fired_count;        // Slots fired in the last step, at fired + begin
+    uint32_t active_count;       // Active slots, at active + begin
+    uint32_t next_count;         // Slots carried over, at next_active + begin
+    int status;                  // Nonzero if worker of the same index failed
+} __attribute__((aligned(64))) sim_partition_t;
+
+struct sim_context;
+
+// Maximum number of slow-cadence tasks
+#define SIM_MAX_RATE_TASKS 8
+
+// Built-in slow-cadence tasks
+#define SIM_RATE_HEBBIAN 0
+#define SIM_RATE_HOMEOSTATIC 1
+
+// Default cadence of the built-in tasks in steps
+#define SIM_DEFAULT_RATE_PERIOD 100
+
+// Work that runs every period steps instead of every step, such as slow
+// plasticity. It is called once per partition, in parallel, after the
+// step's spikes were delivered; elapsed is the simulated time in ms since
+// the task last ran.
+typedef void (*sim_rate_fn)(struct sim_context *ctx, const sim_partition_t *part, float elapsed);
+
+typedef struct {
+    sim_rate_fn run;             // Task body
+    uint32_t period;             // Cadence in steps; 0 disables the task
+    float last_time;             // Simulation time of the last run
+    int due;                     // Runs in the current step
+} sim_rate_task_t;
+
+// State of one independent simulation. The command executor and the JNI
+// bridge take a context handle, so one process can host any number of
+// networks; a single context must not be used by two threads at once.
+typedef struct sim_context {
+    Neuron **neurons;            // Neuron records, parallel to population slots
+    uint32_t neuron_count;       // Number of neurons
+    uint32_t neuron_capacity;    // Capacity of the neuron array
+    Synapse **synapses;          // Synapse records
+    uint32_t synapse_count;      // Number of synapses
+    uint32_t synapse_capacity;   // Capacity of the synapse array
+    sim_bulk_t bulk;             // Synapses created in bulk, without records
+    PopulationStore population;  // Hot per-neuron state, one slot per neuron
+    SynapseCSR csr;              // Outgoing synapses per slot, rebuilt lazily
+    SpikeWheel wheel;            // Synaptic input pending delivery, by due step
+    StdpRule stdp;               // Parameters of STDP synapses
+    RateRule rates;              // Parameters of HEBBIAN and HOMEOSTATIC synapses
+    sim_rate_task_t rate_tasks[SIM_MAX_RATE_TASKS]; // Slow-cadence tasks
+    uint32_t num_rate_tasks;     // Number of registered tasks
+    id_index_t neuron_index;     // Neuron ID to slot
+    id_index_t synapse_index;    // Synapse ID to position in synapses
+    uint32_t *fired;             // Slots that fired in the current step, by partition
+    float time;                  // Simulation time in ms, derived from step
+    uint64_t step;               // Number of steps run since the last reset
+    float dt;                    // Time step of the current clock segment
+    double segment_start;        // Simulation time when dt last changed
+    uint64_t segment_step;       // Step at which dt last changed
+    int event_driven;            // Update only the active set each step
+    int active_valid;            // Active set reflects the current slots
+    uint32_t *active;            // Slots to update in the next step, by partition
+    uint32_t *next_active;       // Active set being built for the step after
+    thread_pool_t *pool;         // Workers of the parallel step
+    scheduler_t scheduler;       // Work-stealing queues for spike delivery
+    sim_partition_t *partitions; // One partition per worker
+    uint32_t num_partitions;     // Number of partitions
+    uint32_t partition_size;     // Slots per partition
+    int partitions_dirty;        // Slots were added or removed since the split
+    sim_input_t input;           // Sparse input for the next step, and input channels
+    spike_recorder_t recorder;   // Raster of the spikes of recorded steps
+    sim_stats_t stats;           // Running statistics of monitored populations
+    sim_noise_t noise;           // Background input drawn inside every step
+    int running;                 // Accepts commands; cleared on shutdown
+} sim_context_t;
+
+// Initialize an empty simulation stepped by num_threads workers; 0 uses
+// one worker per online CPU
+int sim_context_init(sim_context_t *ctx, uint32_t num_threads);
+
+// Destroy all neurons and synapses and free the simulation state
+void sim_context_free(sim_context_t *ctx);
+
+// Allocate and initialize a context; NULL on failure. The first live
+// context brings up logging and the memory manager
+sim_context_t *sim_context_create(uint32_t num_threads);
+
+// Free a context returned by sim_context_create; the last one shuts down
+// logging and the memory manager
+void sim_context_destroy(sim_context_t *ctx);
+
+// Make room for count more neurons, so that adding them does not grow the
+// per-slot arrays one doubling at a time
+int sim_reserve_neurons(sim_context_t *ctx, uint32_t count);
+
+// Add a neuron; the context takes ownership. Returns its slot, or -1 on
+// failure or if the ID is already in use
+int sim_add_neuron(sim_context_t *ctx, Neuron *neuron);
+
+// Remove and destroy the neuron in a slot
+int sim_remove_neuron(sim_context_t *ctx, uint32_t slot);
+
+// Find the slot of a neuron by ID, or -1
+int sim_find_neuron(const sim_context_t *ctx, uint32_t id);
+
+// Connect neurons by ID, given count (source, target) pairs, allocating
+// each touched adjacency once. Returns the number of new connections, or
+// -1 if an ID is unknown
+int sim_connect_neurons(sim_context_t *ctx, const uint32_t *pairs, uint32_t count);
+
+// Move the neurons to new slots: slot i takes the neuron of slot order[i].
+// IDs keep their neurons, and pending input and synaptic events, bulk
+// synapses and the partitions follow them. Input channels, monitored
+// populations, background input, neuron models and recording are ranges
+// of slots, so the permutation is refused while any of them is defined.
+int sim_permute_neurons(sim_context_t *ctx, const uint32_t *order);
+
+// Add a synapse; the context takes ownership. Fails if the ID is in use
+int sim_add_synapse(sim_context_t *ctx, Synapse *synapse);
+
+// Find a synapse by ID
+Synapse *sim_find_synapse(const sim_context_t *ctx, uint32_t id);
+
+// Write learned weights back to the synapse records and bulk synapses and
+// schedule an index rebuild; call before editing or adding synapses
+void sim_sync_synapses(sim_context_t *ctx);
+
+// Current weight of a synapse, including learned changes
+float sim_get_synapse_weight(const sim_context_t *ctx, const Synapse *synapse);
+
+// Register a task run every period steps. Returns its index, or -1
+int sim_add_rate_task(sim_context_t *ctx, sim_rate_fn run, uint32_t period);
+
+// Change the cadence of a task; 0 disables it
+int sim_set_rate_period(sim_context_t *ctx, uint32_t task, uint32_t period);
+
+// Set the firing rate in Hz that HOMEOSTATIC synapses steer towards
+int sim_set_target_rate(sim_context_t *ctx, float rate_hz);
+
+// Rebuild the outgoing synapse index if synapses or neurons changed, with
+// delays in steps of dt
+int sim_rebuild_synapse_index(sim_context_t *ctx, float dt);
+
+// Select the encoding of the synapse index. Compact storage keeps 16- or
+// 8-bit weights and 8-bit delays, and bounds every plastic weight by
+// min_weight and max_weight instead of the synapse's own bounds.
+int sim_set_synapse_storage(sim_context_t *ctx, SynapseStorage storage, float min_weight, float max_weight);
+
+// Switch between dense and event-driven stepping. In event-driven mode only
+// neurons that received input or can still fire are updated; the leak of
+// quiescent neurons is applied in closed form when they are next touched,
+// and the decay of their learning traces when they fire or plasticity
+// reads them.
+int sim_set_event_driven(sim_context_t *ctx, int enabled);
+
+// Select the accuracy of SIGMOID and TANH in the per-step outputs
+int sim_set_activation_accuracy(sim_context_t *ctx, ActivationAccuracy accuracy);
+
+// Select the representation of the neuron state. STATE_FIXED16 steps
+// 16-bit fixed-point potentials with integer kernels; see PopulationStore
+// for its quantization.
+int sim_set_state_format(sim_context_t *ctx, StateFormat format);
+
+// Set the membrane time constant in ms; the leak keeps exp(-dt / tau) of
+// the distance to rest per step
+int sim_set_membrane_tau(sim_context_t *ctx, float tau);
+
+// Queue input in mV for slots, added to their potentials in the next step.
+// Only the listed slots are touched, and in event-driven mode they become
+// active.
+int sim_inject_currents(sim_context_t *ctx, const uint32_t *slots, const float *values, uint32_t count);
+
+// Queue spike sources: in the next step the outgoing synapses of the slots
+// carry spikes as if the slots fired, without changing their own state or
+// learning traces
+int sim_inject_spikes(sim_context_t *ctx, const uint32_t *slots, uint32_t count);
+
+// Name the slots [first, first + count) as an input channel; redefining a
+// name moves its range. Returns the channel ID or -1 on failure. Channels
+// follow their neurons when other neurons are removed.
+int sim_define_input_channel(sim_context_t *ctx, const char *name, uint32_t first, uint32_t count);
+
+// Queue input currents for slots of a channel by offset into its range, or
+// for its first count slots if offsets is NULL
+int sim_inject_channel(sim_context_t *ctx, uint32_t channel, const uint32_t *offsets,
+                       const float *values, uint32_t count);
+
+// Queue spike sources of a channel by offset into its range
+int sim_inject_channel_spikes(sim_context_t *ctx, uint32_t channel, const uint32_t *offsets, uint32_t count);
+
+// Start or stop recording the spikes of every step. With max_bytes > 0
+// the raster keeps only the most recent spikes that fit in that many
+// bytes of chunks; 0 keeps all of them.
+int sim_record_spikes(sim_context_t *ctx, int enabled, size_t max_bytes);
+
+// Record only the spikes of slots in the given ranges, e.g. the slots of
+// some populations, or of every slot if num_ranges is 0. Ranges follow
+// their neurons when other neurons are removed.
+int sim_select_recording(sim_context_t *ctx, const spike_range_t *ranges, uint32_t num_ranges);
+
+// Copy the recorded raster in the export format of spike_recorder_t to
+// out if capacity suffices, and then drop it if clear is set. Returns the
+// size of the export.
+size_t sim_export_spikes(sim_context_t *ctx, uint8_t *out, size_t capacity, int clear);
+
+// Keep running statistics of the slots [first, first + count): firing
+// rate, moments of the membrane potential and synchrony, summed by the
+// step kernels. Returns the population index or -1 on failure. Ranges
+// follow their neurons when other neurons are removed.
+int sim_define_population(sim_context_t *ctx, uint32_t first, uint32_t count);
+
+// Get the statistics of a population since they were last cleared, and
+// clear them if clear is set. See sim_stats_t for their definitions.
+int sim_population_stats(sim_context_t *ctx, uint32_t population, sim_population_stats_t *out, int clear);
+
+// Drive the slots of spec's range with background input generated in the
+// step kernels, see sim_noise_spec_t. Returns the source index or -1 on
+// failure. Ranges follow their neurons when other neurons are removed.
+int sim_add_background(sim_context_t *ctx, const sim_noise_spec_t *spec);
+
+// Remove every background input
+void sim_clear_background(sim_context_t *ctx);
+
+// Set the key of the background input draws. Runs with the same seed draw
+// the same input whatever the number of workers.
+void sim_set_noise_seed(sim_context_t *ctx, uint64_t seed);
+
+// Run the slots [first, first + count) with a neuron model instead of the
+// leaky integrator, put at the model's resting state, with params in the
+// order of the model's parameter enum or NULL for its defaults. Input
+// arrives as jumps of the membrane potential in mV, as for every neuron.
+// Meant for slots that were just created: the range must not overlap
+// another model's, and the state must be in float format.
+int sim_set_neuron_model(sim_context_t *ctx, uint32_t first, uint32_t count, NeuronModelType model,
+                         const float *params);
+
+// Create the neurons of a population and select their model. Returns the
+// slot of the first neuron, or -1 if the spec is invalid or an ID is in
+// use, leaving the context unchanged.
+int sim_create_population(sim_context_t *ctx, const sim_population_spec_t *spec);
+
+// Copy the model state variables of a slot besides its potential to
+// values, in the order of the model's state names. Returns their number,
+// 0 for a leaky slot, or -1 if the slot is out of range.
+int sim_get_model_state(const sim_context_t *ctx, uint32_t slot, float *values);
+
+// Bring the state of a slot up to date with the current step
+void sim_sync_neuron(sim_context_t *ctx, uint32_t slot);
+
+// Sync a slot and make sure it is updated in the next step, e.g. after
+// its parameters changed
+void sim_touch_neuron(sim_context_t *ctx, uint32_t slot);
+
+// Reset all neurons, synapses and the simulation clock, and drop the
+// recorded spikes and population statistics
+void sim_reset(sim_context_t *ctx);
+
+// Advance the simulation by one time step. If outputs is not NULL it
+// receives the activation of every neuron, in slot order.
+int sim_step(sim_context_t *ctx, float dt, float *outputs);
+
+#endif // SIM_CONTEXT_H
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "sim_input.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Grow an array to hold at least needed elements, doubling its capacity
+static int grow(void **array, uint32_t *capacity, uint32_t needed, size_t element_size) {
+    if (needed <= *capacity) {
+        return 0;
+    }
+    
+    uint32_t new_capacity = *capacity > 0 ? *capacity : 64;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    
+    void *grown = mm_realloc(*array, (size_t)new_capacity * element_size);
+    if (!grown) {
+        log_error("Failed to grow input buffer to %u entries", new_capacity);
+        return -1;
+    }
+    
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+// Initialize an empty input buffer without channels
+int sim_input_init(sim_input_t *input) {
+    if (!input) {
+        return -1;
+    }
+    
+    memset(input, 0, sizeof(sim_input_t));
+    return 0;
+}
+
+// Free pending input and channels
+void sim_input_free(sim_input_t *input) {
+    if (!input) return;
+    
+    mm_free(input->currents);
+    mm_free(input->spikes);
+    mm_free(input->channels);
+    memset(input, 0, sizeof(sim_input_t));
+}
+
+// Drop pending input; channels are kept
+void sim_input_clear(sim_input_t *input) {
+    if (!input) return;
+    
+    input->num_currents = 0;
+    input->num_spikes = 0;
+}
+
+// Whether every offset (or 0..count-1 if offsets is NULL) is below limit
+static int offsets_valid(const uint32_t *offsets, uint32_t count, uint32_t limit) {
+    if (!offsets) {
+        return count <= limit;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (offsets[i] >= limit) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Queue input currents for slots base + offsets[i], or base + i if offsets
+// is NULL. Offsets must be below limit; otherwise nothing is queued.
+int sim_input_add_currents(sim_input_t *input, uint32_t base, uint32_t limit,
+                           const uint32_t *offsets, const float *values, uint32_t count) {
+    if (!input || (count > 0 && !values) || !offsets_valid(offsets, count, limit)) {
+        log_error("Invalid input currents");
+        return -1;
+    }
+    
+    if (grow((void **)&input->currents, &input->current_capacity,
+             input->num_currents + count, sizeof(sim_current_t)) != 0) {
+        return -1;
+    }
+    
+    sim_current_t *out = input->currents + input->num_currents;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i].slot = base + (offsets ? offsets[i] : i);
+        out[i].value = values[i];
+    }
+    input->num_currents += count;
+    return 0;
+}
+
+// Queue spike sources at slots base + offsets[i]. Offsets must be below
+// limit; otherwise nothing is queued.
+int sim_input_add_spikes(sim_input_t *input, uint32_t base, uint32_t limit,
+                         const uint32_t *offsets, uint32_t count) {
+    if (!input || (count > 0 && !offsets) || !offsets_valid(offsets, count, limit)) {
+        log_error("Invalid input spikes");
+        return -1;
+    }
+    
+    if (grow((void **)&input->spikes, &input->spike_capacity,
+             input->num_spikes + count, sizeof(uint32_t)) != 0) {
+        return -1;
+    }
+    
+    uint32_t *out = input->spikes + input->num_spikes;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = base + offsets[i];
+    }
+    input->num_spikes += count;
+    return 0;
+}
+
+// Map a name to a range of slots; redefining a name moves its range.
+// Returns the channel ID or -1 on failure.
+int sim_input_define_channel(sim_input_t *input, const char *name, uint32_t first, uint32_t count) {
+    if (!input || !name || name[0] == '\0' || strlen(name) >= SIM_INPUT_NAME_MAX) {
+        log_error("Invalid input channel name");
+        return -1;
+    }
+    
+    int channel = sim_input_find_channel(input, name);
+    if (channel < 0) {
+        if (grow((void **)&input->channels, &input->channel_capacity,
+                 input->num_channels + 1, sizeof(sim_input_channel_t)) != 0) {
+            return -1;
+        }
+        channel = (int)input->num_channels++;
+        memset(&input->channels[channel], 0, sizeof(sim_input_channel_t));
+        strcpy(input->channels[channel].name, name);
+    }
+    
+    input->channels[channel].first = first;
+    input->channels[channel].count = count;
+    return channel;
+}
+
+// Channel ID of a name, or -1 if it is not defined
+int sim_input_find_channel(const sim_input_t *input, const char *name) {
+    if (!input || !name) {
+        return -1;
+    }
+    
+    for (uint32_t c = 0; c < input->num_channels; c++) {
+        if (strcmp(input->channels[c].name, name) == 0) {
+            return (int)c;
+        }
+    }
+    
+    return -1;
+}
+
+// Follow the removal of a slot: later slots move down by one, pending
+// input for the slot is dropped and channels keep their neurons
+void sim_input_remove_slot(sim_input_t *input, uint32_t slot) {
+    if (!input) return;
+    
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < input->num_currents; i++) {
+        sim_current_t current = input->currents[i];
+        if (current.slot == slot) continue;
+        if (current.slot > slot) current.slot--;
+        input->currents[kept++] = current;
+    }
+    input->num_currents = kept;
+    
+    kept = 0;
+    for (uint32_t i = 0; i < input->num_spikes; i++) {
+        uint32_t source = input->spikes[i];
+        if (source == slot) continue;
+        input->spikes[kept++] = source > slot ? source - 1 : source;
+    }
+    input->num_spikes = kept;
+    
+    for (uint32_t c = 0; c < input->num_channels; c++) {
+        sim_input_channel_t *channel = &input->channels[c];
+        if (slot < channel->first) {
+            channel->first--;
+        } else if (slot - channel->first < channel->count) {
+            channel->count--;
+        }
+    }
+}
+
+// Point pending input at the new slots, slot_map[old]. Channel ranges are
+// left alone, as a permutation does not keep them contiguous.
+void sim_input_remap_slots(sim_input_t *input, const uint32_t *slot_map) {
+    if (!input || !slot_map) return;
+    
+    for (uint32_t i = 0; i < input->num_currents; i++) {
+        input->currents[i].slot = slot_map[input->currents[i].slot];
+    }
+    for (uint32_t i = 0; i < input->num_spikes; i++) {
+        input->spikes[i] = slot_map[input->spikes[i]];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef SIM_INPUT_H
+#define SIM_INPUT_H
+
+#include <stdint.h>
+
+// Maximum length of an input channel name, including the terminator
+#define SIM_INPUT_NAME_MAX 32
+
+// Input current for one population slot
+typedef struct {
+    uint32_t slot;               // Target slot
+    float value;                 // Input in mV added in the next step
+} sim_current_t;
+
+// Named input channel: a contiguous range of slots fed by one stream.
+// Channel offsets index into the range.
+typedef struct {
+    char name[SIM_INPUT_NAME_MAX];
+    uint32_t first;              // First slot
+    uint32_t count;              // Number of slots
+} sim_input_channel_t;
+
+// Sparse input injected between steps. Only the touched slots are
+// recorded; the next step scatters the currents into the spike wheel as
+// input due in that step and delivers the spike sources over their
+// outgoing synapses.
+typedef struct {
+    sim_current_t *currents;     // Pending currents
+    uint32_t num_currents;       // Number of pending currents
+    uint32_t current_capacity;   // Capacity of currents
+    uint32_t *spikes;            // Pending spike sources
+    uint32_t num_spikes;         // Number of pending spike sources
+    uint32_t spike_capacity;     // Capacity of spikes
+    sim_input_channel_t *channels; // Channels, indexed by channel ID
+    uint32_t num_channels;       // Number of channels
+    uint32_t channel_capacity;   // Capacity of channels
+} sim_input_t;
+
+// Function declarations
+int sim_input_init(sim_input_t *input);
+void sim_input_free(sim_input_t *input);
+void sim_input_clear(sim_input_t *input);
+int sim_input_add_currents(sim_input_t *input, uint32_t base, uint32_t limit,
+                           const uint32_t *offsets, const float *values, uint32_t count);
+int sim_input_add_spikes(sim_input_t *input, uint32_t base, uint32_t limit,
+                         const uint32_t *offsets, uint32_t count);
+int sim_input_define_channel(sim_input_t *input, const char *name, uint32_t first, uint32_t count);
+int sim_input_find_channel(const sim_input_t *input, const char *name);
+void sim_input_remove_slot(sim_input_t *input, uint32_t slot);
+void sim_input_remap_slots(sim_input_t *input, const uint32_t *slot_map);
+
+#endif // SIM_INPUT_H
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include "sim_noise.h"
+#include "../utils/rng.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NOISE_X86 1
+#endif
+
+// Initialize without sources
+int sim_noise_init(sim_noise_t *noise) {
+    if (!noise) {
+        return -1;
+    }
+    
+    memset(noise, 0, sizeof(sim_noise_t));
+    return 0;
+}
+
+// Free the sources
+void sim_noise_free(sim_noise_t *noise) {
+    if (!noise) return;
+    
+    mm_free(noise->sources);
+    memset(noise, 0, sizeof(sim_noise_t));
+}
+
+// Add a source. Returns its index or -1 on failure.
+int sim_noise_add(sim_noise_t *noise, const sim_noise_spec_t *spec) {
+    if (!noise || !spec || spec->count == 0 || spec->first > UINT32_MAX - spec->count ||
+        (spec->kind != SIM_NOISE_POISSON && spec->kind != SIM_NOISE_GAUSSIAN) ||
+        !(spec->rate >= 0.0f) || !(spec->sigma >= 0.0f)) {
+        log_error("Invalid background input");
+        return -1;
+    }
+    
+    if (noise->num_sources >= noise->source_capacity) {
+        uint32_t capacity = noise->source_capacity > 0 ? noise->source_capacity * 2 : 4;
+        sim_noise_source_t *grown = (sim_noise_source_t *)mm_realloc(noise->sources,
+                                                                     capacity * sizeof(sim_noise_source_t));
+        if (!grown) {
+            log_error("Failed to grow background inputs");
+            return -1;
+        }
+        noise->sources = grown;
+        noise->source_capacity = capacity;
+    }
+    
+    sim_noise_source_t *source = &noise->sources[noise->num_sources];
+    memset(source, 0, sizeof(sim_noise_source_t));
+    source->spec = *spec;
+    
+    // Draw parameters are derived for the next step's dt
+    noise->dt = 0.0f;
+    return (int)noise->num_sources++;
+}
+
+// Drop every source
+void sim_noise_clear(sim_noise_t *noise) {
+    if (!noise) return;
+    
+    noise->num_sources = 0;
+}
+
+// Derive the draw parameters of a source for a time step
+static void prepare_source(sim_noise_source_t *source, float dt) {
+    const sim_noise_spec_t *spec = &source->spec;
+    source->num_cdf = 0;
+    
+    if (spec->kind == SIM_NOISE_GAUSSIAN) {
+        source->gaussian = 1;
+        source->shift = spec->mean * dt;
+        source->scale = spec->sigma * sqrtf(dt);
+        return;
+    }
+    
+    // Events in a step are Poisson with mean lambda; a uniform word counts
+    // the table entries it exceeds, which has exactly that distribution up
+    // to the 32-bit resolution of the table
+    double lambda = (double)spec->rate * dt * 0.001;
+    double term = exp(-lambda);
+    double cdf = term;
+    source->gaussian = 0;
+    source->shift = 0.0f;
+    source->scale = spec->weight;
+    
+    for (uint32_t k = 0; k < SIM_NOISE_MAX_EVENTS; k++) {
+        double scaled = floor(cdf * 4294967296.0);
+        if (scaled >= 4294967295.0) {
+            return;
+        }
+        source->cdf[source->num_cdf++] = (uint32_t)scaled;
+        term *= lambda / (k + 1);
+        cdf += term;
+    }
+    
+    // The tail does not fit the table, so the rate is high enough for the
+    // Gaussian limit
+    source->num_cdf = 0;
+    source->gaussian = 1;
+    source->shift = (float)(lambda * spec->weight);
+    source->scale = (float)(sqrt(lambda) * spec->weight);
+}
+
+// Derive the draw parameters of every source for a time step
+void sim_noise_prepare(sim_noise_t *noise, float dt) {
+    if (!noise || noise->dt == dt) return;
+    
+    for (uint32_t i = 0; i < noise->num_sources; i++) {
+        prepare_source(&noise->sources[i], dt);
+    }
+    noise->dt = dt;
+}
+
+// First two words of the blocks of counters (first + i, step, source)
+static void philox_words(uint64_t key, uint32_t first, uint32_t count, uint64_t step,
+                         uint32_t source, uint32_t *w0, uint32_t *w1) {
+    for (uint32_t i = 0; i < count; i++) {
+        rng_block_t block = rng_philox(first + i, (uint32_t)step, (uint32_t)(step >> 32), source, key);
+        w0[i] = block.v[0];
+        w1[i] = block.v[1];
+    }
+}
+
+#ifdef NOISE_X86
+
+// Low and high words of the 32 x 32-bit products of 8 lanes with m
+__attribute__((target("avx2")))
+static inline void mulhilo_avx2(__m256i x, __m256i m, __m256i *lo, __m256i *hi) {
+    __m256i even = _mm256_mul_epu32(x, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m);
+    *lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// philox_words on 8 counters at a time, same bits as rng_philox
+__attribute__((target("avx2")))
+static void philox_words_avx2(uint64_t key, uint32_t first, uint32_t count, uint64_t step,
+                              uint32_t source, uint32_t *w0, uint32_t *w1) {
+    const __m256i m0 = _mm256_set1_epi32((int)RNG_PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi32((int)RNG_PHILOX_M1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    uint32_t i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32((int)(first + i)), lanes);
+        __m256i c1 = _mm256_set1_epi32((int)(uint32_t)step);
+        __m256i c2 = _mm256_set1_epi32((int)(uint32_t)(step >> 32));
+        __m256i c3 = _mm256_set1_epi32((int)source);
+        uint32_t k0 = (uint32_t)key;
+        uint32_t k1 = (uint32_t)(key >> 32);
+        
+        for (int round = 0; round < RNG_PHILOX_ROUNDS; round++) {
+            __m256i lo0, hi0, lo1, hi1;
+            mulhilo_avx2(c0, m0, &lo0, &hi0);
+            mulhilo_avx2(c2, m1, &lo1, &hi1);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32((int)k0));
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32((int)k1));
+            c1 = lo1;
+            c3 = lo0;
+            k0 += RNG_PHILOX_W0;
+            k1 += RNG_PHILOX_W1;
+        }
+        
+        _mm256_storeu_si256((__m256i *)(w0 + i), c0);
+        _mm256_storeu_si256((__m256i *)(w1 + i), c1);
+    }
+    
+    // Leave the upper register halves clean for the SSE code that follows
+    _mm256_zeroupper();
+    philox_words(key, first + i, count - i, step, source, w0 + i, w1 + i);
+}
+
+#endif
+
+// Draw the input of source for the slots [begin, end) in a step into
+// values; the slots must lie in the source's range and number at most
+// SIM_NOISE_BLOCK
+void sim_noise_draw(const sim_noise_t *noise, uint32_t source, uint64_t step,
+                    uint32_t begin, uint32_t end, float *values) {
+    const sim_noise_source_t *src = &noise->sources[source];
+    uint32_t count = end - begin;
+    uint32_t w0[SIM_NOISE_BLOCK];
+    uint32_t w1[SIM_NOISE_BLOCK];
+
+#ifdef NOISE_X86
+    if (__builtin_cpu_supports("avx2")) {
+        philox_words_avx2(noise->seed, begin, count, step, source, w0, w1);
+    } else {
+        philox_words(noise->seed, begin, count, step, source, w0, w1);
+    }
+#else
+    philox_words(noise->seed, begin, count, step, source, w0, w1);
+#endif
+    
+    if (src->gaussian) {
+        // Box-Muller on the first two words
+        for (uint32_t i = 0; i < count; i++) {
+            float radius = sqrtf(-2.0f * logf(rng_unit(w0[i])));
+            float z = radius * cosf(6.28318531f * rng_unit(w1[i]));
+            values[i] = src->shift + src->scale * z;
+        }
+        return;
+    }
+    
+    // Count the table entries below each word, one entry at a time so the
+    // compares run across slots
+    uint32_t events[SIM_NOISE_BLOCK];
+    memset(events, 0, count * sizeof(uint32_t));
+    for (uint32_t k = 0; k < src->num_cdf; k++) {
+        uint32_t threshold = src->cdf[k];
+        for (uint32_t i = 0; i < count; i++) {
+            events[i] += w0[i] > threshold;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        values[i] = (float)events[i] * src->scale;
+    }
+}
+
+// Keep the source ranges on their neurons when a slot is removed
+void sim_noise_remove_slot(sim_noise_t *noise, uint32_t slot) {
+    if (!noise) return;
+    
+    for (uint32_t i = 0; i < noise->num_sources; i++) {
+        sim_noise_spec_t *spec = &noise->sources[i].spec;
+        if (slot < spec->first) {
+            spec->first--;
+        } else if (slot - spec->first < spec->count) {
+            spec->count--;
+        }
+    }
+}
\ No newline at end of file
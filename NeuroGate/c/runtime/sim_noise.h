@@ -0,0 +1,64 @@
+#ifndef SIM_NOISE_H
+#define SIM_NOISE_H
+
+#include <stdint.h>
+
+// Slots drawn per call of sim_noise_draw
+#define SIM_NOISE_BLOCK 256
+
+// Longest Poisson table; rates with a longer tail are drawn as Gaussian
+#define SIM_NOISE_MAX_EVENTS 32
+
+// Kinds of background input
+typedef enum {
+    SIM_NOISE_POISSON,           // Independent input events arriving at a fixed rate
+    SIM_NOISE_GAUSSIAN           // White-noise current with a drift
+} sim_noise_kind_t;
+
+// Background input of a contiguous range of slots. A Poisson source gives
+// every slot events at rate Hz, each adding weight mV; a Gaussian source
+// adds mean * dt + sigma * sqrt(dt) * z per step with z standard normal,
+// so its statistics do not depend on dt.
+typedef struct {
+    sim_noise_kind_t kind;
+    uint32_t first;              // First slot
+    uint32_t count;              // Number of slots
+    float rate;                  // Poisson: events per slot per second
+    float weight;                // Poisson: input per event in mV
+    float mean;                  // Gaussian: drift in mV per ms
+    float sigma;                 // Gaussian: noise in mV per sqrt(ms)
+} sim_noise_spec_t;
+
+// Source with its per-dt draw parameters
+typedef struct {
+    sim_noise_spec_t spec;
+    uint32_t cdf[SIM_NOISE_MAX_EVENTS]; // Poisson: P(events <= k) scaled to 32 bits
+    uint32_t num_cdf;            // Poisson: table entries below 1
+    int gaussian;                // Draws shift + scale * z; Poisson rates beyond the table
+    float shift;                 // Input per step at z = 0
+    float scale;                 // Input per step per unit of z, or per Poisson event
+} sim_noise_source_t;
+
+// Background input generated inside the step. The value of slot s from
+// source i in step t is drawn from the Philox block of counter (s, t, i)
+// under the seed, so it does not depend on the number of workers or the
+// order in which partitions run.
+typedef struct {
+    sim_noise_source_t *sources; // Sources, by index
+    uint32_t num_sources;        // Number of sources
+    uint32_t source_capacity;    // Capacity of sources
+    uint64_t seed;               // Key of every draw
+    float dt;                    // Time step of the draw parameters
+} sim_noise_t;
+
+// Function declarations
+int sim_noise_init(sim_noise_t *noise);
+void sim_noise_free(sim_noise_t *noise);
+int sim_noise_add(sim_noise_t *noise, const sim_noise_spec_t *spec);
+void sim_noise_clear(sim_noise_t *noise);
+void sim_noise_prepare(sim_noise_t *noise, float dt);
+void sim_noise_draw(const sim_noise_t *noise, uint32_t source, uint64_t step,
+                    uint32_t begin, uint32_t end, float *values);
+void sim_noise_remove_slot(sim_noise_t *noise, uint32_t slot);
+
+#endif // SIM_NOISE_H
\ No newline at end of file
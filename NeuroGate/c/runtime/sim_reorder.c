@@ -0,0 +1,249 @@
+#include "sim_reorder.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Undirected adjacency of the slots, without self loops. Parallel
+// synapses appear as repeated neighbors.
+typedef struct {
+    uint64_t *offsets;           // Neighbor list start per slot (count + 1 entries)
+    uint32_t *neighbors;         // Neighbor slots
+    uint32_t count;              // Number of slots
+} reorder_graph_t;
+
+// Slots of synapse i, records first and then bulk synapses. Returns 0 if
+// the synapse joins two distinct existing neurons.
+static int edge_slots(const sim_context_t *ctx, uint32_t i, uint32_t *pre, uint32_t *post) {
+    if (i >= ctx->synapse_count) {
+        *pre = ctx->bulk.pre[i - ctx->synapse_count];
+        *post = ctx->bulk.post[i - ctx->synapse_count];
+        return *pre == *post ? -1 : 0;
+    }
+    
+    const Synapse *synapse = ctx->synapses[i];
+    if (!synapse) {
+        return -1;
+    }
+    
+    int a = sim_find_neuron(ctx, synapse->pre_neuron_id);
+    int b = sim_find_neuron(ctx, synapse->post_neuron_id);
+    if (a < 0 || b < 0 || a == b) {
+        return -1;
+    }
+    *pre = (uint32_t)a;
+    *post = (uint32_t)b;
+    return 0;
+}
+
+// Collect the neighbors of every slot with a counting sort
+static int build_graph(const sim_context_t *ctx, reorder_graph_t *graph) {
+    uint32_t n = ctx->neuron_count;
+    uint64_t num_synapses = (uint64_t)ctx->synapse_count + ctx->bulk.count;
+    uint32_t pre;
+    uint32_t post;
+    
+    graph->count = n;
+    graph->neighbors = NULL;
+    graph->offsets = (uint64_t *)mm_alloc(((size_t)n + 1) * sizeof(uint64_t));
+    if (!graph->offsets) {
+        return -1;
+    }
+    
+    memset(graph->offsets, 0, ((size_t)n + 1) * sizeof(uint64_t));
+    for (uint64_t i = 0; i < num_synapses; i++) {
+        if (edge_slots(ctx, (uint32_t)i, &pre, &post) == 0) {
+            graph->offsets[pre + 1]++;
+            graph->offsets[post + 1]++;
+        }
+    }
+    for (uint32_t v = 0; v < n; v++) {
+        graph->offsets[v + 1] += graph->offsets[v];
+    }
+    
+    graph->neighbors = (uint32_t *)mm_alloc((size_t)graph->offsets[n] * sizeof(uint32_t) + 1);
+    if (!graph->neighbors) {
+        mm_free(graph->offsets);
+        return -1;
+    }
+    
+    // offsets[v] serves as the cursor of slot v and is shifted back after
+    for (uint64_t i = 0; i < num_synapses; i++) {
+        if (edge_slots(ctx, (uint32_t)i, &pre, &post) == 0) {
+            graph->neighbors[graph->offsets[pre]++] = post;
+            graph->neighbors[graph->offsets[post]++] = pre;
+        }
+    }
+    memmove(&graph->offsets[1], &graph->offsets[0], (size_t)n * sizeof(uint64_t));
+    graph->offsets[0] = 0;
+    return 0;
+}
+
+// Degree of a slot
+static inline uint64_t degree(const reorder_graph_t *graph, uint32_t v) {
+    return graph->offsets[v + 1] - graph->offsets[v];
+}
+
+// Compare two (degree, slot) keys for qsort
+static int compare_keys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sort the slots by ascending degree, ties by slot, with a counting sort
+static int sort_by_degree(const reorder_graph_t *graph, uint32_t *sorted) {
+    uint32_t n = graph->count;
+    uint64_t max_degree = 0;
+    for (uint32_t v = 0; v < n; v++) {
+        uint64_t d = degree(graph, v);
+        max_degree = d > max_degree ? d : max_degree;
+    }
+    
+    uint32_t *starts = (uint32_t *)mm_alloc((size_t)(max_degree + 2) * sizeof(uint32_t));
+    if (!starts) {
+        return -1;
+    }
+    
+    memset(starts, 0, (size_t)(max_degree + 2) * sizeof(uint32_t));
+    for (uint32_t v = 0; v < n; v++) {
+        starts[degree(graph, v) + 1]++;
+    }
+    for (uint64_t d = 0; d <= max_degree; d++) {
+        starts[d + 1] += starts[d];
+    }
+    for (uint32_t v = 0; v < n; v++) {
+        sorted[starts[degree(graph, v)]++] = v;
+    }
+    
+    mm_free(starts);
+    return 0;
+}
+
+// Visit the new neighbors of a slot, order[first..tail), by ascending
+// degree
+static int sort_new_neighbors(const reorder_graph_t *graph, uint32_t *order, uint32_t first, uint32_t tail,
+                              uint64_t **keys, uint32_t *key_capacity) {
+    uint32_t added = tail - first;
+    if (added > *key_capacity) {
+        uint64_t *grown = (uint64_t *)mm_realloc(*keys, (size_t)added * sizeof(uint64_t));
+        if (!grown) {
+            return -1;
+        }
+        *keys = grown;
+        *key_capacity = added;
+    }
+    
+    for (uint32_t k = 0; k < added; k++) {
+        uint32_t u = order[first + k];
+        (*keys)[k] = (degree(graph, u) << 32) | u;
+    }
+    qsort(*keys, added, sizeof(uint64_t), compare_keys);
+    for (uint32_t k = 0; k < added; k++) {
+        order[first + k] = (uint32_t)(*keys)[k];
+    }
+    return 0;
+}
+
+// Walk every component breadth first into order, starting each from its
+// unvisited slot of lowest degree; starts lists the slots by degree. RCM
+// visits the new neighbors of a slot by ascending degree and reverses the
+// walk at the end.
+static int walk(const reorder_graph_t *graph, sim_order_t method, const uint32_t *starts,
+                uint8_t *visited, uint32_t *order) {
+    uint32_t n = graph->count;
+    uint64_t *keys = NULL;
+    uint32_t key_capacity = 0;
+    int status = 0;
+    
+    memset(visited, 0, n);
+    uint32_t tail = 0;
+    for (uint32_t s = 0; s < n && status == 0; s++) {
+        if (visited[starts[s]]) continue;
+        
+        visited[starts[s]] = 1;
+        order[tail++] = starts[s];
+        
+        // The walk itself is the queue
+        for (uint32_t head = tail - 1; head < tail && status == 0; head++) {
+            uint32_t v = order[head];
+            uint32_t first = tail;
+            
+            for (uint64_t e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+                uint32_t u = graph->neighbors[e];
+                if (!visited[u]) {
+                    visited[u] = 1;
+                    order[tail++] = u;
+                }
+            }
+            
+            if (method == SIM_ORDER_RCM && tail - first > 1) {
+                status = sort_new_neighbors(graph, order, first, tail, &keys, &key_capacity);
+            }
+        }
+    }
+    mm_free(keys);
+    
+    if (status == 0 && method == SIM_ORDER_RCM) {
+        for (uint32_t i = 0; i < n / 2; i++) {
+            uint32_t swap = order[i];
+            order[i] = order[n - 1 - i];
+            order[n - 1 - i] = swap;
+        }
+    }
+    return status;
+}
+
+// Compute a locality-improving order of the slots
+int sim_compute_order(sim_context_t *ctx, sim_order_t method, uint32_t *order) {
+    if (!ctx || !order || (method != SIM_ORDER_RCM && method != SIM_ORDER_BFS)) {
+        log_error("Invalid parameters for sim_compute_order");
+        return -1;
+    }
+    
+    reorder_graph_t graph;
+    if (build_graph(ctx, &graph) != 0) {
+        log_error("Failed to allocate the neuron graph");
+        return -1;
+    }
+    
+    uint32_t *starts = (uint32_t *)mm_alloc((size_t)graph.count * sizeof(uint32_t) + 1);
+    uint8_t *visited = (uint8_t *)mm_alloc((size_t)graph.count + 1);
+    int status = -1;
+    if (starts && visited && sort_by_degree(&graph, starts) == 0) {
+        status = walk(&graph, method, starts, visited, order);
+    }
+    if (status != 0) {
+        log_error("Failed to allocate the neuron order");
+    }
+    
+    mm_free(starts);
+    mm_free(visited);
+    mm_free(graph.offsets);
+    mm_free(graph.neighbors);
+    return status;
+}
+
+// Reorder the neurons for locality
+int sim_reorder_neurons(sim_context_t *ctx, sim_order_t method) {
+    if (!ctx) {
+        return -1;
+    }
+    
+    uint32_t *order = (uint32_t *)mm_alloc((size_t)ctx->neuron_count * sizeof(uint32_t) + 1);
+    if (!order) {
+        log_error("Failed to allocate the neuron order");
+        return -1;
+    }
+    
+    int status = sim_compute_order(ctx, method, order);
+    if (status == 0) {
+        status = sim_permute_neurons(ctx, order);
+    }
+    
+    mm_free(order);
+    if (status == 0) {
+        log_info("Reordered %u neurons", ctx->neuron_count);
+    }
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef SIM_REORDER_H
+#define SIM_REORDER_H
+
+#include <stdint.h>
+#include "sim_context.h"
+
+// Slot orders that keep connected neurons close together
+typedef enum {
+    SIM_ORDER_RCM,               // Reverse Cuthill-McKee: breadth first, lowest degree first
+    SIM_ORDER_BFS                // Breadth first in slot order, cheaper on large networks
+} sim_order_t;
+
+// Compute a locality-improving order of the slots from the synapses,
+// treated as undirected edges: each connected component is walked breadth
+// first from a neuron of lowest degree, so neurons sit near the sources
+// that deliver to them and delivery writes stay within a few pages.
+// order[i] receives the current slot of the neuron that should move to
+// slot i.
+int sim_compute_order(sim_context_t *ctx, sim_order_t method, uint32_t *order);
+
+// Compute an order and move the neurons to it with sim_permute_neurons.
+// Run after the network is built; IDs keep their neurons.
+int sim_reorder_neurons(sim_context_t *ctx, sim_order_t method);
+
+#endif // SIM_REORDER_H
\ No newline at end of file
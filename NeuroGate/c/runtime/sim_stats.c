@@ -0,0 +1,294 @@
+#include "sim_stats.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Initialize without monitored populations
+int sim_stats_init(sim_stats_t *stats, uint32_t num_partitions) {
+    if (!stats || num_partitions == 0) {
+        return -1;
+    }
+    
+    memset(stats, 0, sizeof(sim_stats_t));
+    stats->num_partitions = num_partitions;
+    return 0;
+}
+
+// Free populations and segments
+void sim_stats_free(sim_stats_t *stats) {
+    if (!stats) return;
+    
+    mm_free(stats->populations);
+    mm_free(stats->bounds);
+    mm_free(stats->segments);
+    memset(stats, 0, sizeof(sim_stats_t));
+}
+
+// Drop the running statistics of a population; its range is kept
+static void reset_population(sim_stats_pop_t *pop) {
+    pop->steps = 0;
+    pop->sampled_steps = 0;
+    pop->spikes = 0;
+    pop->spikes_sq = 0.0;
+    pop->elapsed = 0.0;
+    pop->mean_sum = 0.0;
+    pop->mean_sq_sum = 0.0;
+    pop->square_sum = 0.0;
+    pop->last_mean = 0.0f;
+    pop->last_var = 0.0f;
+}
+
+// Drop the running statistics of every population
+void sim_stats_clear(sim_stats_t *stats) {
+    if (!stats) return;
+    
+    for (uint32_t i = 0; i < stats->num_populations; i++) {
+        reset_population(&stats->populations[i]);
+    }
+}
+
+// Monitor the slots [first, first + count). Returns the population index
+// or -1 on failure.
+int sim_stats_define(sim_stats_t *stats, uint32_t first, uint32_t count) {
+    if (!stats || count == 0 || first > UINT32_MAX - count) {
+        log_error("Invalid population range");
+        return -1;
+    }
+    
+    if (stats->num_populations >= stats->population_capacity) {
+        uint32_t capacity = stats->population_capacity > 0 ? stats->population_capacity * 2 : 8;
+        sim_stats_pop_t *grown = (sim_stats_pop_t *)mm_realloc(stats->populations,
+                                                               capacity * sizeof(sim_stats_pop_t));
+        if (!grown) {
+            log_error("Failed to grow population statistics");
+            return -1;
+        }
+        stats->populations = grown;
+        stats->population_capacity = capacity;
+    }
+    
+    sim_stats_pop_t *pop = &stats->populations[stats->num_populations];
+    memset(pop, 0, sizeof(sim_stats_pop_t));
+    pop->first = first;
+    pop->count = count;
+    stats->dirty = 1;
+    return (int)stats->num_populations++;
+}
+
+// Compare two boundaries for qsort
+static int compare_bounds(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Index of the first boundary not below slot
+static uint32_t lower_bound(const uint32_t *bounds, uint32_t num_bounds, uint32_t slot) {
+    uint32_t low = 0;
+    uint32_t high = num_bounds;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (bounds[mid] < slot) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Cut the slots at every range boundary and map each population to the
+// segments it covers
+static int build_segments(sim_stats_t *stats) {
+    uint32_t *bounds = (uint32_t *)mm_realloc(stats->bounds, 2 * stats->num_populations * sizeof(uint32_t));
+    if (!bounds) {
+        log_error("Failed to allocate population boundaries");
+        return -1;
+    }
+    stats->bounds = bounds;
+    
+    uint32_t num_bounds = 0;
+    for (uint32_t i = 0; i < stats->num_populations; i++) {
+        const sim_stats_pop_t *pop = &stats->populations[i];
+        if (pop->count > 0) {
+            bounds[num_bounds++] = pop->first;
+            bounds[num_bounds++] = pop->first + pop->count;
+        }
+    }
+    qsort(bounds, num_bounds, sizeof(uint32_t), compare_bounds);
+    
+    uint32_t distinct = 0;
+    for (uint32_t i = 0; i < num_bounds; i++) {
+        if (distinct == 0 || bounds[i] != bounds[distinct - 1]) {
+            bounds[distinct++] = bounds[i];
+        }
+    }
+    stats->num_bounds = distinct;
+    
+    for (uint32_t i = 0; i < stats->num_populations; i++) {
+        sim_stats_pop_t *pop = &stats->populations[i];
+        pop->segment_begin = lower_bound(bounds, distinct, pop->first);
+        pop->segment_end = pop->count > 0 ? lower_bound(bounds, distinct, pop->first + pop->count)
+                                          : pop->segment_begin;
+    }
+    
+    uint32_t needed = stats->num_partitions * sim_stats_num_segments(stats);
+    if (needed > stats->segment_capacity) {
+        sim_stats_segment_t *segments = (sim_stats_segment_t *)mm_realloc(stats->segments,
+                                                                          needed * sizeof(sim_stats_segment_t));
+        if (!segments) {
+            log_error("Failed to allocate population segments");
+            return -1;
+        }
+        stats->segments = segments;
+        stats->segment_capacity = needed;
+    }
+    
+    stats->dirty = 0;
+    return 0;
+}
+
+// Rebuild the segments after ranges changed and zero the per-step sums.
+// Runs before the workers of a step start.
+int sim_stats_prepare(sim_stats_t *stats) {
+    if (stats->dirty && build_segments(stats) != 0) {
+        return -1;
+    }
+    
+    if (stats->segments) {
+        memset(stats->segments, 0, (size_t)stats->num_partitions * sim_stats_num_segments(stats) *
+                                       sizeof(sim_stats_segment_t));
+    }
+    return 0;
+}
+
+// Segment of a slot, or SIM_STATS_NONE outside all segments. next receives
+// the first boundary above the slot, where the segment ends, or
+// UINT32_MAX if there is none.
+uint32_t sim_stats_locate(const sim_stats_t *stats, uint32_t slot, uint32_t *next) {
+    uint32_t k = lower_bound(stats->bounds, stats->num_bounds, slot + 1);
+    
+    // k boundaries are at or below the slot
+    *next = k < stats->num_bounds ? stats->bounds[k] : UINT32_MAX;
+    return k > 0 && k < stats->num_bounds ? k - 1 : SIM_STATS_NONE;
+}
+
+// Count the spikes of an unsorted list of fired slots into the row of a
+// partition, for steps that do not split their kernel calls
+void sim_stats_count_spikes(sim_stats_t *stats, uint32_t partition, const uint32_t *slots, uint32_t count) {
+    sim_stats_segment_t *row = sim_stats_row(stats, partition);
+    uint32_t next;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t segment = sim_stats_locate(stats, slots[i], &next);
+        if (segment != SIM_STATS_NONE) {
+            row[segment].fired++;
+        }
+    }
+}
+
+// Fold the rows of a step into the running statistics of every population.
+// sampled is set when the rows hold the moments of all slots.
+void sim_stats_finish_step(sim_stats_t *stats, float dt, int sampled) {
+    uint32_t num_segments = sim_stats_num_segments(stats);
+    sim_stats_segment_t *total = stats->segments;
+    
+    for (uint32_t p = 1; p < stats->num_partitions; p++) {
+        const sim_stats_segment_t *row = sim_stats_row(stats, p);
+        for (uint32_t k = 0; k < num_segments; k++) {
+            total[k].moments.sum += row[k].moments.sum;
+            total[k].moments.sum_sq += row[k].moments.sum_sq;
+            total[k].fired += row[k].fired;
+        }
+    }
+    
+    for (uint32_t i = 0; i < stats->num_populations; i++) {
+        sim_stats_pop_t *pop = &stats->populations[i];
+        PopulationMoments moments = { 0.0, 0.0 };
+        uint64_t fired = 0;
+    
+        for (uint32_t k = pop->segment_begin; k < pop->segment_end; k++) {
+            moments.sum += total[k].moments.sum;
+            moments.sum_sq += total[k].moments.sum_sq;
+            fired += total[k].fired;
+        }
+    
+        pop->steps++;
+        pop->elapsed += dt;
+        pop->spikes += fired;
+        pop->spikes_sq += (double)fired * (double)fired;
+    
+        if (sampled && pop->count > 0) {
+            double mean = moments.sum / pop->count;
+            double square = moments.sum_sq / pop->count;
+            pop->sampled_steps++;
+            pop->mean_sum += mean;
+            pop->mean_sq_sum += mean * mean;
+            pop->square_sum += square;
+            pop->last_mean = (float)mean;
+            pop->last_var = (float)(square > mean * mean ? square - mean * mean : 0.0);
+        }
+    }
+}
+
+// Report the statistics of a population since the last collection, and
+// start a new interval if clear is set
+int sim_stats_collect(sim_stats_t *stats, uint32_t population, sim_population_stats_t *out, int clear) {
+    if (!stats || !out || population >= stats->num_populations) {
+        log_error("Unknown population %u", population);
+        return -1;
+    }
+    
+    sim_stats_pop_t *pop = &stats->populations[population];
+    memset(out, 0, sizeof(sim_population_stats_t));
+    out->first = pop->first;
+    out->count = pop->count;
+    out->steps = pop->steps;
+    out->sampled_steps = pop->sampled_steps;
+    out->spikes = pop->spikes;
+    out->last_mean = pop->last_mean;
+    out->last_var = pop->last_var;
+    
+    if (pop->count > 0 && pop->elapsed > 0.0) {
+        out->rate = (float)(pop->spikes * 1000.0 / (pop->count * pop->elapsed));
+    }
+    
+    if (pop->spikes > 0) {
+        double mean = (double)pop->spikes / pop->steps;
+        double var = pop->spikes_sq / pop->steps - mean * mean;
+        out->spike_fano = (float)(var > 0.0 ? var / mean : 0.0);
+    }
+    
+    if (pop->sampled_steps > 0) {
+        double mean = pop->mean_sum / pop->sampled_steps;
+        double total = pop->square_sum / pop->sampled_steps - mean * mean;
+        double common = pop->mean_sq_sum / pop->sampled_steps - mean * mean;
+        out->potential_mean = (float)mean;
+        out->potential_var = (float)(total > 0.0 ? total : 0.0);
+        if (total > 0.0 && common > 0.0) {
+            out->synchrony = (float)(common < total ? common / total : 1.0);
+        }
+    }
+    
+    if (clear) {
+        reset_population(pop);
+    }
+    return 0;
+}
+
+// Follow the removal of a slot: ranges keep their neurons
+void sim_stats_remove_slot(sim_stats_t *stats, uint32_t slot) {
+    if (!stats) return;
+    
+    for (uint32_t i = 0; i < stats->num_populations; i++) {
+        sim_stats_pop_t *pop = &stats->populations[i];
+        if (slot < pop->first) {
+            pop->first--;
+        } else if (slot - pop->first < pop->count) {
+            pop->count--;
+        }
+    }
+    stats->dirty = 1;
+}
\ No newline at end of file
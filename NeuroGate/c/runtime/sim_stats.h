@@ -0,0 +1,104 @@
+#ifndef SIM_STATS_H
+#define SIM_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../core/population.h"
+
+// Segment index of slots outside every monitored population
+#define SIM_STATS_NONE UINT32_MAX
+
+// Sums of one segment over the slots of one partition in the current step
+typedef struct {
+    PopulationMoments moments;   // Potentials after the step, dense steps only
+    uint32_t fired;              // Spikes in the step
+} sim_stats_segment_t;
+
+// Monitored population: a contiguous range of slots and its running
+// statistics since they were last collected
+typedef struct {
+    uint32_t first;              // First slot
+    uint32_t count;              // Number of slots
+    uint32_t segment_begin;      // First segment of the range
+    uint32_t segment_end;        // One past the last segment of the range
+    uint64_t steps;              // Steps since the last collection
+    uint64_t sampled_steps;      // Dense steps among them, whose potentials were summed
+    uint64_t spikes;             // Spikes since the last collection
+    double spikes_sq;            // Sum over steps of the squared spike count
+    double elapsed;              // Simulated time since the last collection in ms
+    double mean_sum;             // Sum over sampled steps of the mean potential
+    double mean_sq_sum;          // Sum over sampled steps of the squared mean potential
+    double square_sum;           // Sum over sampled steps of the mean squared potential
+    float last_mean;             // Mean potential in the last sampled step
+    float last_var;              // Variance across slots in the last sampled step
+} sim_stats_pop_t;
+
+// Statistics of a population since they were last collected
+typedef struct {
+    uint32_t first;              // First slot
+    uint32_t count;              // Number of slots
+    uint64_t steps;              // Steps covered
+    uint64_t sampled_steps;      // Steps with potential moments
+    uint64_t spikes;             // Spikes of the population
+    float rate;                  // Mean firing rate per neuron in Hz
+    float spike_fano;            // Variance over mean of the spikes per step
+    float potential_mean;        // Mean potential over slots and sampled steps in mV
+    float potential_var;         // Variance of the potential over slots and sampled steps
+    float last_mean;             // Mean potential in the last sampled step
+    float last_var;              // Variance across slots in the last sampled step
+    float synchrony;             // Share of potential_var due to the population mean moving
+} sim_population_stats_t;
+
+// Running statistics of monitored populations, kept as a side effect of
+// the step. The range boundaries of all populations cut the slots into
+// segments; the dense step splits its kernel calls at the boundaries so
+// that each call sums the moments and spikes of one segment into the row
+// of its partition. After the step the rows are folded into per-population
+// sums, so a step costs O(partitions x segments) beyond the kernels and a
+// collection O(1) per population.
+//
+// Spikes are counted in every step. Potentials are only summed in dense
+// steps, as event-driven steps leave quiescent slots behind; statistics of
+// the potential cover the sampled steps.
+//
+// The spike Fano factor is near 1 for neurons firing independently and
+// grows when they fire together. The synchrony is the variance over time
+// of the population mean potential over the total variance of the
+// potential, the population form of the chi-squared synchrony measure
+// without per-neuron state: near 1 / count for independent slots, 1 when
+// all slots move together.
+typedef struct {
+    sim_stats_pop_t *populations; // Monitored populations, by index
+    uint32_t num_populations;    // Number of populations
+    uint32_t population_capacity; // Capacity of populations
+    uint32_t *bounds;            // Sorted distinct boundaries; segment k is [bounds[k], bounds[k + 1])
+    uint32_t num_bounds;         // Number of boundaries
+    sim_stats_segment_t *segments; // Per-step sums, one row of segments per partition
+    uint32_t segment_capacity;   // Capacity of segments
+    uint32_t num_partitions;     // Number of rows
+    int dirty;                   // Ranges changed since the segments were built
+} sim_stats_t;
+
+// Number of segments in a row
+static inline uint32_t sim_stats_num_segments(const sim_stats_t *stats) {
+    return stats->num_bounds > 0 ? stats->num_bounds - 1 : 0;
+}
+
+// Row of per-step sums written by a partition
+static inline sim_stats_segment_t *sim_stats_row(sim_stats_t *stats, uint32_t partition) {
+    return stats->segments + (size_t)partition * sim_stats_num_segments(stats);
+}
+
+// Function declarations
+int sim_stats_init(sim_stats_t *stats, uint32_t num_partitions);
+void sim_stats_free(sim_stats_t *stats);
+void sim_stats_clear(sim_stats_t *stats);
+int sim_stats_define(sim_stats_t *stats, uint32_t first, uint32_t count);
+int sim_stats_prepare(sim_stats_t *stats);
+uint32_t sim_stats_locate(const sim_stats_t *stats, uint32_t slot, uint32_t *next);
+void sim_stats_count_spikes(sim_stats_t *stats, uint32_t partition, const uint32_t *slots, uint32_t count);
+void sim_stats_finish_step(sim_stats_t *stats, float dt, int sampled);
+int sim_stats_collect(sim_stats_t *stats, uint32_t population, sim_population_stats_t *out, int clear);
+void sim_stats_remove_slot(sim_stats_t *stats, uint32_t slot);
+
+#endif // SIM_STATS_H
\ No newline at end of file
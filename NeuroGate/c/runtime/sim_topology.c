@@ -0,0 +1,598 @@
+#include "sim_topology.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Domains that keep the random streams of different choices apart
+#define TOPOLOGY_DOMAIN_ROWS 1
+#define TOPOLOGY_DOMAIN_TYPES 2
+#define TOPOLOGY_DOMAIN_EDGES 3
+
+#define TOPOLOGY_GOLDEN 0x9e3779b97f4a7c15ULL
+
+// Finalizer of splitmix64: a bijection that spreads every input bit
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Key of the random values of one domain under a seed
+static inline uint64_t domain_key(uint64_t seed, uint64_t domain) {
+    return mix64(seed + domain * TOPOLOGY_GOLDEN);
+}
+
+// Random value number index of a domain key
+static inline uint64_t hash_at(uint64_t key, uint64_t index) {
+    return mix64(key + mix64(index + TOPOLOGY_GOLDEN));
+}
+
+// Uniform double in (0, 1] from 64 random bits
+static inline double unit_interval(uint64_t bits) {
+    return (double)((bits >> 11) + 1) * 0x1.0p-53;
+}
+
+// Random stream of one row: a splitmix64 sequence started at the hash of
+// the row, so rows can be generated in any order and on any worker
+typedef struct {
+    uint64_t state;
+} topology_rng_t;
+
+static inline void rng_seed(topology_rng_t *rng, uint64_t key, uint32_t row) {
+    rng->state = hash_at(key, row);
+}
+
+static inline uint64_t rng_next(topology_rng_t *rng) {
+    rng->state += TOPOLOGY_GOLDEN;
+    return mix64(rng->state);
+}
+
+static inline double rng_uniform(topology_rng_t *rng) {
+    return unit_interval(rng_next(rng));
+}
+
+// Uniform integer in [0, n)
+static inline uint32_t rng_below(topology_rng_t *rng, uint32_t n) {
+    return (uint32_t)(((rng_next(rng) >> 32) * n) >> 32);
+}
+
+// Candidates skipped before the next one kept with a probability whose
+// log1p(-probability) is log_q; 0 when every candidate is kept
+static inline double rng_skip(topology_rng_t *rng, double log_q) {
+    return floor(log(rng_uniform(rng)) / log_q);
+}
+
+// Partners of the row being generated, as neuron offsets into the network
+typedef struct {
+    uint32_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} topology_scratch_t;
+
+// Grow the scratch list to hold needed partners, doubling it
+static int scratch_reserve(topology_scratch_t *scratch, uint32_t needed) {
+    if (needed <= scratch->capacity) {
+        return 0;
+    }
+    
+    uint32_t capacity = scratch->capacity > 0 ? scratch->capacity : 64;
+    while (capacity < needed) {
+        capacity = capacity > UINT32_MAX / 2 ? needed : capacity * 2;
+    }
+    
+    uint32_t *grown = (uint32_t *)mm_realloc(scratch->items, (size_t)capacity * sizeof(uint32_t));
+    if (!grown) {
+        log_error("Failed to grow topology scratch to %u entries", capacity);
+        return -1;
+    }
+    scratch->items = grown;
+    scratch->capacity = capacity;
+    return 0;
+}
+
+static inline int scratch_push(topology_scratch_t *scratch, uint32_t partner) {
+    if (scratch->count >= scratch->capacity && scratch_reserve(scratch, scratch->count + 1) != 0) {
+        return -1;
+    }
+    scratch->items[scratch->count++] = partner;
+    return 0;
+}
+
+// Compare two neuron offsets for qsort
+static int compare_offsets(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Whether a sorted list holds a value
+static int sorted_contains(const uint32_t *list, uint32_t count, uint32_t value) {
+    uint32_t low = 0;
+    uint32_t high = count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (list[mid] < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < count && list[low] == value;
+}
+
+// State shared by the workers of a generation pass
+typedef struct {
+    sim_context_t *ctx;
+    const sim_topology_t *spec;
+    const uint8_t *inhibitory;   // Per neuron of the network
+    uint64_t row_key;            // Key of the per-row streams
+    uint64_t edge_key;           // Key of the scale-free endpoint draws
+    uint32_t first_slot;         // Slot of the first neuron
+    float weight;                // Weight of excitatory synapses
+    float inhibitory_weight;     // Weight of inhibitory synapses
+    float delay;                 // Transmission delay in ms
+    int write;                   // Writing pass; the first pass only counts
+    uint64_t *counts;            // Synapses per worker, from the counting pass
+    uint64_t *positions;         // Bulk position of each worker's first synapse
+    int *status;                 // Nonzero if a worker failed
+} topology_job_t;
+
+// Append count distinct picks from [0, n) other than exclude and the
+// sorted values kept[0..num_kept), none of which is exclude. The caller
+// reserves room for count more partners, so kept may live in the scratch
+// list. Small counts are drawn with replacement and duplicates redrawn;
+// large ones are picked in one selection-sampling scan.
+static void draw_distinct(topology_rng_t *rng, uint32_t n, uint32_t exclude, const uint32_t *kept,
+                          uint32_t num_kept, uint32_t count, topology_scratch_t *scratch) {
+    uint32_t available = n - 1 - num_kept;
+    uint32_t *out = scratch->items + scratch->count;
+    
+    if (count > available) {
+        count = available;
+    }
+    
+    if ((uint64_t)count * 2 > available) {
+        uint32_t left = available;
+        uint32_t picked = 0;
+        uint32_t k = 0;
+        for (uint32_t v = 0; v < n && picked < count; v++) {
+            if (v == exclude) continue;
+            if (k < num_kept && kept[k] == v) {
+                k++;
+                continue;
+            }
+            if (rng_below(rng, left) < count - picked) {
+                out[picked++] = v;
+            }
+            left--;
+        }
+        scratch->count += picked;
+        return;
+    }
+    
+    uint32_t have = 0;
+    while (have < count) {
+        for (uint32_t i = have; i < count; i++) {
+            uint32_t v = rng_below(rng, n - 1);
+            out[i] = v < exclude ? v : v + 1;
+        }
+        qsort(out, count, sizeof(uint32_t), compare_offsets);
+        
+        have = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if ((have > 0 && out[i] == out[have - 1]) || sorted_contains(kept, num_kept, out[i])) {
+                continue;
+            }
+            out[have++] = out[i];
+        }
+    }
+    scratch->count += count;
+}
+
+// Targets of row among the other neurons, each with the same probability.
+// Geometric skips make the cost proportional to the synapses created.
+static int random_row(const topology_job_t *job, topology_rng_t *rng, uint32_t row,
+                      topology_scratch_t *scratch) {
+    uint32_t n = job->spec->num_neurons;
+    double p = job->spec->probability;
+    
+    if (p <= 0.0 || n < 2) {
+        return 0;
+    }
+    
+    double log_q = log1p(-p);
+    double candidate = -1.0;
+    for (;;) {
+        candidate += 1.0 + rng_skip(rng, log_q);
+        if (candidate >= (double)(n - 1)) {
+            break;
+        }
+        uint32_t c = (uint32_t)candidate;
+        if (scratch_push(scratch, c < row ? c : c + 1) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Sources of row: degree distinct other neurons
+static int fixed_indegree_row(const topology_job_t *job, topology_rng_t *rng, uint32_t row,
+                              topology_scratch_t *scratch) {
+    uint32_t n = job->spec->num_neurons;
+    uint32_t count = job->spec->degree < n - 1 ? job->spec->degree : n - 1;
+    
+    if (scratch_reserve(scratch, count) != 0) {
+        return -1;
+    }
+    draw_distinct(rng, n, row, NULL, 0, count, scratch);
+    return 0;
+}
+
+// Targets of row on a ring: the degree nearest neurons, alternating right
+// and left, each rewired with the probability to a random neuron that row
+// does not reach yet
+static int small_world_row(const topology_job_t *job, topology_rng_t *rng, uint32_t row,
+                           topology_scratch_t *scratch) {
+    uint32_t n = job->spec->num_neurons;
+    uint32_t degree = job->spec->degree < n - 1 ? job->spec->degree : n - 1;
+    uint32_t rewired = 0;
+    
+    // Room for all targets, so the kept ones stay in place while drawing
+    if (scratch_reserve(scratch, degree) != 0) {
+        return -1;
+    }
+    
+    for (uint32_t d = 1; d <= degree; d++) {
+        uint32_t offset = (d + 1) / 2;
+        if (rng_uniform(rng) <= job->spec->probability) {
+            rewired++;
+            continue;
+        }
+        uint64_t target = (d & 1) ? (uint64_t)row + offset : (uint64_t)row + n - offset;
+        scratch->items[scratch->count++] = (uint32_t)(target % n);
+    }
+    
+    if (rewired > 0) {
+        qsort(scratch->items, scratch->count, sizeof(uint32_t), compare_offsets);
+        draw_distinct(rng, n, row, scratch->items, scratch->count, rewired, scratch);
+    }
+    return 0;
+}
+
+// Neuron at a position of the Barabasi-Albert endpoint list. Position 0
+// holds neuron 0, position 1 + 2e the source of edge e and position 2 + 2e
+// its target, which repeats the neuron at a uniformly drawn earlier
+// position. Neurons thus appear once per synapse they have, and a target
+// is picked in proportion to degree. Every position is a pure function of
+// the seed, so rows need no shared state; a lookup follows about two
+// target positions on average.
+static uint32_t scale_free_endpoint(const topology_job_t *job, uint64_t position) {
+    uint64_t m = job->spec->degree;
+    
+    while (position > 0 && position % 2 == 0) {
+        uint64_t edge = (position - 2) / 2;
+        uint64_t source = edge / m + 1;
+        position = hash_at(job->edge_key, edge) % (1 + 2 * (source - 1) * m);
+    }
+    return position == 0 ? 0 : (uint32_t)((position - 1) / 2 / m + 1);
+}
+
+// Targets of row among the earlier neurons; repeated picks are merged
+static int scale_free_row(const topology_job_t *job, uint32_t row, topology_scratch_t *scratch) {
+    uint64_t m = job->spec->degree;
+    
+    if (row == 0) {
+        return 0;
+    }
+    
+    if (scratch_reserve(scratch, (uint32_t)m) != 0) {
+        return -1;
+    }
+    
+    for (uint64_t j = 0; j < m; j++) {
+        uint64_t edge = (uint64_t)(row - 1) * m + j;
+        scratch->items[scratch->count++] = scale_free_endpoint(job, 2 + 2 * edge);
+    }
+    
+    qsort(scratch->items, scratch->count, sizeof(uint32_t), compare_offsets);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < scratch->count; i++) {
+        if (unique == 0 || scratch->items[i] != scratch->items[unique - 1]) {
+            scratch->items[unique++] = scratch->items[i];
+        }
+    }
+    scratch->count = unique;
+    return 0;
+}
+
+// Targets of row on one side of the ring, up to max_distance away, each
+// kept with probability * exp(-distance / length). Candidates are thinned:
+// skips are drawn for the largest probability still ahead and each
+// candidate reached is kept with its own over that bound.
+static int distance_side(const topology_job_t *job, topology_rng_t *rng, uint32_t row, int right,
+                         uint32_t max_distance, topology_scratch_t *scratch) {
+    uint32_t n = job->spec->num_neurons;
+    double peak = job->spec->probability;
+    double inverse_length = 1.0 / job->spec->length;
+    double distance = 0.0;
+    
+    for (;;) {
+        double bound = peak * exp(-(distance + 1.0) * inverse_length);
+        if (bound <= 0.0) {
+            break;
+        }
+        
+        distance += 1.0 + rng_skip(rng, log1p(-bound));
+        if (distance > (double)max_distance) {
+            break;
+        }
+        
+        if (rng_uniform(rng) * bound <= peak * exp(-distance * inverse_length)) {
+            uint64_t d = (uint64_t)distance;
+            uint64_t target = right ? (uint64_t)row + d : (uint64_t)row + n - d;
+            if (scratch_push(scratch, (uint32_t)(target % n)) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Targets of row on both sides of the ring; the opposite neuron of an even
+// ring belongs to the right side
+static int distance_row(const topology_job_t *job, topology_rng_t *rng, uint32_t row,
+                        topology_scratch_t *scratch) {
+    uint32_t n = job->spec->num_neurons;
+    
+    if (job->spec->probability <= 0.0f || n < 2) {
+        return 0;
+    }
+    
+    if (distance_side(job, rng, row, 1, n / 2, scratch) != 0 ||
+        distance_side(job, rng, row, 0, (n - 1) / 2, scratch) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Partners of one row in the scratch list: targets of neuron row, or its
+// sources for TOPOLOGY_FIXED_INDEGREE
+static int generate_row(const topology_job_t *job, uint32_t row, topology_scratch_t *scratch) {
+    topology_rng_t rng;
+    rng_seed(&rng, job->row_key, row);
+    scratch->count = 0;
+    
+    switch (job->spec->kind) {
+        case TOPOLOGY_RANDOM:
+            return random_row(job, &rng, row, scratch);
+        case TOPOLOGY_FIXED_INDEGREE:
+            return fixed_indegree_row(job, &rng, row, scratch);
+        case TOPOLOGY_SMALL_WORLD:
+            return small_world_row(job, &rng, row, scratch);
+        case TOPOLOGY_SCALE_FREE:
+            return scale_free_row(job, row, scratch);
+        case TOPOLOGY_DISTANCE:
+            return distance_row(job, &rng, row, scratch);
+        default:
+            return -1;
+    }
+}
+
+// Worker body of both passes. Each worker generates a contiguous block of
+// rows; the counting pass sums their synapses, and the writing pass stores
+// them in order from the worker's position in the bulk store, so the
+// store does not depend on the number of workers.
+static void topology_worker(void *arg, uint32_t worker, uint32_t num_workers) {
+    topology_job_t *job = (topology_job_t *)arg;
+    sim_bulk_t *bulk = &job->ctx->bulk;
+    uint32_t n = job->spec->num_neurons;
+    uint32_t begin = (uint32_t)((uint64_t)n * worker / num_workers);
+    uint32_t end = (uint32_t)((uint64_t)n * (worker + 1) / num_workers);
+    int incoming = job->spec->kind == TOPOLOGY_FIXED_INDEGREE;
+    topology_scratch_t scratch = { NULL, 0, 0 };
+    uint64_t count = 0;
+    uint64_t position = job->write ? job->positions[worker] : 0;
+    
+    for (uint32_t row = begin; row < end; row++) {
+        if (generate_row(job, row, &scratch) != 0) {
+            job->status[worker] = -1;
+            break;
+        }
+        
+        if (!job->write) {
+            count += scratch.count;
+            continue;
+        }
+        
+        for (uint32_t k = 0; k < scratch.count; k++) {
+            uint32_t pre = incoming ? scratch.items[k] : row;
+            uint32_t post = incoming ? row : scratch.items[k];
+            bulk->pre[position] = job->first_slot + pre;
+            bulk->post[position] = job->first_slot + post;
+            bulk->weights[position] = job->inhibitory[pre] ? job->inhibitory_weight : job->weight;
+            bulk->delays[position] = job->delay;
+            bulk->plasticity[position] = (uint8_t)job->spec->plasticity;
+            position++;
+        }
+    }
+    
+    if (!job->write) {
+        job->counts[worker] = count;
+    }
+    mm_free(scratch.items);
+}
+
+// Run one pass on every worker. Returns 0 if none failed.
+static int run_pass(topology_job_t *job, int write) {
+    uint32_t num_workers = job->ctx->pool->num_workers;
+    
+    job->write = write;
+    memset(job->status, 0, num_workers * sizeof(int));
+    if (job->spec->num_neurons >= SIM_PARALLEL_MIN_NEURONS) {
+        thread_pool_run(job->ctx->pool, topology_worker, job);
+    } else {
+        for (uint32_t w = 0; w < num_workers; w++) {
+            topology_worker(job, w, num_workers);
+        }
+    }
+    
+    for (uint32_t w = 0; w < num_workers; w++) {
+        if (job->status[w] != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Whether a spec describes a network that can be generated
+static int topology_valid(const sim_topology_t *spec) {
+    if (spec->num_neurons == 0 || spec->first_id > UINT32_MAX - (spec->num_neurons - 1) ||
+        !(spec->inhibitory_fraction >= 0.0f && spec->inhibitory_fraction <= 1.0f) ||
+        (uint32_t)spec->activation > TANH || (uint32_t)spec->plasticity > HOMEOSTATIC ||
+        (uint32_t)spec->model >= NEURON_MODEL_COUNT) {
+        return 0;
+    }
+    
+    int probability_valid = spec->probability >= 0.0f && spec->probability <= 1.0f;
+    switch (spec->kind) {
+        case TOPOLOGY_RANDOM:
+            return probability_valid;
+        case TOPOLOGY_FIXED_INDEGREE:
+        case TOPOLOGY_SCALE_FREE:
+            return spec->degree > 0;
+        case TOPOLOGY_SMALL_WORLD:
+            return probability_valid && spec->degree > 0;
+        case TOPOLOGY_DISTANCE:
+            return probability_valid && spec->length > 0.0f;
+        default:
+            return 0;
+    }
+}
+
+// Remove the neurons created so far, newest first
+static void remove_new_neurons(sim_context_t *ctx, uint32_t first_slot) {
+    while (ctx->neuron_count > first_slot) {
+        sim_remove_neuron(ctx, ctx->neuron_count - 1);
+    }
+}
+
+// Create the neurons of the network in consecutive slots, running the
+// spec's model
+static int create_neurons(sim_context_t *ctx, const sim_topology_t *spec, const uint8_t *inhibitory) {
+    uint32_t first_slot = ctx->neuron_count;
+    
+    if (sim_reserve_neurons(ctx, spec->num_neurons) != 0) {
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < spec->num_neurons; i++) {
+        Neuron *neuron = neuron_create(spec->first_id + i, inhibitory[i] ? INHIBITORY : EXCITATORY,
+                                       spec->activation);
+        if (!neuron || sim_add_neuron(ctx, neuron) < 0) {
+            neuron_destroy(neuron);
+            remove_new_neurons(ctx, first_slot);
+            return -1;
+        }
+    }
+    
+    if (sim_set_neuron_model(ctx, first_slot, spec->num_neurons, spec->model, spec->model_params) != 0) {
+        remove_new_neurons(ctx, first_slot);
+        return -1;
+    }
+    return 0;
+}
+
+// Create the neurons and synapses of a network
+int sim_generate_topology(sim_context_t *ctx, const sim_topology_t *spec, uint32_t *num_synapses) {
+    if (num_synapses) {
+        *num_synapses = 0;
+    }
+    
+    if (!ctx || !spec || !topology_valid(spec)) {
+        log_error("Invalid network topology");
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < spec->num_neurons; i++) {
+        if (sim_find_neuron(ctx, spec->first_id + i) >= 0) {
+            log_error("Neuron with ID %u already exists", spec->first_id + i);
+            return -1;
+        }
+    }
+    
+    uint32_t num_workers = ctx->pool->num_workers;
+    uint8_t *inhibitory = (uint8_t *)mm_alloc(spec->num_neurons);
+    uint64_t *counts = (uint64_t *)mm_alloc(2 * num_workers * sizeof(uint64_t));
+    int *status = (int *)mm_alloc(num_workers * sizeof(int));
+    if (!inhibitory || !counts || !status) {
+        log_error("Failed to allocate topology generator");
+        mm_free(inhibitory);
+        mm_free(counts);
+        mm_free(status);
+        return -1;
+    }
+    
+    topology_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.ctx = ctx;
+    job.spec = spec;
+    job.inhibitory = inhibitory;
+    job.row_key = domain_key(spec->seed, TOPOLOGY_DOMAIN_ROWS);
+    job.edge_key = domain_key(spec->seed, TOPOLOGY_DOMAIN_EDGES);
+    job.first_slot = ctx->neuron_count;
+    job.weight = spec->weight != 0.0f ? spec->weight : 0.5f;
+    job.inhibitory_weight = spec->inhibitory_weight != 0.0f ? spec->inhibitory_weight : -0.5f;
+    job.delay = spec->delay != 0.0f ? spec->delay : 1.0f;
+    job.counts = counts;
+    job.positions = counts + num_workers;
+    job.status = status;
+    
+    uint64_t type_key = domain_key(spec->seed, TOPOLOGY_DOMAIN_TYPES);
+    for (uint32_t i = 0; i < spec->num_neurons; i++) {
+        inhibitory[i] = unit_interval(hash_at(type_key, i)) <= spec->inhibitory_fraction;
+    }
+    
+    // Count first, so the synapses can be written in place
+    int result = -1;
+    uint64_t total = 0;
+    if (run_pass(&job, 0) == 0) {
+        for (uint32_t w = 0; w < num_workers; w++) {
+            job.positions[w] = ctx->bulk.count + total;
+            total += counts[w];
+        }
+        
+        if (total > SIM_BULK_MAX_SYNAPSES - ctx->bulk.count) {
+            log_error("Network of %llu synapses exceeds the bulk store", (unsigned long long)total);
+        } else if (create_neurons(ctx, spec, inhibitory) == 0) {
+            // Learned weights go back before the index is marked stale
+            sim_sync_synapses(ctx);
+            if (sim_bulk_reserve(&ctx->bulk, ctx->bulk.count + (uint32_t)total) == 0 &&
+                run_pass(&job, 1) == 0) {
+                ctx->bulk.count += (uint32_t)total;
+                result = (int)job.first_slot;
+            } else {
+                remove_new_neurons(ctx, job.first_slot);
+            }
+        }
+    }
+    
+    mm_free(inhibitory);
+    mm_free(counts);
+    mm_free(status);
+    
+    if (result < 0) {
+        return -1;
+    }
+    
+    if (num_synapses) {
+        *num_synapses = (uint32_t)total;
+    }
+    log_info("Generated %u neurons and %llu synapses", spec->num_neurons, (unsigned long long)total);
+    return result;
+}
\ No newline at end of file
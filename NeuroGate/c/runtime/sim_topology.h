@@ -0,0 +1,50 @@
+#ifndef SIM_TOPOLOGY_H
+#define SIM_TOPOLOGY_H
+
+#include <stdint.h>
+#include "sim_context.h"
+
+// Connectivity of a generated network
+typedef enum {
+    TOPOLOGY_RANDOM,             // Erdos-Renyi: every ordered pair with probability
+    TOPOLOGY_FIXED_INDEGREE,     // degree distinct random sources per neuron
+    TOPOLOGY_SMALL_WORLD,        // Watts-Strogatz: ring of degree nearest targets, each
+                                 // rewired to a random neuron with probability
+    TOPOLOGY_SCALE_FREE,         // Barabasi-Albert: each neuron projects to degree earlier
+                                 // neurons, picked in proportion to their degree
+    TOPOLOGY_DISTANCE            // Ring: probability * exp(-distance / length) per pair
+} sim_topology_kind_t;
+
+// Network to generate. Neurons get the IDs first_id.. in slot order and
+// are inhibitory with probability inhibitory_fraction; synapses carry
+// weight from excitatory and inhibitory_weight from inhibitory neurons.
+// Zero weights and delays take the defaults of synapse_create. Every
+// neuron runs model, see sim_set_neuron_model.
+typedef struct {
+    sim_topology_kind_t kind;    // Connectivity
+    uint32_t num_neurons;        // Neurons to create
+    uint32_t first_id;           // ID of the first neuron
+    uint32_t degree;             // In-degree, ring neighbors or edges per new neuron
+    float probability;           // Connection, rewiring or peak probability
+    float length;                // Decay length of TOPOLOGY_DISTANCE in neurons
+    float inhibitory_fraction;   // Share of inhibitory neurons
+    float weight;                // Weight of excitatory synapses
+    float inhibitory_weight;     // Weight of inhibitory synapses
+    float delay;                 // Transmission delay in ms
+    ActivationFunction activation; // Activation of every neuron
+    PlasticityType plasticity;   // Plasticity of every synapse
+    NeuronModelType model;       // Dynamics of every neuron
+    const float *model_params;   // Parameters of model, or NULL for its defaults
+    uint64_t seed;               // Seed of the random choices
+} sim_topology_t;
+
+// Create the neurons and synapses of a network in one pass. Synapses are
+// written straight into the bulk store of the context, without records or
+// IDs. Rows of the network are generated in parallel from random streams
+// keyed by seed and row, so the result depends on the seed only, not on
+// the number of workers. Returns the slot of the first neuron, or -1 if
+// the spec is invalid or an ID is in use; num_synapses receives the
+// number of synapses created.
+int sim_generate_topology(sim_context_t *ctx, const sim_topology_t *spec, uint32_t *num_synapses);
+
+#endif // SIM_TOPOLOGY_H
\ No newline at end of file
@@ -0,0 +1,457 @@
+#include "spike_recorder.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Longest varint of a 32-bit gap
+#define VARINT32_MAX 5
+
+// Room a new record needs: the step delta, one spike and the terminator
+#define RECORD_MIN (10 + VARINT32_MAX + 1)
+
+// Digit width of the radix sort of unsorted spike lists; fired lists span
+// one partition, so a few passes cover them
+#define RADIX_BITS 11
+#define RADIX_SIZE (1u << RADIX_BITS)
+
+// Bytes of the export header and of each chunk header
+#define EXPORT_HEADER_SIZE 24
+#define EXPORT_CHUNK_HEADER_SIZE 16
+
+// Append an unsigned LEB128 varint
+static inline uint8_t *put_varint(uint8_t *p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+// Append a little-endian integer of size bytes
+static uint8_t *put_le(uint8_t *p, uint64_t value, int size) {
+    for (int i = 0; i < size; i++) {
+        *p++ = (uint8_t)(value >> (8 * i));
+    }
+    return p;
+}
+
+// Initialize an idle recorder with num_streams producers that records
+// every slot
+int spike_recorder_init(spike_recorder_t *rec, uint32_t num_streams) {
+    if (!rec || num_streams == 0) {
+        return -1;
+    }
+    
+    memset(rec, 0, sizeof(spike_recorder_t));
+    rec->streams = (spike_stream_t *)mm_alloc_aligned(num_streams * sizeof(spike_stream_t), 64);
+    if (!rec->streams) {
+        log_error("Failed to allocate spike streams");
+        return -1;
+    }
+    memset(rec->streams, 0, num_streams * sizeof(spike_stream_t));
+    rec->num_streams = num_streams;
+    return 0;
+}
+
+// Free the chunk chain
+static void free_chunks(spike_chunk_t *chunk) {
+    while (chunk) {
+        spike_chunk_t *next = chunk->next;
+        mm_free(chunk);
+        chunk = next;
+    }
+}
+
+// Free all recorded spikes and the selection
+void spike_recorder_free(spike_recorder_t *rec) {
+    if (!rec) return;
+    
+    for (uint32_t s = 0; s < rec->num_streams; s++) {
+        spike_stream_t *stream = &rec->streams[s];
+        free_chunks(stream->head);
+        mm_free(stream->spare);
+        mm_free(stream->scratch);
+    }
+    mm_free_aligned(rec->streams);
+    mm_free(rec->ranges);
+    memset(rec, 0, sizeof(spike_recorder_t));
+}
+
+// Drop all recorded spikes; the mode and selection are kept
+void spike_recorder_clear(spike_recorder_t *rec) {
+    if (!rec) return;
+    
+    for (uint32_t s = 0; s < rec->num_streams; s++) {
+        spike_stream_t *stream = &rec->streams[s];
+        
+        // Keep one chunk so that a steady export-and-clear cycle does not
+        // allocate
+        if (stream->head && !stream->spare) {
+            stream->spare = stream->head;
+            stream->head = stream->head->next;
+        }
+        free_chunks(stream->head);
+        
+        stream->head = NULL;
+        stream->tail = NULL;
+        stream->num_chunks = 0;
+        stream->num_spikes = 0;
+        stream->dropped_spikes = 0;
+    }
+}
+
+// Remove the oldest chunk of a stream; the ring drops its spikes
+static spike_chunk_t *drop_head(spike_stream_t *stream) {
+    spike_chunk_t *chunk = stream->head;
+    stream->head = chunk->next;
+    if (!stream->head) {
+        stream->tail = NULL;
+    }
+    stream->num_chunks--;
+    stream->num_spikes -= chunk->num_spikes;
+    stream->dropped_spikes += chunk->num_spikes;
+    return chunk;
+}
+
+// Whether a stream of num_chunks exceeds its share of the memory budget
+static int over_budget(const spike_recorder_t *rec, uint32_t num_chunks) {
+    return rec->max_bytes > 0 &&
+           (size_t)num_chunks * sizeof(spike_chunk_t) > rec->max_bytes / rec->num_streams;
+}
+
+// Start recording. With max_bytes > 0 the streams are rings that share
+// that many bytes, at least one chunk each, and drop the oldest spikes
+// first.
+void spike_recorder_start(spike_recorder_t *rec, size_t max_bytes) {
+    if (!rec) return;
+    
+    rec->enabled = 1;
+    rec->max_bytes = max_bytes;
+    
+    for (uint32_t s = 0; s < rec->num_streams; s++) {
+        spike_stream_t *stream = &rec->streams[s];
+        while (stream->num_chunks > 1 && over_budget(rec, stream->num_chunks)) {
+            mm_free(drop_head(stream));
+        }
+    }
+}
+
+// Stop recording; recorded spikes are kept until cleared
+void spike_recorder_stop(spike_recorder_t *rec) {
+    if (!rec) return;
+    
+    rec->enabled = 0;
+}
+
+// Order ranges by first slot
+static int compare_ranges(const void *a, const void *b) {
+    const spike_range_t *x = (const spike_range_t *)a;
+    const spike_range_t *y = (const spike_range_t *)b;
+    return (x->first > y->first) - (x->first < y->first);
+}
+
+// Record only the slots in the given ranges, or every slot if num_ranges
+// is 0. Overlapping ranges are merged.
+int spike_recorder_select(spike_recorder_t *rec, const spike_range_t *ranges, uint32_t num_ranges) {
+    if (!rec || (num_ranges > 0 && !ranges)) {
+        log_error("Invalid recording selection");
+        return -1;
+    }
+    
+    spike_range_t *selected = NULL;
+    if (num_ranges > 0) {
+        selected = (spike_range_t *)mm_alloc(num_ranges * sizeof(spike_range_t));
+        if (!selected) {
+            log_error("Failed to allocate recording selection");
+            return -1;
+        }
+        memcpy(selected, ranges, num_ranges * sizeof(spike_range_t));
+        qsort(selected, num_ranges, sizeof(spike_range_t), compare_ranges);
+    }
+    
+    // Merge overlapping and adjacent ranges in place
+    uint32_t merged = 0;
+    for (uint32_t r = 0; r < num_ranges; r++) {
+        uint64_t end = (uint64_t)selected[r].first + selected[r].count;
+        if (merged > 0) {
+            spike_range_t *last = &selected[merged - 1];
+            uint64_t last_end = (uint64_t)last->first + last->count;
+            if (selected[r].first <= last_end) {
+                if (end > last_end) {
+                    last->count = (uint32_t)(end - last->first);
+                }
+                continue;
+            }
+        }
+        selected[merged++] = selected[r];
+    }
+    
+    mm_free(rec->ranges);
+    rec->ranges = selected;
+    rec->num_ranges = merged;
+    return 0;
+}
+
+// Append an empty chunk to a stream, reusing its oldest one if the ring
+// is full
+static spike_chunk_t *next_chunk(const spike_recorder_t *rec, spike_stream_t *stream, uint64_t step) {
+    spike_chunk_t *chunk;
+    
+    if (stream->num_chunks > 0 && over_budget(rec, stream->num_chunks + 1)) {
+        chunk = drop_head(stream);
+    } else if (stream->spare) {
+        chunk = stream->spare;
+        stream->spare = NULL;
+    } else {
+        chunk = (spike_chunk_t *)mm_alloc(sizeof(spike_chunk_t));
+        if (!chunk) {
+            log_error("Failed to allocate spike chunk");
+            return NULL;
+        }
+    }
+    
+    chunk->next = NULL;
+    chunk->first_step = step;
+    chunk->last_step = step;
+    chunk->num_spikes = 0;
+    chunk->used = 0;
+    
+    if (stream->tail) {
+        stream->tail->next = chunk;
+    } else {
+        stream->head = chunk;
+    }
+    stream->tail = chunk;
+    stream->num_chunks++;
+    return chunk;
+}
+
+// Encode ascending slots as records of a step. A chunk that fills up
+// closes the record and the step continues in the next chunk.
+static int encode(const spike_recorder_t *rec, spike_stream_t *stream, uint64_t step,
+                  const uint32_t *slots, uint32_t count) {
+    while (count > 0) {
+        spike_chunk_t *chunk = stream->tail;
+        if (!chunk || SPIKE_RECORDER_CHUNK_SIZE - chunk->used < RECORD_MIN) {
+            chunk = next_chunk(rec, stream, step);
+            if (!chunk) {
+                return -1;
+            }
+        }
+        
+        uint8_t *p = put_varint(chunk->data + chunk->used, step - chunk->last_step);
+        chunk->last_step = step;
+        
+        // Spikes that fit whatever their gaps, keeping the terminator byte
+        uint32_t room = (uint32_t)(chunk->data + SPIKE_RECORDER_CHUNK_SIZE - p - 1) / VARINT32_MAX;
+        uint32_t n = count < room ? count : room;
+        uint32_t prev = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t next = slots[i] + 1;
+            p = put_varint(p, next - prev);
+            prev = next;
+        }
+        *p++ = 0;
+        
+        chunk->used = (uint32_t)(p - chunk->data);
+        chunk->num_spikes += n;
+        stream->num_spikes += n;
+        slots += n;
+        count -= n;
+    }
+    
+    return 0;
+}
+
+// Sort count slots of [lo, hi] ascending into out with an LSD radix sort
+// of their offsets from lo, using tmp of the same size
+static void radix_sort(const uint32_t *slots, uint32_t count, uint32_t lo, uint32_t hi,
+                       uint32_t *out, uint32_t *tmp) {
+    uint32_t span_bits = hi > lo ? 32 - (uint32_t)__builtin_clz(hi - lo) : 1;
+    uint32_t passes = (span_bits + RADIX_BITS - 1) / RADIX_BITS;
+    
+    // Alternate between the buffers so that the last pass lands in out
+    const uint32_t *src = slots;
+    uint32_t *dst = passes % 2 ? out : tmp;
+    uint32_t offsets[RADIX_SIZE];
+    
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        uint32_t shift = pass * RADIX_BITS;
+        memset(offsets, 0, sizeof(offsets));
+        for (uint32_t i = 0; i < count; i++) {
+            offsets[((src[i] - lo) >> shift) & (RADIX_SIZE - 1)]++;
+        }
+        
+        uint32_t sum = 0;
+        for (uint32_t d = 0; d < RADIX_SIZE; d++) {
+            uint32_t n = offsets[d];
+            offsets[d] = sum;
+            sum += n;
+        }
+        
+        for (uint32_t i = 0; i < count; i++) {
+            dst[offsets[((src[i] - lo) >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+        }
+        
+        src = dst;
+        dst = dst == out ? tmp : out;
+    }
+}
+
+// Make room for count spikes and the radix sort buffer in a stream's
+// scratch buffer
+static int reserve_scratch(spike_stream_t *stream, uint32_t count) {
+    if (count <= stream->scratch_capacity) {
+        return 0;
+    }
+    
+    uint32_t *grown = (uint32_t *)mm_realloc(stream->scratch, 2 * (size_t)count * sizeof(uint32_t));
+    if (!grown) {
+        log_error("Failed to allocate spike sort buffer");
+        return -1;
+    }
+    stream->scratch = grown;
+    stream->scratch_capacity = count;
+    return 0;
+}
+
+// First position in an ascending list whose slot is at least key
+static uint32_t lower_bound(const uint32_t *slots, uint32_t count, uint64_t key) {
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (slots[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Record the spikes of a step in a stream. Slots must be distinct, in any
+// order; ascending lists are encoded in place. Steps must not decrease
+// within a stream. Different streams may be written concurrently.
+int spike_recorder_add(spike_recorder_t *rec, uint32_t stream, uint64_t step,
+                       const uint32_t *slots, uint32_t count) {
+    if (!rec || !rec->enabled || count == 0) {
+        return 0;
+    }
+    
+    if (stream >= rec->num_streams || !slots) {
+        log_error("Invalid spike stream %u", stream);
+        return -1;
+    }
+    
+    spike_stream_t *target = &rec->streams[stream];
+    if (reserve_scratch(target, count) != 0) {
+        return -1;
+    }
+    
+    // Event-driven fired lists follow activation order and are sorted into
+    // the scratch buffer first
+    uint32_t i = 1;
+    while (i < count && slots[i - 1] < slots[i]) {
+        i++;
+    }
+    if (i < count) {
+        uint32_t lo = slots[0];
+        uint32_t hi = slots[0];
+        for (uint32_t k = 1; k < count; k++) {
+            lo = slots[k] < lo ? slots[k] : lo;
+            hi = slots[k] > hi ? slots[k] : hi;
+        }
+        radix_sort(slots, count, lo, hi, target->scratch, target->scratch + count);
+        slots = target->scratch;
+    }
+    
+    if (rec->num_ranges == 0) {
+        return encode(rec, target, step, slots, count);
+    }
+    
+    // Gather the selected spikes at the front of the scratch buffer; the
+    // ranges are disjoint and ascending, so the spikes stay ascending
+    uint32_t begin = 0;
+    uint32_t selected = 0;
+    for (uint32_t r = 0; r < rec->num_ranges && begin < count; r++) {
+        const spike_range_t *range = &rec->ranges[r];
+        uint32_t first = begin + lower_bound(slots + begin, count - begin, range->first);
+        uint32_t end = first + lower_bound(slots + first, count - first, (uint64_t)range->first + range->count);
+        memmove(target->scratch + selected, slots + first, (end - first) * sizeof(uint32_t));
+        selected += end - first;
+        begin = end;
+    }
+    
+    return encode(rec, target, step, target->scratch, selected);
+}
+
+// Total spikes held by the streams
+static uint64_t held_spikes(const spike_recorder_t *rec, uint64_t *dropped) {
+    uint64_t held = 0;
+    *dropped = 0;
+    for (uint32_t s = 0; s < rec->num_streams; s++) {
+        held += rec->streams[s].num_spikes;
+        *dropped += rec->streams[s].dropped_spikes;
+    }
+    return held;
+}
+
+// Write the recorded spikes to out in the export format if capacity
+// suffices. Returns the size of the export either way.
+size_t spike_recorder_export(const spike_recorder_t *rec, uint8_t *out, size_t capacity) {
+    if (!rec) {
+        return 0;
+    }
+    
+    size_t size = EXPORT_HEADER_SIZE;
+    uint32_t num_chunks = 0;
+    for (uint32_t s = 0; s < rec->num_streams; s++) {
+        for (const spike_chunk_t *chunk = rec->streams[s].head; chunk; chunk = chunk->next) {
+            size += EXPORT_CHUNK_HEADER_SIZE + chunk->used;
+            num_chunks++;
+        }
+    }
+    
+    if (!out || capacity < size) {
+        return size;
+    }
+    
+    uint64_t dropped;
+    uint64_t held = held_spikes(rec, &dropped);
+    
+    uint8_t *p = out;
+    p = put_le(p, SPIKE_RECORDER_FORMAT, 4);
+    p = put_le(p, num_chunks, 4);
+    p = put_le(p, held, 8);
+    p = put_le(p, dropped, 8);
+    
+    for (uint32_t s = 0; s < rec->num_streams; s++) {
+        for (const spike_chunk_t *chunk = rec->streams[s].head; chunk; chunk = chunk->next) {
+            p = put_le(p, chunk->first_step, 8);
+            p = put_le(p, chunk->num_spikes, 4);
+            p = put_le(p, chunk->used, 4);
+            memcpy(p, chunk->data, chunk->used);
+            p += chunk->used;
+        }
+    }
+    
+    return size;
+}
+
+// Follow the removal of a slot: selected ranges keep their neurons.
+// Recorded spikes keep the slots the neurons had when they fired.
+void spike_recorder_remove_slot(spike_recorder_t *rec, uint32_t slot) {
+    if (!rec) return;
+    
+    for (uint32_t r = 0; r < rec->num_ranges; r++) {
+        spike_range_t *range = &rec->ranges[r];
+        if (slot < range->first) {
+            range->first--;
+        } else if (slot - range->first < range->count) {
+            range->count--;
+        }
+    }
+}
\ No newline at end of file
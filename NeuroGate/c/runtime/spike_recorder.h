@@ -0,0 +1,79 @@
+#ifndef SPIKE_RECORDER_H
+#define SPIKE_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Encoded bytes per chunk
+#define SPIKE_RECORDER_CHUNK_SIZE (64 * 1024)
+
+// Version of the export format
+#define SPIKE_RECORDER_FORMAT 1
+
+// Range of slots [first, first + count) whose spikes are recorded
+typedef struct {
+    uint32_t first;              // First slot
+    uint32_t count;              // Number of slots
+} spike_range_t;
+
+// Block of encoded spike events. A chunk holds whole records, one per
+// step with spikes (a step may continue in a new record of the next
+// chunk). A record is the varint step delta to the previous record of the
+// chunk, or to first_step for the first one, followed by one varint per
+// spike: the slot + 1 minus the previous slot + 1 of the record, so every
+// gap is at least 1. A zero byte ends the record.
+typedef struct spike_chunk {
+    struct spike_chunk *next;    // Next chunk in recording order
+    uint64_t first_step;         // Step of the first record
+    uint64_t last_step;          // Step of the last record
+    uint32_t num_spikes;         // Spikes encoded in the chunk
+    uint32_t used;               // Bytes of data in use
+    uint8_t data[SPIKE_RECORDER_CHUNK_SIZE];
+} spike_chunk_t;
+
+// Chunks written by one producer, e.g. the worker of one partition.
+// Padded to a cache line so that producers never write the same line.
+typedef struct {
+    spike_chunk_t *head;         // Oldest chunk
+    spike_chunk_t *tail;         // Chunk being written
+    spike_chunk_t *spare;        // Dropped chunk kept for reuse
+    uint32_t num_chunks;         // Number of chunks from head to tail
+    uint64_t num_spikes;         // Spikes held in the chunks
+    uint64_t dropped_spikes;     // Spikes dropped by the ring since the last clear
+    uint32_t *scratch;           // Sorted copy of an unsorted spike list, and sort buffer
+    uint32_t scratch_capacity;   // Spikes that fit in the sorted copy
+} __attribute__((aligned(64))) spike_stream_t;
+
+// Spike raster recorder. Each producer appends the spikes of a step to its
+// own stream as compressed (step, slot) events, so recording runs in
+// parallel with no locks. With a byte budget every stream is a ring that
+// drops its oldest chunks. Selected ranges restrict recording to some
+// populations of slots; without ranges every slot is recorded.
+//
+// Export format, little-endian: uint32 format, uint32 number of chunks,
+// uint64 spikes exported, uint64 spikes dropped by the ring, then per
+// chunk uint64 first step, uint32 spikes, uint32 bytes and the bytes.
+// Chunks follow stream by stream, so steps ascend within the chunks of a
+// stream but not across streams.
+typedef struct {
+    int enabled;                 // Records the spikes of each step
+    size_t max_bytes;            // Chunk memory budget; 0 keeps every chunk
+    spike_stream_t *streams;     // One stream per producer
+    uint32_t num_streams;        // Number of streams
+    spike_range_t *ranges;       // Selected ranges, sorted and disjoint
+    uint32_t num_ranges;         // Number of ranges; 0 records every slot
+} spike_recorder_t;
+
+// Function declarations
+int spike_recorder_init(spike_recorder_t *rec, uint32_t num_streams);
+void spike_recorder_free(spike_recorder_t *rec);
+void spike_recorder_clear(spike_recorder_t *rec);
+void spike_recorder_start(spike_recorder_t *rec, size_t max_bytes);
+void spike_recorder_stop(spike_recorder_t *rec);
+int spike_recorder_select(spike_recorder_t *rec, const spike_range_t *ranges, uint32_t num_ranges);
+int spike_recorder_add(spike_recorder_t *rec, uint32_t stream, uint64_t step,
+                       const uint32_t *slots, uint32_t count);
+size_t spike_recorder_export(const spike_recorder_t *rec, uint8_t *out, size_t capacity);
+void spike_recorder_remove_slot(spike_recorder_t *rec, uint32_t slot);
+
+#endif // SPIKE_RECORDER_H
\ No newline at end of file
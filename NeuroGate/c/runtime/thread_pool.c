@@ -0,0 +1,139 @@
+#include "thread_pool.h"
+#include "../memory/mm.h"
+#include "../utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Arguments of a spawned worker
+typedef struct {
+    thread_pool_t *pool;
+    uint32_t worker;
+} worker_arg_t;
+
+// Worker loop: wait for a new task generation, run it, report completion
+static void *worker_main(void *arg) {
+    worker_arg_t *worker_arg = (worker_arg_t *)arg;
+    thread_pool_t *pool = worker_arg->pool;
+    uint32_t worker = worker_arg->worker;
+    uint64_t seen = 0;
+    
+    free(worker_arg);
+    
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start_cond, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        seen = pool->generation;
+        thread_task_fn task = pool->task;
+        void *task_arg = pool->task_arg;
+        pthread_mutex_unlock(&pool->mutex);
+        
+        task(task_arg, worker, pool->num_workers);
+        
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    
+    return NULL;
+}
+
+// Create a pool
+thread_pool_t *thread_pool_create(uint32_t num_workers) {
+    if (num_workers == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = cpus > 0 ? (uint32_t)cpus : 1;
+    }
+    
+    thread_pool_t *pool = (thread_pool_t *)mm_alloc(sizeof(thread_pool_t));
+    if (!pool) {
+        log_error("Failed to allocate thread pool");
+        return NULL;
+    }
+    
+    memset(pool, 0, sizeof(thread_pool_t));
+    pool->num_workers = num_workers;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    
+    if (num_workers > 1) {
+        pool->threads = (pthread_t *)mm_alloc((num_workers - 1) * sizeof(pthread_t));
+        if (!pool->threads) {
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+    }
+    
+    // Spawn workers 1..n-1; the caller acts as worker 0
+    for (uint32_t w = 1; w < num_workers; w++) {
+        worker_arg_t *arg = (worker_arg_t *)malloc(sizeof(worker_arg_t));
+        if (arg) {
+            arg->pool = pool;
+            arg->worker = w;
+        }
+        if (!arg || pthread_create(&pool->threads[w - 1], NULL, worker_main, arg) != 0) {
+            free(arg);
+            log_error("Failed to start worker thread %u", w);
+            pool->num_workers = w;
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+    }
+    
+    log_info("Thread pool started with %u workers", num_workers);
+    return pool;
+}
+
+// Stop the workers and free the pool
+void thread_pool_destroy(thread_pool_t *pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    for (uint32_t w = 1; w < pool->num_workers && pool->threads; w++) {
+        pthread_join(pool->threads[w - 1], NULL);
+    }
+    
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    
+    mm_free(pool->threads);
+    mm_free(pool);
+}
+
+// Run a task on every worker and wait for all of them
+void thread_pool_run(thread_pool_t *pool, thread_task_fn task, void *arg) {
+    if (!pool || pool->num_workers <= 1) {
+        task(arg, 0, 1);
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->task_arg = arg;
+    pool->pending = pool->num_workers - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    task(arg, 0, pool->num_workers);
+    
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,34 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// Work function run by every worker of a pool
+typedef void (*thread_task_fn)(void *arg, uint32_t worker, uint32_t num_workers);
+
+// Fixed set of worker threads that run one task at a time. The calling
+// thread takes part as worker 0, so a pool of one thread spawns nothing.
+typedef struct {
+    pthread_t *threads;          // Spawned workers 1..num_workers-1
+    uint32_t num_workers;        // Workers including the caller
+    pthread_mutex_t mutex;
+    pthread_cond_t start_cond;   // Signals a new task
+    pthread_cond_t done_cond;    // Signals that all workers finished
+    thread_task_fn task;         // Current task
+    void *task_arg;              // Argument of the current task
+    uint64_t generation;         // Incremented for every task
+    uint32_t pending;            // Spawned workers still running the task
+    int shutdown;                // Set to stop the workers
+} thread_pool_t;
+
+// Create a pool; num_workers == 0 uses one worker per online CPU
+thread_pool_t *thread_pool_create(uint32_t num_workers);
+
+// Stop the workers and free the pool
+void thread_pool_destroy(thread_pool_t *pool);
+
+// Run task on every worker and wait until all of them return
+void thread_pool_run(thread_pool_t *pool, thread_task_fn task, void *arg);
+
+#endif // THREAD_POOL_H
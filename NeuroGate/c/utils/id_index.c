@@ -0,0 +1,172 @@
+#include "id_index.h"
+#include "log.h"
+#include "../memory/mm.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Maximum load factor before the table doubles, as a fraction of 8
+#define ID_INDEX_MAX_LOAD 5
+
+// Scramble an ID so sequential IDs spread across the table
+static inline uint32_t id_hash(uint32_t id) {
+    id ^= id >> 16;
+    id *= 0x7feb352dU;
+    id ^= id >> 15;
+    id *= 0x846ca68bU;
+    id ^= id >> 16;
+    return id;
+}
+
+// Allocate empty buckets
+static int id_index_alloc(id_index_t *index, uint32_t capacity) {
+    uint32_t *keys = (uint32_t *)mm_alloc(capacity * sizeof(uint32_t));
+    uint32_t *slots = (uint32_t *)mm_alloc(capacity * sizeof(uint32_t));
+    if (!keys || !slots) {
+        mm_free(keys);
+        mm_free(slots);
+        log_error("Failed to allocate ID index with %u buckets", capacity);
+        return -1;
+    }
+    
+    memset(slots, 0xFF, capacity * sizeof(uint32_t));
+    index->keys = keys;
+    index->slots = slots;
+    index->capacity = capacity;
+    index->count = 0;
+    return 0;
+}
+
+// Initialize an index
+int id_index_init(id_index_t *index, uint32_t expected) {
+    if (!index) {
+        log_error("NULL index in id_index_init");
+        return -1;
+    }
+    
+    uint32_t capacity = 16;
+    while ((uint64_t)capacity * ID_INDEX_MAX_LOAD < (uint64_t)expected * 8) {
+        capacity <<= 1;
+    }
+    
+    return id_index_alloc(index, capacity);
+}
+
+// Free the index
+void id_index_free(id_index_t *index) {
+    if (!index) return;
+    
+    mm_free(index->keys);
+    mm_free(index->slots);
+    memset(index, 0, sizeof(id_index_t));
+}
+
+// Double the table and reinsert every ID
+static int id_index_grow(id_index_t *index) {
+    id_index_t old = *index;
+    
+    if (id_index_alloc(index, old.capacity * 2) != 0) {
+        *index = old;
+        return -1;
+    }
+    
+    for (uint32_t b = 0; b < old.capacity; b++) {
+        if (old.slots[b] != ID_INDEX_EMPTY) {
+            id_index_put(index, old.keys[b], old.slots[b]);
+        }
+    }
+    
+    mm_free(old.keys);
+    mm_free(old.slots);
+    return 0;
+}
+
+// Insert or update the slot of an ID
+int id_index_put(id_index_t *index, uint32_t id, uint32_t slot) {
+    if (!index || !index->slots || slot == ID_INDEX_EMPTY) {
+        return -1;
+    }
+    
+    if ((uint64_t)(index->count + 1) * 8 > (uint64_t)index->capacity * ID_INDEX_MAX_LOAD &&
+        id_index_grow(index) != 0) {
+        return -1;
+    }
+    
+    uint32_t mask = index->capacity - 1;
+    uint32_t b = id_hash(id) & mask;
+    
+    while (index->slots[b] != ID_INDEX_EMPTY) {
+        if (index->keys[b] == id) {
+            index->slots[b] = slot;
+            return 0;
+        }
+        b = (b + 1) & mask;
+    }
+    
+    index->keys[b] = id;
+    index->slots[b] = slot;
+    index->count++;
+    return 0;
+}
+
+// Look up the slot of an ID
+int64_t id_index_get(const id_index_t *index, uint32_t id) {
+    if (!index || !index->slots) {
+        return -1;
+    }
+    
+    uint32_t mask = index->capacity - 1;
+    uint32_t b = id_hash(id) & mask;
+    
+    while (index->slots[b] != ID_INDEX_EMPTY) {
+        if (index->keys[b] == id) {
+            return index->slots[b];
+        }
+        b = (b + 1) & mask;
+    }
+    
+    return -1;
+}
+
+// Remove an ID
+int id_index_remove(id_index_t *index, uint32_t id) {
+    if (!index || !index->slots) {
+        return -1;
+    }
+    
+    uint32_t mask = index->capacity - 1;
+    uint32_t b = id_hash(id) & mask;
+    
+    while (index->slots[b] != ID_INDEX_EMPTY && index->keys[b] != id) {
+        b = (b + 1) & mask;
+    }
+    
+    if (index->slots[b] == ID_INDEX_EMPTY) {
+        return -1;
+    }
+    
+    // Shift later entries of the probe run back into the hole, so that
+    // every remaining ID stays reachable from its home bucket
+    uint32_t hole = b;
+    uint32_t next = (b + 1) & mask;
+    while (index->slots[next] != ID_INDEX_EMPTY) {
+        uint32_t home = id_hash(index->keys[next]) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->keys[hole] = index->keys[next];
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    
+    index->slots[hole] = ID_INDEX_EMPTY;
+    index->count--;
+    return 0;
+}
+
+// Remove every ID
+void id_index_clear(id_index_t *index) {
+    if (!index || !index->slots) return;
+    
+    memset(index->slots, 0xFF, index->capacity * sizeof(uint32_t));
+    index->count = 0;
+}
@@ -0,0 +1,35 @@
+#ifndef ID_INDEX_H
+#define ID_INDEX_H
+
+#include <stdint.h>
+
+// Open-addressing hash index from a 32-bit ID to a slot. Uses linear
+// probing and backward-shift deletion, so lookups never walk tombstones.
+typedef struct {
+    uint32_t *keys;              // IDs
+    uint32_t *slots;             // Slot per ID, ID_INDEX_EMPTY if unused
+    uint32_t capacity;           // Number of buckets (power of two)
+    uint32_t count;              // Number of stored IDs
+} id_index_t;
+
+#define ID_INDEX_EMPTY 0xFFFFFFFFu
+
+// Initialize an index sized for at least the given number of IDs
+int id_index_init(id_index_t *index, uint32_t expected);
+
+// Free the index
+void id_index_free(id_index_t *index);
+
+// Insert or update the slot of an ID
+int id_index_put(id_index_t *index, uint32_t id, uint32_t slot);
+
+// Look up the slot of an ID, or -1 if absent
+int64_t id_index_get(const id_index_t *index, uint32_t id);
+
+// Remove an ID; returns 0 if it was present
+int id_index_remove(id_index_t *index, uint32_t id);
+
+// Remove every ID
+void id_index_clear(id_index_t *index);
+
+#endif // ID_INDEX_H
@@ -77,11 +77,12 @@ static void log_internal(log_level_t level, const char *format, va_list args) {
         return;  // Skip messages below current log level
     }
     
-    // Get current time
+    // Get current time; sessions on other threads may log concurrently
     time_t now = time(NULL);
-    struct tm *timeinfo = localtime(&now);
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);
     char time_str[20];
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", timeinfo);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &timeinfo);
     
     // Format for file output
     if (g_log_file != NULL) {
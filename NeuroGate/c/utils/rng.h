@@ -0,0 +1,53 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3", SC 2011): a counter-based generator. Each 128-bit counter is
+// encrypted under a 64-bit key into four independent 32-bit words, so a
+// value is a pure function of (key, counter) and needs no stream state:
+// any thread can draw the value of any (seed, neuron, step) directly, and
+// results do not depend on how work is split.
+
+// Round multipliers and Weyl key increments
+#define RNG_PHILOX_M0 0xD2511F53u
+#define RNG_PHILOX_M1 0xCD9E8D57u
+#define RNG_PHILOX_W0 0x9E3779B9u
+#define RNG_PHILOX_W1 0xBB67AE85u
+#define RNG_PHILOX_ROUNDS 10
+
+// Four words of one counter
+typedef struct {
+    uint32_t v[4];
+} rng_block_t;
+
+// Encrypt a counter under a key
+static inline rng_block_t rng_philox(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint64_t key) {
+    uint32_t k0 = (uint32_t)key;
+    uint32_t k1 = (uint32_t)(key >> 32);
+    
+    for (int round = 0; round < RNG_PHILOX_ROUNDS; round++) {
+        uint64_t p0 = (uint64_t)RNG_PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)RNG_PHILOX_M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += RNG_PHILOX_W0;
+        k1 += RNG_PHILOX_W1;
+    }
+    
+    rng_block_t out = { { c0, c1, c2, c3 } };
+    return out;
+}
+
+// Uniform float in (0, 1) from the top 24 bits of a word; never 0, so its
+// logarithm is finite
+static inline float rng_unit(uint32_t bits) {
+    return ((float)(bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+}
+
+#endif // RNG_H
\ No newline at end of file
@@ -1,8 +1,15 @@
 package interop;
 
+import simulation.PopulationStats;
+import simulation.SpikeRaster;
+
 /**
  * NeuroBridge provides the Java interface to the C-based NeuroCore library.
  * It uses JNI (Java Native Interface) to call native C functions.
+ * 
+ * Each instance owns an independent native simulation context, so several
+ * sessions can run concurrently in one JVM. A single instance is not
+ * thread-safe.
  */
 public class NeuroBridge {
     
@@ -18,84 +25,428 @@ public class NeuroBridge {
         }
     }
     
+    // Handle of the native simulation context, 0 when not initialized
+    private long context;
+    
     // Native methods defined in C (bridge.c)
     
     /**
-     * Initialize the NeuroCore system.
+     * Create an independent simulation context.
      * 
-     * @return 1 on success, negative value on error
+     * @param numThreads Workers that step the simulation, 0 for one per CPU
+     * @return The context handle, or 0 on error
      */
-    public native int initCore();
+    public native long initCore(int numThreads);
     
     /**
-     * Clean up the NeuroCore system.
+     * Destroy a simulation context.
+     * 
+     * @param context The context handle returned by initCore
      */
-    public native void cleanupCore();
+    public native void cleanupCore(long context);
     
     /**
      * Create a new neuron.
      * 
+     * @param context The context handle returned by initCore
      * @param id The unique identifier for the neuron
      * @param type The type of neuron (0 = excitatory, 1 = inhibitory)
      * @param activation The activation function (0 = linear, 1 = sigmoid, 2 = relu, 3 = tanh)
      * @return A pointer to the neuron (as a long) or 0 on failure
      */
-    public native long createNeuron(int id, int type, int activation);
+    public native long createNeuron(long context, int id, int type, int activation);
     
     /**
      * Delete a neuron.
      * 
+     * @param context The context handle returned by initCore
      * @param neuronPtr Pointer to the neuron (returned from createNeuron)
      */
-    public native void deleteNeuron(long neuronPtr);
+    public native void deleteNeuron(long context, long neuronPtr);
     
     /**
      * Connect two neurons.
      * 
+     * @param context The context handle returned by initCore
      * @param sourcePtr Pointer to the source neuron
      * @param targetPtr Pointer to the target neuron
      * @return 0 on success, negative value on error
      */
-    public native int connectNeurons(long sourcePtr, long targetPtr);
+    public native int connectNeurons(long context, long sourcePtr, long targetPtr);
+    
+    /**
+     * Connect neurons from an edge list. Duplicate and existing connections
+     * are skipped.
+     * 
+     * @param context The context handle returned by initCore
+     * @param pairs Flattened (source ID, target ID) pairs
+     * @return The number of connections added, or negative value on error
+     */
+    public native int connectNeuronsBulk(long context, int[] pairs);
     
     /**
      * Create a synapse between two neurons.
      * 
+     * @param context The context handle returned by initCore
      * @param id The unique identifier for the synapse
      * @param preId The ID of the presynaptic neuron
      * @param postId The ID of the postsynaptic neuron
      * @param type The type of synapse (0 = excitatory, 1 = inhibitory, 2 = modulatory)
      * @return A pointer to the synapse (as a long) or 0 on failure
      */
-    public native long createSynapse(int id, int preId, int postId, int type);
+    public native long createSynapse(long context, int id, int preId, int postId, int type);
+    
+    /**
+     * Set the plasticity rule and weight bounds of a synapse.
+     * 
+     * @param context The context handle returned by initCore
+     * @param id The ID of the synapse
+     * @param plasticity The plasticity type (0 = static, 1 = STDP, 2 = Hebbian, 3 = homeostatic)
+     * @param minWeight The lower bound for learned weights
+     * @param maxWeight The upper bound for learned weights
+     * @return 0 on success, negative value on error
+     */
+    public native int setSynapsePlasticity(long context, int id, int plasticity, float minWeight, float maxWeight);
+    
+    /**
+     * Get the current weight of a synapse, including learned changes.
+     * 
+     * @param context The context handle returned by initCore
+     * @param id The ID of the synapse
+     * @return The synaptic weight, or 0 if the synapse does not exist
+     */
+    public native float getSynapseWeight(long context, int id);
     
     /**
      * Run a simulation step with the given inputs.
      * 
+     * @param context The context handle returned by initCore
      * @param inputs Array of input values for input neurons
      * @param timeStep The time step to advance the simulation
      * @return Array of output values from all neurons
      */
-    public native float[] runSimulationStep(float[] inputs, float timeStep);
+    public native float[] runSimulationStep(long context, float[] inputs, float timeStep);
+    
+    /**
+     * Advance the simulation by several steps without copying outputs.
+     * 
+     * @param context The context handle returned by initCore
+     * @param timeStep The time step to advance the simulation
+     * @param numSteps The number of steps to run
+     * @return The simulation time after the steps, or a negative value on error
+     */
+    public native float advanceSimulation(long context, float timeStep, int numSteps);
+    
+    /**
+     * Queue input currents for a few neurons, added in the next step.
+     * 
+     * @param context The context handle returned by initCore
+     * @param indices Neuron indices, as in the arrays of runSimulationStep
+     * @param currents Input value for each index
+     * @return 0 on success, negative value on error
+     */
+    public native int injectCurrents(long context, int[] indices, float[] currents);
+    
+    /**
+     * Queue spike sources: their outgoing synapses deliver spikes as if the
+     * neurons fired in the next step.
+     * 
+     * @param context The context handle returned by initCore
+     * @param indices Neuron indices, as in the arrays of runSimulationStep
+     * @return 0 on success, negative value on error
+     */
+    public native int injectSpikes(long context, int[] indices);
+    
+    /**
+     * Name a range of neuron indices as an input channel.
+     * 
+     * @param context The context handle returned by initCore
+     * @param name The channel name; redefining a name moves its range
+     * @param first The first neuron index of the channel
+     * @param count The number of neurons in the channel
+     * @return The channel ID, or a negative value on error
+     */
+    public native int defineInputChannel(long context, String name, int first, int count);
+    
+    /**
+     * Queue input currents for neurons of a channel.
+     * 
+     * @param context The context handle returned by initCore
+     * @param channel The channel ID
+     * @param offsets Offsets into the channel, or null for its first neurons
+     * @param currents Input value for each offset
+     * @return 0 on success, negative value on error
+     */
+    public native int injectChannel(long context, int channel, int[] offsets, float[] currents);
+    
+    /**
+     * Queue spike sources of a channel.
+     * 
+     * @param context The context handle returned by initCore
+     * @param channel The channel ID
+     * @param offsets Offsets into the channel of the spiking neurons
+     * @return 0 on success, negative value on error
+     */
+    public native int injectChannelSpikes(long context, int channel, int[] offsets);
+    
+    /**
+     * Start or stop recording the spikes of every step.
+     * 
+     * @param context The context handle returned by initCore
+     * @param enabled Whether to record
+     * @param maxBytes Memory budget of the raster, keeping the most recent
+     *                 spikes; 0 keeps all of them
+     * @return 0 on success, negative value on error
+     */
+    public native int setSpikeRecording(long context, boolean enabled, long maxBytes);
+    
+    /**
+     * Record only the spikes of some neuron index ranges.
+     * 
+     * @param context The context handle returned by initCore
+     * @param ranges Pairs of first neuron index and count; empty records all neurons
+     * @return 0 on success, negative value on error
+     */
+    public native int selectRecording(long context, int[] ranges);
+    
+    /**
+     * Export the recorded spike raster in the format read by SpikeRaster.
+     * 
+     * @param context The context handle returned by initCore
+     * @param clear Whether to drop the exported spikes from the recording
+     * @return The encoded raster, or null on error
+     */
+    public native byte[] exportSpikes(long context, boolean clear);
+    
+    /**
+     * Keep running statistics of a range of neurons.
+     * 
+     * @param context The context handle returned by initCore
+     * @param first The first neuron index
+     * @param count The number of neurons
+     * @return The population index, or negative value on error
+     */
+    public native int definePopulation(long context, int first, int count);
+    
+    /**
+     * Get the statistics of a population since they were last cleared.
+     * 
+     * @param context The context handle returned by initCore
+     * @param population The population index returned by definePopulation
+     * @param clear Whether to start a new interval
+     * @return The fields read by PopulationStats, or null on error
+     */
+    public native double[] getPopulationStats(long context, int population, boolean clear);
+    
+    /**
+     * Generate the neurons and synapses of a network natively, in parallel.
+     * The synapses have no IDs; plastic ones use the shared weight bounds
+     * set by setSynapseStorage.
+     * 
+     * @param context The context handle returned by initCore
+     * @param topology The topology (0 = random, 1 = fixed in-degree,
+     *                 2 = small world, 3 = scale free, 4 = distance)
+     * @param numNeurons The number of neurons to create
+     * @param firstId The ID of the first neuron, the others follow
+     * @param degree In-degree, ring neighbors or edges per new neuron
+     * @param probability Connection, rewiring or peak probability
+     * @param length Decay length of the distance topology in neurons
+     * @param inhibitoryFraction Share of inhibitory neurons
+     * @param weight Weight of excitatory synapses, 0 for the default
+     * @param inhibitoryWeight Weight of inhibitory synapses, 0 for the default
+     * @param delay Transmission delay in ms, 0 for the default
+     * @param activation The activation function of every neuron
+     * @param plasticity The plasticity of every synapse
+     * @param model The neuron model of every neuron
+     * @param modelParams The model parameters, or null for its defaults
+     * @param seed Seed of the random choices
+     * @return The number of synapses created, or negative value on error
+     */
+    public native long generateNetwork(long context, int topology, int numNeurons, int firstId, int degree,
+                                       float probability, float length, float inhibitoryFraction,
+                                       float weight, float inhibitoryWeight, float delay,
+                                       int activation, int plasticity, int model, float[] modelParams,
+                                       long seed);
+    
+    /**
+     * Load synapses from an edge list, in parallel and without per-synapse
+     * records. The synapses have no IDs; plastic ones use the shared weight
+     * bounds set by setSynapseStorage.
+     * 
+     * @param context The context handle returned by initCore
+     * @param preIds Presynaptic neuron ID per synapse
+     * @param postIds Postsynaptic neuron ID per synapse
+     * @param weights Weight per synapse, or null for the default
+     * @param delays Transmission delay per synapse in ms, or null for the default
+     * @param plasticity The plasticity of every synapse
+     * @return The number of synapses loaded, or negative value on error
+     */
+    public native int loadSynapses(long context, int[] preIds, int[] postIds, float[] weights, float[] delays,
+                                   int plasticity);
+    
+    /**
+     * Move the neurons to slots that keep connected neurons close together.
+     * IDs keep their neurons; the step outputs and neuron indices follow
+     * the new slot order. Refused while input channels, populations,
+     * background input, neuron models other than LIF or recording are
+     * defined.
+     * 
+     * @param context The context handle returned by initCore
+     * @param method The order (0 = reverse Cuthill-McKee, 1 = breadth first)
+     * @return 0 on success, negative value on error
+     */
+    public native int reorderNeurons(long context, int method);
+    
+    /**
+     * Get the ID of the neuron in every slot.
+     * 
+     * @param context The context handle returned by initCore
+     * @return The IDs in the order of the step outputs, or null on error
+     */
+    public native int[] getNeuronIds(long context);
+    
+    /**
+     * Give a range of neurons Poisson background input, drawn natively in
+     * every step.
+     * 
+     * @param context The context handle returned by initCore
+     * @param first The first neuron index
+     * @param count The number of neurons
+     * @param rate The input events per neuron per second
+     * @param weight The input per event in mV
+     * @return The source index, or negative value on error
+     */
+    public native int addPoissonInput(long context, int first, int count, float rate, float weight);
+    
+    /**
+     * Give a range of neurons Gaussian background input, drawn natively in
+     * every step.
+     * 
+     * @param context The context handle returned by initCore
+     * @param first The first neuron index
+     * @param count The number of neurons
+     * @param mean The drift in mV per ms
+     * @param sigma The noise in mV per square root of ms
+     * @return The source index, or negative value on error
+     */
+    public native int addGaussianInput(long context, int first, int count, float mean, float sigma);
+    
+    /**
+     * Remove every background input.
+     * 
+     * @param context The context handle returned by initCore
+     * @return 0 on success, negative value on error
+     */
+    public native int clearBackgroundInput(long context);
+    
+    /**
+     * Set the seed of the background input.
+     * 
+     * @param context The context handle returned by initCore
+     * @param seed The seed
+     * @return 0 on success, negative value on error
+     */
+    public native int setNoiseSeed(long context, long seed);
+    
+    /**
+     * Create a population of neurons running one neuron model.
+     * 
+     * @param context The context handle returned by initCore
+     * @param firstId The ID of the first neuron, the others follow
+     * @param count The number of neurons
+     * @param model The neuron model
+     * @param params The model parameters, or null for its defaults
+     * @param activation The activation function of every neuron
+     * @return The index of the first neuron, or negative value on error
+     */
+    public native int createPopulation(long context, int firstId, int count, int model, float[] params,
+                                       int activation);
+    
+    /**
+     * Get the model state variables of a neuron besides its potential.
+     * 
+     * @param context The context handle returned by initCore
+     * @param neuronId The neuron ID
+     * @return The state variables, empty for LIF neurons, or null on error
+     */
+    public native float[] getModelState(long context, int neuronId);
+    
+    /**
+     * Select the accuracy of sigmoid and tanh outputs.
+     * 
+     * @param context The context handle returned by initCore
+     * @param accuracy The accuracy mode (0 = exact, 1 = fast, 2 = lookup table)
+     * @return 0 on success, negative value on error
+     */
+    public native int setActivationAccuracy(long context, int accuracy);
+    
+    /**
+     * Set how often slow plasticity runs and the rate homeostasis aims for.
+     * 
+     * @param context The context handle returned by initCore
+     * @param hebbianPeriod Steps between Hebbian updates, 0 to disable
+     * @param homeostaticPeriod Steps between homeostatic updates, 0 to disable
+     * @param targetRate The homeostatic target firing rate in Hz
+     * @return 0 on success, negative value on error
+     */
+    public native int setPlasticitySchedule(long context, int hebbianPeriod, int homeostaticPeriod, float targetRate);
+    
+    /**
+     * Select how synapses are stored. Compact storage rounds weights to 16
+     * or 8 bits, limits delays to 255 steps and bounds every plastic weight
+     * by the given range instead of each synapse's own bounds.
+     * 
+     * @param context The context handle returned by initCore
+     * @param storage The storage mode (0 = full, 1 = bfloat16, 2 = int8)
+     * @param minWeight Lower weight bound in compact storage
+     * @param maxWeight Upper weight bound in compact storage
+     * @return 0 on success, negative value on error
+     */
+    public native int setSynapseStorage(long context, int storage, float minWeight, float maxWeight);
+    
+    /**
+     * Select how neuron state is stored. Fixed point keeps potentials in
+     * 1/256 mV steps between -128 and +128 mV and halves the memory
+     * streamed per step.
+     * 
+     * @param context The context handle returned by initCore
+     * @param format The state format (0 = float, 1 = 16-bit fixed point)
+     * @return 0 on success, negative value on error
+     */
+    public native int setStateFormat(long context, int format);
     
     /**
      * Get memory usage statistics.
      * 
+     * @param context The context handle returned by initCore
      * @return The number of bytes currently allocated
      */
-    public native long getMemoryUsage();
+    public native long getMemoryUsage(long context);
     
     // Java wrapper methods for convenience
     
     /**
-     * Initialize the system and check for errors.
+     * Initialize the system with one worker per CPU and check for errors.
      * 
      * @throws RuntimeException if initialization fails
      */
     public void initialize() throws RuntimeException {
-        int result = initCore();
-        if (result <= 0) {
-            throw new RuntimeException("Failed to initialize NeuroCore: error code " + result);
+        initialize(0);
+    }
+    
+    /**
+     * Initialize the system and check for errors.
+     * 
+     * @param numThreads Workers that step the simulation, 0 for one per CPU
+     * @throws RuntimeException if initialization fails
+     */
+    public void initialize(int numThreads) throws RuntimeException {
+        if (context != 0) {
+            return;
+        }
+        context = initCore(numThreads);
+        if (context == 0) {
+            throw new RuntimeException("Failed to initialize NeuroCore");
         }
     }
     
@@ -103,7 +454,8 @@ public class NeuroBridge {
      * Clean up and release resources.
      */
     public void shutdown() {
-        cleanupCore();
+        cleanupCore(context);
+        context = 0;
     }
     
     /**
@@ -117,7 +469,7 @@ public class NeuroBridge {
      */
     public NeuronHandle createNeuron(int id, NeuronType type, ActivationFunction activation) 
             throws RuntimeException {
-        long ptr = createNeuron(id, type.ordinal(), activation.ordinal());
+        long ptr = createNeuron(context, id, type.ordinal(), activation.ordinal());
         if (ptr == 0) {
             throw new RuntimeException("Failed to create neuron with ID " + id);
         }
@@ -132,7 +484,7 @@ public class NeuroBridge {
      * @throws RuntimeException if connection fails
      */
     public void connectNeurons(NeuronHandle source, NeuronHandle target) throws RuntimeException {
-        int result = connectNeurons(source.getPointer(), target.getPointer());
+        int result = connectNeurons(context, source.getPointer(), target.getPointer());
         if (result != 0) {
             throw new RuntimeException(
                 "Failed to connect neurons " + source.getId() + " and " + target.getId()
@@ -140,6 +492,34 @@ public class NeuroBridge {
         }
     }
     
+    /**
+     * Connect many neurons at once, allocating each neuron's connections a
+     * single time. Much faster than connectNeurons per edge when building
+     * a network.
+     * 
+     * @param sourceIds The IDs of the source neurons
+     * @param targetIds The IDs of the target neurons, parallel to sourceIds
+     * @return The number of connections added
+     * @throws RuntimeException if the arrays differ in length or an ID is unknown
+     */
+    public int connectNeurons(int[] sourceIds, int[] targetIds) throws RuntimeException {
+        if (sourceIds.length != targetIds.length) {
+            throw new RuntimeException("Source and target IDs differ in length");
+        }
+        
+        int[] pairs = new int[2 * sourceIds.length];
+        for (int i = 0; i < sourceIds.length; i++) {
+            pairs[2 * i] = sourceIds[i];
+            pairs[2 * i + 1] = targetIds[i];
+        }
+        
+        int added = connectNeuronsBulk(context, pairs);
+        if (added < 0) {
+            throw new RuntimeException("Failed to connect " + sourceIds.length + " neuron pairs");
+        }
+        return added;
+    }
+    
     /**
      * Create a synapse between two neurons.
      * 
@@ -152,13 +532,40 @@ public class NeuroBridge {
      */
     public SynapseHandle createSynapse(int id, NeuronHandle source, NeuronHandle target, SynapseType type) 
             throws RuntimeException {
-        long ptr = createSynapse(id, source.getId(), target.getId(), type.ordinal());
+        long ptr = createSynapse(context, id, source.getId(), target.getId(), type.ordinal());
         if (ptr == 0) {
             throw new RuntimeException("Failed to create synapse with ID " + id);
         }
         return new SynapseHandle(id, ptr);
     }
     
+    /**
+     * Set the plasticity rule and weight bounds of a synapse.
+     * 
+     * @param synapse The synapse handle
+     * @param plasticity The plasticity type
+     * @param minWeight The lower bound for learned weights
+     * @param maxWeight The upper bound for learned weights
+     * @throws RuntimeException if the synapse does not exist or the bounds are invalid
+     */
+    public void setSynapsePlasticity(SynapseHandle synapse, PlasticityType plasticity,
+            float minWeight, float maxWeight) throws RuntimeException {
+        int result = setSynapsePlasticity(context, synapse.getId(), plasticity.ordinal(), minWeight, maxWeight);
+        if (result != 0) {
+            throw new RuntimeException("Failed to set plasticity of synapse " + synapse.getId());
+        }
+    }
+    
+    /**
+     * Get the current weight of a synapse, including learned changes.
+     * 
+     * @param synapse The synapse handle
+     * @return The synaptic weight, or 0 if the synapse does not exist
+     */
+    public float getSynapseWeight(SynapseHandle synapse) {
+        return getSynapseWeight(context, synapse.getId());
+    }
+    
     /**
      * Run a simulation step.
      * 
@@ -167,7 +574,411 @@ public class NeuroBridge {
      * @return Output values from all neurons
      */
     public float[] runSimulation(float[] inputs, float timeStep) {
-        return runSimulationStep(inputs, timeStep);
+        return runSimulationStep(context, inputs, timeStep);
+    }
+    
+    /**
+     * Advance the simulation without copying outputs. Input is given
+     * sparsely with the inject methods before each call.
+     * 
+     * @param timeStep Time step size
+     * @param numSteps Number of steps to run
+     * @return The simulation time after the steps
+     * @throws RuntimeException if a step fails
+     */
+    public float advance(float timeStep, int numSteps) throws RuntimeException {
+        float time = advanceSimulation(context, timeStep, numSteps);
+        if (time < 0) {
+            throw new RuntimeException("Failed to advance the simulation");
+        }
+        return time;
+    }
+    
+    /**
+     * Queue input currents for a few neurons, added in the next step.
+     * 
+     * @param indices Neuron indices
+     * @param currents Input value for each index
+     * @throws RuntimeException if an index is out of range
+     */
+    public void injectCurrents(int[] indices, float[] currents) throws RuntimeException {
+        if (injectCurrents(context, indices, currents) != 0) {
+            throw new RuntimeException("Failed to inject input currents");
+        }
+    }
+    
+    /**
+     * Queue spike sources for the next step.
+     * 
+     * @param indices Neuron indices
+     * @throws RuntimeException if an index is out of range
+     */
+    public void injectSpikes(int[] indices) throws RuntimeException {
+        if (injectSpikes(context, indices) != 0) {
+            throw new RuntimeException("Failed to inject input spikes");
+        }
+    }
+    
+    /**
+     * Name a range of neuron indices as an input channel.
+     * 
+     * @param name The channel name
+     * @param first The first neuron index
+     * @param count The number of neurons
+     * @return A channel handle for the inject methods
+     * @throws RuntimeException if the range or name is invalid
+     */
+    public InputChannel defineInputChannel(String name, int first, int count) throws RuntimeException {
+        int id = defineInputChannel(context, name, first, count);
+        if (id < 0) {
+            throw new RuntimeException("Failed to define input channel " + name);
+        }
+        return new InputChannel(id, name, first, count);
+    }
+    
+    /**
+     * Queue input currents for neurons of a channel.
+     * 
+     * @param channel The channel handle
+     * @param offsets Offsets into the channel, or null for its first neurons
+     * @param currents Input value for each offset
+     * @throws RuntimeException if an offset is out of range
+     */
+    public void injectChannel(InputChannel channel, int[] offsets, float[] currents) throws RuntimeException {
+        if (injectChannel(context, channel.getId(), offsets, currents) != 0) {
+            throw new RuntimeException("Failed to inject input on channel " + channel.getName());
+        }
+    }
+    
+    /**
+     * Queue spike sources of a channel.
+     * 
+     * @param channel The channel handle
+     * @param offsets Offsets into the channel of the spiking neurons
+     * @throws RuntimeException if an offset is out of range
+     */
+    public void injectChannelSpikes(InputChannel channel, int[] offsets) throws RuntimeException {
+        if (injectChannelSpikes(context, channel.getId(), offsets) != 0) {
+            throw new RuntimeException("Failed to inject spikes on channel " + channel.getName());
+        }
+    }
+    
+    /**
+     * Start recording spikes.
+     * 
+     * @param maxBytes Memory budget of the raster, keeping the most recent
+     *                 spikes; 0 keeps all of them
+     * @throws RuntimeException if recording cannot start
+     */
+    public void startRecording(long maxBytes) throws RuntimeException {
+        if (setSpikeRecording(context, true, maxBytes) != 0) {
+            throw new RuntimeException("Failed to start spike recording");
+        }
+    }
+    
+    /**
+     * Stop recording spikes; the recorded raster is kept for export.
+     */
+    public void stopRecording() {
+        setSpikeRecording(context, false, 0);
+    }
+    
+    /**
+     * Record only the spikes of some neuron index ranges, such as the
+     * neurons of a few populations.
+     * 
+     * @param ranges Pairs of first neuron index and count; none records all neurons
+     * @throws RuntimeException if the ranges are invalid
+     */
+    public void selectRecording(int... ranges) throws RuntimeException {
+        if (selectRecording(context, ranges) != 0) {
+            throw new RuntimeException("Failed to select recorded neurons");
+        }
+    }
+    
+    /**
+     * Export the spikes recorded so far.
+     * 
+     * @param clear Whether to drop the exported spikes, so that the next
+     *              export continues where this one ended
+     * @return The recorded raster
+     * @throws RuntimeException if the export fails
+     */
+    public SpikeRaster exportSpikes(boolean clear) throws RuntimeException {
+        byte[] data = exportSpikes(context, clear);
+        if (data == null) {
+            throw new RuntimeException("Failed to export recorded spikes");
+        }
+        return new SpikeRaster(data);
+    }
+    
+    /**
+     * Keep running statistics of a range of neurons, such as a layer or a
+     * cell type, as a side effect of every step.
+     * 
+     * @param first The first neuron index
+     * @param count The number of neurons
+     * @return The population index for getPopulationStats
+     * @throws RuntimeException if the range is invalid
+     */
+    public int definePopulation(int first, int count) throws RuntimeException {
+        int population = definePopulation(context, first, count);
+        if (population < 0) {
+            throw new RuntimeException("Failed to define population of " + count + " neurons at " + first);
+        }
+        return population;
+    }
+    
+    /**
+     * Get the statistics of a population since they were last cleared.
+     * 
+     * @param population The population index
+     * @param clear Whether to start a new interval after this one
+     * @return The statistics of the interval
+     * @throws RuntimeException if the population is unknown
+     */
+    public PopulationStats getPopulationStats(int population, boolean clear) throws RuntimeException {
+        double[] fields = getPopulationStats(context, population, clear);
+        if (fields == null) {
+            throw new RuntimeException("Failed to get statistics of population " + population);
+        }
+        return new PopulationStats(fields);
+    }
+    
+    /**
+     * Generate a network natively. This is much faster than creating the
+     * neurons and synapses one by one, and the result depends on the seed
+     * only, not on the number of workers.
+     * 
+     * @param spec The network to generate
+     * @return The number of synapses created
+     * @throws RuntimeException if the spec is invalid or an ID is in use
+     */
+    public long generateNetwork(NetworkSpec spec) throws RuntimeException {
+        long synapses = generateNetwork(context, spec.topology.ordinal(), spec.numNeurons, spec.firstId,
+                                        spec.degree, spec.probability, spec.length, spec.inhibitoryFraction,
+                                        spec.weight, spec.inhibitoryWeight, spec.delay,
+                                        spec.activation.ordinal(), spec.plasticity.ordinal(),
+                                        spec.model.ordinal(), spec.modelParams, spec.seed);
+        if (synapses < 0) {
+            throw new RuntimeException("Failed to generate " + spec.topology + " network of " +
+                                       spec.numNeurons + " neurons");
+        }
+        return synapses;
+    }
+    
+    /**
+     * Load synapses from an edge list. Much faster than createSynapse per
+     * synapse: the IDs are resolved and the synapse index is built on every
+     * worker.
+     * 
+     * @param preIds Presynaptic neuron ID per synapse
+     * @param postIds Postsynaptic neuron ID per synapse
+     * @param weights Weight per synapse, or null for the default
+     * @param delays Transmission delay per synapse in ms, or null for the default
+     * @param plasticity The plasticity of every synapse
+     * @return The number of synapses loaded
+     * @throws RuntimeException if the arrays differ in length or an ID is unknown
+     */
+    public int loadSynapses(int[] preIds, int[] postIds, float[] weights, float[] delays,
+                            PlasticityType plasticity) throws RuntimeException {
+        int loaded = loadSynapses(context, preIds, postIds, weights, delays, plasticity.ordinal());
+        if (loaded < 0) {
+            throw new RuntimeException("Failed to load " + preIds.length + " synapses");
+        }
+        return loaded;
+    }
+    
+    /**
+     * Move the neurons to slots that keep connected neurons close together,
+     * which speeds up spike delivery on large networks. Run after the
+     * network is built and before channels, populations, background input
+     * or recording are defined. Networks with neuron models other than LIF
+     * cannot be reordered.
+     * 
+     * @param order The slot order
+     * @return The neuron IDs in the new order of the step outputs
+     * @throws RuntimeException if the neurons cannot be moved
+     */
+    public int[] reorderNeurons(NeuronOrder order) throws RuntimeException {
+        if (reorderNeurons(context, order.ordinal()) != 0) {
+            throw new RuntimeException("Failed to reorder neurons by " + order);
+        }
+        return getNeuronIds();
+    }
+    
+    /**
+     * Get the ID of the neuron behind every step output.
+     * 
+     * @return The neuron IDs in slot order
+     * @throws RuntimeException if the IDs cannot be read
+     */
+    public int[] getNeuronIds() throws RuntimeException {
+        int[] ids = getNeuronIds(context);
+        if (ids == null) {
+            throw new RuntimeException("Failed to get neuron IDs");
+        }
+        return ids;
+    }
+    
+    /**
+     * Give a range of neurons independent input events arriving at a fixed
+     * rate, as from a large unmodeled population. The events are drawn
+     * natively in every step, so no input crosses JNI.
+     * 
+     * @param first The first neuron index
+     * @param count The number of neurons
+     * @param rate The input events per neuron per second
+     * @param weight The input per event in mV
+     * @return The source index
+     * @throws RuntimeException if the range or rate is invalid
+     */
+    public int addPoissonInput(int first, int count, float rate, float weight) throws RuntimeException {
+        int source = addPoissonInput(context, first, count, rate, weight);
+        if (source < 0) {
+            throw new RuntimeException("Failed to add Poisson input to " + count + " neurons at " + first);
+        }
+        return source;
+    }
+    
+    /**
+     * Give a range of neurons a white-noise input current with a drift,
+     * drawn natively in every step. Each step adds mean * dt plus a normal
+     * deviate of standard deviation sigma * sqrt(dt).
+     * 
+     * @param first The first neuron index
+     * @param count The number of neurons
+     * @param mean The drift in mV per ms
+     * @param sigma The noise in mV per square root of ms
+     * @return The source index
+     * @throws RuntimeException if the range or sigma is invalid
+     */
+    public int addGaussianInput(int first, int count, float mean, float sigma) throws RuntimeException {
+        int source = addGaussianInput(context, first, count, mean, sigma);
+        if (source < 0) {
+            throw new RuntimeException("Failed to add Gaussian input to " + count + " neurons at " + first);
+        }
+        return source;
+    }
+    
+    /**
+     * Remove every background input.
+     * 
+     * @throws RuntimeException if the input cannot be removed
+     */
+    public void clearBackgroundInput() throws RuntimeException {
+        if (clearBackgroundInput(context) != 0) {
+            throw new RuntimeException("Failed to clear background input");
+        }
+    }
+    
+    /**
+     * Set the seed of the background input. Runs with the same seed receive
+     * the same input, whatever the number of threads.
+     * 
+     * @param seed The seed
+     * @throws RuntimeException if the seed cannot be set
+     */
+    public void setNoiseSeed(long seed) throws RuntimeException {
+        if (setNoiseSeed(context, seed) != 0) {
+            throw new RuntimeException("Failed to set noise seed");
+        }
+    }
+    
+    /**
+     * Create a population of neurons running one neuron model, integrated
+     * natively by the model's batch kernel. Synaptic and background input
+     * move the membrane potential in mV, as for LIF neurons.
+     * 
+     * @param firstId The ID of the first neuron, the others follow
+     * @param count The number of neurons
+     * @param model The neuron model
+     * @param params The model parameters in the order of NeuronModel, or null for its defaults
+     * @param activation The activation function of every neuron
+     * @return The index of the first neuron
+     * @throws RuntimeException if the parameters do not fit the model or an ID is in use
+     */
+    public int createPopulation(int firstId, int count, NeuronModel model, float[] params,
+                                ActivationFunction activation) throws RuntimeException {
+        int first = createPopulation(context, firstId, count, model.ordinal(), params, activation.ordinal());
+        if (first < 0) {
+            throw new RuntimeException("Failed to create " + model + " population of " + count + " neurons");
+        }
+        return first;
+    }
+    
+    /**
+     * Get the model state variables of a neuron besides its potential, in
+     * the order listed by NeuronModel.
+     * 
+     * @param neuronId The neuron ID
+     * @return The state variables, empty for LIF neurons
+     * @throws RuntimeException if the neuron does not exist
+     */
+    public float[] getModelState(int neuronId) throws RuntimeException {
+        float[] state = getModelState(context, neuronId);
+        if (state == null) {
+            throw new RuntimeException("Failed to get model state of neuron " + neuronId);
+        }
+        return state;
+    }
+    
+    /**
+     * Select the accuracy of sigmoid and tanh outputs.
+     * 
+     * @param accuracy The accuracy mode
+     * @throws RuntimeException if the mode cannot be set
+     */
+    public void setActivationAccuracy(ActivationAccuracy accuracy) throws RuntimeException {
+        int result = setActivationAccuracy(context, accuracy.ordinal());
+        if (result != 0) {
+            throw new RuntimeException("Failed to set activation accuracy " + accuracy);
+        }
+    }
+    
+    /**
+     * Set how often slow plasticity runs and the rate homeostasis aims for.
+     * 
+     * @param hebbianPeriod Steps between Hebbian updates, 0 to disable
+     * @param homeostaticPeriod Steps between homeostatic updates, 0 to disable
+     * @param targetRate The homeostatic target firing rate in Hz
+     * @throws RuntimeException if the schedule is invalid
+     */
+    public void setPlasticitySchedule(int hebbianPeriod, int homeostaticPeriod, float targetRate)
+            throws RuntimeException {
+        int result = setPlasticitySchedule(context, hebbianPeriod, homeostaticPeriod, targetRate);
+        if (result != 0) {
+            throw new RuntimeException("Failed to set plasticity schedule");
+        }
+    }
+    
+    /**
+     * Select how synapses are stored.
+     * 
+     * @param storage The storage mode
+     * @param minWeight Lower weight bound in compact storage
+     * @param maxWeight Upper weight bound in compact storage
+     * @throws RuntimeException if the mode cannot be set
+     */
+    public void setSynapseStorage(SynapseStorage storage, float minWeight, float maxWeight)
+            throws RuntimeException {
+        int result = setSynapseStorage(context, storage.ordinal(), minWeight, maxWeight);
+        if (result != 0) {
+            throw new RuntimeException("Failed to set synapse storage " + storage);
+        }
+    }
+    
+    /**
+     * Select how neuron state is stored.
+     * 
+     * @param format The state format
+     * @throws RuntimeException if the format cannot be set
+     */
+    public void setStateFormat(StateFormat format) throws RuntimeException {
+        int result = setStateFormat(context, format.ordinal());
+        if (result != 0) {
+            throw new RuntimeException("Failed to set state format " + format);
+        }
     }
     
     /**
@@ -176,7 +987,7 @@ public class NeuroBridge {
      * @return Memory usage in bytes
      */
     public long getMemoryUsage() {
-        return getMemoryUsage();
+        return getMemoryUsage(context);
     }
     
     // Neuron types enum
@@ -193,6 +1004,34 @@ public class NeuroBridge {
         TANH
     }
     
+    // Synapse plasticity enum
+    public enum PlasticityType {
+        STATIC,
+        STDP,
+        HEBBIAN,
+        HOMEOSTATIC
+    }
+    
+    // Activation accuracy enum: libm, ~1e-4 polynomial, interpolated table
+    public enum ActivationAccuracy {
+        EXACT,
+        FAST,
+        LOOKUP_TABLE
+    }
+    
+    // Synapse storage enum: float, bfloat16 or int8 weights
+    public enum SynapseStorage {
+        FULL,
+        BF16,
+        INT8
+    }
+    
+    // Neuron state format enum: 32-bit float or 16-bit fixed point
+    public enum StateFormat {
+        FLOAT,
+        FIXED16
+    }
+    
     // Synapse types enum
     public enum SynapseType {
         EXCITATORY,
@@ -200,6 +1039,46 @@ public class NeuroBridge {
         MODULATORY
     }
     
+    // Neuron slot order enum: reverse Cuthill-McKee or breadth first
+    public enum NeuronOrder {
+        RCM,
+        BFS
+    }
+    
+    // Neuron model enum. Parameters, in order, with units and defaults:
+    // IZHIKEVICH: a, b, c (mV), d, peak (mV); 0.02, 0.2, -65, 8, 30; state u
+    // ADEX: C (pF), g_L (nS), E_L, V_T, delta_T (mV), tau_w (ms), a (nS),
+    //       b (pA), V_reset, V_peak (mV); 281, 30, -70.6, -50.4, 2, 144, 4,
+    //       80.5, -70.6, -40.4; state w
+    // HODGKIN_HUXLEY: C (uF/cm^2), g_Na, g_K, g_L (mS/cm^2), E_Na, E_K, E_L,
+    //       V_spike (mV); 1, 120, 36, 0.3, 50, -77, -54.387, 0; state m, h, n
+    public enum NeuronModel {
+        LIF,
+        IZHIKEVICH,
+        ADEX,
+        HODGKIN_HUXLEY
+    }
+    
+    // Network topology enum
+    public enum Topology {
+        RANDOM,
+        FIXED_INDEGREE,
+        SMALL_WORLD,
+        SCALE_FREE,
+        DISTANCE;
+        
+        /**
+         * Look up a topology by its configuration name, e.g. "small_world".
+         * 
+         * @param name The name, in any case, with '_' or '-'
+         * @return The topology
+         * @throws IllegalArgumentException if the name is unknown
+         */
+        public static Topology fromName(String name) throws IllegalArgumentException {
+            return valueOf(name.trim().toUpperCase().replace('-', '_'));
+        }
+    }
+    
     // Handle classes for neurons and synapses
     
     /**
@@ -243,4 +1122,121 @@ public class NeuroBridge {
             return pointer;
         }
     }
+    
+    /**
+     * Handle for a named input channel: a range of neuron indices.
+     */
+    public static class InputChannel {
+        private final int id;
+        private final String name;
+        private final int first;
+        private final int count;
+        
+        public InputChannel(int id, String name, int first, int count) {
+            this.id = id;
+            this.name = name;
+            this.first = first;
+            this.count = count;
+        }
+        
+        public int getId() {
+            return id;
+        }
+        
+        public String getName() {
+            return name;
+        }
+        
+        public int getFirst() {
+            return first;
+        }
+        
+        public int getCount() {
+            return count;
+        }
+    }
+    
+    /**
+     * Description of a network for generateNetwork. Unset weights and
+     * delays take the native defaults.
+     */
+    public static class NetworkSpec {
+        private final Topology topology;
+        private final int numNeurons;
+        private int firstId = 0;
+        private int degree = 0;
+        private float probability = 0.0f;
+        private float length = 0.0f;
+        private float inhibitoryFraction = 0.0f;
+        private float weight = 0.0f;
+        private float inhibitoryWeight = 0.0f;
+        private float delay = 0.0f;
+        private ActivationFunction activation = ActivationFunction.LINEAR;
+        private PlasticityType plasticity = PlasticityType.STATIC;
+        private NeuronModel model = NeuronModel.LIF;
+        private float[] modelParams = null;
+        private long seed = 0;
+        
+        public NetworkSpec(Topology topology, int numNeurons) {
+            this.topology = topology;
+            this.numNeurons = numNeurons;
+        }
+        
+        public NetworkSpec firstId(int firstId) {
+            this.firstId = firstId;
+            return this;
+        }
+        
+        public NetworkSpec degree(int degree) {
+            this.degree = degree;
+            return this;
+        }
+        
+        public NetworkSpec probability(float probability) {
+            this.probability = probability;
+            return this;
+        }
+        
+        public NetworkSpec length(float length) {
+            this.length = length;
+            return this;
+        }
+        
+        public NetworkSpec inhibitoryFraction(float inhibitoryFraction) {
+            this.inhibitoryFraction = inhibitoryFraction;
+            return this;
+        }
+        
+        public NetworkSpec weights(float weight, float inhibitoryWeight) {
+            this.weight = weight;
+            this.inhibitoryWeight = inhibitoryWeight;
+            return this;
+        }
+        
+        public NetworkSpec delay(float delay) {
+            this.delay = delay;
+            return this;
+        }
+        
+        public NetworkSpec activation(ActivationFunction activation) {
+            this.activation = activation;
+            return this;
+        }
+        
+        public NetworkSpec plasticity(PlasticityType plasticity) {
+            this.plasticity = plasticity;
+            return this;
+        }
+        
+        public NetworkSpec model(NeuronModel model, float[] params) {
+            this.model = model;
+            this.modelParams = params;
+            return this;
+        }
+        
+        public NetworkSpec seed(long seed) {
+            this.seed = seed;
+            return this;
+        }
+    }
 }
\ No newline at end of file
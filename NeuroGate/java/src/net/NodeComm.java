@@ -1,13 +1,17 @@
 package net;
 
 import core.NodeController.SimulationConfig;
+import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
 import java.io.OutputStream;
 import java.net.Socket;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
 import java.util.HashMap;
 import java.util.Map;
 import java.util.logging.Logger;
+import simulation.SpikeRaster;
 
 /**
  * NodeComm handles TCP/UDP communication with C-based nodes.
@@ -142,26 +146,35 @@ public class NodeComm {
      * @return A map containing results data
      */
     public Map<String, Object> getResults(String sessionId) {
-        // For demonstration purposes, we're returning simulated results
         logger.fine("Getting results for session " + sessionId + " on node " + address + ":" + port);
         
         Map<String, Object> results = new HashMap<>();
         results.put("sessionId", sessionId);
         results.put("timestamp", System.currentTimeMillis());
         
-        // Simulated neuron states
-        Map<Integer, Float> neuronStates = new HashMap<>();
-        for (int i = 0; i < 10; i++) {
-            neuronStates.put(i, (float) Math.random());
+        SpikeRaster raster;
+        try {
+            Socket socket = createSocket();
+            
+            // Request the spikes recorded since the last results
+            sendMessage(socket, createResultsMessage(sessionId));
+            
+            // The raster may be far larger than one read
+            byte[] response = receiveAll(socket);
+            
+            socket.close();
+            
+            raster = parseResultsResponse(response);
+        } catch (IOException | IllegalArgumentException e) {
+            logger.severe("Error getting results from node " + address + ":" + port + ": " + e.getMessage());
+            return null;
         }
-        results.put("neuronStates", neuronStates);
         
-        // Simulated synapse states
-        Map<Integer, Float> synapseStates = new HashMap<>();
-        for (int i = 0; i < 20; i++) {
-            synapseStates.put(i, (float) Math.random());
-        }
-        results.put("synapseStates", synapseStates);
+        results.put("spikeRaster", raster);
+        results.put("spikeCount", raster.getSpikeCount());
+        results.put("droppedSpikes", raster.getDroppedSpikes());
+        results.put("firstStep", raster.getFirstStep());
+        results.put("lastStep", raster.getLastStep());
         
         return results;
     }
@@ -228,6 +241,20 @@ public class NodeComm {
         return new byte[] { MSG_INIT };
     }
     
+    /**
+     * Create a results request for the given session.
+     * 
+     * @param sessionId The session ID
+     * @return A byte array containing the message
+     */
+    private byte[] createResultsMessage(String sessionId) {
+        byte[] id = sessionId.getBytes(StandardCharsets.UTF_8);
+        byte[] message = new byte[1 + id.length];
+        message[0] = MSG_RESULTS;
+        System.arraycopy(id, 0, message, 1, id.length);
+        return message;
+    }
+    
     /**
      * Send a message to the node.
      * 
@@ -268,6 +295,28 @@ public class NodeComm {
         return result;
     }
     
+    /**
+     * Receive everything the node sends until it closes the connection.
+     * 
+     * @param socket The socket to receive from
+     * @return The received bytes
+     * @throws IOException if receiving fails
+     */
+    private byte[] receiveAll(Socket socket) throws IOException {
+        logger.fine("Receiving results from " + address + ":" + port);
+        
+        InputStream in = socket.getInputStream();
+        ByteArrayOutputStream result = new ByteArrayOutputStream();
+        byte[] buffer = new byte[64 * 1024];
+        int length;
+        
+        while ((length = in.read(buffer)) > 0) {
+            result.write(buffer, 0, length);
+        }
+        
+        return result.toByteArray();
+    }
+    
     /**
      * Parse the response to an initialization message.
      * 
@@ -279,4 +328,22 @@ public class NodeComm {
         // For demonstration, we'll assume success if the response is not empty
         return response.length > 0 && response[0] == 1;
     }
+
+    /**
+     * Parse the response to a results request: a status byte followed by the
+     * spike raster exported by the node, if it recorded any.
+     * 
+     * @param response The response bytes
+     * @return The spike raster
+     * @throws IOException if the node reported an error
+     */
+    private SpikeRaster parseResultsResponse(byte[] response) throws IOException {
+        if (response.length == 0 || response[0] != 1) {
+            throw new IOException("Node failed to export results");
+        }
+        if (response.length == 1) {
+            return SpikeRaster.empty();
+        }
+        return new SpikeRaster(Arrays.copyOfRange(response, 1, response.length));
+    }
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+package simulation;
+
+/**
+ * PopulationStats holds the running statistics of a population of a
+ * NeuroCore context: a contiguous range of neuron indices whose spikes and
+ * membrane potentials are summed during the step, covering the steps since
+ * the statistics were last cleared.
+ * 
+ * Potentials are only sampled in dense steps; event-driven steps count
+ * spikes alone, so the potential figures cover the sampled steps.
+ */
+public class PopulationStats {
+    
+    // Number of fields returned by the native call
+    public static final int FIELDS = 12;
+    
+    private final int first;
+    private final int count;
+    private final long steps;
+    private final long sampledSteps;
+    private final long spikes;
+    private final double rate;
+    private final double spikeFano;
+    private final double potentialMean;
+    private final double potentialVariance;
+    private final double lastMean;
+    private final double lastVariance;
+    private final double synchrony;
+    
+    /**
+     * Wrap the fields returned by the native call.
+     * 
+     * @param fields The statistics in native order
+     * @throws IllegalArgumentException if the field count is wrong
+     */
+    public PopulationStats(double[] fields) throws IllegalArgumentException {
+        if (fields == null || fields.length != FIELDS) {
+            throw new IllegalArgumentException("Population statistics need " + FIELDS + " fields");
+        }
+        
+        this.first = (int) fields[0];
+        this.count = (int) fields[1];
+        this.steps = (long) fields[2];
+        this.sampledSteps = (long) fields[3];
+        this.spikes = (long) fields[4];
+        this.rate = fields[5];
+        this.spikeFano = fields[6];
+        this.potentialMean = fields[7];
+        this.potentialVariance = fields[8];
+        this.lastMean = fields[9];
+        this.lastVariance = fields[10];
+        this.synchrony = fields[11];
+    }
+    
+    public int getFirst() {
+        return first;
+    }
+    
+    public int getCount() {
+        return count;
+    }
+    
+    public long getSteps() {
+        return steps;
+    }
+    
+    public long getSampledSteps() {
+        return sampledSteps;
+    }
+    
+    public long getSpikes() {
+        return spikes;
+    }
+    
+    /**
+     * @return The mean firing rate per neuron in Hz
+     */
+    public double getRate() {
+        return rate;
+    }
+    
+    /**
+     * @return Variance over mean of the spike count per step; near 1 for
+     *         neurons firing independently, larger when they fire together
+     */
+    public double getSpikeFano() {
+        return spikeFano;
+    }
+    
+    /**
+     * @return The mean potential over neurons and sampled steps in mV
+     */
+    public double getPotentialMean() {
+        return potentialMean;
+    }
+    
+    /**
+     * @return The variance of the potential over neurons and sampled steps
+     */
+    public double getPotentialVariance() {
+        return potentialVariance;
+    }
+    
+    /**
+     * @return The mean potential in the last sampled step in mV
+     */
+    public double getLastMean() {
+        return lastMean;
+    }
+    
+    /**
+     * @return The variance across neurons in the last sampled step
+     */
+    public double getLastVariance() {
+        return lastVariance;
+    }
+    
+    /**
+     * @return The share of the potential variance due to the population
+     *         mean moving; near 1 / count for independent neurons, 1 when
+     *         all neurons move together
+     */
+    public double getSynchrony() {
+        return synchrony;
+    }
+    
+    @Override
+    public String toString() {
+        return String.format("PopulationStats[%d+%d, steps=%d, spikes=%d, rate=%.2f Hz, fano=%.3f, " +
+                             "mean=%.3f mV, var=%.3f, synchrony=%.3f]",
+                             first, count, steps, spikes, rate, spikeFano,
+                             potentialMean, potentialVariance, synchrony);
+    }
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 package simulation;
 
+import java.util.ArrayList;
 import java.util.HashMap;
+import java.util.List;
 import java.util.Map;
 import java.util.concurrent.ConcurrentHashMap;
 import java.util.logging.Logger;
@@ -108,41 +110,27 @@ public class ResultProcessor {
      * @param results The results data
      */
     private void processResultData(String sessionId, Map<String, Object> results) {
-        // This is where you would implement result analysis, visualization preparation, etc.
-        // For demonstration, we'll just log some basic metrics
-        
-        // Extract neuron states if available
-        Map<Integer, Float> neuronStates = (Map<Integer, Float>) results.get("neuronStates");
-        if (neuronStates != null) {
-            float averageState = calculateAverageState(neuronStates);
-            logger.fine("Session " + sessionId + " average neuron state: " + averageState);
+        SpikeRaster raster = (SpikeRaster) results.get("spikeRaster");
+        if (raster == null || raster.getSpikeCount() == 0) {
+            return;
         }
         
-        // Extract synapse states if available
-        Map<Integer, Float> synapseStates = (Map<Integer, Float>) results.get("synapseStates");
-        if (synapseStates != null) {
-            float averageWeight = calculateAverageState(synapseStates);
-            logger.fine("Session " + sessionId + " average synapse weight: " + averageWeight);
-        }
-    }
-    
-    /**
-     * Calculate the average value of a map of states.
-     * 
-     * @param states The map of states
-     * @return The average value
-     */
-    private float calculateAverageState(Map<Integer, Float> states) {
-        if (states == null || states.isEmpty()) {
-            return 0.0f;
+        // Spike statistics of the steps this export covers
+        int activeNeurons = 0;
+        for (int count : raster.spikeCounts()) {
+            if (count > 0) {
+                activeNeurons++;
+            }
         }
-        
-        float sum = 0.0f;
-        for (Float value : states.values()) {
-            sum += value;
+        long steps = raster.getLastStep() - raster.getFirstStep() + 1;
+        
+        logger.fine("Session " + sessionId + " recorded " + raster.getSpikeCount() + " spikes of " +
+                    activeNeurons + " neurons over " + steps + " steps (" +
+                    (double) raster.getSpikeCount() / steps + " spikes per step)");
+        if (raster.getDroppedSpikes() > 0) {
+            logger.warning("Session " + sessionId + " dropped " + raster.getDroppedSpikes() +
+                           " spikes to stay within its recording budget");
         }
-        
-        return sum / states.size();
     }
     
     /**
@@ -150,23 +138,32 @@ public class ResultProcessor {
      */
     private static class SessionResults {
         private final String sessionId;
-        private final Map<String, Map<String, Object>> nodeResults;
+        private final Map<String, List<SpikeRaster>> nodeRasters;
+        private long spikeCount;
+        private long droppedSpikes;
         private long lastUpdateTime;
         
         public SessionResults(String sessionId) {
             this.sessionId = sessionId;
-            this.nodeResults = new ConcurrentHashMap<>();
+            this.nodeRasters = new ConcurrentHashMap<>();
             this.lastUpdateTime = System.currentTimeMillis();
         }
         
         /**
-         * Add results from a node.
+         * Add results from a node. Each export holds the spikes recorded
+         * since the previous one, so the rasters of a node are kept in order.
          * 
          * @param nodeId The ID of the node
          * @param results The results data
          */
-        public void addNodeResults(String nodeId, Map<String, Object> results) {
-            nodeResults.put(nodeId, results);
+        public synchronized void addNodeResults(String nodeId, Map<String, Object> results) {
+            List<SpikeRaster> rasters = nodeRasters.computeIfAbsent(nodeId, id -> new ArrayList<>());
+            SpikeRaster raster = (SpikeRaster) results.get("spikeRaster");
+            if (raster != null) {
+                rasters.add(raster);
+                spikeCount += raster.getSpikeCount();
+                droppedSpikes += raster.getDroppedSpikes();
+            }
             lastUpdateTime = System.currentTimeMillis();
         }
         
@@ -175,53 +172,25 @@ public class ResultProcessor {
          * 
          * @return The aggregated results
          */
-        public Map<String, Object> generateFinalResults() {
+        public synchronized Map<String, Object> generateFinalResults() {
             Map<String, Object> finalResults = new HashMap<>();
             finalResults.put("sessionId", sessionId);
             finalResults.put("timestamp", lastUpdateTime);
-            finalResults.put("nodeCount", nodeResults.size());
-            
-            // Aggregate neuron states across all nodes
-            Map<Integer, Float> aggregatedNeuronStates = new HashMap<>();
-            
-            // Aggregate synapse states across all nodes
-            Map<Integer, Float> aggregatedSynapseStates = new HashMap<>();
-            
-            for (Map<String, Object> nodeResult : nodeResults.values()) {
-                // Process neuron states
-                Map<Integer, Float> neuronStates = (Map<Integer, Float>) nodeResult.get("neuronStates");
-                if (neuronStates != null) {
-                    aggregatedNeuronStates.putAll(neuronStates);
-                }
-                
-                // Process synapse states
-                Map<Integer, Float> synapseStates = (Map<Integer, Float>) nodeResult.get("synapseStates");
-                if (synapseStates != null) {
-                    aggregatedSynapseStates.putAll(synapseStates);
-                }
-            }
-            
-            finalResults.put("neuronStates", aggregatedNeuronStates);
-            finalResults.put("synapseStates", aggregatedSynapseStates);
-            
-            // Calculate summary metrics
-            if (!aggregatedNeuronStates.isEmpty()) {
-                float averageNeuronState = 0.0f;
-                for (Float value : aggregatedNeuronStates.values()) {
-                    averageNeuronState += value;
-                }
-                averageNeuronState /= aggregatedNeuronStates.size();
-                finalResults.put("averageNeuronState", averageNeuronState);
-            }
+            finalResults.put("nodeCount", nodeRasters.size());
+            finalResults.put("spikeCount", spikeCount);
+            finalResults.put("droppedSpikes", droppedSpikes);
             
-            if (!aggregatedSynapseStates.isEmpty()) {
-                float averageSynapseWeight = 0.0f;
-                for (Float value : aggregatedSynapseStates.values()) {
-                    averageSynapseWeight += value;
+            // Spike rasters of each node, in export order
+            Map<String, Object> rasters = new HashMap<>();
+            long encodedSize = 0;
+            for (Map.Entry<String, List<SpikeRaster>> entry : nodeRasters.entrySet()) {
+                rasters.put(entry.getKey(), new ArrayList<Object>(entry.getValue()));
+                for (SpikeRaster raster : entry.getValue()) {
+                    encodedSize += raster.getEncodedSize();
                 }
-                averageSynapseWeight /= aggregatedSynapseStates.size();
-                finalResults.put("averageSynapseWeight", averageSynapseWeight);
             }
+            finalResults.put("spikeRasters", rasters);
+            finalResults.put("encodedSize", encodedSize);
             
             return finalResults;
         }
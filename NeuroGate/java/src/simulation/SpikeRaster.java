@@ -0,0 +1,243 @@
+package simulation;
+
+/**
+ * SpikeRaster holds the spike raster exported by a NeuroCore context:
+ * (step, neuron index) events in chunks of delta- and varint-encoded
+ * records. The encoded bytes are kept as they are and decoded on demand.
+ * 
+ * Events are ordered by step within the chunks of one recording stream,
+ * and neuron indices ascend within a step of a stream; streams follow one
+ * another, so the raster as a whole is not ordered by step.
+ */
+public class SpikeRaster {
+    
+    // Version of the export format this class reads
+    public static final int FORMAT = 1;
+    
+    private static final int HEADER_SIZE = 24;
+    private static final int CHUNK_HEADER_SIZE = 16;
+    
+    private final byte[] data;
+    private final int chunkCount;
+    private final long spikeCount;
+    private final long droppedSpikes;
+    private final long firstStep;
+    private final long lastStep;
+    private final int maxNeuron;
+    
+    /**
+     * Receives the events of a raster.
+     */
+    public interface SpikeVisitor {
+        void spike(long step, int neuron);
+    }
+    
+    /**
+     * Wrap an exported raster and check its structure.
+     * 
+     * @param data The bytes returned by the export call
+     * @throws IllegalArgumentException if the bytes are not a valid raster
+     */
+    public SpikeRaster(byte[] data) throws IllegalArgumentException {
+        if (data == null || data.length < HEADER_SIZE || readInt(data, 0) != FORMAT) {
+            throw new IllegalArgumentException("Not a spike raster of format " + FORMAT);
+        }
+        
+        this.data = data;
+        this.chunkCount = readInt(data, 4);
+        this.spikeCount = readLong(data, 8);
+        this.droppedSpikes = readLong(data, 16);
+        
+        // One decoding pass validates the chunks and collects the bounds
+        long[] bounds = { Long.MAX_VALUE, -1, -1 };
+        long decoded = decode((step, neuron) -> {
+            bounds[0] = Math.min(bounds[0], step);
+            bounds[1] = Math.max(bounds[1], step);
+            bounds[2] = Math.max(bounds[2], neuron);
+        });
+        if (decoded != spikeCount) {
+            throw new IllegalArgumentException("Spike raster holds " + decoded + " spikes, header says " + spikeCount);
+        }
+        
+        this.firstStep = decoded > 0 ? bounds[0] : 0;
+        this.lastStep = decoded > 0 ? bounds[1] : -1;
+        this.maxNeuron = (int) bounds[2];
+    }
+    
+    /**
+     * Create a raster without spikes.
+     * 
+     * @return An empty raster
+     */
+    public static SpikeRaster empty() {
+        byte[] data = new byte[HEADER_SIZE];
+        data[0] = FORMAT;
+        return new SpikeRaster(data);
+    }
+    
+    /**
+     * Visit every spike of the raster.
+     * 
+     * @param visitor The visitor called once per spike
+     */
+    public void forEach(SpikeVisitor visitor) {
+        decode(visitor);
+    }
+    
+    /**
+     * Count the spikes of each neuron.
+     * 
+     * @return Spike counts indexed by neuron, up to the highest neuron that spiked
+     */
+    public int[] spikeCounts() {
+        int[] counts = new int[maxNeuron + 1];
+        decode((step, neuron) -> counts[neuron]++);
+        return counts;
+    }
+    
+    /**
+     * Get the number of spikes in the raster.
+     * 
+     * @return The spike count
+     */
+    public long getSpikeCount() {
+        return spikeCount;
+    }
+    
+    /**
+     * Get the number of spikes a bounded recording dropped to stay within
+     * its memory budget.
+     * 
+     * @return The dropped spike count
+     */
+    public long getDroppedSpikes() {
+        return droppedSpikes;
+    }
+    
+    /**
+     * Get the earliest step with a spike.
+     * 
+     * @return The first step, or 0 if the raster is empty
+     */
+    public long getFirstStep() {
+        return firstStep;
+    }
+    
+    /**
+     * Get the latest step with a spike.
+     * 
+     * @return The last step, or -1 if the raster is empty
+     */
+    public long getLastStep() {
+        return lastStep;
+    }
+    
+    /**
+     * Get the size of the encoded raster.
+     * 
+     * @return The size in bytes
+     */
+    public int getEncodedSize() {
+        return data.length;
+    }
+    
+    @Override
+    public String toString() {
+        return "SpikeRaster[spikes=" + spikeCount + ", dropped=" + droppedSpikes +
+               ", steps=" + firstStep + ".." + lastStep + ", bytes=" + data.length + "]";
+    }
+    
+    /**
+     * Decode all chunks and pass their spikes to a visitor.
+     * 
+     * @param visitor The visitor called once per spike
+     * @return The number of spikes decoded
+     * @throws IllegalArgumentException if a chunk is malformed
+     */
+    private long decode(SpikeVisitor visitor) {
+        long decoded = 0;
+        int offset = HEADER_SIZE;
+        int[] cursor = new int[1];
+        
+        for (int c = 0; c < chunkCount; c++) {
+            if (offset + CHUNK_HEADER_SIZE > data.length) {
+                throw new IllegalArgumentException("Spike raster truncated in chunk " + c);
+            }
+            long step = readLong(data, offset);
+            int chunkSpikes = readInt(data, offset + 8);
+            int chunkBytes = readInt(data, offset + 12);
+            if (chunkBytes < 0 || chunkBytes > data.length - offset - CHUNK_HEADER_SIZE) {
+                throw new IllegalArgumentException("Spike raster truncated in chunk " + c);
+            }
+            int end = offset + CHUNK_HEADER_SIZE + chunkBytes;
+            
+            // Records: step delta, then neuron gaps ending with a zero gap
+            cursor[0] = offset + CHUNK_HEADER_SIZE;
+            long counted = 0;
+            while (cursor[0] < end) {
+                step += readVarint(cursor, end);
+                long neuron = 0;
+                long gap;
+                while ((gap = readVarint(cursor, end)) != 0) {
+                    neuron += gap;
+                    visitor.spike(step, (int) (neuron - 1));
+                    counted++;
+                }
+            }
+            
+            if (counted != chunkSpikes) {
+                throw new IllegalArgumentException("Spike raster chunk " + c + " is corrupt");
+            }
+            decoded += counted;
+            offset = end;
+        }
+        
+        return decoded;
+    }
+    
+    /**
+     * Read an unsigned LEB128 varint and advance the cursor past it.
+     * 
+     * @param cursor Holds the offset of the varint
+     * @param end The end of the chunk
+     * @return The value
+     */
+    private long readVarint(int[] cursor, int end) {
+        long value = 0;
+        int shift = 0;
+        while (true) {
+            if (cursor[0] >= end || shift > 63) {
+                throw new IllegalArgumentException("Spike raster record is truncated");
+            }
+            int b = data[cursor[0]++];
+            value |= (long) (b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+            shift += 7;
+        }
+    }
+    
+    /**
+     * Read a little-endian 32-bit integer.
+     * 
+     * @param bytes The buffer
+     * @param offset The offset of the integer
+     * @return The value
+     */
+    private static int readInt(byte[] bytes, int offset) {
+        return (bytes[offset] & 0xff) | (bytes[offset + 1] & 0xff) << 8 |
+               (bytes[offset + 2] & 0xff) << 16 | (bytes[offset + 3] & 0xff) << 24;
+    }
+    
+    /**
+     * Read a little-endian 64-bit integer.
+     * 
+     * @param bytes The buffer
+     * @param offset The offset of the integer
+     * @return The value
+     */
+    private static long readLong(byte[] bytes, int offset) {
+        return (readInt(bytes, offset) & 0xffffffffL) | (long) readInt(bytes, offset + 4) << 32;
+    }
+}
\ No newline at end of file
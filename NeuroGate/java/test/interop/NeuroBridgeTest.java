@@ -0,0 +1,64 @@
+package interop;
+
+import simulation.PopulationStats;
+
+/**
+ * Checks of NeuroBridge against the native library. Run with the library
+ * on java.library.path:
+ * 
+ *   java -Djava.library.path=build/lib -cp <classes> interop.NeuroBridgeTest
+ * 
+ * Exits with status 1 if a check fails.
+ */
+public class NeuroBridgeTest {
+    
+    private static int failures = 0;
+    
+    private static void check(boolean condition, String message) {
+        if (!condition) {
+            System.err.println("FAILED: " + message);
+            failures++;
+        }
+    }
+    
+    /**
+     * Advance a network whose neurons fire in most steps. Steps that fire
+     * must not be reported as failures.
+     */
+    private static void testAdvanceWithSpikes() {
+        NeuroBridge bridge = new NeuroBridge();
+        bridge.initialize(1);
+        try {
+            for (int i = 0; i < 10; i++) {
+                bridge.createNeuron(i, NeuroBridge.NeuronType.EXCITATORY, NeuroBridge.ActivationFunction.LINEAR);
+            }
+            int population = bridge.definePopulation(0, 10);
+            bridge.addGaussianInput(0, 10, 20.0f, 0.0f);
+            
+            float time = bridge.advance(1.0f, 50);
+            check(Math.abs(time - 50.0f) < 1e-3f, "advance returned time " + time + ", expected 50");
+            
+            PopulationStats stats = bridge.getPopulationStats(population, false);
+            check(stats.getSpikes() > 0, "no spikes in 50 driven steps");
+            
+            // Sparse input into firing neurons takes the same path
+            bridge.injectCurrents(new int[] { 0, 1 }, new float[] { 30.0f, 30.0f });
+            time = bridge.advance(1.0f, 1);
+            check(Math.abs(time - 51.0f) < 1e-3f, "advance returned time " + time + ", expected 51");
+        } catch (RuntimeException e) {
+            check(false, "advance on a spiking network threw " + e.getMessage());
+        } finally {
+            bridge.shutdown();
+        }
+    }
+    
+    public static void main(String[] args) {
+        testAdvanceWithSpikes();
+        
+        if (failures > 0) {
+            System.err.println(failures + " check(s) failed");
+            System.exit(1);
+        }
+        System.out.println("All checks passed");
+    }
+}